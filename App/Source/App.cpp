@@ -1,12 +1,1047 @@
 #include "Core/World.h"
+#include "Core/PerfCounters.h"
+#include "Core/ShardLauncher.h"
+#include "Core/ScenarioFile.h"
+#include "Core/MobilityModels.h"
+#include "ScenarioSupport.h"
 
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <map>
+#include <ctime>
+#include <random>
+
+// App --shards N [--ues M] [--grid G] [--epochs E] [--threads T] [--pin]
+// runs the sharded mobility scenario instead of the protocol walkthrough
+static int RunShardedScenario(int argc, char** argv) {
+    ShardScenario scenario;
+    size_t shards = 1;
+    ScenarioOptions cli;
+    cli.Value("--shards", shards)
+       .Value("--ues", scenario.ueCount)
+       .Value("--grid", [&](const std::string& value) { scenario.gnbCols = scenario.gnbRows = static_cast<uint32_t>(std::stoul(value)); })
+       .Value("--epochs", scenario.epochs)
+       .Value("--threads", scenario.threadsPerShard)
+       .Value("--seed", scenario.seed)
+       .Switch("--pin", scenario.pinCpus)
+       .Switch("--verbose", scenario.verbose);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+
+    auto report = ShardLauncher::Launch(scenario, shards);
+    if (!report) {
+        return 1;
+    }
+    report->Print();
+    return 0;
+}
+
+// App --cells [--grid G] [--ues M] [--duration S] [--threads T] [--seed S]
+// runs World::runCellSimulation on the same G x G cell world with 1, 2, 4,
+// ... up to T threads, checks that every run ends with the same digest and
+// reports each run's speedup over one thread. The default world is sized so
+// a run takes about a second. Protocol logging is muted while running.
+static int RunCellScenario(int argc, char** argv) {
+    uint32_t grid = 8;
+    uint32_t ueCount = 50000;
+    float duration = 10.0f;
+    size_t maxThreads = std::max(2u, std::thread::hardware_concurrency());
+    uint64_t seed = 1;
+    ScenarioOptions cli("--cells");
+    cli.Value("--grid", grid)
+       .Value("--ues", ueCount)
+       .Value("--duration", duration)
+       .Value("--threads", maxThreads)
+       .Value("--seed", seed);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+    grid = std::max<uint32_t>(grid, 1);
+    maxThreads = std::max<size_t>(maxThreads, 1);
+
+    const uint32_t spacing = 1000;
+    auto setup = [&](World& world) {
+        for (uint32_t row = 0; row < grid; ++row) {
+            for (uint32_t col = 0; col < grid; ++col) {
+                world.addGNB(row * grid + col + 1, col * spacing + spacing / 2, row * spacing + spacing / 2);
+            }
+        }
+        std::mt19937_64 rng(seed);
+        for (uint32_t i = 0; i < ueCount; ++i) {
+            UE* ue = world.addUE(i + 1, static_cast<uint32_t>(rng() % (grid * spacing)), static_cast<uint32_t>(rng() % (grid * spacing)));
+            ue->SetVelocity(10 + static_cast<uint32_t>(rng() % 90), 10 + static_cast<uint32_t>(rng() % 90));
+        }
+    };
+
+    std::cout << "\n===== Cell-Partitioned Simulation (" << grid * grid << " cells, " << ueCount << " UEs, "
+              << duration << " s) =====" << std::endl;
+    uint64_t expected = 0;
+    double singleMs = 0.0;
+    bool identical = true;
+    for (size_t threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        MutedConsole muted;
+        World world;
+        setup(world);
+        auto start = std::chrono::steady_clock::now();
+        CellSimulationStats stats = world.runCellSimulation(duration, 0.1f, 0.01f, threads);
+        const double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        muted.Restore();
+
+        if (threads == 1) {
+            expected = stats.digest;
+            singleMs = wallMs;
+        }
+        identical = identical && stats.digest == expected;
+        std::cout << "Threads=" << threads << " digest=" << std::hex << stats.digest << std::dec
+                  << " events=" << stats.engine.events << " reassociations=" << stats.reassociations
+                  << " wall=" << wallMs << " ms speedup=" << singleMs / wallMs << "x"
+                  << (stats.digest == expected ? "" : " MISMATCH") << std::endl;
+        if (threads == maxThreads) break;
+    }
+    std::cout << "Digest identical across thread counts: " << (identical ? "yes" : "no") << std::endl;
+    return identical ? 0 : 1;
+}
+
+// App --scenario FILE loads a binary scenario, authenticates every UAV and
+// connects the first UE through the nearest authenticated UAV
+static int RunScenarioFile(const std::string& path) {
+    World world;
+    if (!world.loadScenario(path)) {
+        return 1;
+    }
+    world.linkEntities();
+    world.setupInfrastructure();
+
+    std::cout << "\n\n===== PHASE A: UAV Service Authentication =====" << std::endl;
+    std::vector<int> uavIds;
+    world.uavs.ForEach([&](const UAV& uav) { uavIds.push_back(static_cast<int>(uav.GetID())); });
+    world.authenticateUAVFleet(uavIds);
+
+    const UE* firstUE = nullptr;
+    world.ues.ForEach([&](const UE& ue) { if (!firstUE) firstUE = &ue; });
+    if (firstUE && !uavIds.empty()) {
+        std::cout << "\n\n===== PHASE B: UE Connects via Authenticated UAV =====" << std::endl;
+        world.simulateUAVAssistedConnection(static_cast<int>(firstUE->GetID()));
+    }
+    world.printStateMachineReport();
+    return 0;
+}
+
+// App --snapshot [--ues N] [--file PATH] warms a World (UAVs authorized,
+// the first half of the UEs attached), saves it, restores it into a fresh
+// World and then hands the attached UEs over and attaches the rest on the
+// restored state. Exits non-zero if any step fails on the restored World.
+static int RunSnapshotScenario(int argc, char** argv) {
+    uint32_t ueCount = 200;
+    std::string path = (std::filesystem::temp_directory_path() / "world.snap").string();
+    ScenarioOptions cli("--snapshot");
+    cli.Value("--ues", ueCount)
+       .Value("--file", path);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+    // Three-digit IDs for the placeholder SUCI layout
+    ueCount = std::clamp<uint32_t>(ueCount, 2, 700);
+    const uint32_t warm = ueCount / 2;
+    using Millis = std::chrono::duration<double, std::milli>;
+
+    // Serving UAV of each warm UE, -1 if it is not connected
+    auto servingUAVs = [&](World& world) {
+        std::vector<int> serving;
+        for (uint32_t i = 0; i < warm; ++i) {
+            const UE* ue = world.findUE(300 + i);
+            serving.push_back(ue && ue->GetState() == UEState::Connected ? ue->GetServingUAVId() : -1);
+        }
+        return serving;
+    };
+
+    MutedConsole muted;
+    World original;
+    original.addGNB(1, 500, 500);
+    original.addUAV(101, 450, 500);
+    original.addUAV(102, 550, 500);
+    for (uint32_t i = 0; i < ueCount; ++i) {
+        original.addUE(300 + i, 450, 500, "5G_LONG_TERM_KEY");
+    }
+    original.linkEntities();
+    original.setupInfrastructure();
+    original.simulateUAVServiceAuthentication(101);
+    original.simulateUAVServiceAuthentication(102);
+    for (uint32_t i = 0; i < warm; ++i) {
+        original.simulateUAVAssistedConnection(static_cast<int>(300 + i));
+    }
+    const std::vector<int> warmServing = servingUAVs(original);
+    const uint32_t warmConnected = static_cast<uint32_t>(warm - std::count(warmServing.begin(), warmServing.end(), -1));
+
+    auto saveStart = std::chrono::steady_clock::now();
+    bool saved = original.saveSnapshot(path);
+    const double saveMs = Millis(std::chrono::steady_clock::now() - saveStart).count();
+    World restored;
+    auto loadStart = std::chrono::steady_clock::now();
+    bool loaded = saved && restored.loadSnapshot(path);
+    const double loadMs = Millis(std::chrono::steady_clock::now() - loadStart).count();
+    uint32_t restoredConnected = 0;
+    if (loaded) {
+        std::vector<int> serving = servingUAVs(restored);
+        for (uint32_t i = 0; i < warm; ++i) restoredConnected += serving[i] >= 0 && serving[i] == warmServing[i] ? 1 : 0;
+    }
+
+    // Phase C for the restored sessions, then Phase B for the cold UEs
+    PathCost handover = MeasurePath(loaded ? warm : 0, [&](uint32_t i) {
+        int ueId = static_cast<int>(300 + i);
+        int target = warmServing[i] == 101 ? 102 : 101;
+        restored.simulateUEHandoverAuthentication(ueId, target);
+        return restored.findUE(ueId)->GetServingUAVId() == target;
+    });
+    PathCost attach = MeasurePath(loaded ? ueCount - warm : 0, [&](uint32_t i) {
+        int ueId = static_cast<int>(300 + warm + i);
+        restored.simulateUAVAssistedConnection(ueId);
+        return restored.findUE(ueId)->GetState() == UEState::Connected;
+    });
+    muted.Restore();
+
+    std::cout << "\n===== Snapshot Round Trip (" << ueCount << " UEs, " << warm << " attached) =====" << std::endl;
+    if (!loaded) {
+        std::cout << "Snapshot " << path << " could not be " << (saved ? "restored" : "saved") << std::endl;
+        return 1;
+    }
+    std::cout << "Saved " << std::filesystem::file_size(path) << " bytes in " << saveMs << " ms, restored in "
+              << loadMs << " ms" << std::endl;
+    std::cout << "Restored sessions: " << restoredConnected << "/" << warmConnected << " UEs on the same UAV" << std::endl;
+    std::cout << "Handover after restore: " << handover.succeeded << "/" << warm << " to the other UAV, "
+              << handover.wallUs << " us/UE" << std::endl;
+    std::cout << "Attach after restore:   " << attach.succeeded << "/" << ueCount - warm << " connected, "
+              << attach.wallUs << " us/UE" << std::endl;
+    bool ok = restoredConnected == warmConnected && warmConnected == warm
+        && handover.succeeded == warm && attach.succeeded == ueCount - warm;
+    std::cout << "Round trip: " << (ok ? "ok" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// App --churn [--rate R] [--dwell D] [--duration T] [--scale S] [--capacity C]
+// [--trace FILE] runs the open-system UE arrival/departure workload on the
+// demo topology. UE IDs are drawn from 300..300+C-1 and stay three digits,
+// which the placeholder SUCI layout expects.
+static int RunChurnScenario(int argc, char** argv) {
+    PoissonArrivals::Params poisson;
+    poisson.minX = 250;
+    poisson.minY = 250;
+    poisson.maxX = 750;
+    poisson.maxY = 750;
+    ChurnOptions options;
+    uint32_t capacity = 200;
+    std::string tracePath;
+    ScenarioOptions cli("--churn");
+    cli.Value("--rate", poisson.rate)
+       .Value("--dwell", poisson.meanDwell)
+       .Value("--duration", options.duration)
+       .Value("--scale", options.timeScale)
+       .Value("--capacity", capacity)
+       .Value("--trace", tracePath)
+       .Value("--seed", poisson.seed);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+    capacity = std::min<uint32_t>(capacity, 700);
+
+    std::unique_ptr<ArrivalSource> source;
+    if (!tracePath.empty()) {
+        auto trace = std::make_unique<TraceArrivals>(tracePath);
+        if (!trace->IsOpen()) return 1;
+        source = std::move(trace);
+    } else {
+        source = std::make_unique<PoissonArrivals>(poisson);
+    }
+
+    World world;
+    world.addGNB(1, 500, 500);
+    world.addUAV(101, 300, 300);
+    world.addUAV(102, 700, 700);
+    world.setupInfrastructure();
+    world.simulateUAVServiceAuthentication(101);
+    world.simulateUAVServiceAuthentication(102);
+
+    ChurnGenerator generator(std::move(source), 300, capacity);
+    world.runChurnWorkload(generator, options);
+    world.printStateMachineReport();
+    return 0;
+}
+
+// App --generate-trace waypoint|gauss-markov|flight-plan OUT [--kind ue|uav]
+// [--entities N] [--first-id I] [--ticks T] [--tick S] [--area W]
+// [--speed V] [--keyframe K] [--seed S] writes a binary mobility trace
+static int RunTraceGenerator(int argc, char** argv) {
+    std::string model, outPath;
+    TraceGeneration generation;
+    generation.count = 1000;
+    generation.ticks = 3600;
+    MobilityArea area;
+    double speed = 10.0;
+    uint64_t seed = 1;
+    ScenarioOptions cli;
+    cli.Values("--generate-trace", 2, [&](char** values) { model = values[0]; outPath = values[1]; })
+       .Value("--kind", [&](const std::string& kind) {
+           generation.kind = kind == "uav" ? MobilityTraceFormat::EntityKind::UAV : MobilityTraceFormat::EntityKind::UE;
+       })
+       .Value("--entities", generation.count)
+       .Value("--first-id", generation.firstId)
+       .Value("--ticks", generation.ticks)
+       .Value("--tick", generation.tickSeconds)
+       .Value("--area", [&](const std::string& value) { area.maxX = area.maxY = std::stod(value); })
+       .Value("--speed", speed)
+       .Value("--keyframe", generation.keyframeInterval)
+       .Value("--seed", seed);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+
+    std::unique_ptr<MobilityModel> mobility;
+    if (model == "waypoint") {
+        RandomWaypointModel::Params params;
+        params.area = area;
+        params.maxSpeed = speed;
+        params.seed = seed;
+        mobility = std::make_unique<RandomWaypointModel>(params);
+    } else if (model == "gauss-markov") {
+        GaussMarkovModel::Params params;
+        params.area = area;
+        params.meanSpeed = speed;
+        params.seed = seed;
+        mobility = std::make_unique<GaussMarkovModel>(params);
+    } else if (model == "flight-plan") {
+        FlightPlanModel::Params params;
+        params.area = area;
+        params.cruiseSpeed = speed;
+        mobility = std::make_unique<FlightPlanModel>(params);
+    } else {
+        std::cerr << "Unknown mobility model: " << model << std::endl;
+        return 1;
+    }
+    return WriteMobilityTrace(*mobility, generation, outPath) ? 0 : 1;
+}
+
+// App --handover [--ues N] [--duration T] [--trace FILE] [--hysteresis H]
+// [--rate R] [--seed S] [--predict L] moves UEs among a 3x3 grid of UAVs
+// and lets the World hand them over automatically. Without --trace a
+// Gauss-Markov trace is generated first. --predict sends handover hints to
+// the UAV each UE is heading for, L simulated seconds ahead.
+static int RunHandoverScenario(int argc, char** argv) {
+    uint32_t ueCount = 200;
+    double duration = 60.0;
+    std::string tracePath;
+    HandoverPolicy policy;
+    uint64_t seed = 1;
+    ScenarioOptions cli("--handover");
+    cli.Value("--ues", ueCount)
+       .Value("--duration", duration)
+       .Value("--trace", tracePath)
+       .Value("--hysteresis", policy.hysteresis)
+       .Value("--rate", policy.maxPerSecond)
+       .Value("--seed", seed)
+       .Value("--predict", policy.predictLookahead);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+    // Three-digit IDs for the placeholder SUCI layout
+    ueCount = std::min<uint32_t>(ueCount, 700);
+
+    const double tick = 0.1;
+    if (tracePath.empty()) {
+        tracePath = (std::filesystem::temp_directory_path() / "handover_mobility.ktrc").string();
+        GaussMarkovModel::Params params;
+        params.seed = seed;
+        GaussMarkovModel model(params);
+        TraceGeneration generation;
+        generation.firstId = 300;
+        generation.count = ueCount;
+        generation.ticks = static_cast<uint64_t>(duration / tick) + 1;
+        generation.tickSeconds = tick;
+        if (!WriteMobilityTrace(model, generation, tracePath)) return 1;
+    }
+
+    World world;
+    world.addGNB(1, 500, 500);
+    for (uint32_t i = 0; i < 9; ++i) {
+        world.addUAV(101 + i, 167 + 333 * (i % 3), 167 + 333 * (i / 3));
+    }
+    for (uint32_t i = 0; i < ueCount; ++i) {
+        world.addUE(300 + i, 500, 500, "5G_LONG_TERM_KEY");
+    }
+    world.linkEntities();
+    world.setupInfrastructure();
+    for (uint32_t i = 0; i < 9; ++i) {
+        world.simulateUAVServiceAuthentication(static_cast<int>(101 + i));
+    }
+    if (!world.attachMobilityTrace(tracePath)) return 1;
+    for (uint32_t i = 0; i < ueCount; ++i) {
+        world.simulateUAVAssistedConnection(static_cast<int>(300 + i));
+    }
+
+    world.enableAutomaticHandover(policy);
+    for (double t = 0.0; t < duration; t += tick) {
+        world.update(static_cast<float>(tick));
+    }
+    world.printHandoverReport();
+    return 0;
+}
+
+// App --uav-failure [--ues N] [--threads T] attaches N UEs around the
+// centre UAV of a 3x3 grid, fails it and reports how long re-homing takes
+static int RunUAVFailureScenario(int argc, char** argv) {
+    uint32_t ueCount = 300;
+    size_t threads = 4;
+    ScenarioOptions cli("--uav-failure");
+    cli.Value("--ues", ueCount)
+       .Value("--threads", threads);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+    ueCount = std::min<uint32_t>(ueCount, 700);
+
+    World world;
+    world.addGNB(1, 500, 500);
+    for (uint32_t i = 0; i < 9; ++i) {
+        world.addUAV(101 + i, 167 + 333 * (i % 3), 167 + 333 * (i / 3));
+    }
+    // Spread within the centre UAV's cell so every neighbour takes some
+    for (uint32_t i = 0; i < ueCount; ++i) {
+        world.addUE(300 + i, 340 + (i * 37) % 320, 340 + (i * 91) % 320, "5G_LONG_TERM_KEY");
+    }
+    world.linkEntities();
+    world.setupInfrastructure();
+    for (uint32_t i = 0; i < 9; ++i) {
+        world.simulateUAVServiceAuthentication(static_cast<int>(101 + i));
+    }
+    for (uint32_t i = 0; i < ueCount; ++i) {
+        world.simulateUAVAssistedConnection(static_cast<int>(300 + i));
+    }
+
+    UAVFailureReport report = world.simulateUAVFailure(105, threads);
+    std::cout << "\n===== UAV Failure Recovery =====" << std::endl;
+    std::cout << "Affected=" << report.affected << " HandedOver=" << report.handedOver
+              << " Reauthenticated=" << report.reauthenticated << " Stranded=" << report.stranded
+              << " Targets=" << report.targets << " Recovery=" << report.recovery.count() / 1000.0 << " ms" << std::endl;
+    return report.stranded == 0 ? 0 : 1;
+}
+
+// App --load-balance [--ues N] [--capacity C] [--load-weight W] attaches N
+// UEs clustered around the centre UAV of a 3x3 grid with at most C UEs per
+// UAV and prints how the relay load spread across the fleet
+static int RunLoadBalanceScenario(int argc, char** argv) {
+    uint32_t ueCount = 300;
+    RelayCapacity capacity;
+    capacity.maxConnectedUEs = 60;
+    UAVSelectionPolicy policy;
+    ScenarioOptions cli("--load-balance");
+    cli.Value("--ues", ueCount)
+       .Value("--capacity", capacity.maxConnectedUEs)
+       .Value("--load-weight", policy.connectedWeight);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+    ueCount = std::min<uint32_t>(ueCount, 700);
+
+    World world;
+    world.addGNB(1, 500, 500);
+    for (uint32_t i = 0; i < 9; ++i) {
+        world.addUAV(101 + i, 167 + 333 * (i % 3), 167 + 333 * (i / 3));
+    }
+    for (uint32_t i = 0; i < ueCount; ++i) {
+        world.addUE(300 + i, 400 + (i * 37) % 200, 400 + (i * 91) % 200, "5G_LONG_TERM_KEY");
+    }
+    world.linkEntities();
+    world.setupInfrastructure();
+    world.setUAVSelectionPolicy(policy);
+    world.setRelayCapacity(capacity);
+    for (uint32_t i = 0; i < 9; ++i) {
+        world.simulateUAVServiceAuthentication(static_cast<int>(101 + i));
+    }
+    uint32_t attached = 0;
+    for (uint32_t i = 0; i < ueCount; ++i) {
+        world.simulateUAVAssistedConnection(static_cast<int>(300 + i));
+        if (world.findUE(static_cast<int>(300 + i))->GetState() == UEState::Connected) attached++;
+    }
+    world.printRelayLoadReport();
+    std::cout << "Attached=" << attached << " of " << ueCount << std::endl;
+    return attached == ueCount ? 0 : 1;
+}
+
+// App --multi-gnb [--gnbs G] [--ues N] [--threads T] [--hash] lays out G
+// cells in a row, partitions N UEs between them by region (or consistent
+// hashing) and runs concurrent Phase B, so the rate shows how auth capacity
+// scales with the number of gNBs
+static int RunMultiGNBScenario(int argc, char** argv) {
+    uint32_t gnbCount = 4;
+    uint32_t ueCount = 400;
+    size_t threads = 4;
+    HomePartitioning partitioning = HomePartitioning::Region;
+    ScenarioOptions cli("--multi-gnb");
+    cli.Value("--gnbs", gnbCount)
+       .Value("--ues", ueCount)
+       .Value("--threads", threads)
+       .Values("--hash", 0, [&](char**) { partitioning = HomePartitioning::ConsistentHash; });
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+    gnbCount = std::clamp<uint32_t>(gnbCount, 1, 50);
+    ueCount = std::min<uint32_t>(ueCount, 700);
+
+    World world;
+    world.setHomePartitioning(partitioning);
+    for (uint32_t g = 0; g < gnbCount; ++g) {
+        uint32_t cx = 500 + 1000 * g;
+        world.addGNB(1 + g, cx, 500);
+        for (uint32_t k = 0; k < 4; ++k) {
+            world.addUAV(101 + 4 * g + k, cx - 250 + 500 * (k % 2), 250 + 500 * (k / 2));
+        }
+    }
+    for (uint32_t i = 0; i < ueCount; ++i) {
+        world.addUE(300 + i, (i * 7919) % (1000 * gnbCount), 300 + (i * 37) % 400, "5G_LONG_TERM_KEY");
+    }
+    world.linkEntities();
+    auto start = std::chrono::steady_clock::now();
+    world.setupInfrastructure();
+    double setupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    world.uavs.ForEach([&](const UAV& uav) { world.simulateUAVServiceAuthentication(static_cast<int>(uav.GetID())); });
+
+    std::vector<int> ueIds;
+    for (uint32_t i = 0; i < ueCount; ++i) ueIds.push_back(static_cast<int>(300 + i));
+    start = std::chrono::steady_clock::now();
+    auto results = world.simulateConcurrentUEAccess(ueIds, threads);
+    double accessSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::map<int, uint32_t> perGNB;
+    uint32_t succeeded = 0;
+    for (const AuthResult& result : results) {
+        if (result.status != AuthResult::Status::Success) continue;
+        succeeded++;
+        perGNB[world.findUE(result.entityId)->GetServingGNBId()]++;
+    }
+    std::cout << "\n===== Multi-gNB Access =====" << std::endl;
+    std::cout << "gNBs=" << gnbCount << " Partitioning=" << (partitioning == HomePartitioning::Region ? "region" : "hash")
+              << " Setup=" << setupMs << " ms Authenticated=" << succeeded << "/" << ueCount
+              << " Rate=" << (accessSeconds > 0 ? succeeded / accessSeconds : 0.0) << " UEs/s" << std::endl;
+    for (const auto& [gnbId, count] : perGNB) std::cout << "  gNB " << gnbId << ": " << count << " UEs" << std::endl;
+    return succeeded == ueCount ? 0 : 1;
+}
+
+// App --xn-handover [--ues N] compares the two ways a UE can move to a UAV
+// of a neighbouring gNB: Xn preparation + Phase C for N UEs against a full
+// Phase B for another N. Protocol logging is muted while timing.
+static int RunXnHandoverScenario(int argc, char** argv) {
+    uint32_t ueCount = 200;
+    ScenarioOptions cli("--xn-handover");
+    cli.Value("--ues", ueCount);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+    ueCount = std::clamp<uint32_t>(ueCount, 1, 350);
+
+    World world;
+    gNB* source = world.addGNB(1, 500, 500);
+    gNB* target = world.addGNB(2, 1500, 500);
+    world.addUAV(101, 900, 500);
+    world.addUAV(102, 1100, 500);
+    // Both groups are homed at gNB 1, on the border with gNB 2
+    for (uint32_t i = 0; i < 2 * ueCount; ++i) {
+        world.addUE(300 + i, 950 + i % 50, 450 + i % 100, "5G_LONG_TERM_KEY");
+    }
+    world.linkEntities();
+    world.setupInfrastructure();
+    world.simulateUAVServiceAuthentication(101);
+    world.simulateUAVServiceAuthentication(102);
+    for (uint32_t i = 0; i < ueCount; ++i) {
+        world.simulateUAVAssistedConnection(static_cast<int>(300 + i));
+    }
+
+    PathCost xn = MeasurePath(ueCount, [&](uint32_t i) {
+        int ueId = static_cast<int>(300 + i);
+        world.simulateUEHandoverAuthentication(ueId, 102);
+        UE* ue = world.findUE(ueId);
+        return ue->GetServingUAVId() == 102 && ue->GetServingGNBId() == 2;
+    });
+    PathCost full = MeasurePath(ueCount, [&](uint32_t i) {
+        int ueId = static_cast<int>(300 + ueCount + i);
+        world.simulateUAVAssistedConnection(ueId);
+        return world.findUE(ueId)->GetState() == UEState::Connected;
+    });
+
+    std::cout << "\n===== Inter-gNB Handover =====" << std::endl;
+    std::cout << "Xn + Phase C: " << xn.succeeded << "/" << ueCount << " ok, " << xn.wallUs << " us/UE wall, "
+              << xn.cpuUs << " us/UE CPU" << std::endl;
+    std::cout << "Full Phase B: " << full.succeeded << "/" << ueCount << " ok, " << full.wallUs << " us/UE wall, "
+              << full.cpuUs << " us/UE CPU" << std::endl;
+    std::cout << "Speedup: " << (xn.wallUs > 0 ? full.wallUs / xn.wallUs : 0.0) << "x wall, "
+              << (xn.cpuUs > 0 ? full.cpuUs / xn.cpuUs : 0.0) << "x CPU" << std::endl;
+    std::cout << "gNB 1 Xn prepared=" << source->GetXnStats().prepared << " rejected=" << source->GetXnStats().rejected
+              << "; gNB 2 Xn accepted=" << target->GetXnStats().accepted << " rejected=" << target->GetXnStats().rejected << std::endl;
+    return xn.succeeded == ueCount && full.succeeded == ueCount ? 0 : 1;
+}
+
+// App --resumption [--ues N] [--rounds R] [--cache C] attaches N UEs with a
+// full Phase B, then disconnects and re-attaches them R times. Re-attaches
+// resume from the gNB's cache (bounded to C entries) and fall back to
+// Phase B on a miss. Protocol logging is muted while timing.
+static int RunResumptionScenario(int argc, char** argv) {
+    uint32_t ueCount = 300;
+    uint32_t rounds = 3;
+    ResumptionLimits limits;
+    ScenarioOptions cli("--resumption");
+    cli.Value("--ues", ueCount)
+       .Value("--rounds", rounds)
+       .Value("--cache", limits.maxEntries);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+    ueCount = std::clamp<uint32_t>(ueCount, 1, 700);
+
+    World world;
+    world.addGNB(1, 500, 500);
+    world.addUAV(101, 400, 500);
+    world.addUAV(102, 600, 500);
+    for (uint32_t i = 0; i < ueCount; ++i) {
+        world.addUE(300 + i, 300 + i % 400, 400 + i % 200, "5G_LONG_TERM_KEY");
+    }
+    world.linkEntities();
+    world.setupInfrastructure();
+    world.setResumptionLimits(limits);
+    world.simulateUAVServiceAuthentication(101);
+    world.simulateUAVServiceAuthentication(102);
+
+    std::cout << "\n===== Fast Re-authentication =====" << std::endl;
+    bool allConnected = true;
+    for (uint32_t round = 0; round <= rounds; ++round) {
+        PathCost attach = MeasurePath(ueCount, [&](uint32_t i) {
+            int ueId = static_cast<int>(300 + i);
+            world.simulateUAVAssistedConnection(ueId);
+            return world.findUE(ueId)->GetState() == UEState::Connected;
+        });
+
+        // Everyone leaves again; the gNB keeps their contexts
+        MutedConsole muted;
+        for (uint32_t i = 0; i < ueCount && round < rounds; ++i) {
+            UE* ue = world.findUE(300 + i);
+            if (UAV* uav = world.findUAV(ue->GetServingUAVId())) uav->ReleaseUE(ue->GetID());
+            ue->Disconnect();
+        }
+        muted.Restore();
+        std::cout << (round == 0 ? "Initial attach: " : "Re-attach " + std::to_string(round) + ":   ") << attach.succeeded << "/" << ueCount
+                  << " connected, " << attach.wallUs << " us/UE wall, " << attach.cpuUs << " us/UE CPU" << std::endl;
+        allConnected = allConnected && attach.succeeded == ueCount;
+    }
+    world.printResumptionReport();
+    return allConnected ? 0 : 1;
+}
+
+// App --token-cache [--ues N] [--rounds R] [--cache C] [--reps K] attaches N
+// UEs and hands each back and forth between UAVs 101 and 102, once with the
+// target UAVs' verified-token cache off and once bounded to C entries. Two
+// untimed rounds first give every UE a contact at both UAVs, so the R timed
+// rounds compare cache hits against misses for the same warm UEs. The two
+// runs alternate K times and the medians are reported. Protocol logging is
+// muted while timing.
+static int RunTokenCacheScenario(int argc, char** argv) {
+    uint32_t ueCount = 200;
+    uint32_t rounds = 10;
+    uint32_t reps = 5;
+    TokenCacheLimits limits;
+    ScenarioOptions cli("--token-cache");
+    cli.Value("--ues", ueCount)
+       .Value("--rounds", rounds)
+       .Value("--cache", limits.maxEntries)
+       .Value("--reps", reps);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+    ueCount = std::clamp<uint32_t>(ueCount, 1, 700);
+    rounds = std::max<uint32_t>(rounds, 1);
+    reps = std::max<uint32_t>(reps, 1);
+
+    // One handover per UE per round, in rounds
+    auto handOver = [&](World& world, uint32_t count) {
+        return MeasurePath(ueCount * count, [&](uint32_t i) {
+            int ueId = static_cast<int>(300 + i % ueCount);
+            int target = world.findUE(ueId)->GetServingUAVId() == 101 ? 102 : 101;
+            world.simulateUEHandoverAuthentication(ueId, target);
+            return world.findUE(ueId)->GetServingUAVId() == target;
+        });
+    };
+    auto targetTotals = [](World& world) {
+        const TokenCacheStats& a = world.findUAV(101)->GetTokenCacheStats();
+        const TokenCacheStats& b = world.findUAV(102)->GetTokenCacheStats();
+        return std::make_pair(a.hits + b.hits, a.hitTime + a.missTime + b.hitTime + b.missTime);
+    };
+    struct CacheRun {
+        PathCost handovers;
+        uint64_t hits = 0;
+        double targetUs = 0.0; // Target UAV processing per handover
+    };
+    auto run = [&](World& world, const TokenCacheLimits& cacheLimits) {
+        CacheRun result;
+        {
+            MutedConsole muted;
+            world.addGNB(1, 500, 500);
+            world.addUAV(101, 450, 500);
+            world.addUAV(102, 550, 500);
+            for (uint32_t i = 0; i < ueCount; ++i) {
+                world.addUE(300 + i, 450, 500, "5G_LONG_TERM_KEY");
+            }
+            world.linkEntities();
+            world.setupInfrastructure();
+            world.setTokenCacheLimits(cacheLimits);
+            world.simulateUAVServiceAuthentication(101);
+            world.simulateUAVServiceAuthentication(102);
+            for (uint32_t i = 0; i < ueCount; ++i) {
+                world.simulateUAVAssistedConnection(static_cast<int>(300 + i));
+            }
+        }
+        handOver(world, 2);
+
+        auto [hitsBefore, timeBefore] = targetTotals(world);
+        result.handovers = handOver(world, rounds);
+        auto [hitsAfter, timeAfter] = targetTotals(world);
+        result.hits = hitsAfter - hitsBefore;
+        result.targetUs = std::chrono::duration<double, std::micro>(timeAfter - timeBefore).count() / (ueCount * rounds);
+        return result;
+    };
+
+    // Alternate the two so drift on the host hits both alike
+    std::vector<double> offWall, offTarget, onWall, onTarget;
+    uint32_t offOk = 0, onOk = 0;
+    uint64_t onHits = 0;
+    World cached;
+    for (uint32_t rep = 0; rep < reps; ++rep) {
+        World uncached;
+        TokenCacheLimits off;
+        off.maxEntries = 0;
+        CacheRun without = run(uncached, off);
+        offOk += without.handovers.succeeded;
+        offWall.push_back(without.handovers.wallUs);
+        offTarget.push_back(without.targetUs);
+
+        World scratch;
+        CacheRun with = run(rep + 1 == reps ? cached : scratch, limits);
+        onOk += with.handovers.succeeded;
+        onHits += with.hits;
+        onWall.push_back(with.handovers.wallUs);
+        onTarget.push_back(with.targetUs);
+    }
+
+    const uint32_t total = ueCount * rounds * reps;
+    const double offTargetUs = HandoverStats::Percentile(offTarget, 0.5);
+    const double onTargetUs = HandoverStats::Percentile(onTarget, 0.5);
+    std::cout << "\n===== Verified-Token Cache (" << reps << " runs each, medians) =====" << std::endl;
+    std::cout << "Cache off: " << offOk << "/" << total << " handovers ok, " << HandoverStats::Percentile(offWall, 0.5)
+              << " us/handover wall, " << offTargetUs << " us/handover at the target UAV" << std::endl;
+    std::cout << "Cache on:  " << onOk << "/" << total << " handovers ok, " << HandoverStats::Percentile(onWall, 0.5)
+              << " us/handover wall, " << onTargetUs << " us/handover at the target UAV, "
+              << 100.0 * onHits / total << "% hits" << std::endl;
+    std::cout << "Target UAV: " << (onTargetUs > 0 ? offTargetUs / onTargetUs : 0.0) << "x, range off "
+              << HandoverStats::Percentile(offTarget, 0.0) << "-" << HandoverStats::Percentile(offTarget, 1.0) << " us, on "
+              << HandoverStats::Percentile(onTarget, 0.0) << "-" << HandoverStats::Percentile(onTarget, 1.0) << " us" << std::endl;
+    cached.printTokenCacheReport();
+    return offOk == total && onOk == total ? 0 : 1;
+}
+
+// App --sqn-window [--ues N] [--burst B] [--ind-bits K] has every UE build B
+// SUCIs back to back and the gNB verify them in shuffled order, as happens
+// when attempts are pipelined. Run once with a single SQN slot (the last
+// accepted SQN only) and once with 2^K slots; counts the resyncs.
+static int RunSQNWindowScenario(int argc, char** argv) {
+    uint32_t ueCount = 100;
+    uint32_t burst = 8;
+    uint32_t indBits = 5;
+    ScenarioOptions cli("--sqn-window");
+    cli.Value("--ues", ueCount)
+       .Value("--burst", burst)
+       .Value("--ind-bits", indBits);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+    ueCount = std::clamp<uint32_t>(ueCount, 1, 700);
+    burst = std::max<uint32_t>(burst, 1);
+
+    std::cout << "\n===== SQN Window =====" << std::endl;
+    uint64_t windowResyncs = 0;
+    for (uint32_t bits : { 0u, indBits }) {
+        World world;
+        gNB* gnb = world.addGNB(1, 500, 500);
+        UAV* uav = world.addUAV(101, 500, 500);
+        for (uint32_t i = 0; i < ueCount; ++i) {
+            world.addUE(300 + i, 400 + i % 200, 400, "5G_LONG_TERM_KEY");
+        }
+        world.linkEntities();
+        world.setupInfrastructure();
+        world.setSQNWindow(bits);
+        world.simulateUAVServiceAuthentication(101);
+
+        struct Attempt {
+            int ueId;
+            std::vector<uint8_t> suci;
+        };
+        std::vector<Attempt> attempts;
+        MutedConsole muted;
+        for (uint32_t i = 0; i < ueCount; ++i) {
+            UE* ue = world.findUE(300 + i);
+            for (uint32_t b = 0; b < burst; ++b) {
+                if (auto suci = ue->BuildConnectionRequest(*uav)) attempts.push_back({ static_cast<int>(ue->GetID()), std::move(*suci) });
+            }
+        }
+        std::shuffle(attempts.begin(), attempts.end(), std::mt19937(7));
+        size_t accepted = 0;
+        for (const Attempt& attempt : attempts) {
+            UEAuthResponse response = gnb->AuthenticateUE(attempt.suci, uav->GetTID(), uav->GetID(), attempt.ueId);
+            accepted += response.outcome == UEAuthResponse::Outcome::Accepted ? 1 : 0;
+        }
+        muted.Restore();
+        std::cout << (1u << gnb->GetSQNWindowBits()) << " SQN slot(s): " << accepted << "/" << attempts.size()
+                  << " accepted, " << gnb->GetSyncFailureCount() << " resyncs" << std::endl;
+        if (bits == indBits) windowResyncs = gnb->GetSyncFailureCount();
+    }
+    // Reordering within one burst fits the window, so none should resync
+    return burst <= (1u << std::min(indBits, SQNArray::MaxIndBits)) && windowResyncs != 0 ? 1 : 0;
+}
+
+// App --fleet [--uavs N] [--threads T] brings up N UAVs around one gNB
+// twice: one Phase A exchange at a time, then as one batch through
+// World::authenticateUAVFleet with the UAV side on T workers. Protocol
+// logging is muted while timing.
+static int RunFleetScenario(int argc, char** argv) {
+    uint32_t uavCount = 5000;
+    size_t threads = 0;
+    ScenarioOptions cli("--fleet");
+    cli.Value("--uavs", uavCount)
+       .Value("--threads", threads);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+    uavCount = std::max<uint32_t>(uavCount, 1);
+
+    std::vector<int> uavIds;
+    for (uint32_t i = 0; i < uavCount; ++i) {
+        uavIds.push_back(static_cast<int>(1000 + i));
+    }
+    auto setup = [&](World& world) {
+        world.addGNB(1, 5000, 5000);
+        for (uint32_t i = 0; i < uavCount; ++i) {
+            world.addUAV(1000 + i, 50 * (i % 200), 50 * (i / 200));
+        }
+        world.linkEntities();
+        world.setupInfrastructure();
+    };
+    auto authorized = [&](World& world) {
+        size_t count = 0;
+        for (int id : uavIds) count += world.findUAV(id)->IsAuthenticatedWithGNB() ? 1 : 0;
+        return count;
+    };
+    using Micros = std::chrono::duration<double, std::micro>;
+
+    // One exchange at a time, timing the gNB's steps on their own
+    MutedConsole muted;
+    World sequential;
+    setup(sequential);
+    gNB* gnb = sequential.findGNB(1);
+    std::chrono::nanoseconds sequentialGNB{};
+    auto sequentialStart = std::chrono::steady_clock::now();
+    for (int id : uavIds) {
+        auto start = std::chrono::steady_clock::now();
+        std::optional<UAVAuthChallenge> challenge = gnb->BuildUAVServiceAccessChallenge(id);
+        sequentialGNB += std::chrono::steady_clock::now() - start;
+        if (!challenge || !sequential.findUAV(id)->VerifyServiceAccessAuth(challenge->hres_star_j, challenge->cj, challenge->rand_prime)) continue;
+        start = std::chrono::steady_clock::now();
+        gnb->AcceptServiceAccessConfirmation(id);
+        sequentialGNB += std::chrono::steady_clock::now() - start;
+    }
+    const double sequentialWall = Micros(std::chrono::steady_clock::now() - sequentialStart).count();
+    const size_t sequentialOk = authorized(sequential);
+
+    World batched;
+    setup(batched);
+    auto batchedStart = std::chrono::steady_clock::now();
+    FleetAuthStats stats = batched.authenticateUAVFleet(uavIds, threads);
+    const double batchedWall = Micros(std::chrono::steady_clock::now() - batchedStart).count();
+    const size_t batchedOk = authorized(batched);
+    muted.Restore();
+
+    std::cout << "\n===== Fleet Phase A (" << uavCount << " UAVs) =====" << std::endl;
+    std::cout << "One at a time: " << sequentialOk << "/" << uavCount << " authorized, " << sequentialWall / 1000.0
+              << " ms wall, " << Micros(sequentialGNB).count() / 1000.0 << " ms gNB ("
+              << Micros(sequentialGNB).count() / uavCount << " us/UAV)" << std::endl;
+    std::cout << "Batched:       " << batchedOk << "/" << uavCount << " authorized, " << batchedWall / 1000.0
+              << " ms wall, " << Micros(stats.gnbTime).count() / 1000.0 << " ms gNB (" << stats.GNBMicrosPerUAV()
+              << " us/UAV), UAV side " << Micros(stats.uavTime).count() / 1000.0 << " ms on " << stats.threads << " threads" << std::endl;
+    std::cout << "Speedup: " << (batchedWall > 0 ? sequentialWall / batchedWall : 0.0) << "x wall, "
+              << (stats.gnbTime.count() > 0 ? static_cast<double>(sequentialGNB.count()) / stats.gnbTime.count() : 0.0) << "x gNB" << std::endl;
+    return sequentialOk == uavCount && batchedOk == uavCount ? 0 : 1;
+}
+
+// App --lkh [--max N] [--batch B] [--reps R] measures group rekeying with
+// the logical key hierarchy. For fleets of 1000, 10000, ... up to N UAVs it
+// reports the wrapped keys and gNB time of one leave, one join, a rotation
+// and a batch of B leaves plus B joins, against the N Phase A runs a flat
+// GKUAV needs. Single changes are averaged over R rekeys. A small World then
+// checks that members follow a rekey and a revoked UAV cannot.
+static int RunGroupKeyScenario(int argc, char** argv) {
+    uint32_t maxUAVs = 100000;
+    uint32_t batch = 100;
+    uint32_t reps = 200;
+    ScenarioOptions cli("--lkh");
+    cli.Value("--max", maxUAVs)
+       .Value("--batch", batch)
+       .Value("--reps", reps);
+    if (!cli.Parse(argc, argv)) {
+        return 1;
+    }
+    maxUAVs = std::max<uint32_t>(maxUAVs, 1000);
+    reps = std::max<uint32_t>(reps, 1);
+    using Micros = std::chrono::duration<double, std::micro>;
+    auto leafKey = [](uint32_t member) { return Kyber::KDF(Kyber::StringToBytes("KRAN_UAV_" + std::to_string(member))); };
+
+    struct Cost {
+        double messages = 0.0;
+        double us = 0.0;
+    };
+    std::cout << "\n===== Group Rekey Cost (LKH) =====" << std::endl;
+    for (uint32_t fleet = 1000; fleet <= maxUAVs; fleet *= 10) {
+        GroupKeyTree tree;
+        for (uint32_t member = 0; member < fleet; ++member) {
+            tree.Join(member, leafKey(member));
+        }
+        tree.Rekey();
+
+        auto measure = [&](uint32_t rounds, auto&& change) {
+            Cost cost;
+            for (uint32_t round = 0; round < rounds; ++round) {
+                change(round);
+                auto start = std::chrono::steady_clock::now();
+                GroupRekey rekey = tree.Rekey();
+                cost.us += Micros(std::chrono::steady_clock::now() - start).count();
+                cost.messages += static_cast<double>(rekey.messages.size());
+            }
+            cost.messages /= rounds;
+            cost.us /= rounds;
+            return cost;
+        };
+        const uint32_t singles = std::min(reps, fleet / 2);
+        Cost leave = measure(singles, [&](uint32_t round) { tree.Leave(round); });
+        Cost join = measure(singles, [&](uint32_t round) { tree.Join(fleet + round, leafKey(fleet + round)); });
+        Cost rotate = measure(reps, [&](uint32_t) { tree.Rotate(); });
+        // Spread over the whole tree, the worst case for sharing paths
+        const uint32_t changes = std::min(batch, fleet / 4);
+        Cost batched = measure(1, [&](uint32_t) {
+            for (uint32_t b = 0; b < changes; ++b) {
+                tree.Leave(singles + b * ((fleet - singles) / changes));
+                tree.Join(2 * fleet + b, leafKey(2 * fleet + b));
+            }
+        });
+
+        std::cout << fleet << " UAVs (height " << tree.Height() << "): leave " << leave.messages << " keys " << leave.us
+                  << " us | join " << join.messages << " keys " << join.us << " us | rotate " << rotate.messages << " keys "
+                  << rotate.us << " us | " << changes << "+" << changes << " batched " << batched.messages << " keys "
+                  << batched.us << " us (" << changes * (leave.messages + join.messages) << " one by one) | flat: "
+                  << fleet << " Phase A runs" << std::endl;
+    }
+
+    // Members follow a rekey; a revoked UAV is locked out of the next one
+    const uint32_t uavCount = 64;
+    MutedConsole muted(true);
+    World world;
+    world.addGNB(1, 500, 500);
+    std::vector<int> uavIds;
+    for (uint32_t i = 0; i < uavCount; ++i) {
+        uavIds.push_back(static_cast<int>(1000 + i));
+        world.addUAV(1000 + i, 100 + 100 * (i % 8), 100 + 100 * (i / 8));
+    }
+    world.linkEntities();
+    world.setupInfrastructure();
+    world.authenticateUAVFleet(uavIds);
+    size_t joinKeys = world.rekeyUAVGroups();
+    gNB* gnb = world.findGNB(1);
+    auto inSync = [&]() {
+        size_t count = 0;
+        for (int id : uavIds) count += world.findUAV(id)->GetGroupKey() == gnb->GetGroupKey() ? 1 : 0;
+        return count;
+    };
+    size_t joinedInSync = inSync();
+    world.revokeUAV(uavIds.front(), false);
+    size_t revokeKeys = world.rekeyUAVGroups();
+    size_t revokedInSync = inSync();
+    bool lockedOut = world.findUAV(uavIds.front())->GetGroupKey() != gnb->GetGroupKey();
+    muted.Restore();
+
+    std::cout << "\nWorld check, " << uavCount << " UAVs: joining rekey sent " << joinKeys << " wrapped keys, "
+              << joinedInSync << "/" << uavCount << " UAVs hold GKUAV; after revoking UAV " << uavIds.front() << ": "
+              << revokeKeys << " wrapped keys, " << revokedInSync << "/" << uavCount - 1 << " members hold GKUAV, revoked UAV "
+              << (lockedOut ? "locked out" : "NOT locked out") << std::endl;
+    return joinedInSync == uavCount && revokedInSync == uavCount - 1 && lockedOut ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--cells") == 0) {
+            return RunCellScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--shards") == 0) {
+            return RunShardedScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--churn") == 0) {
+            return RunChurnScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--handover") == 0) {
+            return RunHandoverScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--uav-failure") == 0) {
+            return RunUAVFailureScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--load-balance") == 0) {
+            return RunLoadBalanceScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--multi-gnb") == 0) {
+            return RunMultiGNBScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--xn-handover") == 0) {
+            return RunXnHandoverScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--resumption") == 0) {
+            return RunResumptionScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--token-cache") == 0) {
+            return RunTokenCacheScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--sqn-window") == 0) {
+            return RunSQNWindowScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--fleet") == 0) {
+            return RunFleetScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--lkh") == 0) {
+            return RunGroupKeyScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--generate-trace") == 0) {
+            return RunTraceGenerator(argc, argv);
+        }
+        // App --convert-scenario TEXT BINARY
+        if (std::strcmp(argv[i], "--convert-scenario") == 0 && i + 2 < argc) {
+            return ScenarioFile::ConvertText(argv[i + 1], argv[i + 2]) ? 0 : 1;
+        }
+        if (std::strcmp(argv[i], "--snapshot") == 0) {
+            return RunSnapshotScenario(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) {
+            return RunScenarioFile(argv[i + 1]);
+        }
+    }
 
-int main() {
     std::cout << "===== 5G Authentication Simulation =====" << std::endl;
 
+    // Optional hardware counter sampling; a no-op (with a note on stderr) if unavailable
+    Perf::Enable();
+
     // Create world and setup entities
     World world;
 
@@ -29,9 +1064,7 @@ int main() {
     // Phase A: Authenticate UAVs with the gNB
     std::cout << "\n\n===== PHASE A: UAV Service Authentication =====" << std::endl;
     world.simulateUAVServiceAuthentication(101); // Authenticate first UAV
-    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Allow time for authentication
     world.simulateUAVServiceAuthentication(102); // Authenticate second UAV
-    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Allow time for authentication
 
     // Phase B: UE connects via an authenticated UAV
     std::cout << "\n\n===== PHASE B: UE Connects via Authenticated UAV =====" << std::endl;
@@ -43,6 +1076,9 @@ int main() {
     world.simulateUEHandoverAuthentication(201, 102);
     std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Allow time for handover
 
+    Perf::PrintReport();
+    world.printStateMachineReport();
+
     std::cout << "\n===== 5G Authentication Simulation Complete =====" << std::endl;
 
     return 0;
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Command-line options of one App scenario. Each option binds a flag to a
+// variable (`--flag value`), a switch (`--flag`) or a handler taking a fixed
+// number of values; the flag that selected the scenario is skipped unless
+// it is bound itself.
+class ScenarioOptions {
+public:
+    explicit ScenarioOptions(std::string scenarioFlag = {}) : m_ScenarioFlag(std::move(scenarioFlag)) {}
+
+    // Parse the value with the converter matching `target`'s type
+    template<typename T>
+    ScenarioOptions& Value(const char* flag, T& target)
+    {
+        return Value(flag, [&target](const std::string& value) {
+            if constexpr (std::is_same_v<T, std::string>) target = value;
+            else if constexpr (std::is_floating_point_v<T>) target = static_cast<T>(std::stod(value));
+            else target = static_cast<T>(std::stoull(value));
+        });
+    }
+
+    ScenarioOptions& Value(const char* flag, std::function<void(const std::string&)> apply)
+    {
+        return Values(flag, 1, [apply = std::move(apply)](char** values) { apply(values[0]); });
+    }
+
+    ScenarioOptions& Switch(const char* flag, bool& target)
+    {
+        return Values(flag, 0, [&target](char**) { target = true; });
+    }
+
+    ScenarioOptions& Values(const char* flag, int count, std::function<void(char** values)> apply)
+    {
+        m_Options.push_back({ flag, count, std::move(apply) });
+        return *this;
+    }
+
+    // False, with a message on stderr, on an unknown flag or a missing value
+    bool Parse(int argc, char** argv) const
+    {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            const Option* option = Find(arg);
+            if (!option && arg == m_ScenarioFlag) continue;
+            if (!option || i + option->values >= argc) {
+                std::cerr << "Unknown or incomplete option: " << arg << std::endl;
+                return false;
+            }
+            option->apply(argv + i + 1);
+            i += option->values;
+        }
+        return true;
+    }
+
+private:
+    struct Option {
+        std::string flag;
+        int values;
+        std::function<void(char**)> apply;
+    };
+
+    const Option* Find(const std::string& flag) const
+    {
+        for (const Option& option : m_Options) {
+            if (option.flag == flag) return &option;
+        }
+        return nullptr;
+    }
+
+    std::string m_ScenarioFlag;
+    std::vector<Option> m_Options;
+};
+
+// Silences std::cout (and std::cerr if asked) while a scenario times the
+// protocol; restored on Restore() or destruction
+class MutedConsole {
+public:
+    explicit MutedConsole(bool errorsToo = false)
+        : m_Console(std::cout.rdbuf(nullptr)), m_Errors(errorsToo ? std::cerr.rdbuf(nullptr) : nullptr) {}
+    ~MutedConsole() { Restore(); }
+
+    MutedConsole(const MutedConsole&) = delete;
+    MutedConsole& operator=(const MutedConsole&) = delete;
+
+    void Restore()
+    {
+        if (m_Console) {
+            std::cout.rdbuf(m_Console);
+            std::cout.clear();
+            m_Console = nullptr;
+        }
+        if (m_Errors) {
+            std::cerr.rdbuf(m_Errors);
+            std::cerr.clear();
+            m_Errors = nullptr;
+        }
+    }
+
+private:
+    std::streambuf* m_Console;
+    std::streambuf* m_Errors;
+};
+
+// Cost of running one protocol path for a number of UEs
+struct PathCost {
+    uint32_t succeeded = 0;
+    double wallUs = 0.0; // Per UE
+    double cpuUs = 0.0;  // Per UE, whole process
+};
+
+// Run `step(i)` for i in [0, count) with logging muted; `step` returns
+// whether UE i got through
+template<typename Step>
+PathCost MeasurePath(uint32_t count, Step&& step)
+{
+    PathCost cost;
+    MutedConsole muted;
+    std::clock_t cpuStart = std::clock();
+    auto wallStart = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; ++i) cost.succeeded += step(i) ? 1 : 0;
+    if (count) {
+        cost.wallUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - wallStart).count() / count;
+        cost.cpuUs = 1e6 * (std::clock() - cpuStart) / CLOCKS_PER_SEC / count;
+    }
+    return cost;
+}
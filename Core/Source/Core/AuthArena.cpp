@@ -0,0 +1,46 @@
+#include "AuthArena.h"
+
+#include <cstddef>
+
+namespace Kyber {
+
+    namespace {
+        // One Phase B exchange allocates a few KB of temporaries; the inline
+        // block covers that without touching malloc, and the monotonic
+        // resource spills to the heap if a transaction grows beyond it.
+        constexpr size_t InlineArenaBytes = 32 * 1024;
+
+        struct ThreadArena {
+            alignas(std::max_align_t) std::byte buffer[InlineArenaBytes];
+            std::pmr::monotonic_buffer_resource resource{ buffer, sizeof(buffer), std::pmr::new_delete_resource() };
+            int depth = 0;
+        };
+
+        ThreadArena& LocalArena()
+        {
+            thread_local ThreadArena arena;
+            return arena;
+        }
+    }
+
+    AuthTransaction::AuthTransaction()
+    {
+        LocalArena().depth++;
+    }
+
+    AuthTransaction::~AuthTransaction()
+    {
+        auto& arena = LocalArena();
+        if (--arena.depth == 0) {
+            arena.resource.release();
+        }
+    }
+
+    std::pmr::memory_resource* AuthTransaction::Resource()
+    {
+        auto& arena = LocalArena();
+        if (arena.depth == 0) return std::pmr::get_default_resource();
+        return &arena.resource;
+    }
+
+} // namespace Kyber
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory_resource>
+
+namespace Kyber {
+
+    // Per-thread bump arena for the temporaries of one authentication
+    // transaction (Phase A, B or C message chain).
+    //
+    // Construct an AuthTransaction at the entry of a protocol flow; nested
+    // transactions on the same thread join the outer one, and the arena is
+    // reset in one step when the outermost transaction ends. Protocol code
+    // allocates ArenaBytes from AuthTransaction::Resource(). Outside any
+    // transaction Resource() falls back to the default heap resource, so
+    // helpers stay safe to call standalone.
+    class AuthTransaction {
+    public:
+        AuthTransaction();
+        ~AuthTransaction();
+
+        AuthTransaction(const AuthTransaction&) = delete;
+        AuthTransaction& operator=(const AuthTransaction&) = delete;
+
+        static std::pmr::memory_resource* Resource();
+    };
+
+} // namespace Kyber
@@ -0,0 +1,256 @@
+#include "AuthFlows.h"
+#include "gNB.h"
+#include "UAV.h"
+#include "UE.h"
+
+#include <exception>
+#include <optional>
+#include <utility>
+
+const char* AuthStatusName(AuthResult::Status status)
+{
+    switch (status) {
+    case AuthResult::Status::Success: return "Success";
+    case AuthResult::Status::Failed: return "Failed";
+    case AuthResult::Status::TimedOut: return "TimedOut";
+    }
+    return "Unknown";
+}
+
+namespace {
+
+    AuthResult MakeResult(AuthResult::Phase phase, int entityId, AuthResult::Status status, std::string message = {})
+    {
+        AuthResult result;
+        result.phase = phase;
+        result.entityId = entityId;
+        result.status = status;
+        result.message = std::move(message);
+        return result;
+    }
+
+} // namespace
+
+// --- Phase A ---
+
+Task<AuthResult> UAVServiceAccessFlow(AuthScheduler& scheduler, FlowContext& ctx, gNB& gnb, UAV& uav)
+{
+    using Status = AuthResult::Status;
+    const auto phase = AuthResult::Phase::UAVServiceAccess;
+    const int uavId = uav.GetID();
+
+    if (!co_await scheduler.Deliver(ctx, &gnb))
+        co_return MakeResult(phase, uavId, Status::TimedOut, "gNB start");
+    std::optional<UAVAuthChallenge> challenge = gnb.BuildUAVServiceAccessChallenge(uavId);
+    if (!challenge)
+        co_return MakeResult(phase, uavId, Status::Failed, "gNB challenge");
+
+    if (!co_await scheduler.Deliver(ctx, &uav))
+        co_return MakeResult(phase, uavId, Status::TimedOut, "UAV challenge");
+    if (!uav.VerifyServiceAccessAuth(challenge->hres_star_j, challenge->cj, challenge->rand_prime))
+        co_return MakeResult(phase, uavId, Status::Failed, "UAV verification");
+
+    if (!co_await scheduler.Deliver(ctx, &gnb))
+        co_return MakeResult(phase, uavId, Status::TimedOut, "gNB confirmation");
+    if (!gnb.AcceptServiceAccessConfirmation(uavId))
+        co_return MakeResult(phase, uavId, Status::Failed, "gNB confirmation");
+
+    // Broadcast is local to the UAV; no deadline applies
+    co_await scheduler.SwitchTo(&uav);
+    uav.BroadcastNotification();
+    co_return MakeResult(phase, uavId, Status::Success);
+}
+
+// --- Phase B ---
+
+Task<AuthResult> UEAccessFlow(AuthScheduler& scheduler, FlowContext& ctx, UE& ue, UAV& uav)
+{
+    using Status = AuthResult::Status;
+    const auto phase = AuthResult::Phase::UEAccess;
+    const int ueId = ue.GetID();
+
+    // A UE left in Connecting by a failed run may simply retry
+    if (!co_await scheduler.Deliver(ctx, &ue))
+        co_return MakeResult(phase, ueId, Status::TimedOut, "UE start");
+
+    // Fast re-authentication first; on a miss the UAV relays the rejection
+    // and the UE carries on with a SUCI
+    if (std::optional<ResumeRequest> resume = ue.BuildResumeRequest(uav)) {
+        if (!co_await scheduler.Deliver(ctx, &uav))
+            co_return MakeResult(phase, ueId, Status::TimedOut, "UAV resume");
+        gNB* gnb = uav.AcceptConnectionRequest(ueId);
+        if (!gnb)
+            co_return MakeResult(phase, ueId, Status::Failed, "UAV not authorized");
+        Kyber::TID tid_j = uav.GetTID();
+
+        if (!co_await scheduler.Deliver(ctx, gnb))
+            co_return MakeResult(phase, ueId, Status::TimedOut, "gNB resume");
+        UEAuthResponse response = gnb->ResumeUE(*resume, tid_j, uav.GetID(), ueId);
+
+        if (!co_await scheduler.Deliver(ctx, &uav))
+            co_return MakeResult(phase, ueId, Status::TimedOut, "UAV resume params");
+        const bool accepted = response.outcome == UEAuthResponse::Outcome::Accepted;
+        if (accepted && !uav.StoreUEAuthParams(ueId, response.tid_i, response.kuav_i))
+            co_return MakeResult(phase, ueId, Status::Failed, "UAV session table");
+
+        if (!co_await scheduler.Deliver(ctx, &ue))
+            co_return MakeResult(phase, ueId, Status::TimedOut, "UE resume response");
+        if (accepted) {
+            ue.HandleUAVAssistedAuthResponse(response.hres_star_i, response.ci, tid_j);
+            if (ue.GetState() == UEState::Connected)
+                co_return MakeResult(phase, ueId, Status::Success);
+        }
+        ue.AbandonResumption();
+    }
+
+    std::optional<std::vector<uint8_t>> suci = ue.BuildConnectionRequest(uav);
+    if (!suci)
+        co_return MakeResult(phase, ueId, Status::Failed, "UE state");
+
+    if (!co_await scheduler.Deliver(ctx, &uav))
+        co_return MakeResult(phase, ueId, Status::TimedOut, "UAV SUCI");
+    gNB* gnb = uav.AcceptConnectionRequest(ueId);
+    if (!gnb)
+        co_return MakeResult(phase, ueId, Status::Failed, "UAV not authorized");
+    Kyber::TID tid_j = uav.GetTID();
+
+    if (!co_await scheduler.Deliver(ctx, gnb))
+        co_return MakeResult(phase, ueId, Status::TimedOut, "gNB SUCI");
+    UEAuthResponse response = gnb->AuthenticateUE(*suci, tid_j, uav.GetID(), ueId);
+
+    if (!co_await scheduler.Deliver(ctx, &uav))
+        co_return MakeResult(phase, ueId, Status::TimedOut, "UAV auth params");
+    switch (response.outcome) {
+    case UEAuthResponse::Outcome::Accepted:
+        if (!uav.StoreUEAuthParams(ueId, response.tid_i, response.kuav_i))
+            co_return MakeResult(phase, ueId, Status::Failed, "UAV session table");
+        std::cout << "UAV " << uav.GetID() << ": Forwarding (HRES*i, Ci) to UE " << ueId << std::endl;
+        break;
+    case UEAuthResponse::Outcome::MacFailure:
+        std::cout << "UAV " << uav.GetID() << ": Forwarding MAC Failure to UE " << ueId << std::endl;
+        break;
+    case UEAuthResponse::Outcome::SyncFailure:
+        std::cout << "UAV " << uav.GetID() << ": Forwarding Sync Failure (AUTS) to UE " << ueId << std::endl;
+        break;
+    case UEAuthResponse::Outcome::Rejected:
+        co_return MakeResult(phase, ueId, Status::Failed, "gNB rejected");
+    }
+
+    if (!co_await scheduler.Deliver(ctx, &ue))
+        co_return MakeResult(phase, ueId, Status::TimedOut, "UE auth response");
+    if (response.outcome == UEAuthResponse::Outcome::MacFailure) {
+        ue.HandleMacFailure();
+        co_return MakeResult(phase, ueId, Status::Failed, "MAC failure");
+    }
+    if (response.outcome == UEAuthResponse::Outcome::SyncFailure) {
+        ue.HandleSyncFailure(response.auts);
+        co_return MakeResult(phase, ueId, Status::Failed, "Sync failure");
+    }
+    ue.HandleUAVAssistedAuthResponse(response.hres_star_i, response.ci, tid_j);
+    if (ue.GetState() != UEState::Connected)
+        co_return MakeResult(phase, ueId, Status::Failed, "UE verification");
+    co_return MakeResult(phase, ueId, Status::Success);
+}
+
+// --- Phase C ---
+
+Task<AuthResult> UEHandoverFlow(AuthScheduler& scheduler, FlowContext& ctx, UE& ue, UAV& target)
+{
+    using Status = AuthResult::Status;
+    const auto phase = AuthResult::Phase::UEHandover;
+    const int ueId = ue.GetID();
+
+    if (!co_await scheduler.Deliver(ctx, &ue))
+        co_return MakeResult(phase, ueId, Status::TimedOut, "UE start");
+
+    // Target under another gNB: Xn preparation UE -> source gNB -> target gNB -> UE
+    gNB* sourceGNB = ue.GetServingGNB();
+    gNB* targetGNB = target.GetAssociatedGNB();
+    if (sourceGNB && targetGNB && sourceGNB != targetGNB) {
+        std::optional<XnHandoverRequest> xn = ue.BuildXnHandoverRequest(targetGNB->GetID());
+        if (!xn)
+            co_return MakeResult(phase, ueId, Status::Failed, "UE state");
+        if (!co_await scheduler.Deliver(ctx, sourceGNB))
+            co_return MakeResult(phase, ueId, Status::TimedOut, "Xn source gNB");
+        std::optional<XnHandoverContext> context = sourceGNB->PrepareXnHandover(ueId, *xn);
+        if (!context)
+            co_return MakeResult(phase, ueId, Status::Failed, "Xn source gNB");
+        if (!co_await scheduler.Deliver(ctx, targetGNB))
+            co_return MakeResult(phase, ueId, Status::TimedOut, "Xn target gNB");
+        std::optional<XnHandoverCommand> command = targetGNB->AcceptXnHandover(ueId, *context);
+        if (!command)
+            co_return MakeResult(phase, ueId, Status::Failed, "Xn target gNB");
+        if (!co_await scheduler.Deliver(ctx, &ue))
+            co_return MakeResult(phase, ueId, Status::TimedOut, "Xn command");
+        if (!ue.ApplyXnHandoverCommand(*command))
+            co_return MakeResult(phase, ueId, Status::Failed, "Xn command");
+    }
+
+    std::optional<HandoverAuthRequest> request = ue.BuildHandoverRequest(target);
+    if (!request)
+        co_return MakeResult(phase, ueId, Status::Failed, "UE state");
+
+    // From here on the UE is in Handover and must be returned to its
+    // source UAV if the run does not complete
+    AuthResult failure;
+    do {
+        if (!co_await scheduler.Deliver(ctx, &target)) {
+            failure = MakeResult(phase, ueId, Status::TimedOut, "target request");
+            break;
+        }
+        std::optional<HandoverAuthChallenge> challenge = target.ProcessHandoverRequest(ueId, *request);
+        if (!challenge) {
+            failure = MakeResult(phase, ueId, Status::Failed, "target verification");
+            break;
+        }
+        std::cout << "UAV " << target.GetID() << ": Sending (HRESi, R2) to UE " << ueId << std::endl;
+
+        if (!co_await scheduler.Deliver(ctx, &ue)) {
+            failure = MakeResult(phase, ueId, Status::TimedOut, "UE challenge");
+            break;
+        }
+        std::optional<std::vector<uint8_t>> xres_i = ue.AnswerHandoverChallenge(challenge->hres_i, challenge->r2);
+        if (!xres_i) // UE has already fallen back to the source UAV
+            co_return MakeResult(phase, ueId, Status::Failed, "UE verification");
+
+        if (!co_await scheduler.Deliver(ctx, &target)) {
+            failure = MakeResult(phase, ueId, Status::TimedOut, "target confirmation");
+            break;
+        }
+        if (!target.VerifyHandoverConfirmation(ueId, *xres_i)) {
+            failure = MakeResult(phase, ueId, Status::Failed, "target confirmation");
+            break;
+        }
+        gNB* gnb = target.GetAssociatedGNB();
+        Kyber::TID tid_j = target.GetTID();
+        Kyber::TID tid_i = request->tid_i;
+
+        if (gnb) {
+            // Inform is advisory; the UE switches even if it arrives late
+            if (co_await scheduler.Deliver(ctx, gnb))
+                gnb->ReceiveHandoverInform(tid_j, tid_i);
+        }
+        co_await scheduler.SwitchTo(&ue);
+        ue.FinishHandover(true);
+        co_return MakeResult(phase, ueId, Status::Success);
+    } while (false);
+
+    co_await scheduler.SwitchTo(&ue);
+    ue.FinishHandover(false);
+    co_return failure;
+}
+
+// --- Runner ---
+
+Task<void> RunAuthFlow(AuthFlowFactory flow, std::chrono::milliseconds timeout, AuthResult& out)
+{
+    auto start = AuthScheduler::Clock::now();
+    FlowContext ctx{ start + timeout };
+    try {
+        out = co_await flow(ctx);
+    } catch (const std::exception& e) {
+        out.status = AuthResult::Status::Failed;
+        out.message = e.what();
+    }
+    out.latency = std::chrono::duration_cast<std::chrono::microseconds>(AuthScheduler::Clock::now() - start);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "AuthScheduler.h"
+#include "Task.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+class gNB;
+class UAV;
+class UE;
+
+// Outcome of one protocol run driven by the AuthScheduler
+struct AuthResult {
+    enum class Phase : uint8_t { UAVServiceAccess, UEAccess, UEHandover };
+    enum class Status : uint8_t { Success, Failed, TimedOut };
+
+    Phase phase = Phase::UEAccess;
+    int entityId = -1; // UAV for Phase A, UE otherwise
+    Status status = Status::Failed;
+    std::chrono::microseconds latency{ 0 };
+    std::string message; // Step that failed or timed out
+};
+
+const char* AuthStatusName(AuthResult::Status status);
+
+// Protocol flows as coroutines. Each message hop is an explicit
+// `co_await scheduler.Deliver(...)` followed by the receiving party's step
+// function, so a flow reads top to bottom like the message sequence chart
+// while thousands of them share the scheduler's worker threads.
+
+// Phase A: gNB -> UAV (HRES*j, Cj, RAND') -> gNB (confirmation) -> UAV (broadcast)
+Task<AuthResult> UAVServiceAccessFlow(AuthScheduler& scheduler, FlowContext& ctx, gNB& gnb, UAV& uav);
+
+// Phase B: UE (SUCI) -> UAV -> gNB -> UAV (HRES*i, Ci) -> UE, via the UAV's gNB.
+// A UE holding a resumption ticket first runs the same hops with a
+// ResumeRequest and only sends the SUCI if the gNB cannot resume it.
+Task<AuthResult> UEAccessFlow(AuthScheduler& scheduler, FlowContext& ctx, UE& ue, UAV& uav);
+
+// Phase C: UE -> target UAV -> UE (HRESi, R2) -> target UAV (XRESi) -> gNB,
+// preceded by Xn preparation (UE -> source gNB -> target gNB -> UE) when
+// the target UAV belongs to another gNB
+Task<AuthResult> UEHandoverFlow(AuthScheduler& scheduler, FlowContext& ctx, UE& ue, UAV& target);
+
+// Run `flow` with a deadline of now + `timeout` and store its result in
+// `out`. Pass the returned task to AuthScheduler::Spawn.
+using AuthFlowFactory = std::function<Task<AuthResult>(FlowContext&)>;
+Task<void> RunAuthFlow(AuthFlowFactory flow, std::chrono::milliseconds timeout, AuthResult& out);
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "KyberUtils.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Protocol messages exchanged between UE, UAV and gNB.
+//
+// The synchronous entry points (UE::InitiateConnection, ...) build one of
+// these and hand it straight to the next hop; the coroutine flows in
+// AuthFlows.h carry them across hops instead.
+
+// Phase A, gNB -> UAV: (HRES*j, Cj, RAND')
+struct UAVAuthChallenge {
+    std::vector<uint8_t> hres_star_j;
+    std::vector<uint8_t> cj;
+    std::vector<uint8_t> rand_prime;
+};
+
+// Phase B, gNB -> UAV: (HRES*i, Ci, TIDi, KUAVi) or a failure indication
+struct UEAuthResponse {
+    enum class Outcome : uint8_t { Accepted, Rejected, MacFailure, SyncFailure };
+
+    Outcome outcome = Outcome::Rejected;
+    std::vector<uint8_t> hres_star_i;
+    std::vector<uint8_t> ci;
+    Kyber::TID tid_i;
+    std::vector<uint8_t> kuav_i;
+    std::vector<uint8_t> auts; // SyncFailure only
+};
+
+// Fast re-authentication, UE -> UAV -> gNB, in place of the SUCI when the
+// UE still holds KRANi from an earlier Phase B: (TIDi, counter, MAC). The
+// gNB answers with a UEAuthResponse under the next KRANi.
+struct ResumeRequest {
+    Kyber::TID tid_i;
+    uint64_t counter = 0;     // Strictly increasing per KRANi; stops replays
+    std::vector<uint8_t> mac; // Kyber::ResumeRequestMAC under KRANi
+};
+
+// Phase C, UE -> target UAV: (TIDi, MACi, R1, TST)
+struct HandoverAuthRequest {
+    Kyber::TID tid_i;
+    std::vector<uint8_t> mac_i;
+    std::vector<uint8_t> r1;
+    Kyber::Timestamp tst{};
+};
+
+// Phase C preparation, towards a UAV the UE is predicted to hand over to:
+// (TIDi, TST), enough to derive TGK'i and K*UAVi before the request
+// arrives. Both travel in clear in the request anyway.
+struct HandoverHint {
+    Kyber::TID tid_i;
+    Kyber::Timestamp tst{};
+};
+
+// Phase C, target UAV -> UE: (HRESi, R2)
+struct HandoverAuthChallenge {
+    std::vector<uint8_t> hres_i;
+    std::vector<uint8_t> r2;
+};
+
+// Xn preparation, run before Phase C when the target UAV belongs to
+// another gNB. UE -> serving gNB: (TIDi, TST, target gNB, MAC)
+struct XnHandoverRequest {
+    Kyber::TID tid_i;
+    Kyber::Timestamp tst{};
+    uint32_t targetGnbId = 0;
+    std::vector<uint8_t> mac; // Kyber::XnRequestMAC under TGKi
+};
+
+// Xn, serving gNB -> target gNB: the UE's security context. NH is bound to
+// the target gNB, so it is useless anywhere else.
+struct XnHandoverContext {
+    Kyber::TID tid_i;
+    Kyber::Timestamp tst{};
+    std::vector<uint8_t> nh; // Kyber::XnNextHopKey
+    uint32_t sourceGnbId = 0;
+};
+
+// Xn, target gNB -> UE (relayed by the serving gNB): TGKi re-issued under
+// the target gNB's GKUAV, encrypted with NH
+struct XnHandoverCommand {
+    uint32_t targetGnbId = 0;
+    std::vector<uint8_t> c_tgk;
+};
+
+// Group rekey, gNB -> every UAV of the cell (broadcast). Each message is
+// one new key of the gNB's key tree (GroupKeyTree.h) wrapped under a child
+// node's key. They run leaves to root, so a UAV unwraps its path in one
+// pass and ends with the new GKUAV as the key of `root`.
+struct GroupRekeyMessage {
+    uint64_t node = 0;
+    uint64_t wrappingNode = 0;
+    std::vector<uint8_t> wrapped_key; // E_key(wrappingNode)(key(node))
+};
+
+struct GroupRekey {
+    uint64_t epoch = 0;
+    uint64_t root = 0;
+    std::vector<std::pair<uint32_t, uint64_t>> joined; // UAV ID -> its leaf, keyed with its KRANj
+    std::vector<GroupRekeyMessage> messages;
+};
@@ -0,0 +1,187 @@
+#include "AuthScheduler.h"
+
+#include <algorithm>
+
+AuthScheduler::AuthScheduler(size_t threads)
+{
+    threads = std::max<size_t>(threads, 1);
+    m_Workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        m_Workers.emplace_back([this] { WorkerLoop(); });
+    }
+    m_TimerThread = std::thread([this] { TimerLoop(); });
+}
+
+AuthScheduler::~AuthScheduler()
+{
+    WaitIdle();
+    {
+        std::lock_guard<std::mutex> lock(m_TimerMutex);
+        m_TimersStopping = true;
+    }
+    m_TimerChanged.notify_all();
+    m_TimerThread.join();
+    {
+        std::lock_guard<std::mutex> lock(m_QueueMutex);
+        m_Stopping = true;
+    }
+    m_QueueReady.notify_all();
+    for (std::thread& worker : m_Workers) {
+        worker.join();
+    }
+}
+
+// --- Flows ---
+
+AuthScheduler::Detached AuthScheduler::RunDetached(AuthScheduler* scheduler, Task<void> flow)
+{
+    // Hop off the spawning thread before running the first step
+    struct ToPool {
+        AuthScheduler* scheduler;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { scheduler->Post([handle] { handle.resume(); }); }
+        void await_resume() const noexcept {}
+    };
+    co_await ToPool{ scheduler };
+    co_await flow;
+    scheduler->FlowFinished();
+}
+
+void AuthScheduler::Spawn(Task<void> flow)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_IdleMutex);
+        m_Outstanding++;
+    }
+    RunDetached(this, std::move(flow));
+}
+
+void AuthScheduler::FlowFinished()
+{
+    std::lock_guard<std::mutex> lock(m_IdleMutex);
+    if (--m_Outstanding == 0) {
+        m_Idle.notify_all();
+    }
+}
+
+void AuthScheduler::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_IdleMutex);
+    m_Idle.wait(lock, [this] { return m_Outstanding == 0; });
+}
+
+// --- Delivery ---
+
+void AuthScheduler::ScheduleDelivery(FlowContext& ctx, const void* entity, std::coroutine_handle<> handle)
+{
+    Clock::time_point arrival = Clock::now() + m_LinkLatency;
+    if (ctx.timedOut || arrival >= ctx.deadline) {
+        // Message would arrive after the deadline: resume the flow at the
+        // deadline with the timeout flag set
+        ctx.timedOut = true;
+        if (ctx.deadline <= Clock::now()) {
+            Post([handle] { handle.resume(); });
+        } else {
+            AddTimer(ctx.deadline, [this, handle] { Post([handle] { handle.resume(); }); });
+        }
+        return;
+    }
+    if (m_LinkLatency <= Clock::duration::zero()) {
+        PostToStrand(entity, handle);
+    } else {
+        AddTimer(arrival, [this, entity, handle] { PostToStrand(entity, handle); });
+    }
+}
+
+void AuthScheduler::PostToStrand(const void* entity, std::coroutine_handle<> handle)
+{
+    Strand* strand;
+    {
+        std::lock_guard<std::mutex> lock(m_StrandMutex);
+        std::unique_ptr<Strand>& slot = m_Strands[entity];
+        if (!slot) slot = std::make_unique<Strand>();
+        strand = slot.get();
+    }
+
+    std::lock_guard<std::mutex> lock(strand->mutex);
+    strand->ready.push_back(handle);
+    if (strand->running) return; // The active drain picks it up
+    strand->running = true;
+    Post([this, strand] { DrainStrand(*strand); });
+}
+
+void AuthScheduler::DrainStrand(Strand& strand)
+{
+    for (;;) {
+        std::coroutine_handle<> handle;
+        {
+            std::lock_guard<std::mutex> lock(strand.mutex);
+            if (strand.ready.empty()) {
+                strand.running = false;
+                return;
+            }
+            handle = strand.ready.front();
+            strand.ready.pop_front();
+        }
+        handle.resume(); // Runs until the flow's next hop or completion
+    }
+}
+
+// --- Worker pool ---
+
+void AuthScheduler::Post(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_QueueMutex);
+        m_Queue.push_back(std::move(job));
+    }
+    m_QueueReady.notify_one();
+}
+
+void AuthScheduler::WorkerLoop()
+{
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_QueueMutex);
+            m_QueueReady.wait(lock, [this] { return m_Stopping || !m_Queue.empty(); });
+            if (m_Queue.empty()) return; // Stopping
+            job = std::move(m_Queue.front());
+            m_Queue.pop_front();
+        }
+        job();
+    }
+}
+
+// --- Timers ---
+
+void AuthScheduler::AddTimer(Clock::time_point when, std::function<void()> fire)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_TimerMutex);
+        m_Timers.push(Timer{ when, m_TimerSeq++, std::move(fire) });
+    }
+    m_TimerChanged.notify_one();
+}
+
+void AuthScheduler::TimerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_TimerMutex);
+    for (;;) {
+        if (m_TimersStopping && m_Timers.empty()) return;
+        if (m_Timers.empty()) {
+            m_TimerChanged.wait(lock);
+            continue;
+        }
+        Clock::time_point next = m_Timers.top().when;
+        if (Clock::now() < next) {
+            m_TimerChanged.wait_until(lock, next);
+            continue;
+        }
+        std::function<void()> fire = std::move(const_cast<Timer&>(m_Timers.top()).fire);
+        m_Timers.pop();
+        lock.unlock();
+        fire();
+        lock.lock();
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "Task.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Per-flow bookkeeping shared between a protocol coroutine and the scheduler
+struct FlowContext {
+    std::chrono::steady_clock::time_point deadline;
+    bool timedOut = false;
+};
+
+// Runs protocol coroutines (AuthFlows.h) on a fixed pool of worker threads.
+//
+// Every entity taking part in a flow has a strand: the coroutine segments
+// that run on behalf of one entity are executed one at a time, in arrival
+// order, so entity state needs no locks while thousands of flows are in
+// flight. Different entities progress in parallel.
+//
+// A message hop is `co_await scheduler.Deliver(ctx, &entity)`: the flow
+// suspends for the configured link latency and resumes on the receiving
+// entity's strand. Once the flow's deadline has passed, Deliver resumes
+// with false instead and the flow is expected to give up.
+//
+// Entities driven here must not be touched from other threads (e.g. by the
+// synchronous World::simulate* calls) until WaitIdle() returns.
+class AuthScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit AuthScheduler(size_t threads = 4);
+    ~AuthScheduler();
+
+    AuthScheduler(const AuthScheduler&) = delete;
+    AuthScheduler& operator=(const AuthScheduler&) = delete;
+
+    // One-way delay applied to every Deliver() hop
+    void SetLinkLatency(Clock::duration latency) { m_LinkLatency = latency; }
+    Clock::duration GetLinkLatency() const { return m_LinkLatency; }
+
+    // Awaitable for one message hop to `entity`; yields false on timeout
+    auto Deliver(FlowContext& ctx, const void* entity)
+    {
+        struct Awaiter {
+            AuthScheduler& scheduler;
+            FlowContext& ctx;
+            const void* entity;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { scheduler.ScheduleDelivery(ctx, entity, handle); }
+            bool await_resume() const noexcept { return !ctx.timedOut; }
+        };
+        return Awaiter{ *this, ctx, entity };
+    }
+
+    // Awaitable that moves the flow onto `entity`'s strand immediately,
+    // ignoring latency and deadline. Used for local cleanup after a timeout.
+    auto SwitchTo(const void* entity)
+    {
+        struct Awaiter {
+            AuthScheduler& scheduler;
+            const void* entity;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { scheduler.PostToStrand(entity, handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{ *this, entity };
+    }
+
+    // Start `flow` on a worker thread. The task must not throw.
+    void Spawn(Task<void> flow);
+
+    // Block until every spawned flow has finished
+    void WaitIdle();
+
+    size_t GetThreadCount() const { return m_Workers.size(); }
+
+private:
+    struct Strand {
+        std::mutex mutex;
+        std::deque<std::coroutine_handle<>> ready;
+        bool running = false;
+    };
+
+    struct Timer {
+        Clock::time_point when;
+        uint64_t seq; // FIFO among equal deadlines
+        std::function<void()> fire;
+
+        bool operator>(const Timer& other) const { return when != other.when ? when > other.when : seq > other.seq; }
+    };
+
+    // Fire-and-forget coroutine that owns a spawned flow
+    struct Detached {
+        struct promise_type {
+            Detached get_return_object() const noexcept { return {}; }
+            std::suspend_never initial_suspend() const noexcept { return {}; }
+            std::suspend_never final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+    };
+
+    static Detached RunDetached(AuthScheduler* scheduler, Task<void> flow);
+
+    void Post(std::function<void()> job);
+    void PostToStrand(const void* entity, std::coroutine_handle<> handle);
+    void ScheduleDelivery(FlowContext& ctx, const void* entity, std::coroutine_handle<> handle);
+    void AddTimer(Clock::time_point when, std::function<void()> fire);
+    void DrainStrand(Strand& strand);
+    void FlowFinished();
+
+    void WorkerLoop();
+    void TimerLoop();
+
+    Clock::duration m_LinkLatency{ 0 };
+
+    // Worker pool
+    std::mutex m_QueueMutex;
+    std::condition_variable m_QueueReady;
+    std::deque<std::function<void()>> m_Queue;
+    std::vector<std::thread> m_Workers;
+    bool m_Stopping = false;
+
+    // Strands, created on first delivery to an entity
+    std::mutex m_StrandMutex;
+    std::unordered_map<const void*, std::unique_ptr<Strand>> m_Strands;
+
+    // Latency and deadline timers
+    std::mutex m_TimerMutex;
+    std::condition_variable m_TimerChanged;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> m_Timers;
+    uint64_t m_TimerSeq = 0;
+    bool m_TimersStopping = false;
+    std::thread m_TimerThread;
+
+    // Outstanding spawned flows
+    std::mutex m_IdleMutex;
+    std::condition_variable m_Idle;
+    size_t m_Outstanding = 0;
+};
@@ -0,0 +1,128 @@
+#include "ChurnGenerator.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+// --- PoissonArrivals ---
+
+PoissonArrivals::PoissonArrivals(const Params& params)
+    : m_Params(params), m_Rng(params.seed)
+{
+}
+
+std::optional<UEArrival> PoissonArrivals::Next()
+{
+    if (!(m_Params.rate > 0.0)) return std::nullopt;
+    std::exponential_distribution<double> gap(m_Params.rate);
+    std::exponential_distribution<double> dwell(1.0 / m_Params.meanDwell);
+    std::uniform_int_distribution<uint32_t> x(m_Params.minX, m_Params.maxX);
+    std::uniform_int_distribution<uint32_t> y(m_Params.minY, m_Params.maxY);
+    std::uniform_int_distribution<uint32_t> speed(0, m_Params.maxSpeed);
+
+    m_Time += gap(m_Rng);
+    UEArrival arrival;
+    arrival.time = m_Time;
+    arrival.dwell = dwell(m_Rng);
+    arrival.x = x(m_Rng);
+    arrival.y = y(m_Rng);
+    arrival.vx = speed(m_Rng);
+    arrival.vy = speed(m_Rng);
+    return arrival;
+}
+
+// --- TraceArrivals ---
+
+TraceArrivals::TraceArrivals(const std::string& path)
+    : m_In(path), m_Path(path)
+{
+    if (!m_In) {
+        std::cerr << "TraceArrivals: Cannot open " << path << std::endl;
+    }
+}
+
+std::optional<UEArrival> TraceArrivals::Next()
+{
+    std::string line;
+    while (m_In && std::getline(m_In, line)) {
+        ++m_Line;
+        if (size_t comment = line.find('#'); comment != std::string::npos) line.erase(comment);
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream fields(line);
+        std::vector<double> values;
+        for (double value; fields >> value;) values.push_back(value);
+
+        UEArrival arrival;
+        bool ok = fields.eof() && (values.size() == 4 || values.size() == 6)
+            && std::all_of(values.begin() + 2, values.end(), [](double v) { return v >= 0.0; });
+        if (ok) {
+            arrival.time = values[0];
+            arrival.dwell = values[1];
+            arrival.x = static_cast<uint32_t>(values[2]);
+            arrival.y = static_cast<uint32_t>(values[3]);
+            if (values.size() == 6) {
+                arrival.vx = static_cast<uint32_t>(values[4]);
+                arrival.vy = static_cast<uint32_t>(values[5]);
+            }
+        }
+        if (!ok || arrival.time < m_LastTime || arrival.dwell < 0.0) {
+            std::cerr << "TraceArrivals: " << m_Path << ":" << m_Line << ": expected <time>,<dwell>,<x>,<y>[,<vx>,<vy>] in time order" << std::endl;
+            m_In.close();
+            return std::nullopt;
+        }
+        m_LastTime = arrival.time;
+        return arrival;
+    }
+    return std::nullopt;
+}
+
+// --- ChurnGenerator ---
+
+ChurnGenerator::ChurnGenerator(std::unique_ptr<ArrivalSource> source, uint32_t firstId, uint32_t capacity)
+    : m_Source(std::move(source))
+{
+    for (uint32_t i = 0; i < capacity; ++i) {
+        m_FreeIds.push_back(firstId + i);
+    }
+}
+
+std::optional<ChurnEvent> ChurnGenerator::Next()
+{
+    for (;;) {
+        if (!m_Pending && !m_SourceDone) {
+            m_Pending = m_Source ? m_Source->Next() : std::nullopt;
+            m_SourceDone = !m_Pending;
+        }
+
+        if (!m_Departures.empty() && (!m_Pending || m_Departures.top().time <= m_Pending->time)) {
+            Departure departure = m_Departures.top();
+            m_Departures.pop();
+            m_FreeIds.push_back(departure.ueId);
+            ChurnEvent event;
+            event.kind = ChurnEvent::Kind::Departure;
+            event.time = departure.time;
+            event.ueId = departure.ueId;
+            return event;
+        }
+        if (!m_Pending) {
+            return std::nullopt;
+        }
+
+        UEArrival arrival = *m_Pending;
+        m_Pending.reset();
+        if (m_FreeIds.empty()) {
+            m_Blocked++;
+            continue;
+        }
+        ChurnEvent event;
+        event.kind = ChurnEvent::Kind::Arrival;
+        event.time = arrival.time;
+        event.ueId = m_FreeIds.front();
+        event.arrival = arrival;
+        m_FreeIds.pop_front();
+        m_Departures.push(Departure{ arrival.time + arrival.dwell, event.ueId });
+        return event;
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+// One UE entering the system at `time` (seconds) and staying `dwell` seconds
+struct UEArrival {
+    double time = 0.0;
+    double dwell = 0.0;
+    uint32_t x = 0, y = 0;
+    uint32_t vx = 0, vy = 0;
+};
+
+// Stream of arrivals in non-decreasing time order
+class ArrivalSource {
+public:
+    virtual ~ArrivalSource() = default;
+    virtual std::optional<UEArrival> Next() = 0;
+};
+
+// Poisson arrivals: exponential inter-arrival and dwell times, uniform
+// positions in the area and speeds up to maxSpeed per axis
+class PoissonArrivals : public ArrivalSource {
+public:
+    struct Params {
+        double rate = 50.0;      // Offered load, arrivals per second
+        double meanDwell = 10.0; // Seconds
+        uint32_t minX = 0, minY = 0;
+        uint32_t maxX = 1000, maxY = 1000;
+        uint32_t maxSpeed = 0;
+        uint64_t seed = 1;
+    };
+
+    explicit PoissonArrivals(const Params& params);
+    std::optional<UEArrival> Next() override;
+
+private:
+    Params m_Params;
+    std::mt19937_64 m_Rng;
+    double m_Time = 0.0;
+};
+
+// Arrivals replayed from a text trace, read one line at a time. Each line is
+// "<time>,<dwell>,<x>,<y>[,<vx>,<vy>]"; '#' starts a comment. Lines with
+// decreasing time are rejected and end the stream.
+class TraceArrivals : public ArrivalSource {
+public:
+    explicit TraceArrivals(const std::string& path);
+    bool IsOpen() const { return m_In.is_open(); }
+    std::optional<UEArrival> Next() override;
+
+private:
+    std::ifstream m_In;
+    std::string m_Path;
+    size_t m_Line = 0;
+    double m_LastTime = 0.0;
+};
+
+// Arrival or departure produced by ChurnGenerator
+struct ChurnEvent {
+    enum class Kind : uint8_t { Arrival, Departure };
+    Kind kind = Kind::Arrival;
+    double time = 0.0;
+    uint32_t ueId = 0;
+    UEArrival arrival; // Arrivals only
+};
+
+// Open-system workload: merges an arrival stream with the departures of the
+// UEs currently in the system, in time order (departures first on ties).
+//
+// UE IDs come from a fixed pool [firstId, firstId + capacity) and go back to
+// it on departure, so memory stays bounded by `capacity` however long the
+// run. An arrival that finds the pool empty is blocked and counted.
+class ChurnGenerator {
+public:
+    ChurnGenerator(std::unique_ptr<ArrivalSource> source, uint32_t firstId, uint32_t capacity);
+
+    std::optional<ChurnEvent> Next();
+
+    inline size_t GetActive() const { return m_Departures.size(); }
+    inline uint64_t GetBlocked() const { return m_Blocked; }
+
+private:
+    struct Departure {
+        double time;
+        uint32_t ueId;
+        bool operator>(const Departure& other) const
+        {
+            return time != other.time ? time > other.time : ueId > other.ueId;
+        }
+    };
+
+    std::unique_ptr<ArrivalSource> m_Source;
+    std::optional<UEArrival> m_Pending; // Next arrival, read ahead
+    bool m_SourceDone = false;
+    std::deque<uint32_t> m_FreeIds;     // FIFO so a departed ID rests before reuse
+    std::priority_queue<Departure, std::vector<Departure>, std::greater<Departure>> m_Departures;
+    uint64_t m_Blocked = 0;
+};
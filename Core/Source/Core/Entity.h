@@ -22,6 +22,13 @@ public:
 		m_Position = { theX, theY };
 	}
 
+	inline Velocity GetVelocity() const { return m_Velocity; }
+
+	inline void SetVelocity(uint32_t theXVel, uint32_t theYVel)
+	{
+		m_Velocity = { theXVel, theYVel };
+	}
+
 	inline uint32_t GetID() const { return m_Id; }
 
 	virtual std::string GetType() const = 0;
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// 32-bit generational handle: low 24 bits slot index, high 8 bits generation.
+// Generation 0 is never issued, so a zero handle is always invalid.
+struct EntityHandle {
+    static constexpr uint32_t IndexBits = 24;
+    static constexpr uint32_t IndexMask = (1u << IndexBits) - 1;
+    static constexpr uint32_t MaxIndex = IndexMask;
+
+    uint32_t value = 0;
+
+    static EntityHandle Make(uint32_t index, uint8_t generation) {
+        return { (static_cast<uint32_t>(generation) << IndexBits) | (index & IndexMask) };
+    }
+
+    uint32_t Index() const { return value & IndexMask; }
+    uint8_t Generation() const { return static_cast<uint8_t>(value >> IndexBits); }
+    bool IsValid() const { return value != 0; }
+
+    bool operator==(const EntityHandle& other) const { return value == other.value; }
+    bool operator!=(const EntityHandle& other) const { return value != other.value; }
+};
+
+// Contiguous, chunked storage for one entity type.
+//
+// Entities are constructed in place in fixed-size chunks, so addresses are
+// stable for an entity's lifetime and creation never relocates neighbours.
+// Destroy() is O(1): the slot's generation is bumped (invalidating every
+// outstanding handle) and the slot joins a FIFO free list, so churn cycles
+// through all free slots rather than reusing one. A slot whose 8-bit
+// generation would wrap is retired instead of freed, so a stale handle can
+// never match a later occupant.
+// Lookups are a bounds check plus a generation compare; no refcounts or
+// atomics are involved. Not thread-safe for concurrent Create/Destroy.
+template<typename T>
+class EntityPool {
+public:
+    static constexpr uint32_t ChunkBits = 12;
+    static constexpr uint32_t ChunkSize = 1u << ChunkBits;
+
+    EntityPool() = default;
+    ~EntityPool() { Clear(); }
+
+    EntityPool(const EntityPool&) = delete;
+    EntityPool& operator=(const EntityPool&) = delete;
+
+    size_t Size() const { return m_Size; }
+    size_t Capacity() const { return m_Chunks.size() * ChunkSize; }
+    size_t Retired() const { return m_Retired; }
+
+    // Pre-allocate chunks for `count` entities so bulk creation does no
+    // further chunk allocations.
+    void Reserve(size_t count) {
+        if (count > size_t(EntityHandle::MaxIndex) + 1) {
+            throw std::length_error("EntityPool: reserve exceeds handle index range");
+        }
+        while (Capacity() < count) AddChunk();
+        m_Generations.reserve(count);
+        m_Alive.reserve(count);
+    }
+
+    template<typename... Args>
+    EntityHandle Create(Args&&... args) {
+        uint32_t index;
+        bool reused = !m_FreeList.empty();
+        if (reused) {
+            index = m_FreeList.front();
+            m_FreeList.pop_front();
+        } else {
+            if (m_Generations.size() > EntityHandle::MaxIndex) {
+                throw std::length_error("EntityPool: handle index range exhausted");
+            }
+            index = static_cast<uint32_t>(m_Generations.size());
+            if (index >= Capacity()) AddChunk();
+            m_Generations.push_back(1);
+            m_Alive.push_back(0);
+        }
+
+        try {
+            new (SlotPtr(index)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            m_FreeList.push_front(index);
+            throw;
+        }
+        m_Alive[index] = 1;
+        ++m_Size;
+        return EntityHandle::Make(index, m_Generations[index]);
+    }
+
+    bool Destroy(EntityHandle handle) {
+        T* entity = Get(handle);
+        if (!entity) return false;
+        uint32_t index = handle.Index();
+        entity->~T();
+        m_Alive[index] = 0;
+        if (m_Generations[index] == UINT8_MAX) {
+            ++m_Retired; // Generations exhausted; the slot is never reused
+        } else {
+            ++m_Generations[index];
+            m_FreeList.push_back(index);
+        }
+        --m_Size;
+        return true;
+    }
+
+    T* Get(EntityHandle handle) const {
+        uint32_t index = handle.Index();
+        if (index >= m_Generations.size() || !m_Alive[index] || m_Generations[index] != handle.Generation()) {
+            return nullptr;
+        }
+        return SlotPtr(index);
+    }
+
+    // Visit live entities in slot order
+    template<typename Fn>
+    void ForEach(Fn&& fn) const {
+        for (uint32_t index = 0; index < m_Generations.size(); ++index) {
+            if (m_Alive[index]) fn(*SlotPtr(index));
+        }
+    }
+
+    void Clear() {
+        for (uint32_t index = 0; index < m_Generations.size(); ++index) {
+            if (m_Alive[index]) SlotPtr(index)->~T();
+        }
+        m_Generations.clear();
+        m_Alive.clear();
+        m_FreeList.clear();
+        m_Chunks.clear();
+        m_Size = 0;
+        m_Retired = 0;
+    }
+
+private:
+    struct alignas(T) Slot {
+        std::byte storage[sizeof(T)];
+    };
+
+    void AddChunk() {
+        m_Chunks.push_back(std::make_unique<Slot[]>(ChunkSize));
+    }
+
+    T* SlotPtr(uint32_t index) const {
+        Slot& slot = m_Chunks[index >> ChunkBits][index & (ChunkSize - 1)];
+        return std::launder(reinterpret_cast<T*>(slot.storage));
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> m_Chunks;
+    std::vector<uint8_t> m_Generations; // Per slot; bumped on destroy
+    std::vector<uint8_t> m_Alive;
+    std::deque<uint32_t> m_FreeList;
+    size_t m_Size = 0;
+    size_t m_Retired = 0;
+};
+
+// Non-owning, generation-checked reference to a pooled entity. Replaces
+// weak_ptr cross-references: resolving is a plain load and compare.
+template<typename T>
+class EntityRef {
+public:
+    EntityRef() = default;
+    EntityRef(const EntityPool<T>* pool, EntityHandle handle) : m_Pool(pool), m_Handle(handle) {}
+
+    T* Get() const { return m_Pool ? m_Pool->Get(m_Handle) : nullptr; }
+    EntityHandle Handle() const { return m_Handle; }
+    bool Expired() const { return Get() == nullptr; }
+    void Reset() { m_Pool = nullptr; m_Handle = {}; }
+
+private:
+    const EntityPool<T>* m_Pool = nullptr;
+    EntityHandle m_Handle;
+};
+
+// Lets a pooled entity hand out references to itself, the pooled analogue
+// of enable_shared_from_this. The owning World sets it on creation.
+template<typename T>
+class EnableSelfRef {
+public:
+    const EntityRef<T>& SelfRef() const { return m_SelfRef; }
+    void SetSelfRef(const EntityRef<T>& self) { m_SelfRef = self; }
+
+private:
+    EntityRef<T> m_SelfRef;
+};
@@ -0,0 +1,135 @@
+#include "GroupKeyTree.h"
+
+#include <algorithm>
+
+GroupKeyTree::GroupKeyTree()
+    : m_Rng(std::random_device{}())
+{
+    // Two leaves under a root, so the group key is never a member's own key
+    m_Levels.resize(2);
+    m_Levels[0].resize(2);
+    m_Levels[1].resize(1);
+    m_Levels[1][0].key = NewKey();
+    m_Marked.resize(2);
+}
+
+void GroupKeyTree::SetGroupKey(std::vector<uint8_t> key)
+{
+    m_Levels.back()[0].key = std::move(key);
+}
+
+void GroupKeyTree::Join(uint32_t member, Kyber::ByteView leafKey)
+{
+    auto [it, added] = m_LeafOf.try_emplace(member, 0);
+    if (added) {
+        if (!m_FreeLeaves.empty()) {
+            it->second = m_FreeLeaves.back();
+            m_FreeLeaves.pop_back();
+        } else {
+            if (m_NextLeaf == m_Levels[0].size()) Grow();
+            it->second = m_NextLeaf++;
+        }
+        m_Stats.joins++;
+    }
+    const uint32_t leaf = it->second;
+    m_Levels[0][leaf].key.assign(leafKey.begin(), leafKey.end());
+    MarkPath(leaf, added ? 1 : 0);
+    m_Joined.emplace_back(member, Node(0, leaf));
+}
+
+bool GroupKeyTree::Leave(uint32_t member)
+{
+    auto it = m_LeafOf.find(member);
+    if (it == m_LeafOf.end()) return false;
+    const uint32_t leaf = it->second;
+    m_Levels[0][leaf].key.clear();
+    MarkPath(leaf, -1);
+    m_FreeLeaves.push_back(leaf);
+    m_LeafOf.erase(it);
+    std::erase_if(m_Joined, [member](const auto& joined) { return joined.first == member; });
+    m_Stats.leaves++;
+    return true;
+}
+
+void GroupKeyTree::Rotate()
+{
+    Mark(Height(), 0);
+}
+
+GroupRekey GroupKeyTree::Rekey()
+{
+    GroupRekey rekey;
+    if (!m_Pending) return rekey;
+
+    for (uint32_t level = 1; level < m_Levels.size(); ++level) {
+        std::vector<uint32_t>& marked = m_Marked[level];
+        std::sort(marked.begin(), marked.end());
+        for (uint32_t index : marked) {
+            KeyNode& node = m_Levels[level][index];
+            node.marked = false;
+            node.key = NewKey();
+            m_Stats.nodeKeys++;
+            // Children are final by now: new if marked, else unchanged
+            for (uint32_t child = 2 * index; child <= 2 * index + 1; ++child) {
+                const KeyNode& below = m_Levels[level - 1][child];
+                if (below.members == 0) continue; // Nobody left to tell, a departed member included
+                rekey.messages.push_back({ Node(level, index), Node(level - 1, child), Kyber::EncryptSymmetric(below.key, node.key) });
+            }
+        }
+        marked.clear();
+    }
+
+    rekey.epoch = ++m_Epoch;
+    rekey.root = Root();
+    rekey.joined = std::move(m_Joined);
+    m_Joined.clear();
+    m_Pending = false;
+    m_Stats.rekeys++;
+    m_Stats.messages += rekey.messages.size();
+    return rekey;
+}
+
+void GroupKeyTree::MarkPath(uint32_t leaf, int32_t delta)
+{
+    for (uint32_t level = 0; level < m_Levels.size(); ++level) {
+        uint32_t index = leaf >> level;
+        m_Levels[level][index].members += delta;
+        if (level > 0) Mark(level, index);
+    }
+}
+
+void GroupKeyTree::Mark(uint32_t level, uint32_t index)
+{
+    m_Pending = true;
+    KeyNode& node = m_Levels[level][index];
+    if (node.marked) return;
+    node.marked = true;
+    m_Marked[level].push_back(index);
+}
+
+void GroupKeyTree::Grow()
+{
+    // The old root becomes the left child of a new root that keeps the
+    // group key until the next rekey. Both get new keys then: anyone who
+    // saw the old group key must not be able to unwrap the new one.
+    for (uint32_t level = 0; level < m_Levels.size(); ++level) {
+        m_Levels[level].resize(m_Levels[level].size() * 2);
+    }
+    KeyNode root;
+    const KeyNode& oldRoot = m_Levels.back()[0];
+    root.key = oldRoot.key;
+    root.members = oldRoot.members;
+    m_Levels.push_back({ std::move(root) });
+    m_Marked.emplace_back();
+    Mark(Height() - 1, 0);
+}
+
+std::vector<uint8_t> GroupKeyTree::NewKey()
+{
+    std::vector<uint8_t> key(KeyBytes);
+    for (size_t i = 0; i < KeyBytes; i += 8) {
+        uint64_t word = m_Rng();
+        for (size_t b = i; b < i + 8; ++b, word >>= 8) key[b] = static_cast<uint8_t>(word);
+    }
+    return key;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "AuthMessages.h"
+#include "KyberUtils.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct GroupKeyTreeStats {
+    uint64_t joins = 0;
+    uint64_t leaves = 0;
+    uint64_t rekeys = 0;   // Rekey() calls that replaced the group key
+    uint64_t nodeKeys = 0; // Inner node keys regenerated
+    uint64_t messages = 0; // Wrapped keys broadcast
+};
+
+// Logical key hierarchy (LKH) for the UAV group key GKUAV.
+//
+// Members sit at the leaves of a binary tree, each under a key it shares
+// with the gNB (its KRANj). Every inner node has a key known to the members
+// below it, and the root's key is the group key. A join or leave changes
+// only the keys on one leaf-to-root path, so it costs about 2 log2 N
+// wrapped keys instead of a Phase A per UAV. Changes are batched:
+// Join/Leave/Rotate mark paths and Rekey() regenerates each marked node
+// once, so concurrent changes share the upper levels of their paths.
+//
+// Nodes are named (level, index) with the leaves at level 0. Growing the
+// tree puts a new root on top without renaming anything, so members keep
+// the keys they hold.
+class GroupKeyTree {
+public:
+    using NodeId = uint64_t;
+    static constexpr size_t KeyBytes = 32;
+
+    static NodeId Node(uint32_t level, uint32_t index) { return (static_cast<uint64_t>(level) << 32) | index; }
+    static uint32_t Level(NodeId node) { return static_cast<uint32_t>(node >> 32); }
+    static uint32_t Index(NodeId node) { return static_cast<uint32_t>(node); }
+
+    GroupKeyTree();
+
+    // Replace the group key without a rekey; members must learn it some
+    // other way (Cj in Phase A)
+    void SetGroupKey(std::vector<uint8_t> key);
+    const std::vector<uint8_t>& GroupKey() const { return m_Levels.back()[0].key; }
+
+    // Place `member` under `leafKey`, or give a member a new leaf key
+    void Join(uint32_t member, Kyber::ByteView leafKey);
+    // False if `member` is not in the tree
+    bool Leave(uint32_t member);
+    // New group key with no membership change
+    void Rotate();
+
+    // Regenerate every key marked since the last call, leaves to root, and
+    // return the broadcast that carries them. Empty without pending changes.
+    GroupRekey Rekey();
+    inline bool HasPendingChanges() const { return m_Pending; }
+
+    inline size_t Size() const { return m_LeafOf.size(); }
+    inline uint32_t Height() const { return static_cast<uint32_t>(m_Levels.size() - 1); }
+    inline NodeId Root() const { return Node(Height(), 0); }
+    inline uint64_t Epoch() const { return m_Epoch; }
+    inline bool Contains(uint32_t member) const { return m_LeafOf.count(member) != 0; }
+    inline const GroupKeyTreeStats& GetStats() const { return m_Stats; }
+
+private:
+    struct KeyNode {
+        std::vector<uint8_t> key;
+        uint32_t members = 0; // Occupied leaves below
+        bool marked = false;
+    };
+
+    // Add `delta` members along the path of `leaf` and mark its inner nodes
+    void MarkPath(uint32_t leaf, int32_t delta);
+    void Mark(uint32_t level, uint32_t index);
+    void Grow();
+    std::vector<uint8_t> NewKey();
+
+    std::vector<std::vector<KeyNode>> m_Levels;  // [level][index], leaves at level 0
+    std::vector<std::vector<uint32_t>> m_Marked; // Marked indices per level
+    std::unordered_map<uint32_t, uint32_t> m_LeafOf; // Member -> leaf index
+    std::vector<uint32_t> m_FreeLeaves;
+    uint32_t m_NextLeaf = 0;
+    std::vector<std::pair<uint32_t, uint64_t>> m_Joined; // Since the last rekey
+    uint64_t m_Epoch = 0;
+    bool m_Pending = false;
+    GroupKeyTreeStats m_Stats;
+    std::mt19937_64 m_Rng;
+};
@@ -4,15 +4,15 @@
 #include <random>
 #include <algorithm> // for std::copy
 #include <chrono>
-#include <sstream> // for TID generation
-#include <iomanip> // for TID generation
+#include <sstream> // for TID formatting
+#include <charconv> // for TID formatting
+#include <string_view>
+#include <atomic>
 
 
 
 namespace Kyber {
 
-    std::vector<uint8_t> RandValue = { 0 };
-
     
 
     std::pair<std::vector<uint8_t>, std::vector<uint8_t>> G(const std::vector<uint8_t>& d) {
@@ -123,14 +123,11 @@ namespace Kyber {
 
         // TODO
         
-        RandValue = input;
         return result; // Return Polynomial
     }
 
     std::vector<uint8_t> Compressq(const Polynomial& input, int parameter) {
         
-        return RandValue;
-        
         std::vector<uint8_t> result;
         for(int val : input) {
             result.push_back(static_cast<uint8_t>(val & 0xFF)); // No actual compression
@@ -140,89 +137,163 @@ namespace Kyber {
     }
 
 
-    std::vector<uint8_t> KDF(const std::vector<uint8_t>& input) {
-        
-        
-        std::vector<uint8_t> output = input;
-        if (!output.empty()) output[0] ^= 0xAA;
-        else output.push_back(0xAA);
-        return output;
+    // Stub primitives are written once against any byte container so the
+    // heap (std::vector) and arena (ArenaBytes) variants stay identical.
+    namespace {
+        template<typename Out>
+        Out XorFirstByte(ByteView input, uint8_t val, Out output) {
+            output.assign(input.begin(), input.end());
+            if (!output.empty()) output[0] ^= val;
+            else output.push_back(val);
+            return output;
+        }
+
+        template<typename Out>
+        Out KDFImpl(ByteView key, ByteView data, Out output) {
+            uint8_t val;
+            if (!key.empty()) val = key[0];
+            else val = 0xAA;
+            return XorFirstByte(data, val, std::move(output));
+        }
+
+        template<typename Out>
+        Out KeyedHashStub(std::string_view key, ByteView input, Out output) {
+            // Mix in key length as a trivial way to use the key
+            return XorFirstByte(input, static_cast<uint8_t>(key.length() & 0xFF), std::move(output));
+        }
+
+        template<typename Out>
+        Out F1StarImpl(std::string_view key, ByteView input, Out output) {
+            output = KeyedHashStub(key, input, std::move(output));
+            // Make it slightly different from f1K
+            if (!output.empty()) output[output.size()-1] ^= 0x55;
+            else output.push_back(0x55);
+            return output;
+        }
+
+        template<typename Out>
+        Out TaggedHashStub(std::string_view key, ByteView input, std::string_view tag, Out output) {
+            output = KeyedHashStub(key, input, std::move(output));
+            output.insert(output.end(), tag.begin(), tag.end()); // Tag
+            return output;
+        }
+
+        template<typename Out>
+        Out XorCipher(ByteView key, ByteView data, Out output) {
+            output.assign(data.begin(), data.end());
+            if (key.empty()) return output; // Cannot encrypt without key
+            for (size_t i = 0; i < output.size(); ++i) {
+                output[i] ^= key[i % key.size()];
+            }
+            return output;
+        }
+
+        template<typename Out>
+        Out TimestampBytesImpl(const Timestamp& t, Out bytes) {
+            auto epoch_ms = std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+            bytes.resize(sizeof(epoch_ms));
+            // Simple Big-Endian conversion
+            for (size_t i = 0; i < sizeof(epoch_ms); ++i) {
+                bytes[sizeof(epoch_ms) - 1 - i] = static_cast<uint8_t>((epoch_ms >> (i * 8)) & 0xFF);
+            }
+            return bytes;
+        }
     }
 
-    std::vector<uint8_t> KDF(const std::vector<uint8_t>& key, const std::vector<uint8_t>& data)
-    {
-        
-        
-        std::vector<uint8_t> output = data;
-        uint8_t val;
-        if (!key.empty()) val = key[0];
-        else val = 0xAA;
+    std::vector<uint8_t> KDF(ByteView input) {
+        return XorFirstByte(input, 0xAA, std::vector<uint8_t>{});
+    }
 
-        if (!output.empty()) output[0] ^= val;
-        else output.push_back(val);
-        return output;
+    std::vector<uint8_t> KDF(ByteView key, ByteView data) {
+        return KDFImpl(key, data, std::vector<uint8_t>{});
     }
 
-    std::vector<uint8_t> EMSK(const std::vector<uint8_t>& input) {
-        
-        
-        std::vector<uint8_t> output = input;
-         if (!output.empty()) output[0] ^= 0xBB;
-         else output.push_back(0xBB);
-        return output;
+    std::vector<uint8_t> EMSK(ByteView input) {
+        return XorFirstByte(input, 0xBB, std::vector<uint8_t>{});
     }
 
-    std::vector<uint8_t> DMSK(const std::vector<uint8_t>& input) {
-        
-        
-        std::vector<uint8_t> output = input;
-         if (!output.empty()) output[0] ^= 0xBB;
-         else output.push_back(0xBB); // If input was empty, result is just BB
-        return output;
+    std::vector<uint8_t> DMSK(ByteView input) {
+        // If input was empty, result is just BB
+        return XorFirstByte(input, 0xBB, std::vector<uint8_t>{});
     }
 
-    std::vector<uint8_t> keyed_hash_stub(const std::string& key, const std::vector<uint8_t>& input) {
-        std::vector<uint8_t> output = input;
-        // Mix in key length as a trivial way to use the key
-        if (!output.empty()) output[0] ^= static_cast<uint8_t>(key.length() & 0xFF);
-        else output.push_back(static_cast<uint8_t>(key.length() & 0xFF));
-        return output;
+    std::vector<uint8_t> f1K(std::string_view key, ByteView input) {
+        return KeyedHashStub(key, input, std::vector<uint8_t>{});
     }
 
-    std::vector<uint8_t> f1K(const std::string& key, const std::vector<uint8_t>& input) {
-        
-        return keyed_hash_stub(key, input);
+    std::vector<uint8_t> f1_star_K(std::string_view key, ByteView input) {
+        return F1StarImpl(key, input, std::vector<uint8_t>{});
     }
 
-    std::vector<uint8_t> f1_star_K(const std::string& key, const std::vector<uint8_t>& input) {
-         
-         std::vector<uint8_t> output = keyed_hash_stub(key, input);
-         // Make it slightly different from f1K
-         if (!output.empty()) output[output.size()-1] ^= 0x55;
-         else output.push_back(0x55);
-         return output;
+    std::vector<uint8_t> f2K(std::string_view key, ByteView input) {
+        return TaggedHashStub(key, input, "RES", std::vector<uint8_t>{});
     }
 
+    std::vector<uint8_t> f3K(std::string_view key, ByteView input) {
+        return TaggedHashStub(key, input, "CK", std::vector<uint8_t>{});
+    }
 
-    std::vector<uint8_t> f2K(const std::string& key, const std::vector<uint8_t>& input) {
-        
-        std::vector<uint8_t> output = keyed_hash_stub(key, input);
-        output.push_back('R'); output.push_back('E'); output.push_back('S'); // Tag
-        return output;
+    std::vector<uint8_t> f4K(std::string_view key, ByteView input) {
+        return TaggedHashStub(key, input, "IK", std::vector<uint8_t>{});
     }
 
-    std::vector<uint8_t> f3K(const std::string& key, const std::vector<uint8_t>& input) {
-        
-         std::vector<uint8_t> output = keyed_hash_stub(key, input);
-        output.push_back('C'); output.push_back('K'); // Tag
-        return output;
+    // --- Arena Variants ---
+
+    ArenaBytes KDF(ByteView input, std::pmr::memory_resource* arena) {
+        return XorFirstByte(input, 0xAA, ArenaBytes(arena));
     }
 
-    std::vector<uint8_t> f4K(const std::string& key, const std::vector<uint8_t>& input) {
-        
-         std::vector<uint8_t> output = keyed_hash_stub(key, input);
-        output.push_back('I'); output.push_back('K'); // Tag
-        return output;
+    ArenaBytes KDF(ByteView key, ByteView data, std::pmr::memory_resource* arena) {
+        return KDFImpl(key, data, ArenaBytes(arena));
+    }
+
+    ArenaBytes EMSK(ByteView input, std::pmr::memory_resource* arena) {
+        return XorFirstByte(input, 0xBB, ArenaBytes(arena));
+    }
+
+    ArenaBytes DMSK(ByteView input, std::pmr::memory_resource* arena) {
+        return XorFirstByte(input, 0xBB, ArenaBytes(arena));
+    }
+
+    ArenaBytes f1K(std::string_view key, ByteView input, std::pmr::memory_resource* arena) {
+        return KeyedHashStub(key, input, ArenaBytes(arena));
+    }
+
+    ArenaBytes f1_star_K(std::string_view key, ByteView input, std::pmr::memory_resource* arena) {
+        return F1StarImpl(key, input, ArenaBytes(arena));
+    }
+
+    ArenaBytes f2K(std::string_view key, ByteView input, std::pmr::memory_resource* arena) {
+        return TaggedHashStub(key, input, "RES", ArenaBytes(arena));
+    }
+
+    ArenaBytes f3K(std::string_view key, ByteView input, std::pmr::memory_resource* arena) {
+        return TaggedHashStub(key, input, "CK", ArenaBytes(arena));
+    }
+
+    ArenaBytes f4K(std::string_view key, ByteView input, std::pmr::memory_resource* arena) {
+        return TaggedHashStub(key, input, "IK", ArenaBytes(arena));
+    }
+
+    ArenaBytes DecryptSymmetric(ByteView key, ByteView ciphertext, std::pmr::memory_resource* arena) {
+        return XorCipher(key, ciphertext, ArenaBytes(arena));
+    }
+
+    ArenaBytes ConcatBytes(std::initializer_list<ByteView> parts, std::pmr::memory_resource* arena) {
+        size_t total = 0;
+        for (const auto& part : parts) total += part.size();
+        ArenaBytes result(arena);
+        result.reserve(total);
+        for (const auto& part : parts) result.insert(result.end(), part.begin(), part.end());
+        return result;
+    }
+
+    ArenaBytes StringToBytes(std::string_view str, std::pmr::memory_resource* arena) {
+        return ArenaBytes(str.begin(), str.end(), arena);
+    }
+
+    ArenaBytes TimestampToBytes(const Timestamp& t, std::pmr::memory_resource* arena) {
+        return TimestampBytesImpl(t, ArenaBytes(arena));
     }
 
     // Helper to convert uint64_t to bytes (Big Endian)
@@ -235,7 +306,7 @@ namespace Kyber {
     }
 
     // Helper to convert bytes to uint64_t (Big Endian)
-    uint64_t BytesToU64(const std::vector<uint8_t>& bytes) {
+    uint64_t BytesToU64(ByteView bytes) {
         if (bytes.size() < 8) return 0; // Or throw error
         uint64_t val = 0;
         for (int i = 0; i < 8; ++i) {
@@ -274,29 +345,107 @@ namespace Kyber {
 
     
 
-    std::vector<uint8_t> EncryptSymmetric(const std::vector<uint8_t>& key, const std::vector<uint8_t>& data) {
-        
-        if (key.empty()) return data; // Cannot encrypt without key
-        std::vector<uint8_t> ciphertext = data;
-        for (size_t i = 0; i < ciphertext.size(); ++i) {
-            ciphertext[i] ^= key[i % key.size()];
-        }
-        return ciphertext;
+    std::vector<uint8_t> EncryptSymmetric(ByteView key, ByteView data) {
+        return XorCipher(key, data, std::vector<uint8_t>{});
     }
 
-    std::vector<uint8_t> DecryptSymmetric(const std::vector<uint8_t>& key, const std::vector<uint8_t>& ciphertext) {
+    std::vector<uint8_t> DecryptSymmetric(ByteView key, ByteView ciphertext) {
         
         // XOR decryption is the same as encryption
         return EncryptSymmetric(key, ciphertext);
     }
 
-    std::string GenerateTID(const std::string& prefix) {
-        static uint64_t counter = 0;
+    std::vector<uint8_t> XnRequestMAC(ByteView tgk_i, const TID& tid_i, uint32_t targetGnbId) {
+        std::vector<uint8_t> input = { 'X', 'N' };
+        input.insert(input.end(), tid_i.bytes.begin(), tid_i.bytes.end());
+        std::vector<uint8_t> id = U64ToBytes(targetGnbId);
+        input.insert(input.end(), id.begin(), id.end());
+        return KDF(tgk_i, input);
+    }
+
+    std::vector<uint8_t> XnNextHopKey(ByteView tgk_i, const TID& tid_i, uint32_t targetGnbId) {
+        std::vector<uint8_t> input = { 'N', 'H' };
+        std::vector<uint8_t> id = U64ToBytes(targetGnbId);
+        input.insert(input.end(), id.begin(), id.end());
+        input.insert(input.end(), tid_i.bytes.begin(), tid_i.bytes.end());
+        return KDF(tgk_i, input);
+    }
+
+    std::vector<uint8_t> ResumeRequestMAC(ByteView kran_i, const TID& tid_i, uint64_t counter) {
+        std::vector<uint8_t> input = { 'R', 'S' };
+        input.insert(input.end(), tid_i.bytes.begin(), tid_i.bytes.end());
+        std::vector<uint8_t> count = U64ToBytes(counter);
+        input.insert(input.end(), count.begin(), count.end());
+        return KDF(kran_i, input);
+    }
+
+    std::vector<uint8_t> ResumeKRAN(ByteView kran_i, const TID& tid_i, uint64_t counter) {
+        std::vector<uint8_t> input = { 'R', 'K' };
+        std::vector<uint8_t> count = U64ToBytes(counter);
+        input.insert(input.end(), count.begin(), count.end());
+        input.insert(input.end(), tid_i.bytes.begin(), tid_i.bytes.end());
+        return KDF(kran_i, input);
+    }
+
+    std::optional<TID> TID::FromBytes(ByteView view) {
+        if (view.size() != Bytes || view[0] == 0 || view[0] > static_cast<uint8_t>(TIDKind::UAV)) return std::nullopt;
+        TID tid;
+        std::copy(view.begin(), view.end(), tid.bytes.begin());
+        return tid;
+    }
+
+    uint32_t TID::Owner() const {
+        return static_cast<uint32_t>(BytesToU64(View().first(8))); // Low half of the first word
+    }
+
+    uint64_t TID::Serial() const {
+        return BytesToU64(ByteView(bytes.data() + 8, 8));
+    }
+
+    std::string TID::ToString() const {
         std::stringstream ss;
-        ss << prefix << "_" << std::hex << std::setw(8) << std::setfill('0') << counter++;
+        ss << *this;
         return ss.str();
     }
 
+    // Formatted into a local buffer and written unformatted: entities log
+    // TIDs to the shared std::cout from worker threads, so the stream's
+    // fill, flags and width must not be touched.
+    std::ostream& operator<<(std::ostream& os, const TID& tid) {
+        std::string_view prefix;
+        switch (tid.Kind()) {
+        case TIDKind::UE: prefix = "TID_UE_"; break;
+        case TIDKind::UAV: prefix = "TID_UAV_"; break;
+        default: prefix = "TID_NONE"; return os.write(prefix.data(), prefix.size());
+        }
+        char serial[16];
+        char* serialEnd = std::to_chars(serial, serial + sizeof(serial), tid.Serial(), 16).ptr;
+        char text[48];
+        char* out = std::copy(prefix.begin(), prefix.end(), text);
+        out = std::to_chars(out, text + sizeof(text), tid.Owner()).ptr;
+        *out++ = '_';
+        out = std::fill_n(out, std::max<ptrdiff_t>(0, 8 - (serialEnd - serial)), '0');
+        out = std::copy(serial, serialEnd, out);
+        return os.write(text, out - text);
+    }
+
+    TID GenerateTID(TIDKind kind, uint32_t ownerId) {
+        constexpr uint64_t BlockSize = 256;
+        static std::atomic<uint64_t> counter{ 0 }; // Flows may run on several threads
+        thread_local uint64_t next = 0, end = 0;
+        if (next == end) {
+            next = counter.fetch_add(BlockSize, std::memory_order_relaxed);
+            end = next + BlockSize;
+        }
+        uint64_t serial = next++;
+
+        TID tid;
+        tid.bytes[0] = static_cast<uint8_t>(kind);
+        for (int i = 0; i < 4; ++i) tid.bytes[4 + i] = static_cast<uint8_t>(ownerId >> (24 - 8 * i));
+        for (int i = 0; i < 8; ++i) tid.bytes[8 + i] = static_cast<uint8_t>(serial >> (56 - 8 * i));
+        return tid;
+    }
+
     Timestamp GenerateTST(int validity_seconds) {
         return std::chrono::system_clock::now() + std::chrono::seconds(validity_seconds);
     }
@@ -311,21 +460,15 @@ namespace Kyber {
         return std::vector<uint8_t>(str.begin(), str.end());
     }
 
-    std::string BytesToString(const std::vector<uint8_t>& bytes) {
+    std::string BytesToString(ByteView bytes) {
         return std::string(bytes.begin(), bytes.end());
     }
 
     std::vector<uint8_t> TimestampToBytes(const Timestamp& t) {
-        auto epoch_ms = std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
-        std::vector<uint8_t> bytes(sizeof(epoch_ms));
-        // Simple Big-Endian conversion
-        for (size_t i = 0; i < sizeof(epoch_ms); ++i) {
-            bytes[sizeof(epoch_ms) - 1 - i] = static_cast<uint8_t>((epoch_ms >> (i * 8)) & 0xFF);
-        }
-        return bytes;
+        return TimestampBytesImpl(t, std::vector<uint8_t>{});
     }
 
-    Timestamp BytesToTimestamp(const std::vector<uint8_t>& bytes) {
+    Timestamp BytesToTimestamp(ByteView bytes) {
         if (bytes.size() < sizeof(long long)) return Timestamp::min(); // Or throw
         long long epoch_ms = 0;
         // Simple Big-Endian conversion
@@ -335,5 +478,8 @@ namespace Kyber {
         return Timestamp(std::chrono::milliseconds(epoch_ms));
     }
 
-} // namespace Kyber
+    bool BytesEqual(ByteView a, ByteView b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
 
+} // namespace Kyber
\ No newline at end of file
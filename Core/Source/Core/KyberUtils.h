@@ -6,6 +6,13 @@
 #include <cstdint>
 #include <utility> // for std::pair
 #include <chrono> // For timestamps
+#include <span> // Non-owning byte views
+#include <string_view>
+#include <memory_resource> // Arena-backed temporaries
+#include <array>
+#include <algorithm>
+#include <iosfwd>
+#include <optional>
 
 namespace Kyber {
 
@@ -16,6 +23,89 @@ namespace Kyber {
                                             // Let's assume A is std::vector<std::vector<int>> for simplicity in stubs.
     using Matrix2x2 = std::vector<std::vector<int>>; // Specific 2x2 matrix
     using Timestamp = std::chrono::time_point<std::chrono::system_clock>;
+    using ByteView = std::span<const uint8_t>;        // Read-only input bytes (vector, arena buffer, or slice)
+    using ArenaBytes = std::pmr::vector<uint8_t>;     // Temporary bytes allocated from a transaction arena
+
+    // Fixed-capacity inline byte string for per-entity key material. Avoids a
+    // heap block per key; capacity is a compile-time bound (<= 255 bytes).
+    template<size_t N>
+    class FixedBytes {
+        static_assert(N <= 255, "FixedBytes length is stored in one byte");
+    public:
+        FixedBytes() = default;
+
+        // Returns false (leaving the value unchanged) if `bytes` does not fit
+        bool Assign(ByteView bytes) {
+            if (bytes.size() > N) return false;
+            std::copy(bytes.begin(), bytes.end(), m_Data.begin());
+            m_Size = static_cast<uint8_t>(bytes.size());
+            return true;
+        }
+        bool Assign(std::string_view str) {
+            return Assign(ByteView(reinterpret_cast<const uint8_t*>(str.data()), str.size()));
+        }
+
+        ByteView View() const { return ByteView(m_Data.data(), m_Size); }
+        operator ByteView() const { return View(); }
+        std::string_view AsString() const { return std::string_view(reinterpret_cast<const char*>(m_Data.data()), m_Size); }
+
+        size_t size() const { return m_Size; }
+        bool empty() const { return m_Size == 0; }
+        void clear() { m_Size = 0; }
+
+    private:
+        std::array<uint8_t, N> m_Data{};
+        uint8_t m_Size = 0;
+    };
+
+    enum class TIDKind : uint8_t { None = 0, UE = 1, UAV = 2 };
+
+    // Fixed-width temporary identity (TIDi of a UE, TIDj of a UAV):
+    // [kind][3 zero bytes][entity ID, u32 BE][serial, u64 BE]. Travels in Ci,
+    // Cj and the TID-bound KDF inputs as these 16 bytes, and keys the gNB's
+    // session index directly. All zero is "no TID". Prints as the old text
+    // form TID_UE_<id>_<serial hex>.
+    struct TID {
+        static constexpr size_t Bytes = 16;
+        std::array<uint8_t, Bytes> bytes{};
+
+        // Nullopt unless `view` is exactly Bytes long with a known kind
+        static std::optional<TID> FromBytes(ByteView view);
+
+        TIDKind Kind() const { return static_cast<TIDKind>(bytes[0]); }
+        uint32_t Owner() const;
+        uint64_t Serial() const;
+        std::string ToString() const;
+
+        ByteView View() const { return ByteView(bytes.data(), Bytes); }
+        operator ByteView() const { return View(); }
+        bool empty() const { return Kind() == TIDKind::None; }
+        void clear() { bytes.fill(0); }
+
+        friend bool operator==(const TID&, const TID&) = default;
+    };
+
+    struct TIDHash {
+        size_t operator()(const TID& tid) const noexcept {
+            uint64_t h = tid.Serial() ^ (uint64_t(tid.Owner()) << 29) ^ (uint64_t(tid.bytes[0]) << 61);
+            h ^= h >> 33; // Serials are sequential; spread them over the buckets
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return static_cast<size_t>(h);
+        }
+    };
+
+    std::ostream& operator<<(std::ostream& os, const TID& tid);
+
+    // Read-only home-network parameters, built once per gNB and shared by
+    // every UE it provisions.
+    struct NetworkParams {
+        std::vector<uint8_t> amf;
+        std::vector<uint8_t> rho;
+        Polynomial pk;
+        Matrix2x2 A;
+        std::string servingNetworkName;
+    };
 
     // Constants (Placeholder)
     const size_t POLYNOMIAL_SIZE = 256; // Example size n
@@ -48,6 +138,9 @@ namespace Kyber {
     Polynomial VecTransposeVecMul(const Polynomial& pkT, const Polynomial& r);
 
     // Compression/Decompression (Placeholders)
+    // RAND size in bytes; the placeholder C1 carries Decompressq(RAND) in the
+    // first RandBytes coefficients of v
+    constexpr size_t RandBytes = 32;
     // Decompress bytes to a Polynomial (e.g., for RAND)
     Polynomial Decompressq(const std::vector<uint8_t>& input, int parameter);
     // Compress a Polynomial to bytes (e.g., for RAND')
@@ -56,31 +149,56 @@ namespace Kyber {
     // --- 5G Protocol Specific Functions (Placeholders) ---
 
     // Key Derivation Function
-    std::vector<uint8_t> KDF(const std::vector<uint8_t>& input);
+    std::vector<uint8_t> KDF(ByteView input);
     // Overload for KDF with key (needed for RES*, K_RAN)
-    std::vector<uint8_t> KDF(const std::vector<uint8_t>& key, const std::vector<uint8_t>& data);
+    std::vector<uint8_t> KDF(ByteView key, ByteView data);
 
     // SUCI Encryption/Decryption
-    std::vector<uint8_t> EMSK(const std::vector<uint8_t>& input); // Encrypt SUPI||SQN
-    std::vector<uint8_t> DMSK(const std::vector<uint8_t>& input); // Decrypt C2
+    std::vector<uint8_t> EMSK(ByteView input); // Encrypt SUPI||SQN
+    std::vector<uint8_t> DMSK(ByteView input); // Decrypt C2
 
     // MAC Functions (using long-term key K)
-    std::vector<uint8_t> f1K(const std::string& key, const std::vector<uint8_t>& input); // MAC calculation
-    std::vector<uint8_t> f1_star_K(const std::string& key, const std::vector<uint8_t>& input); // MACS calculation
+    std::vector<uint8_t> f1K(std::string_view key, ByteView input); // MAC calculation
+    std::vector<uint8_t> f1_star_K(std::string_view key, ByteView input); // MACS calculation
 
     // Key Generation Functions (using long-term key K)
-    std::vector<uint8_t> f2K(const std::string& key, const std::vector<uint8_t>& input); // RES generation
-    std::vector<uint8_t> f3K(const std::string& key, const std::vector<uint8_t>& input); // CK generation
-    std::vector<uint8_t> f4K(const std::string& key, const std::vector<uint8_t>& input); // IK generation
+    std::vector<uint8_t> f2K(std::string_view key, ByteView input); // RES generation
+    std::vector<uint8_t> f3K(std::string_view key, ByteView input); // CK generation
+    std::vector<uint8_t> f4K(std::string_view key, ByteView input); // IK generation
 
     // --- New Functions for UAV Protocol ---
 
     // Symmetric Encryption/Decryption (Placeholder using simple XOR)
-    std::vector<uint8_t> EncryptSymmetric(const std::vector<uint8_t>& key, const std::vector<uint8_t>& data);
-    std::vector<uint8_t> DecryptSymmetric(const std::vector<uint8_t>& key, const std::vector<uint8_t>& ciphertext);
-
-    // Temporary Identity Generation (Placeholder)
-    std::string GenerateTID(const std::string& prefix);
+    std::vector<uint8_t> EncryptSymmetric(ByteView key, ByteView data);
+    std::vector<uint8_t> DecryptSymmetric(ByteView key, ByteView ciphertext);
+
+    // Inter-gNB (Xn) handover; derived by the UE and by the gNB that issued TGKi
+    std::vector<uint8_t> XnRequestMAC(ByteView tgk_i, const TID& tid_i, uint32_t targetGnbId); // KDF(TGKi, "XN" || TIDi || gNB ID)
+    std::vector<uint8_t> XnNextHopKey(ByteView tgk_i, const TID& tid_i, uint32_t targetGnbId); // KDF(TGKi, "NH" || gNB ID || TIDi)
+
+    // Fast re-authentication; derived by the UE and by the gNB caching KRANi
+    std::vector<uint8_t> ResumeRequestMAC(ByteView kran_i, const TID& tid_i, uint64_t counter); // KDF(KRANi, "RS" || TIDi || counter)
+    std::vector<uint8_t> ResumeKRAN(ByteView kran_i, const TID& tid_i, uint64_t counter); // KDF(KRANi, "RK" || counter || TIDi), the next KRANi
+
+    // --- Arena Variants (temporaries that die with the auth transaction) ---
+    ArenaBytes KDF(ByteView input, std::pmr::memory_resource* arena);
+    ArenaBytes KDF(ByteView key, ByteView data, std::pmr::memory_resource* arena);
+    ArenaBytes DMSK(ByteView input, std::pmr::memory_resource* arena);
+    ArenaBytes EMSK(ByteView input, std::pmr::memory_resource* arena);
+    ArenaBytes f1K(std::string_view key, ByteView input, std::pmr::memory_resource* arena);
+    ArenaBytes f1_star_K(std::string_view key, ByteView input, std::pmr::memory_resource* arena);
+    ArenaBytes f2K(std::string_view key, ByteView input, std::pmr::memory_resource* arena);
+    ArenaBytes f3K(std::string_view key, ByteView input, std::pmr::memory_resource* arena);
+    ArenaBytes f4K(std::string_view key, ByteView input, std::pmr::memory_resource* arena);
+    ArenaBytes DecryptSymmetric(ByteView key, ByteView ciphertext, std::pmr::memory_resource* arena);
+    ArenaBytes ConcatBytes(std::initializer_list<ByteView> parts, std::pmr::memory_resource* arena);
+    ArenaBytes StringToBytes(std::string_view str, std::pmr::memory_resource* arena);
+    ArenaBytes TimestampToBytes(const Timestamp& t, std::pmr::memory_resource* arena);
+
+    // Temporary identity for entity `ownerId`. Serials are handed out in
+    // per-thread blocks of a shared atomic counter: no lock, no allocation,
+    // unique across threads.
+    TID GenerateTID(TIDKind kind, uint32_t ownerId);
 
     // Timestamp Generation and Validation (Placeholder)
     Timestamp GenerateTST(int validity_seconds);
@@ -88,14 +206,16 @@ namespace Kyber {
 
     // --- Helper Functions ---
     std::vector<uint8_t> U64ToBytes(uint64_t val);
-    uint64_t BytesToU64(const std::vector<uint8_t>& bytes);
+    uint64_t BytesToU64(ByteView bytes);
     std::vector<uint8_t> ConcatBytes(const std::vector<std::vector<uint8_t>>& vecs);
     std::vector<uint8_t> PolyToBytes(const Polynomial& p);
     Polynomial BytesToPoly(const std::vector<uint8_t>& bytes, size_t expected_size);
     std::vector<uint8_t> StringToBytes(const std::string& str);
-    std::string BytesToString(const std::vector<uint8_t>& bytes);
+    std::string BytesToString(ByteView bytes);
     std::vector<uint8_t> TimestampToBytes(const Timestamp& t);
-    Timestamp BytesToTimestamp(const std::vector<uint8_t>& bytes);
+    Timestamp BytesToTimestamp(ByteView bytes);
+    bool BytesEqual(ByteView a, ByteView b);
+    inline std::vector<uint8_t> ToVector(ByteView bytes) { return std::vector<uint8_t>(bytes.begin(), bytes.end()); }
 
 } // namespace Kyber
 
@@ -0,0 +1,83 @@
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#if defined(__linux__) || defined(__APPLE__)
+#define KYBERSIM_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+#ifdef KYBERSIM_MMAP
+    if (m_Mapped) {
+        munmap(const_cast<char*>(m_Data), m_Size);
+    }
+#endif
+}
+
+std::shared_ptr<const MappedFile> MappedFile::Open(const std::string& path)
+{
+    std::shared_ptr<MappedFile> file(new MappedFile());
+#ifdef KYBERSIM_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "MappedFile: Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return nullptr;
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        std::cerr << "MappedFile: Cannot size " << path << std::endl;
+        ::close(fd);
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "MappedFile: mmap of " << path << " failed: " << std::strerror(errno) << std::endl;
+        return nullptr;
+    }
+    // Loaders read front to back
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    file->m_Data = static_cast<const char*>(mapping);
+    file->m_Size = size;
+    file->m_Mapped = true;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        std::cerr << "MappedFile: Cannot open " << path << std::endl;
+        return nullptr;
+    }
+    file->m_Buffer.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    if (!in.read(file->m_Buffer.data(), static_cast<std::streamsize>(file->m_Buffer.size()))) {
+        std::cerr << "MappedFile: Cannot read " << path << std::endl;
+        return nullptr;
+    }
+    file->m_Data = file->m_Buffer.data();
+    file->m_Size = file->m_Buffer.size();
+#endif
+    return file;
+}
+
+void MappedFile::Prefetch(size_t offset, size_t length) const
+{
+#ifdef KYBERSIM_MMAP
+    if (!m_Mapped || offset >= m_Size) return;
+    length = std::min(length, m_Size - offset);
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin = offset / page * page;
+    madvise(const_cast<char*>(m_Data) + begin, offset + length - begin, MADV_WILLNEED);
+#else
+    (void)offset;
+    (void)length;
+#endif
+}
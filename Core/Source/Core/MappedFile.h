@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. Memory-mapped where the platform allows
+// it, read into one buffer otherwise. Share it through shared_ptr so views
+// into the data (e.g. a SubscriberTable) can keep it alive.
+class MappedFile {
+public:
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Reports to std::cerr and returns null on error
+    static std::shared_ptr<const MappedFile> Open(const std::string& path);
+
+    inline const char* Data() const { return m_Data; }
+    inline size_t Size() const { return m_Size; }
+    inline std::span<const char> Bytes() const { return { m_Data, m_Size }; }
+
+    // Hint that [offset, offset + length) will be read soon so the kernel
+    // starts paging it in; a no-op without mmap
+    void Prefetch(size_t offset, size_t length) const;
+
+private:
+    MappedFile() = default;
+
+    const char* m_Data = nullptr;
+    size_t m_Size = 0;
+    bool m_Mapped = false;      // m_Data is an mmap, not m_Buffer
+    std::vector<char> m_Buffer; // Fallback when mmap is unavailable
+};
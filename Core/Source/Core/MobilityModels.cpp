@@ -0,0 +1,234 @@
+#include "MobilityModels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numbers>
+
+namespace {
+
+    Position Round(double x, double y)
+    {
+        return { static_cast<uint32_t>(std::lround(std::max(x, 0.0))), static_cast<uint32_t>(std::lround(std::max(y, 0.0))) };
+    }
+
+    // Reflect `value` back into [low, high]; true if it crossed an edge
+    bool Reflect(double& value, double low, double high)
+    {
+        if (value < low) {
+            value = std::min(2 * low - value, high);
+            return true;
+        }
+        if (value > high) {
+            value = std::max(2 * high - value, low);
+            return true;
+        }
+        return false;
+    }
+
+} // namespace
+
+// --- RandomWaypointModel ---
+
+RandomWaypointModel::RandomWaypointModel(const Params& params)
+    : m_Params(params), m_Rng(params.seed)
+{
+}
+
+void RandomWaypointModel::PickWaypoint(State& state)
+{
+    std::uniform_real_distribution<double> x(m_Params.area.minX, m_Params.area.maxX);
+    std::uniform_real_distribution<double> y(m_Params.area.minY, m_Params.area.maxY);
+    // A zero speed would never reach its waypoint
+    double minSpeed = std::max(m_Params.minSpeed, 1e-3);
+    std::uniform_real_distribution<double> speed(minSpeed, std::max(minSpeed, m_Params.maxSpeed));
+    state.targetX = x(m_Rng);
+    state.targetY = y(m_Rng);
+    state.speed = speed(m_Rng);
+}
+
+void RandomWaypointModel::Initialize(std::span<Position> positions)
+{
+    std::uniform_real_distribution<double> x(m_Params.area.minX, m_Params.area.maxX);
+    std::uniform_real_distribution<double> y(m_Params.area.minY, m_Params.area.maxY);
+    m_States.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        State& state = m_States[i];
+        state.x = x(m_Rng);
+        state.y = y(m_Rng);
+        state.pause = 0.0;
+        PickWaypoint(state);
+        positions[i] = Round(state.x, state.y);
+    }
+}
+
+void RandomWaypointModel::Step(double dt, std::span<Position> positions)
+{
+    std::uniform_real_distribution<double> pause(0.0, m_Params.maxPause);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        State& state = m_States[i];
+        double left = dt;
+        while (left > 0.0) {
+            if (state.pause > 0.0) {
+                double wait = std::min(state.pause, left);
+                state.pause -= wait;
+                left -= wait;
+                continue;
+            }
+            double dx = state.targetX - state.x;
+            double dy = state.targetY - state.y;
+            double distance = std::hypot(dx, dy);
+            double reach = state.speed * left;
+            if (reach < distance) {
+                state.x += dx / distance * reach;
+                state.y += dy / distance * reach;
+                break;
+            }
+            state.x = state.targetX;
+            state.y = state.targetY;
+            left -= distance / state.speed;
+            state.pause = pause(m_Rng);
+            PickWaypoint(state);
+        }
+        positions[i] = Round(state.x, state.y);
+    }
+}
+
+// --- GaussMarkovModel ---
+
+GaussMarkovModel::GaussMarkovModel(const Params& params)
+    : m_Params(params), m_Rng(params.seed)
+{
+}
+
+void GaussMarkovModel::Initialize(std::span<Position> positions)
+{
+    std::uniform_real_distribution<double> x(m_Params.area.minX, m_Params.area.maxX);
+    std::uniform_real_distribution<double> y(m_Params.area.minY, m_Params.area.maxY);
+    std::uniform_real_distribution<double> heading(0.0, 2 * std::numbers::pi);
+    m_States.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        State& state = m_States[i];
+        state.x = x(m_Rng);
+        state.y = y(m_Rng);
+        state.speed = m_Params.meanSpeed;
+        state.heading = state.meanHeading = heading(m_Rng);
+        positions[i] = Round(state.x, state.y);
+    }
+}
+
+void GaussMarkovModel::Step(double dt, std::span<Position> positions)
+{
+    const MobilityArea& area = m_Params.area;
+    m_SinceUpdate += dt;
+    bool update = m_SinceUpdate >= m_Params.updateInterval;
+    if (update) m_SinceUpdate = 0.0;
+
+    const double alpha = m_Params.alpha;
+    const double noise = std::sqrt(1.0 - alpha * alpha);
+    std::normal_distribution<double> gauss(0.0, 1.0);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        State& state = m_States[i];
+        if (update) {
+            state.speed = alpha * state.speed + (1 - alpha) * m_Params.meanSpeed + noise * m_Params.speedStdDev * gauss(m_Rng);
+            state.speed = std::max(state.speed, 0.0);
+            state.heading = alpha * state.heading + (1 - alpha) * state.meanHeading + noise * m_Params.headingStdDev * gauss(m_Rng);
+        }
+        state.x += state.speed * std::cos(state.heading) * dt;
+        state.y += state.speed * std::sin(state.heading) * dt;
+
+        // Bounce: mirror the heading (and its mean, or the process pulls the
+        // entity straight back into the wall)
+        if (Reflect(state.x, area.minX, area.maxX)) {
+            state.heading = std::numbers::pi - state.heading;
+            state.meanHeading = std::numbers::pi - state.meanHeading;
+        }
+        if (Reflect(state.y, area.minY, area.maxY)) {
+            state.heading = -state.heading;
+            state.meanHeading = -state.meanHeading;
+        }
+        positions[i] = Round(state.x, state.y);
+    }
+}
+
+// --- FlightPlanModel ---
+
+FlightPlanModel::FlightPlanModel(const Params& params)
+    : m_Params(params)
+{
+}
+
+void FlightPlanModel::Initialize(std::span<Position> positions)
+{
+    const MobilityArea& area = m_Params.area;
+    const double stripWidth = positions.empty() ? 0.0 : (area.maxX - area.minX) / positions.size();
+    const double spacing = std::max(m_Params.laneSpacing, 1.0);
+    m_Plans.assign(positions.size(), Plan{});
+    for (size_t i = 0; i < positions.size(); ++i) {
+        Plan& plan = m_Plans[i];
+        double left = area.minX + stripWidth * i;
+        double right = left + stripWidth;
+        // Horizontal passes across the strip, stepping up by the lane spacing
+        bool eastbound = true;
+        for (double y = area.minY; y <= area.maxY; y += spacing) {
+            plan.waypoints.push_back({ eastbound ? left : right, y });
+            plan.waypoints.push_back({ eastbound ? right : left, y });
+            eastbound = !eastbound;
+        }
+        if (plan.waypoints.empty()) plan.waypoints.push_back({ left, area.minY });
+        plan.x = plan.waypoints.front().first;
+        plan.y = plan.waypoints.front().second;
+        plan.next = plan.waypoints.size() > 1 ? 1 : 0;
+        positions[i] = Round(plan.x, plan.y);
+    }
+}
+
+void FlightPlanModel::Step(double dt, std::span<Position> positions)
+{
+    for (size_t i = 0; i < positions.size(); ++i) {
+        Plan& plan = m_Plans[i];
+        double reach = m_Params.cruiseSpeed * dt;
+        while (reach > 0.0 && plan.waypoints.size() > 1) {
+            auto [targetX, targetY] = plan.waypoints[plan.next];
+            double dx = targetX - plan.x;
+            double dy = targetY - plan.y;
+            double distance = std::hypot(dx, dy);
+            if (reach < distance) {
+                plan.x += dx / distance * reach;
+                plan.y += dy / distance * reach;
+                break;
+            }
+            plan.x = targetX;
+            plan.y = targetY;
+            reach -= distance;
+            // Turn around at either end of the sweep
+            if (plan.next + 1 == plan.waypoints.size()) plan.direction = -1;
+            else if (plan.next == 0) plan.direction = 1;
+            plan.next += plan.direction;
+        }
+        positions[i] = Round(plan.x, plan.y);
+    }
+}
+
+// --- Trace generation ---
+
+bool WriteMobilityTrace(MobilityModel& model, const TraceGeneration& generation, const std::string& path)
+{
+    std::vector<uint32_t> ids(generation.count);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        ids[i] = generation.firstId + static_cast<uint32_t>(i);
+    }
+    MobilityTraceWriter writer(path, generation.kind, ids, generation.tickSeconds, generation.keyframeInterval);
+    if (!writer.IsOpen()) return false;
+
+    std::vector<Position> positions(generation.count);
+    for (uint64_t tick = 0; tick < generation.ticks; ++tick) {
+        if (tick == 0) model.Initialize(positions);
+        else model.Step(generation.tickSeconds, positions);
+        if (!writer.WriteFrame(positions)) return false;
+    }
+    if (!writer.Finish()) return false;
+    std::cout << "MobilityTrace: Wrote " << generation.ticks << " ticks of " << generation.count
+              << " entities to " << path << std::endl;
+    return true;
+}
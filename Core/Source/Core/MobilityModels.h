@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Entity.h"
+#include "MobilityTrace.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+// Rectangle entities move in; models keep everyone inside it
+struct MobilityArea {
+    double minX = 0.0, minY = 0.0;
+    double maxX = 1000.0, maxY = 1000.0;
+};
+
+// Synthetic trajectory generator for MobilityTraceWriter. Models keep their
+// own floating-point state and report rounded positions once per tick.
+class MobilityModel {
+public:
+    virtual ~MobilityModel() = default;
+
+    // Place `count` entities; fills the tick 0 positions
+    virtual void Initialize(std::span<Position> positions) = 0;
+
+    // Advance everyone by `dt` seconds
+    virtual void Step(double dt, std::span<Position> positions) = 0;
+};
+
+// Random waypoint: pick a uniform destination and speed, travel there in a
+// straight line, pause, repeat
+class RandomWaypointModel : public MobilityModel {
+public:
+    struct Params {
+        MobilityArea area;
+        double minSpeed = 1.0; // Units per second
+        double maxSpeed = 20.0;
+        double maxPause = 5.0; // Seconds, uniform in [0, maxPause]
+        uint64_t seed = 1;
+    };
+
+    explicit RandomWaypointModel(const Params& params);
+    void Initialize(std::span<Position> positions) override;
+    void Step(double dt, std::span<Position> positions) override;
+
+private:
+    struct State {
+        double x, y;
+        double targetX, targetY;
+        double speed;
+        double pause;
+    };
+    void PickWaypoint(State& state);
+
+    Params m_Params;
+    std::mt19937_64 m_Rng;
+    std::vector<State> m_States;
+};
+
+// Gauss-Markov: speed and heading are first-order autoregressive processes
+// around their means with memory `alpha` (0 = random walk, 1 = straight
+// line). Entities bounce off the area edges.
+class GaussMarkovModel : public MobilityModel {
+public:
+    struct Params {
+        MobilityArea area;
+        double meanSpeed = 10.0;
+        double speedStdDev = 3.0;
+        double headingStdDev = 0.5; // Radians
+        double alpha = 0.85;
+        double updateInterval = 1.0; // Seconds between AR steps
+        uint64_t seed = 1;
+    };
+
+    explicit GaussMarkovModel(const Params& params);
+    void Initialize(std::span<Position> positions) override;
+    void Step(double dt, std::span<Position> positions) override;
+
+private:
+    struct State {
+        double x, y;
+        double speed;
+        double heading;
+        double meanHeading;
+    };
+
+    Params m_Params;
+    std::mt19937_64 m_Rng;
+    std::vector<State> m_States;
+    double m_SinceUpdate = 0.0;
+};
+
+// UAV flight plans: the area is split into one vertical strip per UAV and
+// each UAV flies a lawnmower sweep of its strip at cruise speed, then
+// returns along the same path and repeats
+class FlightPlanModel : public MobilityModel {
+public:
+    struct Params {
+        MobilityArea area;
+        double cruiseSpeed = 15.0;
+        double laneSpacing = 50.0;
+    };
+
+    explicit FlightPlanModel(const Params& params);
+    void Initialize(std::span<Position> positions) override;
+    void Step(double dt, std::span<Position> positions) override;
+
+private:
+    struct Plan {
+        std::vector<std::pair<double, double>> waypoints;
+        size_t next = 1;
+        int direction = 1; // Walking the waypoint list forwards or back
+        double x, y;
+    };
+
+    Params m_Params;
+    std::vector<Plan> m_Plans;
+};
+
+// Parameters of WriteMobilityTrace
+struct TraceGeneration {
+    MobilityTraceFormat::EntityKind kind = MobilityTraceFormat::EntityKind::UE;
+    uint32_t firstId = 0;       // Entities get IDs firstId, firstId + 1, ...
+    size_t count = 0;
+    uint64_t ticks = 0;
+    double tickSeconds = 1.0;
+    uint32_t keyframeInterval = 600;
+};
+
+// Run `model` for `generation.ticks` ticks and stream the frames to `path`
+bool WriteMobilityTrace(MobilityModel& model, const TraceGeneration& generation, const std::string& path);
@@ -0,0 +1,226 @@
+#include "MobilityTrace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+using namespace MobilityTraceFormat;
+
+namespace {
+
+    constexpr size_t PrefetchBytes = size_t(8) << 20;
+
+    uint64_t AlignUp(uint64_t offset, uint64_t alignment) { return (offset + alignment - 1) & ~(alignment - 1); }
+
+    void PutVarint(std::vector<uint8_t>& out, uint32_t delta)
+    {
+        // Zigzag so small moves in either direction stay small
+        int32_t signedDelta = static_cast<int32_t>(delta);
+        uint32_t value = (static_cast<uint32_t>(signedDelta) << 1) ^ static_cast<uint32_t>(signedDelta >> 31);
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    bool GetVarint(const uint8_t*& cursor, const uint8_t* end, uint32_t& delta)
+    {
+        uint32_t value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (cursor == end) return false;
+            uint8_t byte = *cursor++;
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                delta = (value >> 1) ^ (0u - (value & 1));
+                return true;
+            }
+        }
+        return false;
+    }
+
+} // namespace
+
+// --- Writing ---
+
+MobilityTraceWriter::MobilityTraceWriter(const std::string& path, EntityKind kind, std::span<const uint32_t> ids,
+    double tickSeconds, uint32_t keyframeInterval)
+    : m_Out(path, std::ios::binary | std::ios::trunc), m_Path(path), m_Previous(ids.size())
+{
+    if (!m_Out) {
+        std::cerr << "MobilityTraceWriter: Cannot open " << path << std::endl;
+        return;
+    }
+    std::memcpy(m_Header.magic, Magic, sizeof(Magic));
+    m_Header.majorVersion = MajorVersion;
+    m_Header.minorVersion = MinorVersion;
+    m_Header.entityKind = static_cast<uint32_t>(kind);
+    m_Header.keyframeInterval = std::max<uint32_t>(keyframeInterval, 1);
+    m_Header.entityCount = ids.size();
+    m_Header.tickSeconds = tickSeconds;
+    m_Header.idsOffset = AlignUp(sizeof(Header), IDAlignment);
+
+    // Header is rewritten by Finish once the frame count is known
+    m_Out.write(reinterpret_cast<const char*>(&m_Header), sizeof(m_Header));
+    std::vector<char> padding(m_Header.idsOffset - sizeof(Header), '\0');
+    m_Out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    m_Out.write(reinterpret_cast<const char*>(ids.data()), static_cast<std::streamsize>(ids.size_bytes()));
+}
+
+bool MobilityTraceWriter::WriteFrame(std::span<const Position> positions)
+{
+    if (!IsOpen()) return false;
+    if (positions.size() != m_Previous.size()) {
+        std::cerr << "MobilityTraceWriter: Frame has " << positions.size() << " positions, expected "
+                  << m_Previous.size() << std::endl;
+        return false;
+    }
+
+    bool keyframe = m_FrameOffsets.size() % m_Header.keyframeInterval == 0;
+    if (keyframe) std::fill(m_Previous.begin(), m_Previous.end(), Position{ 0, 0 });
+
+    m_Frame.clear();
+    for (size_t i = 0; i < positions.size(); ++i) {
+        PutVarint(m_Frame, positions[i].first - m_Previous[i].first);
+        PutVarint(m_Frame, positions[i].second - m_Previous[i].second);
+        m_Previous[i] = positions[i];
+    }
+    m_FrameOffsets.push_back(static_cast<uint64_t>(m_Out.tellp()));
+    m_Out.write(reinterpret_cast<const char*>(m_Frame.data()), static_cast<std::streamsize>(m_Frame.size()));
+    return m_Out.good();
+}
+
+bool MobilityTraceWriter::Finish()
+{
+    if (!IsOpen()) return false;
+    uint64_t end = static_cast<uint64_t>(m_Out.tellp());
+    m_Header.indexOffset = AlignUp(end, sizeof(uint64_t));
+    std::vector<char> padding(m_Header.indexOffset - end, '\0');
+    m_Out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    m_Out.write(reinterpret_cast<const char*>(m_FrameOffsets.data()),
+        static_cast<std::streamsize>(m_FrameOffsets.size() * sizeof(uint64_t)));
+
+    m_Header.tickCount = m_FrameOffsets.size();
+    m_Header.fileBytes = static_cast<uint64_t>(m_Out.tellp());
+    m_Out.seekp(0);
+    m_Out.write(reinterpret_cast<const char*>(&m_Header), sizeof(m_Header));
+    m_Out.close();
+    if (!m_Out) {
+        std::cerr << "MobilityTraceWriter: Failed writing " << m_Path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- Reading ---
+
+std::unique_ptr<MobilityTrace> MobilityTrace::Open(const std::string& path)
+{
+    std::unique_ptr<MobilityTrace> trace(new MobilityTrace());
+    trace->m_File = MappedFile::Open(path);
+    if (!trace->m_File || !trace->Validate(path)) {
+        return nullptr;
+    }
+    return trace;
+}
+
+bool MobilityTrace::Validate(const std::string& path)
+{
+    auto fail = [&](const char* reason) {
+        std::cerr << "MobilityTrace: " << path << ": " << reason << std::endl;
+        return false;
+    };
+
+    const char* data = m_File->Data();
+    const size_t size = m_File->Size();
+    if (size < sizeof(Header)) return fail("file too short");
+    std::memcpy(&m_Header, data, sizeof(Header));
+    if (std::memcmp(m_Header.magic, Magic, sizeof(Magic)) != 0) return fail("not a mobility trace");
+    if (m_Header.majorVersion != MajorVersion) return fail("unsupported format version");
+    if (m_Header.fileBytes != size) return fail("truncated or padded file");
+    if (m_Header.entityKind > static_cast<uint32_t>(EntityKind::UAV)) return fail("unknown entity kind");
+    if (m_Header.keyframeInterval == 0 || !(m_Header.tickSeconds > 0.0)) return fail("bad tick parameters");
+
+    if (m_Header.idsOffset % IDAlignment != 0 || m_Header.idsOffset > size
+        || m_Header.entityCount > (size - m_Header.idsOffset) / sizeof(uint32_t)) {
+        return fail("ID column out of range");
+    }
+    uint64_t framesBegin = m_Header.idsOffset + m_Header.entityCount * sizeof(uint32_t);
+    if (m_Header.indexOffset < framesBegin || m_Header.indexOffset > size
+        || m_Header.tickCount != (size - m_Header.indexOffset) / sizeof(uint64_t)
+        || (size - m_Header.indexOffset) % sizeof(uint64_t) != 0) {
+        return fail("frame index out of range");
+    }
+    uint64_t previous = framesBegin;
+    for (uint64_t tick = 0; tick < m_Header.tickCount; ++tick) {
+        uint64_t offset = FrameOffset(tick);
+        if (offset < previous || offset > m_Header.indexOffset) return fail("frame index not in order");
+        previous = offset;
+    }
+
+    m_IDs = { reinterpret_cast<const uint32_t*>(data + m_Header.idsOffset), static_cast<size_t>(m_Header.entityCount) };
+    m_Positions.resize(m_IDs.size());
+    m_PrefetchedTo = framesBegin;
+    return true;
+}
+
+uint64_t MobilityTrace::FrameOffset(uint64_t tick) const
+{
+    if (tick >= m_Header.tickCount) return m_Header.indexOffset;
+    uint64_t offset = 0;
+    std::memcpy(&offset, m_File->Data() + m_Header.indexOffset + tick * sizeof(uint64_t), sizeof(offset));
+    return offset;
+}
+
+bool MobilityTrace::DecodeFrame(uint64_t tick)
+{
+    uint64_t begin = FrameOffset(tick);
+    uint64_t end = FrameOffset(tick + 1);
+
+    // Keep the kernel a window (at least two frames) ahead of the cursor so
+    // replay does not stall on page faults; refreshed once half the window
+    // has been consumed
+    uint64_t window = std::max<uint64_t>(PrefetchBytes, 2 * (end - begin));
+    if (end + window / 2 > m_PrefetchedTo) {
+        m_File->Prefetch(static_cast<size_t>(begin), static_cast<size_t>(window));
+        m_PrefetchedTo = begin + window;
+    }
+
+    if (tick % m_Header.keyframeInterval == 0) {
+        std::fill(m_Positions.begin(), m_Positions.end(), Position{ 0, 0 });
+    }
+    const uint8_t* cursor = reinterpret_cast<const uint8_t*>(m_File->Data() + begin);
+    const uint8_t* limit = reinterpret_cast<const uint8_t*>(m_File->Data() + end);
+    for (Position& position : m_Positions) {
+        uint32_t dx = 0, dy = 0;
+        if (!GetVarint(cursor, limit, dx) || !GetVarint(cursor, limit, dy)) {
+            std::cerr << "MobilityTrace: Frame " << tick << " is corrupt" << std::endl;
+            return false;
+        }
+        position.first += dx;
+        position.second += dy;
+    }
+    m_Tick = static_cast<int64_t>(tick);
+    return true;
+}
+
+bool MobilityTrace::Advance()
+{
+    uint64_t next = static_cast<uint64_t>(m_Tick + 1);
+    if (next >= m_Header.tickCount) return false;
+    return DecodeFrame(next);
+}
+
+bool MobilityTrace::Seek(uint64_t tick)
+{
+    if (tick >= m_Header.tickCount) return false;
+    m_PrefetchedTo = 0;
+    uint64_t first = tick / m_Header.keyframeInterval * m_Header.keyframeInterval;
+    if (m_Tick >= 0 && static_cast<uint64_t>(m_Tick) <= tick && static_cast<uint64_t>(m_Tick) >= first) {
+        first = static_cast<uint64_t>(m_Tick) + 1;
+    }
+    for (uint64_t t = first; t <= tick; ++t) {
+        if (!DecodeFrame(t)) return false;
+    }
+    return true;
+}
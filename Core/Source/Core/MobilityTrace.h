@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Entity.h"
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Binary mobility trace (.ktrc): per-tick positions of a fixed set of UEs or
+// UAVs, replayed into the World by World::attachMobilityTrace.
+//
+// Layout, all little-endian:
+//   [Header][u32 entity IDs][frame 0][frame 1]...[u64 frame offsets]
+// A frame holds two zigzag varints per entity, in ID-column order: the x and
+// y change since the previous frame, modulo 2^32. Every keyframeInterval-th
+// frame is coded against (0, 0) instead, i.e. absolute, so a reader can seek
+// without decoding from the start. Slow movers cost one or two bytes per
+// axis per tick.
+namespace MobilityTraceFormat {
+    constexpr char Magic[8] = { 'K', 'S', 'I', 'M', 'T', 'R', 'C', 'E' };
+    constexpr uint16_t MajorVersion = 1;
+    constexpr uint16_t MinorVersion = 0;
+    constexpr size_t IDAlignment = 64;
+
+    enum class EntityKind : uint32_t { UE, UAV };
+
+    struct Header {
+        char magic[8];
+        uint16_t majorVersion;
+        uint16_t minorVersion;
+        uint32_t entityKind;       // EntityKind value
+        uint32_t keyframeInterval; // Frames; frame 0 is always a keyframe
+        uint32_t reserved;
+        uint64_t entityCount;
+        uint64_t tickCount;
+        double tickSeconds;
+        uint64_t idsOffset;
+        uint64_t indexOffset;      // u64 x tickCount frame offsets
+        uint64_t fileBytes;
+    };
+    static_assert(sizeof(Header) == 72, "Mobility trace header layout changed");
+}
+
+// Streams a trace to disk one frame at a time, so generating hours of
+// movement for millions of entities needs memory for a single frame only.
+class MobilityTraceWriter {
+public:
+    using EntityKind = MobilityTraceFormat::EntityKind;
+
+    MobilityTraceWriter(const std::string& path, EntityKind kind, std::span<const uint32_t> ids,
+        double tickSeconds, uint32_t keyframeInterval = 600);
+
+    inline bool IsOpen() const { return m_Out.is_open() && m_Out.good(); }
+
+    // Positions of every entity at the next tick, in ID order
+    bool WriteFrame(std::span<const Position> positions);
+
+    // Append the frame index and patch the header
+    bool Finish();
+
+private:
+    std::ofstream m_Out;
+    std::string m_Path;
+    MobilityTraceFormat::Header m_Header{};
+    std::vector<Position> m_Previous;
+    std::vector<uint64_t> m_FrameOffsets;
+    std::vector<uint8_t> m_Frame;
+};
+
+// Sequential reader over a mapped trace. Only the current frame's positions
+// are decoded into memory; frame bytes are read straight from the mapping,
+// with the next few megabytes prefetched ahead of the cursor.
+class MobilityTrace {
+public:
+    using EntityKind = MobilityTraceFormat::EntityKind;
+
+    // Map and validate `path`; reports to std::cerr and returns null on error
+    static std::unique_ptr<MobilityTrace> Open(const std::string& path);
+
+    inline EntityKind GetKind() const { return static_cast<EntityKind>(m_Header.entityKind); }
+    inline size_t GetEntityCount() const { return static_cast<size_t>(m_Header.entityCount); }
+    inline uint64_t GetTickCount() const { return m_Header.tickCount; }
+    inline double GetTickSeconds() const { return m_Header.tickSeconds; }
+    inline std::span<const uint32_t> GetIDs() const { return m_IDs; }
+
+    // Index of the frame in Positions(), or -1 before the first Advance
+    inline int64_t GetTick() const { return m_Tick; }
+    inline std::span<const Position> Positions() const { return m_Positions; }
+
+    // Decode the next frame; false at the end of the trace or on a corrupt frame
+    bool Advance();
+
+    // Position the reader on frame `tick`, decoding from the keyframe before it
+    bool Seek(uint64_t tick);
+
+private:
+    MobilityTrace() = default;
+    bool Validate(const std::string& path);
+    bool DecodeFrame(uint64_t tick);
+    uint64_t FrameOffset(uint64_t tick) const;
+
+    std::shared_ptr<const MappedFile> m_File;
+    MobilityTraceFormat::Header m_Header{};
+    std::span<const uint32_t> m_IDs;
+    std::vector<Position> m_Positions;
+    int64_t m_Tick = -1;
+    uint64_t m_PrefetchedTo = 0; // File offset the read-ahead hint covers
+};
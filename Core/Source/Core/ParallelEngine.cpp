@@ -0,0 +1,168 @@
+#include "ParallelEngine.h"
+
+#include <algorithm>
+#include <barrier>
+#include <stdexcept>
+#include <thread>
+
+// --- EventInbox ---
+
+EventInbox::~EventInbox()
+{
+    Drain([](SimEvent&&) {});
+}
+
+void EventInbox::Push(SimEvent event)
+{
+    Node* node = new Node{ std::move(event), m_Head.load(std::memory_order_relaxed) };
+    while (!m_Head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+}
+
+// --- LogicalProcess ---
+
+void LogicalProcess::Schedule(SimTime delay, SimAction action)
+{
+    if (!(delay >= 0.0)) {
+        throw std::invalid_argument("LogicalProcess: negative event delay");
+    }
+    m_Events.push(SimEvent{ m_Now + delay, m_Id, m_NextSeq++, std::move(action) });
+}
+
+void LogicalProcess::Send(uint32_t target, SimTime delay, SimAction action)
+{
+    if (target == m_Id) {
+        Schedule(delay, std::move(action));
+        return;
+    }
+    if (target >= m_Engine.GetProcessCount()) {
+        throw std::out_of_range("LogicalProcess: unknown target process");
+    }
+    if (delay < m_Engine.GetLookahead()) {
+        throw std::invalid_argument("LogicalProcess: cross-process delay below lookahead");
+    }
+    m_Sent++;
+    m_Engine.GetProcess(target).m_Inbox.Push(SimEvent{ m_Now + delay, m_Id, m_NextSeq++, std::move(action) });
+}
+
+void LogicalProcess::RunUntil(SimTime end)
+{
+    while (!m_Events.empty() && m_Events.top().time < end) {
+        SimEvent event = std::move(const_cast<SimEvent&>(m_Events.top()));
+        m_Events.pop();
+        m_Now = event.time;
+        event.action(*this);
+        m_Processed++;
+    }
+}
+
+void LogicalProcess::AbsorbInbox()
+{
+    m_Inbox.Drain([this](SimEvent&& event) { m_Events.push(std::move(event)); });
+}
+
+// --- ParallelEngine ---
+
+ParallelEngine::ParallelEngine(SimTime lookahead, size_t threads)
+    : m_Lookahead(lookahead), m_Threads(std::max<size_t>(threads, 1))
+{
+    if (!(lookahead > 0.0)) {
+        throw std::invalid_argument("ParallelEngine: lookahead must be positive");
+    }
+}
+
+LogicalProcess& ParallelEngine::AddProcess()
+{
+    uint32_t id = static_cast<uint32_t>(m_Processes.size());
+    m_Processes.push_back(std::make_unique<LogicalProcess>(*this, id));
+    return *m_Processes.back();
+}
+
+bool ParallelEngine::PrepareWindow(SimTime endTime)
+{
+    SimTime earliest = SimTimeNever;
+    for (auto& process : m_Processes) {
+        process->AbsorbInbox();
+        earliest = std::min(earliest, process->NextEventTime());
+    }
+    if (earliest >= endTime) {
+        return false;
+    }
+    m_WindowEnd = std::min(earliest + m_Lookahead, endTime);
+    m_Windows++;
+
+    m_Runnable.clear();
+    for (auto& process : m_Processes) {
+        if (process->NextEventTime() < m_WindowEnd) m_Runnable.push_back(process->GetID());
+    }
+
+    // Deal contiguous slices; stealing evens out uneven cells
+    size_t count = m_Runnable.size();
+    size_t begin = 0;
+    for (size_t w = 0; w < m_Threads; ++w) {
+        size_t share = count / m_Threads + (w < count % m_Threads ? 1 : 0);
+        m_Ranges[w].next.store(begin, std::memory_order_relaxed);
+        m_Ranges[w].end = begin + share;
+        begin += share;
+    }
+    return true;
+}
+
+void ParallelEngine::RunWindow(size_t worker)
+{
+    for (size_t i = 0; i < m_Threads; ++i) {
+        size_t victim = (worker + i) % m_Threads;
+        WorkRange& range = m_Ranges[victim];
+        for (;;) {
+            size_t slot = range.next.fetch_add(1, std::memory_order_relaxed);
+            if (slot >= range.end) break;
+            if (victim != worker) m_Steals.fetch_add(1, std::memory_order_relaxed);
+            m_Processes[m_Runnable[slot]]->RunUntil(m_WindowEnd);
+        }
+    }
+}
+
+ParallelEngine::Stats ParallelEngine::Run(SimTime endTime)
+{
+    uint64_t eventsBefore = 0, sentBefore = 0;
+    for (auto& process : m_Processes) {
+        eventsBefore += process->m_Processed;
+        sentBefore += process->m_Sent;
+    }
+    uint64_t windowsBefore = m_Windows;
+    m_Steals.store(0, std::memory_order_relaxed);
+    m_Ranges = std::make_unique<WorkRange[]>(m_Threads);
+
+    bool done = false;
+    std::barrier sync(static_cast<std::ptrdiff_t>(m_Threads));
+    auto work = [&](size_t worker) {
+        for (;;) {
+            if (worker == 0) done = !PrepareWindow(endTime);
+            sync.arrive_and_wait();
+            if (done) return;
+            RunWindow(worker);
+            sync.arrive_and_wait();
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    helpers.reserve(m_Threads - 1);
+    for (size_t w = 1; w < m_Threads; ++w) {
+        helpers.emplace_back(work, w);
+    }
+    work(0);
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+
+    Stats stats;
+    for (auto& process : m_Processes) {
+        stats.events += process->m_Processed;
+        stats.crossMessages += process->m_Sent;
+    }
+    stats.events -= eventsBefore;
+    stats.crossMessages -= sentBefore;
+    stats.windows = m_Windows - windowsBefore;
+    stats.steals = m_Steals.load(std::memory_order_relaxed);
+    stats.endTime = endTime;
+    return stats;
+}
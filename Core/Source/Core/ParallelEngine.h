@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <vector>
+
+// Simulation time in seconds
+using SimTime = double;
+
+constexpr SimTime SimTimeNever = std::numeric_limits<SimTime>::infinity();
+
+class LogicalProcess;
+
+using SimAction = std::function<void(LogicalProcess&)>;
+
+// Timestamped event. (time, source, seq) is unique and totally ordered, so
+// the processing order inside a logical process does not depend on which
+// thread produced an event or when it arrived.
+struct SimEvent {
+    SimTime time = 0.0;
+    uint32_t source = 0; // Sending logical process
+    uint64_t seq = 0;    // Per-source counter
+    SimAction action;
+};
+
+struct SimEventLater {
+    bool operator()(const SimEvent& a, const SimEvent& b) const
+    {
+        if (a.time != b.time) return a.time > b.time;
+        if (a.source != b.source) return a.source > b.source;
+        return a.seq > b.seq;
+    }
+};
+
+// Lock-free multi-producer inbox (Treiber stack). Senders push with one
+// CAS; the owning process takes the whole list at a window boundary.
+class EventInbox {
+public:
+    EventInbox() = default;
+    ~EventInbox();
+
+    EventInbox(const EventInbox&) = delete;
+    EventInbox& operator=(const EventInbox&) = delete;
+
+    void Push(SimEvent event);
+
+    // Hand every queued event to `sink`, in no particular order
+    template<typename Sink>
+    void Drain(Sink&& sink)
+    {
+        Node* node = m_Head.exchange(nullptr, std::memory_order_acquire);
+        while (node) {
+            Node* next = node->next;
+            sink(std::move(node->event));
+            delete node;
+            node = next;
+        }
+    }
+
+private:
+    struct Node {
+        SimEvent event;
+        Node* next;
+    };
+    std::atomic<Node*> m_Head{ nullptr };
+};
+
+class ParallelEngine;
+
+// One partition of the model with its own clock and event list. Only the
+// thread currently running the process touches it; other processes reach
+// it solely through Send().
+class LogicalProcess {
+public:
+    LogicalProcess(ParallelEngine& engine, uint32_t id) : m_Engine(engine), m_Id(id) {}
+
+    inline uint32_t GetID() const { return m_Id; }
+    inline SimTime Now() const { return m_Now; }
+    inline uint64_t GetProcessedCount() const { return m_Processed; }
+
+    // Local event `delay` (>= 0) seconds from now
+    void Schedule(SimTime delay, SimAction action);
+
+    // Event for another process; `delay` must be at least the engine's
+    // lookahead so the receiver can never be handed an event in its past
+    void Send(uint32_t target, SimTime delay, SimAction action);
+
+private:
+    friend class ParallelEngine;
+
+    // Run every event with time < end
+    void RunUntil(SimTime end);
+    // Move delivered cross-process events into the event list
+    void AbsorbInbox();
+    SimTime NextEventTime() const { return m_Events.empty() ? SimTimeNever : m_Events.top().time; }
+
+    ParallelEngine& m_Engine;
+    uint32_t m_Id;
+    SimTime m_Now = 0.0;
+    uint64_t m_NextSeq = 0;
+    uint64_t m_Processed = 0;
+    uint64_t m_Sent = 0;
+    std::priority_queue<SimEvent, std::vector<SimEvent>, SimEventLater> m_Events;
+    EventInbox m_Inbox;
+};
+
+// Conservative parallel discrete-event engine.
+//
+// Time advances in windows [T, T + lookahead) where T is the earliest
+// pending event over all processes. No message sent inside a window can be
+// due before the window ends, so every process runs its window
+// independently; inboxes are absorbed at the barrier. Processes are dealt
+// to worker threads per window and idle workers steal unclaimed ones.
+//
+// Because the window schedule and the per-process event order only depend
+// on event timestamps, a run is bit-for-bit identical for any thread count.
+class ParallelEngine {
+public:
+    struct Stats {
+        uint64_t events = 0;
+        uint64_t windows = 0;
+        uint64_t crossMessages = 0;
+        uint64_t steals = 0; // Processes run by a worker other than their home worker
+        SimTime endTime = 0.0;
+    };
+
+    ParallelEngine(SimTime lookahead, size_t threads);
+
+    ParallelEngine(const ParallelEngine&) = delete;
+    ParallelEngine& operator=(const ParallelEngine&) = delete;
+
+    LogicalProcess& AddProcess();
+    LogicalProcess& GetProcess(uint32_t id) { return *m_Processes[id]; }
+    size_t GetProcessCount() const { return m_Processes.size(); }
+    SimTime GetLookahead() const { return m_Lookahead; }
+    size_t GetThreadCount() const { return m_Threads; }
+
+    // Process all events with time < endTime
+    Stats Run(SimTime endTime);
+
+private:
+    friend class LogicalProcess;
+
+    // Contiguous slice of the window's process list owned by one worker.
+    // Owner and thieves claim entries with the same fetch_add.
+    struct WorkRange {
+        std::atomic<size_t> next{ 0 };
+        size_t end = 0;
+    };
+
+    bool PrepareWindow(SimTime endTime);
+    void RunWindow(size_t worker);
+
+    SimTime m_Lookahead;
+    size_t m_Threads;
+    std::vector<std::unique_ptr<LogicalProcess>> m_Processes;
+
+    // Per-window state, written by worker 0 between barriers
+    SimTime m_WindowEnd = 0.0;
+    std::vector<uint32_t> m_Runnable;
+    std::unique_ptr<WorkRange[]> m_Ranges;
+    std::atomic<uint64_t> m_Steals{ 0 };
+    uint64_t m_Windows = 0;
+};
@@ -0,0 +1,279 @@
+#include "PerfCounters.h"
+
+#include <atomic>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace Perf {
+
+    namespace {
+
+        struct RegionTotals {
+            uint64_t calls = 0;
+            CounterValues sum;
+        };
+
+        using RegionMap = std::unordered_map<const char*, RegionTotals>;
+
+        std::atomic<bool> g_Enabled{ false };
+
+        class ThreadCounters;
+
+        // Registry of live per-thread accumulators plus totals retired by
+        // threads that have already exited.
+        std::mutex g_RegistryMutex;
+        std::vector<ThreadCounters*> g_Threads;
+        std::map<std::string, RegionTotals> g_Retired;
+        bool g_CounterAvailable[CounterCount] = {};
+
+        void Accumulate(std::map<std::string, RegionTotals>& into, const RegionMap& from)
+        {
+            for (const auto& [name, totals] : from) {
+                auto& dst = into[name];
+                dst.calls += totals.calls;
+                for (uint32_t i = 0; i < CounterCount; ++i) dst.sum.values[i] += totals.sum.values[i];
+            }
+        }
+
+        class ThreadCounters {
+        public:
+            ThreadCounters()
+            {
+                for (int& fd : m_Fds) fd = -1;
+                std::lock_guard<std::mutex> lock(g_RegistryMutex);
+                g_Threads.push_back(this);
+            }
+
+            ~ThreadCounters()
+            {
+                std::lock_guard<std::mutex> lock(g_RegistryMutex);
+                MergeInto(g_Retired);
+                for (auto it = g_Threads.begin(); it != g_Threads.end(); ++it) {
+                    if (*it == this) { g_Threads.erase(it); break; }
+                }
+#ifdef __linux__
+                for (int fd : m_Fds) if (fd >= 0) close(fd);
+#endif
+            }
+
+            // Opens the counter group on first use. Returns false if the
+            // group leader (cycles) is unavailable on this thread.
+            bool Open()
+            {
+                if (m_Opened) return m_Usable;
+                m_Opened = true;
+#ifdef __linux__
+                struct EventSpec { uint32_t type; uint64_t config; };
+                const EventSpec specs[CounterCount] = {
+                    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+                    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+                    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                                          | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                          | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+                    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+                    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+                };
+
+                for (uint32_t i = 0; i < CounterCount; ++i) {
+                    perf_event_attr attr;
+                    std::memset(&attr, 0, sizeof(attr));
+                    attr.size = sizeof(attr);
+                    attr.type = specs[i].type;
+                    attr.config = specs[i].config;
+                    attr.disabled = (i == Cycles) ? 1 : 0;
+                    attr.exclude_kernel = 1;
+                    attr.exclude_hv = 1;
+                    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+                    int groupFd = (i == Cycles) ? -1 : m_Fds[Cycles];
+                    m_Fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+                    if (m_Fds[i] >= 0) {
+                        ioctl(m_Fds[i], PERF_EVENT_IOC_ID, &m_Ids[i]);
+                    } else if (i == Cycles) {
+                        return false;
+                    }
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(g_RegistryMutex);
+                    for (uint32_t i = 0; i < CounterCount; ++i) {
+                        if (m_Fds[i] >= 0) g_CounterAvailable[i] = true;
+                    }
+                }
+
+                ioctl(m_Fds[Cycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(m_Fds[Cycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+                m_Usable = true;
+#endif
+                return m_Usable;
+            }
+
+            bool Read(CounterValues& out) const
+            {
+#ifdef __linux__
+                // PERF_FORMAT_GROUP | PERF_FORMAT_ID: nr, then {value, id} pairs
+                uint64_t buffer[1 + 2 * CounterCount] = {};
+                if (read(m_Fds[Cycles], buffer, sizeof(buffer)) <= 0) return false;
+                uint64_t nr = buffer[0];
+                for (uint64_t n = 0; n < nr && n < CounterCount; ++n) {
+                    uint64_t value = buffer[1 + 2 * n];
+                    uint64_t id = buffer[2 + 2 * n];
+                    for (uint32_t i = 0; i < CounterCount; ++i) {
+                        if (m_Fds[i] >= 0 && m_Ids[i] == id) { out.values[i] = value; break; }
+                    }
+                }
+                return true;
+#else
+                (void)out;
+                return false;
+#endif
+            }
+
+            // Only the owning thread records; the per-thread mutex is
+            // uncontended except against a concurrent report or reset.
+            void Record(const char* name, const CounterValues& start, const CounterValues& end)
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                auto& totals = m_Regions[name];
+                totals.calls++;
+                for (uint32_t i = 0; i < CounterCount; ++i) {
+                    totals.sum.values[i] += end.values[i] - start.values[i];
+                }
+            }
+
+            void MergeInto(std::map<std::string, RegionTotals>& into)
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                Accumulate(into, m_Regions);
+            }
+
+            void Clear()
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Regions.clear();
+            }
+
+        private:
+            std::mutex m_Mutex;
+            int m_Fds[CounterCount];
+            uint64_t m_Ids[CounterCount] = {};
+            bool m_Opened = false;
+            bool m_Usable = false;
+            RegionMap m_Regions;
+        };
+
+        ThreadCounters& LocalCounters()
+        {
+            thread_local ThreadCounters counters;
+            return counters;
+        }
+
+    } // namespace
+
+    bool Enable()
+    {
+        if (!LocalCounters().Open()) {
+            std::cerr << "Perf: Hardware counters unavailable, instrumentation disabled." << std::endl;
+            g_Enabled = false;
+            return false;
+        }
+        g_Enabled = true;
+        std::cout << "Perf: Hardware counter instrumentation enabled." << std::endl;
+        return true;
+    }
+
+    void Disable() { g_Enabled = false; }
+
+    bool IsEnabled() { return g_Enabled.load(std::memory_order_relaxed); }
+
+    void Reset()
+    {
+        std::lock_guard<std::mutex> lock(g_RegistryMutex);
+        g_Retired.clear();
+        for (ThreadCounters* thread : g_Threads) thread->Clear();
+    }
+
+    void PrintReport(std::ostream& os)
+    {
+        std::map<std::string, RegionTotals> merged;
+        bool available[CounterCount];
+        {
+            std::lock_guard<std::mutex> lock(g_RegistryMutex);
+            merged = g_Retired;
+            for (ThreadCounters* thread : g_Threads) thread->MergeInto(merged);
+            for (uint32_t i = 0; i < CounterCount; ++i) available[i] = g_CounterAvailable[i];
+        }
+
+        os << "\n===== Hardware Counter Report =====" << std::endl;
+        if (merged.empty()) {
+            os << "(no samples; counters disabled or unavailable)" << std::endl;
+            return;
+        }
+
+        auto perCall = [&](const RegionTotals& t, CounterIndex idx) -> std::string {
+            if (!available[idx]) return "n/a";
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(1) << static_cast<double>(t.sum.values[idx]) / t.calls;
+            return ss.str();
+        };
+
+        os << std::left << std::setw(44) << "Region"
+           << std::right << std::setw(8) << "Calls"
+           << std::setw(14) << "Cycles/call"
+           << std::setw(14) << "Instr/call"
+           << std::setw(8) << "IPC"
+           << std::setw(12) << "L1D miss"
+           << std::setw(12) << "LLC miss"
+           << std::setw(12) << "Br miss" << std::endl;
+
+        for (const auto& [name, t] : merged) {
+            if (t.calls == 0) continue;
+            std::string ipc = "n/a";
+            if (available[Instructions] && t.sum.values[Cycles] > 0) {
+                std::ostringstream ss;
+                ss << std::fixed << std::setprecision(2)
+                   << static_cast<double>(t.sum.values[Instructions]) / t.sum.values[Cycles];
+                ipc = ss.str();
+            }
+            os << std::left << std::setw(44) << name
+               << std::right << std::setw(8) << t.calls
+               << std::setw(14) << perCall(t, Cycles)
+               << std::setw(14) << perCall(t, Instructions)
+               << std::setw(8) << ipc
+               << std::setw(12) << perCall(t, L1DMisses)
+               << std::setw(12) << perCall(t, LLCMisses)
+               << std::setw(12) << perCall(t, BranchMisses) << std::endl;
+        }
+        os << "(miss columns are per call, i.e. per authentication step)" << std::endl;
+    }
+
+    ScopedRegion::ScopedRegion(const char* name)
+        : m_Name(name)
+    {
+        if (!IsEnabled()) return;
+        auto& counters = LocalCounters();
+        if (!counters.Open()) return;
+        m_Active = counters.Read(m_Start);
+    }
+
+    ScopedRegion::~ScopedRegion()
+    {
+        if (!m_Active) return;
+        auto& counters = LocalCounters();
+        CounterValues end;
+        if (counters.Read(end)) counters.Record(m_Name, m_Start, end);
+    }
+
+} // namespace Perf
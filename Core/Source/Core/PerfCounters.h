@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+// Optional hardware performance counter instrumentation.
+//
+// On Linux each thread lazily opens a perf_event_open counter group
+// (cycles, instructions, L1D read misses, LLC misses, branch misses) the
+// first time it enters a region. Deltas are attributed to the enclosing
+// PERF_SCOPE and summarised by PrintReport(). When instrumentation is not
+// enabled, the platform is not Linux, or the kernel refuses the counters
+// (e.g. perf_event_paranoid, containers), every scope is a no-op.
+namespace Perf {
+
+    enum CounterIndex : uint32_t {
+        Cycles = 0,
+        Instructions,
+        L1DMisses,
+        LLCMisses,
+        BranchMisses,
+        CounterCount
+    };
+
+    struct CounterValues {
+        uint64_t values[CounterCount] = {};
+    };
+
+    // Turn instrumentation on for all threads. Returns false (and stays a
+    // no-op) if counters cannot be opened on the calling thread.
+    bool Enable();
+    void Disable();
+    bool IsEnabled();
+
+    // Clear all accumulated region statistics.
+    void Reset();
+
+    // Print per-region IPC and per-call miss tables.
+    void PrintReport(std::ostream& os = std::cout);
+
+    // RAII region: counter deltas between construction and destruction are
+    // attributed to `name`, which must be a string literal (or otherwise
+    // outlive the run). Regions nest; deltas are inclusive.
+    class ScopedRegion {
+    public:
+        explicit ScopedRegion(const char* name);
+        ~ScopedRegion();
+
+        ScopedRegion(const ScopedRegion&) = delete;
+        ScopedRegion& operator=(const ScopedRegion&) = delete;
+
+    private:
+        const char* m_Name = nullptr;
+        bool m_Active = false;
+        CounterValues m_Start;
+    };
+
+} // namespace Perf
+
+#define PERF_CONCAT_INNER(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_INNER(a, b)
+#define PERF_SCOPE(name) Perf::ScopedRegion PERF_CONCAT(perfScope_, __LINE__)(name)
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Per-subscriber SQN array for replay protection (3GPP TS 33.102 Annex C.3).
+//
+// An SQN is SEQ || IND, IND being its low `indBits` bits. Each subscriber
+// row holds one slot per IND value with the highest SQN accepted in it, and
+// a new SQN is fresh if it beats its own slot. Requests that overtake each
+// other land in different slots and are all accepted; a replay always finds
+// its slot at or above it. Rows live in one flat array and slots are
+// updated with compare-and-swap, so checks need no lock. Adding rows or
+// changing the window is not thread-safe (provisioning time only).
+class SQNArray {
+public:
+    static constexpr uint32_t MaxIndBits = 8;
+
+    explicit SQNArray(uint32_t indBits = 5) : m_IndBits(std::min(indBits, MaxIndBits)) {}
+
+    inline uint32_t IndBits() const { return m_IndBits; }
+    inline size_t Window() const { return size_t(1) << m_IndBits; }
+    inline size_t Rows() const { return m_Rows; }
+
+    // Append `count` rows with nothing accepted yet; returns the first
+    size_t AddRows(size_t count)
+    {
+        size_t first = m_Rows;
+        Reserve(m_Rows + count, Window());
+        m_Rows += count;
+        return first;
+    }
+
+    // Re-lay every row for a new window. New slots start at the row's
+    // highest SQN, so nothing accepted before becomes fresh again.
+    void SetIndBits(uint32_t indBits)
+    {
+        indBits = std::min(indBits, MaxIndBits);
+        if (indBits == m_IndBits) return;
+        size_t window = size_t(1) << indBits;
+        auto slots = std::make_unique<std::atomic<uint64_t>[]>(std::max<size_t>(m_Capacity, 1) * window);
+        for (size_t row = 0; row < m_Rows; ++row) {
+            uint64_t highest = Highest(row);
+            for (size_t ind = 0; ind < window; ++ind) slots[row * window + ind].store(highest, std::memory_order_relaxed);
+        }
+        m_Slots = std::move(slots);
+        m_IndBits = indBits;
+    }
+
+    // True, and recorded, if `sqn` is fresh for `row`
+    bool Accept(size_t row, uint64_t sqn)
+    {
+        std::atomic<uint64_t>& slot = m_Slots[row * Window() + (sqn & (Window() - 1))];
+        uint64_t seen = slot.load(std::memory_order_acquire);
+        while (sqn > seen) {
+            if (slot.compare_exchange_weak(seen, sqn, std::memory_order_acq_rel, std::memory_order_acquire)) return true;
+        }
+        return false;
+    }
+
+    // Highest SQN accepted for `row`; SQN_HN in a resynchronisation
+    uint64_t Highest(size_t row) const
+    {
+        uint64_t highest = 0;
+        for (size_t ind = 0; ind < Window(); ++ind) highest = std::max(highest, Get(row, ind));
+        return highest;
+    }
+
+    void ResetRow(size_t row)
+    {
+        for (size_t ind = 0; ind < Window(); ++ind) Set(row, ind, 0);
+    }
+
+    uint64_t Get(size_t row, size_t ind) const { return m_Slots[row * Window() + ind].load(std::memory_order_acquire); }
+    void Set(size_t row, size_t ind, uint64_t sqn) { m_Slots[row * Window() + ind].store(sqn, std::memory_order_release); }
+
+private:
+    void Reserve(size_t rows, size_t window)
+    {
+        if (rows <= m_Capacity) return;
+        size_t capacity = std::max(rows, m_Capacity * 2);
+        auto slots = std::make_unique<std::atomic<uint64_t>[]>(capacity * window); // Zeroed
+        for (size_t i = 0; i < m_Rows * window; ++i) slots[i].store(m_Slots[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        m_Slots = std::move(slots);
+        m_Capacity = capacity;
+    }
+
+    uint32_t m_IndBits;
+    size_t m_Rows = 0;
+    size_t m_Capacity = 0;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_Slots;
+};
@@ -0,0 +1,338 @@
+#include "ScenarioFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+using namespace ScenarioFormat;
+
+namespace {
+
+    constexpr size_t ColumnIndex(Column column) { return static_cast<size_t>(column); }
+
+    bool IsStringColumn(Column column)
+    {
+        return column == Column::UAVKey || column == Column::UEKey || column == Column::UESUPI;
+    }
+
+    uint64_t AlignUp(uint64_t offset) { return (offset + ColumnAlignment - 1) & ~uint64_t(ColumnAlignment - 1); }
+
+    // One column staged for writing
+    struct PendingColumn {
+        Column column;
+        uint32_t width;
+        std::vector<char> bytes;
+    };
+
+    template<typename Record, typename Field>
+    PendingColumn PackU32(Column column, const std::vector<Record>& records, const std::vector<size_t>& order, Field field)
+    {
+        PendingColumn out{ column, sizeof(uint32_t), std::vector<char>(order.size() * sizeof(uint32_t)) };
+        for (size_t row = 0; row < order.size(); ++row) {
+            uint32_t value = field(records[order[row]]);
+            std::memcpy(out.bytes.data() + row * sizeof(uint32_t), &value, sizeof(value));
+        }
+        return out;
+    }
+
+    PendingColumn PackStrings(Column column, const std::vector<std::string>& values, const std::vector<size_t>& order)
+    {
+        size_t width = 1;
+        for (const auto& value : values) width = std::max(width, value.size());
+        PendingColumn out{ column, static_cast<uint32_t>(width), std::vector<char>(order.size() * width, '\0') };
+        for (size_t row = 0; row < order.size(); ++row) {
+            const std::string& value = values[order[row]];
+            std::memcpy(out.bytes.data() + row * width, value.data(), value.size());
+        }
+        return out;
+    }
+
+    std::vector<size_t> Identity(size_t count)
+    {
+        std::vector<size_t> order(count);
+        std::iota(order.begin(), order.end(), size_t(0));
+        return order;
+    }
+
+    bool ParseU32(const std::string& field, uint32_t& out)
+    {
+        try {
+            size_t used = 0;
+            unsigned long value = std::stoul(field, &used);
+            if (used != field.size() || value > UINT32_MAX) return false;
+            out = static_cast<uint32_t>(value);
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+} // namespace
+
+// --- Reading ---
+
+std::shared_ptr<const ScenarioFile> ScenarioFile::Open(const std::string& path)
+{
+    std::shared_ptr<ScenarioFile> file(new ScenarioFile());
+    file->m_File = MappedFile::Open(path);
+    if (!file->m_File || !file->Validate(path)) {
+        return nullptr;
+    }
+    return file;
+}
+
+bool ScenarioFile::Validate(const std::string& path)
+{
+    auto fail = [&](const char* reason) {
+        std::cerr << "ScenarioFile: " << path << ": " << reason << std::endl;
+        return false;
+    };
+
+    const char* data = m_File->Data();
+    const size_t size = m_File->Size();
+    if (size < sizeof(Header)) return fail("file too short");
+    std::memcpy(&m_Header, data, sizeof(Header));
+    if (std::memcmp(m_Header.magic, Magic, sizeof(Magic)) != 0) return fail("not a scenario file");
+    if (m_Header.majorVersion != MajorVersion) return fail("unsupported format version");
+    if (m_Header.fileBytes != size) return fail("truncated or padded file");
+
+    uint64_t tableEnd = sizeof(Header) + uint64_t(m_Header.columnCount) * sizeof(ColumnEntry);
+    if (tableEnd > size) return fail("column table out of range");
+
+    for (uint32_t i = 0; i < m_Header.columnCount; ++i) {
+        ColumnEntry entry;
+        std::memcpy(&entry, data + sizeof(Header) + i * sizeof(ColumnEntry), sizeof(entry));
+        if (entry.column >= ColumnIndex(Column::Count)) continue; // Newer minor version
+
+        Column column = static_cast<Column>(entry.column);
+        uint64_t rows = column <= Column::GNBY ? m_Header.gnbCount
+            : column <= Column::UAVKey ? m_Header.uavCount
+            : m_Header.ueCount;
+        bool widthOk = IsStringColumn(column)
+            ? entry.width > 0 && entry.width <= (column == Column::UESUPI ? MaxSUPIWidth : MaxKeyWidth)
+            : entry.width == sizeof(uint32_t);
+        if (!widthOk) return fail("bad column width");
+        if (entry.offset % ColumnAlignment != 0 || entry.offset < tableEnd
+            || entry.offset > size || rows > (size - entry.offset) / entry.width) {
+            return fail("column out of range");
+        }
+        m_Columns[entry.column] = ColumnView{ data + entry.offset, entry.width };
+    }
+
+    // Positions and IDs are mandatory; velocities and keys are optional, in pairs
+    const Column required[] = { Column::GNBId, Column::GNBX, Column::GNBY, Column::UAVId, Column::UAVX,
+        Column::UAVY, Column::UEId, Column::UEX, Column::UEY };
+    for (Column column : required) {
+        if (!m_Columns[ColumnIndex(column)].data) return fail("missing required column");
+    }
+    auto paired = [this](Column a, Column b) { return !m_Columns[ColumnIndex(a)].data == !m_Columns[ColumnIndex(b)].data; };
+    if (!paired(Column::UEKey, Column::UESUPI)) {
+        return fail("UE keys and SUPIs must both be present or both absent");
+    }
+    if (!paired(Column::UAVVelX, Column::UAVVelY) || !paired(Column::UEVelX, Column::UEVelY)) {
+        return fail("velocity X and Y columns must both be present or both absent");
+    }
+    // SubscriberTable binary-searches the SUPI column in place
+    if (m_Columns[ColumnIndex(Column::UESUPI)].data) {
+        for (uint64_t i = 1; i < m_Header.ueCount; ++i) {
+            if (!(StringAt(Column::UESUPI, i - 1) < StringAt(Column::UESUPI, i))) {
+                return fail("UESUPI column is not sorted or has duplicate SUPIs");
+            }
+        }
+    }
+    return true;
+}
+
+std::span<const uint32_t> ScenarioFile::U32Column(Column column) const
+{
+    const ColumnView& view = m_Columns[ColumnIndex(column)];
+    if (!view.data || IsStringColumn(column)) return {};
+    size_t rows = column <= Column::GNBY ? GetGNBCount() : column <= Column::UAVKey ? GetUAVCount() : GetUECount();
+    // Columns are 64-byte aligned within a page-aligned mapping
+    return std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(view.data), rows);
+}
+
+std::string_view ScenarioFile::StringAt(Column column, size_t index) const
+{
+    const ColumnView& view = m_Columns[ColumnIndex(column)];
+    if (!view.data || !IsStringColumn(column)) return {};
+    const char* record = view.data + index * view.width;
+    const void* end = std::memchr(record, '\0', view.width);
+    return std::string_view(record, end ? static_cast<const char*>(end) - record : view.width);
+}
+
+std::shared_ptr<const SubscriberTable> ScenarioFile::GetSubscribers() const
+{
+    const ColumnView& supis = m_Columns[ColumnIndex(Column::UESUPI)];
+    const ColumnView& keys = m_Columns[ColumnIndex(Column::UEKey)];
+    if (!supis.data) {
+        return std::make_shared<const SubscriberTable>(m_File, nullptr, 1, nullptr, 1, 0);
+    }
+    return std::make_shared<const SubscriberTable>(m_File, supis.data, supis.width, keys.data, keys.width, GetUECount());
+}
+
+// --- Writing ---
+
+bool ScenarioFile::Write(const ScenarioDescription& scenario, const std::string& path)
+{
+    using Station = ScenarioDescription::Station;
+    using Mobile = ScenarioDescription::Mobile;
+
+    std::vector<std::string> uavKeys, ueKeys, ueSUPIs;
+    uavKeys.reserve(scenario.uavs.size());
+    ueKeys.reserve(scenario.ues.size());
+    ueSUPIs.reserve(scenario.ues.size());
+    for (const Mobile& uav : scenario.uavs) {
+        uavKeys.push_back(uav.longTermKey);
+    }
+    for (const Mobile& ue : scenario.ues) {
+        ueKeys.push_back(ue.longTermKey.empty() ? "DEFAULT_KEY" : ue.longTermKey);
+        ueSUPIs.push_back(ue.supi.empty() ? "SUPI_UE" + std::to_string(ue.id) : ue.supi);
+    }
+    for (const auto* keys : { &uavKeys, &ueKeys }) {
+        for (const auto& key : *keys) {
+            if (key.size() > MaxKeyWidth) {
+                std::cerr << "ScenarioFile: Key '" << key << "' exceeds " << MaxKeyWidth << " bytes." << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // UE rows go in SUPI order so the file is its own subscriber index
+    std::vector<size_t> ueOrder = Identity(scenario.ues.size());
+    std::sort(ueOrder.begin(), ueOrder.end(), [&](size_t a, size_t b) { return ueSUPIs[a] < ueSUPIs[b]; });
+    for (size_t row = 0; row < ueOrder.size(); ++row) {
+        const std::string& supi = ueSUPIs[ueOrder[row]];
+        if (supi.size() > MaxSUPIWidth || supi.find('\0') != std::string::npos) {
+            std::cerr << "ScenarioFile: SUPI '" << supi << "' is not a valid " << MaxSUPIWidth << "-byte string." << std::endl;
+            return false;
+        }
+        if (row > 0 && supi == ueSUPIs[ueOrder[row - 1]]) {
+            std::cerr << "ScenarioFile: Duplicate SUPI " << supi << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<size_t> gnbOrder = Identity(scenario.gnbs.size());
+    std::vector<size_t> uavOrder = Identity(scenario.uavs.size());
+    std::vector<PendingColumn> columns;
+    columns.push_back(PackU32(Column::GNBId, scenario.gnbs, gnbOrder, [](const Station& s) { return s.id; }));
+    columns.push_back(PackU32(Column::GNBX, scenario.gnbs, gnbOrder, [](const Station& s) { return s.x; }));
+    columns.push_back(PackU32(Column::GNBY, scenario.gnbs, gnbOrder, [](const Station& s) { return s.y; }));
+    columns.push_back(PackU32(Column::UAVId, scenario.uavs, uavOrder, [](const Mobile& m) { return m.id; }));
+    columns.push_back(PackU32(Column::UAVX, scenario.uavs, uavOrder, [](const Mobile& m) { return m.x; }));
+    columns.push_back(PackU32(Column::UAVY, scenario.uavs, uavOrder, [](const Mobile& m) { return m.y; }));
+    columns.push_back(PackU32(Column::UAVVelX, scenario.uavs, uavOrder, [](const Mobile& m) { return m.velX; }));
+    columns.push_back(PackU32(Column::UAVVelY, scenario.uavs, uavOrder, [](const Mobile& m) { return m.velY; }));
+    columns.push_back(PackStrings(Column::UAVKey, uavKeys, uavOrder));
+    columns.push_back(PackU32(Column::UEId, scenario.ues, ueOrder, [](const Mobile& m) { return m.id; }));
+    columns.push_back(PackU32(Column::UEX, scenario.ues, ueOrder, [](const Mobile& m) { return m.x; }));
+    columns.push_back(PackU32(Column::UEY, scenario.ues, ueOrder, [](const Mobile& m) { return m.y; }));
+    columns.push_back(PackU32(Column::UEVelX, scenario.ues, ueOrder, [](const Mobile& m) { return m.velX; }));
+    columns.push_back(PackU32(Column::UEVelY, scenario.ues, ueOrder, [](const Mobile& m) { return m.velY; }));
+    columns.push_back(PackStrings(Column::UEKey, ueKeys, ueOrder));
+    columns.push_back(PackStrings(Column::UESUPI, ueSUPIs, ueOrder));
+
+    Header header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.majorVersion = MajorVersion;
+    header.minorVersion = MinorVersion;
+    header.columnCount = static_cast<uint32_t>(columns.size());
+    header.gnbCount = scenario.gnbs.size();
+    header.uavCount = scenario.uavs.size();
+    header.ueCount = scenario.ues.size();
+
+    std::vector<ColumnEntry> entries;
+    uint64_t offset = sizeof(Header) + columns.size() * sizeof(ColumnEntry);
+    for (const PendingColumn& column : columns) {
+        offset = AlignUp(offset);
+        entries.push_back(ColumnEntry{ static_cast<uint32_t>(column.column), column.width, offset });
+        offset += column.bytes.size();
+    }
+    header.fileBytes = offset;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "ScenarioFile: Cannot create " << path << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(ColumnEntry)));
+    uint64_t written = sizeof(Header) + entries.size() * sizeof(ColumnEntry);
+    const char padding[ColumnAlignment] = {};
+    for (size_t i = 0; i < columns.size(); ++i) {
+        out.write(padding, static_cast<std::streamsize>(entries[i].offset - written));
+        out.write(columns[i].bytes.data(), static_cast<std::streamsize>(columns[i].bytes.size()));
+        written = entries[i].offset + columns[i].bytes.size();
+    }
+    if (!out.flush()) {
+        std::cerr << "ScenarioFile: Write to " << path << " failed." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- Text conversion ---
+
+bool ScenarioFile::ParseText(const std::string& textPath, ScenarioDescription& out)
+{
+    std::ifstream in(textPath);
+    if (!in) {
+        std::cerr << "ScenarioFile: Cannot open " << textPath << std::endl;
+        return false;
+    }
+
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (size_t comment = line.find('#'); comment != std::string::npos) line.erase(comment);
+        line.erase(std::remove_if(line.begin(), line.end(), [](unsigned char c) { return std::isspace(c); }), line.end());
+        if (line.empty()) continue;
+
+        std::vector<std::string> fields;
+        std::stringstream row(line);
+        for (std::string field; std::getline(row, field, ',');) fields.push_back(field);
+
+        auto fail = [&](const char* reason) {
+            std::cerr << "ScenarioFile: " << textPath << ":" << lineNumber << ": " << reason << std::endl;
+            return false;
+        };
+
+        const std::string& type = fields[0];
+        uint32_t id = 0, x = 0, y = 0;
+        if (fields.size() < 4 || !ParseU32(fields[1], id) || !ParseU32(fields[2], x) || !ParseU32(fields[3], y)) {
+            return fail("expected <type>,<id>,<x>,<y>");
+        }
+        if (type == "gnb") {
+            if (fields.size() != 4) return fail("gnb takes <id>,<x>,<y>");
+            out.gnbs.push_back({ id, x, y });
+        } else if (type == "uav" || type == "ue") {
+            ScenarioDescription::Mobile mobile{ .id = id, .x = x, .y = y };
+            if (fields.size() == 5 || fields.size() > 7) return fail("expected [,<vx>,<vy>[,<key>]]");
+            if (fields.size() >= 6 && (!ParseU32(fields[4], mobile.velX) || !ParseU32(fields[5], mobile.velY))) {
+                return fail("bad velocity");
+            }
+            if (fields.size() == 7) mobile.longTermKey = fields[6];
+            (type == "uav" ? out.uavs : out.ues).push_back(std::move(mobile));
+        } else {
+            return fail("unknown record type");
+        }
+    }
+    return true;
+}
+
+bool ScenarioFile::ConvertText(const std::string& textPath, const std::string& binaryPath)
+{
+    ScenarioDescription scenario;
+    if (!ParseText(textPath, scenario) || !Write(scenario, binaryPath)) {
+        return false;
+    }
+    std::cout << "ScenarioFile: Wrote " << scenario.gnbs.size() << " gNBs, " << scenario.uavs.size() << " UAVs and "
+              << scenario.ues.size() << " UEs to " << binaryPath << std::endl;
+    return true;
+}
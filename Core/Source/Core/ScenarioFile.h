@@ -0,0 +1,134 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "SubscriberTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Columnar binary scenario file (.kscn).
+//
+// Layout, all little-endian:
+//   [Header][ColumnEntry x columnCount][column data ...]
+// Every column is a packed array of `count` fixed-width records starting at
+// a 64-byte aligned offset: u32 IDs, positions and velocities, and
+// NUL-padded key/SUPI strings (width = longest value in the file). UE rows
+// are stored in SUPI order, so the UE SUPI and key columns double as the
+// subscriber table a gNB binary-searches in place.
+//
+// Readers accept any file with the same major version and skip columns
+// they do not know, so columns can be appended without breaking old files.
+namespace ScenarioFormat {
+    constexpr char Magic[8] = { 'K', 'S', 'C', 'N', 'F', 'I', 'L', 'E' };
+    constexpr uint16_t MajorVersion = 1;
+    constexpr uint16_t MinorVersion = 0;
+    constexpr size_t ColumnAlignment = 64;
+
+    constexpr size_t MaxKeyWidth = 32;  // UE::LongTermKeyBytes
+    constexpr size_t MaxSUPIWidth = 24; // UE::SUPIBytes
+
+    enum class Column : uint32_t {
+        GNBId, GNBX, GNBY,
+        UAVId, UAVX, UAVY, UAVVelX, UAVVelY, UAVKey,
+        UEId, UEX, UEY, UEVelX, UEVelY, UEKey, UESUPI,
+        Count
+    };
+
+    struct Header {
+        char magic[8];
+        uint16_t majorVersion;
+        uint16_t minorVersion;
+        uint32_t columnCount;
+        uint64_t gnbCount;
+        uint64_t uavCount;
+        uint64_t ueCount;
+        uint64_t fileBytes;
+    };
+    static_assert(sizeof(Header) == 48, "Scenario header layout changed");
+
+    struct ColumnEntry {
+        uint32_t column; // Column enum value
+        uint32_t width;  // Bytes per record
+        uint64_t offset; // From the start of the file
+    };
+    static_assert(sizeof(ColumnEntry) == 16, "Scenario column entry layout changed");
+}
+
+// In-memory scenario, used to write files and by the text converter
+struct ScenarioDescription {
+    struct Station {
+        uint32_t id;
+        uint32_t x;
+        uint32_t y;
+    };
+    struct Mobile {
+        uint32_t id = 0;
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t velX = 0;
+        uint32_t velY = 0;
+        std::string longTermKey{};
+        std::string supi{}; // UEs only; defaults to "SUPI_UE<id>"
+    };
+
+    std::vector<Station> gnbs;
+    std::vector<Mobile> uavs;
+    std::vector<Mobile> ues;
+};
+
+// Read-only view of a scenario file. Columns are handed out as spans into
+// the MappedFile and are valid while the object lives.
+class ScenarioFile {
+public:
+    using Column = ScenarioFormat::Column;
+
+    ScenarioFile(const ScenarioFile&) = delete;
+    ScenarioFile& operator=(const ScenarioFile&) = delete;
+
+    // Map and validate `path`; reports to std::cerr and returns null on error
+    static std::shared_ptr<const ScenarioFile> Open(const std::string& path);
+
+    // Serialise `scenario`; over-long keys or SUPIs and duplicate SUPIs are rejected
+    static bool Write(const ScenarioDescription& scenario, const std::string& path);
+
+    // Parse the text form (see ParseText) and write it as a binary file
+    static bool ConvertText(const std::string& textPath, const std::string& binaryPath);
+
+    // One record per line, '#' starts a comment:
+    //   gnb,<id>,<x>,<y>
+    //   uav,<id>,<x>,<y>[,<vx>,<vy>[,<key>]]
+    //   ue,<id>,<x>,<y>[,<vx>,<vy>[,<key>]]
+    static bool ParseText(const std::string& textPath, ScenarioDescription& out);
+
+    inline size_t GetGNBCount() const { return static_cast<size_t>(m_Header.gnbCount); }
+    inline size_t GetUAVCount() const { return static_cast<size_t>(m_Header.uavCount); }
+    inline size_t GetUECount() const { return static_cast<size_t>(m_Header.ueCount); }
+    inline uint16_t GetMinorVersion() const { return m_Header.minorVersion; }
+
+    // u32 column (IDs, positions, velocities); empty if absent
+    std::span<const uint32_t> U32Column(Column column) const;
+
+    // Record `index` of a string column, without its NUL padding
+    std::string_view StringAt(Column column, size_t index) const;
+
+    // SUPI -> key table sharing this file's mapping
+    std::shared_ptr<const SubscriberTable> GetSubscribers() const;
+
+private:
+    struct ColumnView {
+        const char* data = nullptr;
+        uint32_t width = 0;
+    };
+
+    ScenarioFile() = default;
+    bool Validate(const std::string& path);
+
+    std::shared_ptr<const MappedFile> m_File;
+    ScenarioFormat::Header m_Header{};
+    ColumnView m_Columns[static_cast<size_t>(Column::Count)];
+};
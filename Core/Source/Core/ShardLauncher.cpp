@@ -0,0 +1,386 @@
+#include "ShardLauncher.h"
+#include "World.h"
+#include "ShmRing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#if defined(__linux__) || defined(__APPLE__)
+#define KYBERSIM_SHARDS_SUPPORTED 1
+#include <cerrno>
+#include <csignal>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// --- Metrics ---
+
+std::string ShardMetrics::ToLine() const
+{
+    std::ostringstream line;
+    line << "METRICS " << shard << ' ' << gnbs << ' ' << ues << ' ' << migratedOut << ' ' << migratedIn << ' '
+         << deferred << ' ' << events << ' ' << cellHandovers << ' ' << wallMs << ' ' << maxRssKb;
+    return line.str();
+}
+
+std::optional<ShardMetrics> ShardMetrics::FromLine(const std::string& line)
+{
+    std::istringstream in(line);
+    std::string tag;
+    ShardMetrics metrics;
+    in >> tag >> metrics.shard >> metrics.gnbs >> metrics.ues >> metrics.migratedOut >> metrics.migratedIn
+       >> metrics.deferred >> metrics.events >> metrics.cellHandovers >> metrics.wallMs >> metrics.maxRssKb;
+    if (!in || tag != "METRICS") return std::nullopt;
+    return metrics;
+}
+
+void ShardReport::Print(std::ostream& os) const
+{
+    auto row = [&os](const std::string& label, const ShardMetrics& m) {
+        os << std::left << std::setw(8) << label << std::right
+           << std::setw(6) << m.gnbs << std::setw(12) << m.ues
+           << std::setw(10) << m.migratedOut << std::setw(10) << m.migratedIn << std::setw(9) << m.deferred
+           << std::setw(12) << m.events << std::setw(11) << m.cellHandovers
+           << std::setw(9) << m.wallMs << std::setw(11) << m.maxRssKb << std::endl;
+    };
+    os << "\n===== Sharded Simulation Report =====" << std::endl;
+    os << std::left << std::setw(8) << "Shard" << std::right
+       << std::setw(6) << "gNBs" << std::setw(12) << "UEs"
+       << std::setw(10) << "MigOut" << std::setw(10) << "MigIn" << std::setw(9) << "Deferred"
+       << std::setw(12) << "Events" << std::setw(11) << "CellHO"
+       << std::setw(9) << "WallMs" << std::setw(11) << "MaxRssKB" << std::endl;
+    for (const ShardMetrics& m : shards) {
+        row(std::to_string(m.shard), m);
+    }
+    row("Total", total);
+}
+
+#ifdef KYBERSIM_SHARDS_SUPPORTED
+
+namespace {
+
+    // Scenario geometry every shard derives identically
+    struct ShardGeometry {
+        const ShardScenario& scenario;
+        uint32_t shards;
+
+        uint32_t Width() const { return scenario.gnbCols * scenario.spacing; }
+        uint32_t Height() const { return scenario.gnbRows * scenario.spacing; }
+        // gNB (col, row) sits at the centre of its spacing x spacing square
+        uint32_t Column(uint32_t x) const { return std::min(x / scenario.spacing, scenario.gnbCols - 1); }
+        uint32_t OwnerOfColumn(uint32_t col) const { return static_cast<uint32_t>(uint64_t(col) * shards / scenario.gnbCols); }
+        uint32_t Owner(const Position& pos) const { return OwnerOfColumn(Column(pos.first)); }
+    };
+
+    uint64_t SplitMix64(uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    // Frames carried between shards
+    enum class ShardMessageKind : uint32_t { MigrateUE = 1 };
+
+    struct MigrateUEMessage {
+        ShardMessageKind kind = ShardMessageKind::MigrateUE;
+        uint32_t id;
+        uint32_t x, y;
+        uint32_t vx, vy;
+    };
+
+    // Line-based control messages over one end of a socket pair
+    class ControlChannel {
+    public:
+        explicit ControlChannel(int fd = -1) : m_Fd(fd) {}
+
+        bool SendLine(const std::string& line)
+        {
+            std::string data = line + '\n';
+            size_t sent = 0;
+            while (sent < data.size()) {
+#ifdef MSG_NOSIGNAL
+                ssize_t n = ::send(m_Fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#else
+                ssize_t n = ::send(m_Fd, data.data() + sent, data.size() - sent, 0);
+#endif
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                sent += static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        bool ReadLine(std::string& line)
+        {
+            for (;;) {
+                size_t newline = m_Buffer.find('\n');
+                if (newline != std::string::npos) {
+                    line = m_Buffer.substr(0, newline);
+                    m_Buffer.erase(0, newline + 1);
+                    return true;
+                }
+                char chunk[256];
+                ssize_t n = ::read(m_Fd, chunk, sizeof(chunk));
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                m_Buffer.append(chunk, static_cast<size_t>(n));
+            }
+        }
+
+        void Close()
+        {
+            if (m_Fd >= 0) ::close(m_Fd);
+            m_Fd = -1;
+        }
+
+    private:
+        int m_Fd;
+        std::string m_Buffer;
+    };
+
+    // shards x shards rings in one shared mapping; ring (i, i) is unused
+    struct RingSegment {
+        uint8_t* base = nullptr;
+        size_t bytes = 0;
+        size_t ringCapacity = 0;
+        uint32_t shards = 0;
+
+        ShmRing Ring(uint32_t from, uint32_t to) const
+        {
+            return ShmRing::Attach(base + (size_t(from) * shards + to) * ShmRing::Footprint(ringCapacity));
+        }
+    };
+
+    std::string BarrierLine(uint32_t epoch, int phase)
+    {
+        return "BARRIER " + std::to_string(epoch) + " " + std::to_string(phase);
+    }
+
+    bool Barrier(ControlChannel& control, uint32_t epoch, int phase)
+    {
+        std::string reply;
+        return control.SendLine(BarrierLine(epoch, phase)) && control.ReadLine(reply) && reply == "GO";
+    }
+
+    // Body of one shard process
+    int RunShard(const ShardScenario& scenario, uint32_t shard, uint32_t shards, const RingSegment& rings, ControlChannel& control)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (!scenario.verbose) std::cout.setstate(std::ios::failbit);
+#ifdef __linux__
+        if (scenario.pinCpus) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(shard % CPU_SETSIZE, &cpus);
+            sched_setaffinity(0, sizeof(cpus), &cpus); // Best effort
+        }
+#endif
+        ShardGeometry geometry{ scenario, shards };
+        ShardMetrics metrics;
+        metrics.shard = shard;
+
+        World world;
+        for (uint32_t col = 0; col < scenario.gnbCols; ++col) {
+            if (geometry.OwnerOfColumn(col) != shard) continue;
+            for (uint32_t row = 0; row < scenario.gnbRows; ++row) {
+                world.addGNB(row * scenario.gnbCols + col + 1,
+                             col * scenario.spacing + scenario.spacing / 2,
+                             row * scenario.spacing + scenario.spacing / 2);
+                metrics.gnbs++;
+            }
+        }
+
+        // Every shard walks the full UE sequence but only keeps its own
+        for (uint64_t i = 0; i < scenario.ueCount; ++i) {
+            uint64_t r = SplitMix64(scenario.seed ^ (i * 0x2545F4914F6CDD1Dull));
+            Position pos{ static_cast<uint32_t>(r % geometry.Width()), static_cast<uint32_t>((r >> 32) % geometry.Height()) };
+            if (geometry.Owner(pos) != shard) continue;
+            uint64_t v = SplitMix64(r);
+            UE* ue = world.addUE(static_cast<uint32_t>(i + 1), pos.first, pos.second);
+            ue->SetVelocity(10 + static_cast<uint32_t>(v % 90), 10 + static_cast<uint32_t>((v >> 32) % 90));
+        }
+
+        std::vector<uint8_t> frame;
+        for (uint32_t epoch = 0; epoch < scenario.epochs; ++epoch) {
+            CellSimulationStats stats = world.runCellSimulation(scenario.epochLength, scenario.tick, scenario.linkDelay, scenario.threadsPerShard);
+            metrics.events += stats.engine.events;
+            metrics.cellHandovers += stats.reassociations;
+
+            // Wrap around the torus and hand over UEs that left the region
+            std::vector<std::pair<uint32_t, uint32_t>> leaving; // (UE ID, owner)
+            world.ues.ForEach([&](UE& ue) {
+                Position pos = ue.GetPosition();
+                ue.SetPosition(pos.first % geometry.Width(), pos.second % geometry.Height());
+                uint32_t owner = geometry.Owner(ue.GetPosition());
+                if (owner != shard) leaving.push_back({ ue.GetID(), owner });
+            });
+            for (const auto& [ueId, owner] : leaving) {
+                UE* ue = world.findUE(ueId);
+                MigrateUEMessage message{ ShardMessageKind::MigrateUE, ueId, ue->GetPosition().first, ue->GetPosition().second,
+                                          ue->GetVelocity().first, ue->GetVelocity().second };
+                if (!rings.Ring(shard, owner).TryWrite(&message, sizeof(message))) {
+                    metrics.deferred++; // Ring full; stays here until next epoch
+                    continue;
+                }
+                world.removeUE(ueId);
+                metrics.migratedOut++;
+            }
+
+            if (!Barrier(control, epoch, 0)) return 1;
+            for (uint32_t from = 0; from < shards; ++from) {
+                if (from == shard) continue;
+                ShmRing ring = rings.Ring(from, shard);
+                while (ring.TryRead(frame)) {
+                    MigrateUEMessage message;
+                    if (frame.size() != sizeof(message)) continue;
+                    std::memcpy(&message, frame.data(), sizeof(message));
+                    if (message.kind != ShardMessageKind::MigrateUE) continue;
+                    UE* ue = world.addUE(message.id, message.x, message.y);
+                    ue->SetVelocity(message.vx, message.vy);
+                    metrics.migratedIn++;
+                }
+            }
+            if (!Barrier(control, epoch, 1)) return 1;
+        }
+
+        metrics.ues = world.ues.Size();
+        metrics.wallMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+            metrics.maxRssKb = static_cast<uint64_t>(usage.ru_maxrss) / 1024; // Bytes on macOS
+#else
+            metrics.maxRssKb = static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+        }
+        return control.SendLine(metrics.ToLine()) ? 0 : 1;
+    }
+
+} // namespace
+
+std::optional<ShardReport> ShardLauncher::Launch(const ShardScenario& scenario, size_t shardCount)
+{
+    if (shardCount == 0 || scenario.gnbCols < shardCount || scenario.gnbRows == 0 || scenario.spacing == 0) {
+        std::cerr << "ShardLauncher: Need 1..gnbCols shards and a non-empty gNB grid." << std::endl;
+        return std::nullopt;
+    }
+    const uint32_t shards = static_cast<uint32_t>(shardCount);
+    std::cout << "ShardLauncher: Starting " << shards << " shards for " << scenario.ueCount << " UEs on a "
+              << scenario.gnbCols << "x" << scenario.gnbRows << " gNB grid" << std::endl;
+
+    RingSegment rings;
+    rings.shards = shards;
+    rings.ringCapacity = std::max<size_t>((scenario.ringBytes + 63) & ~size_t(63), 4096);
+    rings.bytes = size_t(shards) * shards * ShmRing::Footprint(rings.ringCapacity);
+    void* mapping = mmap(nullptr, rings.bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "ShardLauncher: Failed to map " << rings.bytes << " bytes of shared memory: " << std::strerror(errno) << std::endl;
+        return std::nullopt;
+    }
+    rings.base = static_cast<uint8_t*>(mapping);
+    for (uint32_t from = 0; from < shards; ++from) {
+        for (uint32_t to = 0; to < shards; ++to) {
+            if (from != to) ShmRing::Create(rings.base + (size_t(from) * shards + to) * ShmRing::Footprint(rings.ringCapacity), rings.ringCapacity);
+        }
+    }
+
+    std::vector<pid_t> children;
+    std::vector<ControlChannel> controls;
+    auto fail = [&](const std::string& reason) -> std::optional<ShardReport> {
+        std::cerr << "ShardLauncher: " << reason << std::endl;
+        for (pid_t child : children) kill(child, SIGKILL);
+        for (pid_t child : children) waitpid(child, nullptr, 0);
+        for (ControlChannel& control : controls) control.Close();
+        munmap(mapping, rings.bytes);
+        return std::nullopt;
+    };
+
+    std::cout.flush();
+    std::cerr.flush();
+    for (uint32_t shard = 0; shard < shards; ++shard) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            return fail(std::string("socketpair failed: ") + std::strerror(errno));
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            ::close(fds[0]);
+            ::close(fds[1]);
+            return fail(std::string("fork failed: ") + std::strerror(errno));
+        }
+        if (pid == 0) {
+            ::close(fds[0]);
+            for (ControlChannel& sibling : controls) sibling.Close();
+            ControlChannel control(fds[1]);
+            int code = RunShard(scenario, shard, shards, rings, control);
+            std::cout.clear();
+            std::cout.flush();
+            std::cerr.flush();
+            _exit(code);
+        }
+        ::close(fds[1]);
+        children.push_back(pid);
+        controls.emplace_back(fds[0]);
+    }
+
+    // Two barriers per epoch: after sending migrations, after receiving them
+    std::string line;
+    for (uint32_t epoch = 0; epoch < scenario.epochs; ++epoch) {
+        for (int phase = 0; phase < 2; ++phase) {
+            for (uint32_t shard = 0; shard < shards; ++shard) {
+                if (!controls[shard].ReadLine(line) || line != BarrierLine(epoch, phase)) {
+                    return fail("Shard " + std::to_string(shard) + " lost at epoch " + std::to_string(epoch));
+                }
+            }
+            for (ControlChannel& control : controls) {
+                if (!control.SendLine("GO")) return fail("Failed to release barrier");
+            }
+        }
+    }
+
+    ShardReport report;
+    for (uint32_t shard = 0; shard < shards; ++shard) {
+        std::optional<ShardMetrics> metrics;
+        if (!controls[shard].ReadLine(line) || !(metrics = ShardMetrics::FromLine(line))) {
+            return fail("Shard " + std::to_string(shard) + " sent no metrics");
+        }
+        report.shards.push_back(*metrics);
+    }
+    for (pid_t child : children) waitpid(child, nullptr, 0);
+    for (ControlChannel& control : controls) control.Close();
+    munmap(mapping, rings.bytes);
+
+    for (const ShardMetrics& m : report.shards) {
+        report.total.gnbs += m.gnbs;
+        report.total.ues += m.ues;
+        report.total.migratedOut += m.migratedOut;
+        report.total.migratedIn += m.migratedIn;
+        report.total.deferred += m.deferred;
+        report.total.events += m.events;
+        report.total.cellHandovers += m.cellHandovers;
+        report.total.wallMs = std::max(report.total.wallMs, m.wallMs);
+        report.total.maxRssKb = std::max(report.total.maxRssKb, m.maxRssKb);
+    }
+    return report;
+}
+
+#else
+
+std::optional<ShardReport> ShardLauncher::Launch(const ShardScenario&, size_t)
+{
+    std::cerr << "ShardLauncher: Multi-process shards are only supported on POSIX systems." << std::endl;
+    return std::nullopt;
+}
+
+#endif
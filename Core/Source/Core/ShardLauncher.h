@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Generated scenario for a sharded run. gNBs sit on a cols x rows grid
+// `spacing` apart; the area wraps around (torus), so UEs keep crossing
+// cells. Every shard derives the same scenario from `seed` and only
+// instantiates the UEs in its own region.
+struct ShardScenario {
+    uint32_t gnbCols = 8;
+    uint32_t gnbRows = 8;
+    uint32_t spacing = 2000;
+    uint64_t ueCount = 100000;
+    uint64_t seed = 1;
+
+    uint32_t epochs = 10;      // Barrier-synchronised exchange rounds
+    float epochLength = 1.0f;  // Simulated seconds per epoch
+    float tick = 0.1f;
+    float linkDelay = 0.01f;
+
+    size_t threadsPerShard = 1; // ParallelEngine workers inside each shard
+    size_t ringBytes = 8u << 20; // Per directed shard pair
+    bool pinCpus = false;       // Pin shard i to CPU i (first-touch keeps its memory local)
+    bool verbose = false;       // Keep shard stdout
+};
+
+// Per-shard counters, summed by the launcher
+struct ShardMetrics {
+    uint32_t shard = 0;
+    uint64_t gnbs = 0;
+    uint64_t ues = 0;            // At the end of the run
+    uint64_t migratedOut = 0;    // UEs sent to another shard
+    uint64_t migratedIn = 0;
+    uint64_t deferred = 0;       // Migrations postponed because a ring was full
+    uint64_t events = 0;
+    uint64_t cellHandovers = 0;  // Re-associations between cells of one shard
+    uint64_t wallMs = 0;
+    uint64_t maxRssKb = 0;
+
+    std::string ToLine() const;
+    static std::optional<ShardMetrics> FromLine(const std::string& line);
+};
+
+struct ShardReport {
+    std::vector<ShardMetrics> shards;
+    ShardMetrics total; // Sums; wallMs and maxRssKb are maxima
+
+    void Print(std::ostream& os = std::cout) const;
+};
+
+// Runs a World sharded by gNB region across local processes.
+//
+// Shard i owns a vertical strip of gNB columns and runs the regular
+// World::runCellSimulation for its cells, one epoch at a time. Between
+// epochs every UE that has moved into another shard's region is serialised
+// into a shared-memory ShmRing for that shard and removed locally; after a
+// barrier the receivers instantiate it. Barriers and metrics go over a Unix
+// socket pair per shard to the launcher.
+//
+// POSIX only; elsewhere Launch reports an error.
+class ShardLauncher {
+public:
+    static std::optional<ShardReport> Launch(const ShardScenario& scenario, size_t shards);
+};
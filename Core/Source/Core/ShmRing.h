@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <vector>
+
+// Single-producer/single-consumer ring of length-prefixed frames laid out
+// in a caller-provided block of memory, typically a mapping shared between
+// processes. Head and tail are monotonic byte offsets in lock-free atomics,
+// which are address-free and therefore valid across processes.
+//
+// Layout: [Header][capacity data bytes]. Frames are [u32 size][payload]
+// padded to 8 bytes; a frame that would straddle the end is preceded by a
+// wrap marker and starts again at offset 0.
+class ShmRing {
+public:
+    struct Header {
+        alignas(64) std::atomic<uint64_t> head; // Producer: next write offset
+        alignas(64) std::atomic<uint64_t> tail; // Consumer: next read offset
+        alignas(64) uint64_t capacity;
+    };
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "ShmRing needs address-free atomics");
+
+    ShmRing() = default;
+
+    // Bytes needed for a ring with `capacity` data bytes (multiple of 8)
+    static constexpr size_t Footprint(size_t capacity) { return sizeof(Header) + capacity; }
+
+    // Initialise a new ring in `memory` (aligned to 64 bytes)
+    static ShmRing Create(void* memory, size_t capacity)
+    {
+        Header* header = new (memory) Header;
+        header->head.store(0, std::memory_order_relaxed);
+        header->tail.store(0, std::memory_order_relaxed);
+        header->capacity = capacity & ~uint64_t(7);
+        return ShmRing(header);
+    }
+
+    // Use a ring another process has created
+    static ShmRing Attach(void* memory) { return ShmRing(static_cast<Header*>(memory)); }
+
+    // Largest payload a frame can carry
+    size_t MaxPayload() const { return m_Header->capacity / 2 - sizeof(uint32_t); }
+
+    // Producer side. Returns false if the ring lacks space right now.
+    bool TryWrite(const void* data, uint32_t size)
+    {
+        const uint64_t capacity = m_Header->capacity;
+        const uint64_t frame = Align(sizeof(uint32_t) + size);
+        if (size > MaxPayload()) return false;
+
+        uint64_t head = m_Header->head.load(std::memory_order_relaxed);
+        const uint64_t tail = m_Header->tail.load(std::memory_order_acquire);
+        uint64_t offset = head % capacity;
+        const uint64_t toEnd = capacity - offset;
+        const uint64_t needed = toEnd < frame ? toEnd + frame : frame;
+        if (capacity - (head - tail) < needed) return false;
+
+        if (toEnd < frame) {
+            WriteSize(offset, WrapMarker);
+            head += toEnd;
+            offset = 0;
+        }
+        WriteSize(offset, size);
+        std::memcpy(m_Data + offset + sizeof(uint32_t), data, size);
+        m_Header->head.store(head + frame, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if no frame is pending.
+    bool TryRead(std::vector<uint8_t>& out)
+    {
+        const uint64_t capacity = m_Header->capacity;
+        uint64_t tail = m_Header->tail.load(std::memory_order_relaxed);
+        const uint64_t head = m_Header->head.load(std::memory_order_acquire);
+        if (tail == head) return false;
+
+        uint64_t offset = tail % capacity;
+        uint32_t size = ReadSize(offset);
+        if (size == WrapMarker) {
+            tail += capacity - offset;
+            offset = 0;
+            size = ReadSize(offset);
+        }
+        out.assign(m_Data + offset + sizeof(uint32_t), m_Data + offset + sizeof(uint32_t) + size);
+        m_Header->tail.store(tail + Align(sizeof(uint32_t) + size), std::memory_order_release);
+        return true;
+    }
+
+private:
+    static constexpr uint32_t WrapMarker = 0xFFFFFFFFu;
+
+    explicit ShmRing(Header* header) : m_Header(header), m_Data(reinterpret_cast<uint8_t*>(header + 1)) {}
+
+    static constexpr uint64_t Align(uint64_t bytes) { return (bytes + 7) & ~uint64_t(7); }
+
+    void WriteSize(uint64_t offset, uint32_t size) { std::memcpy(m_Data + offset, &size, sizeof(size)); }
+    uint32_t ReadSize(uint64_t offset) const
+    {
+        uint32_t size;
+        std::memcpy(&size, m_Data + offset, sizeof(size));
+        return size;
+    }
+
+    Header* m_Header = nullptr;
+    uint8_t* m_Data = nullptr;
+};
@@ -0,0 +1,278 @@
+#include "Snapshot.h"
+#include "gNB.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+using namespace SnapshotFormat;
+
+namespace {
+
+    uint64_t AlignUp(uint64_t offset) { return (offset + SectionAlignment - 1) & ~uint64_t(SectionAlignment - 1); }
+
+} // namespace
+
+// --- SnapshotWriter ---
+
+void SnapshotWriter::PutBytes(Kyber::ByteView bytes)
+{
+    Put(static_cast<uint32_t>(bytes.size()));
+    m_Entities.insert(m_Entities.end(), reinterpret_cast<const char*>(bytes.data()),
+        reinterpret_cast<const char*>(bytes.data()) + bytes.size());
+}
+
+void SnapshotWriter::PutString(std::string_view str)
+{
+    Put(static_cast<uint32_t>(str.size()));
+    m_Entities.insert(m_Entities.end(), str.begin(), str.end());
+}
+
+void SnapshotWriter::PutInts(const std::vector<int>& values)
+{
+    Put(static_cast<uint32_t>(values.size()));
+    for (int value : values) Put<int32_t>(value);
+}
+
+void SnapshotWriter::PutTimestamp(const Kyber::Timestamp& time)
+{
+    Put<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count());
+}
+
+void SnapshotWriter::PutNetworkParams(const std::shared_ptr<const Kyber::NetworkParams>& params)
+{
+    auto it = params ? m_NetworkOwners.find(params.get()) : m_NetworkOwners.end();
+    Put<uint32_t>(it != m_NetworkOwners.end() ? it->second : NoID);
+}
+
+void SnapshotWriter::PutSubscriberTable(const std::shared_ptr<const SubscriberTable>& table)
+{
+    if (!table) {
+        Put<uint32_t>(NoID);
+        return;
+    }
+    auto [it, inserted] = m_TableIndex.try_emplace(table.get(), static_cast<uint32_t>(m_Tables.size()));
+    if (inserted) m_Tables.push_back(table.get());
+    Put<uint32_t>(it->second);
+}
+
+size_t SnapshotWriter::BeginEntity(const Entity& entity)
+{
+    size_t mark = m_Entities.size();
+    Position position = entity.GetPosition();
+    Velocity velocity = entity.GetVelocity();
+    Put(EntityHeader{ entity.GetID(), position.first, position.second, velocity.first, velocity.second, 0 });
+    return mark;
+}
+
+void SnapshotWriter::EndEntity(size_t mark)
+{
+    uint32_t payload = static_cast<uint32_t>(m_Entities.size() - mark - sizeof(EntityHeader));
+    std::memcpy(m_Entities.data() + mark + offsetof(EntityHeader, payloadBytes), &payload, sizeof(payload));
+}
+
+bool SnapshotWriter::WriteFile(const std::string& path) const
+{
+    struct Pending {
+        SectionEntry entry;
+        std::vector<char> column; // Empty for the entity stream
+    };
+    std::vector<Pending> sections;
+    sections.push_back({ SectionEntry{ static_cast<uint32_t>(Section::Entities), 0, 1, 0, 0, m_Entities.size() }, {} });
+    for (uint32_t t = 0; t < m_Tables.size(); ++t) {
+        const SubscriberTable& table = *m_Tables[t];
+        size_t supiWidth = std::max<size_t>(table.SUPIWidth(), 1);
+        size_t keyWidth = std::max<size_t>(table.KeyWidth(), 1);
+        std::vector<char> supis(table.Size() * supiWidth, '\0');
+        std::vector<char> keys(table.Size() * keyWidth, '\0');
+        for (size_t i = 0; i < table.Size(); ++i) {
+            std::string_view supi = table.SUPIAt(i), key = table.KeyAt(i);
+            std::memcpy(supis.data() + i * supiWidth, supi.data(), supi.size());
+            std::memcpy(keys.data() + i * keyWidth, key.data(), key.size());
+        }
+        sections.push_back({ SectionEntry{ static_cast<uint32_t>(Section::SubscriberSUPIs), t, static_cast<uint32_t>(supiWidth), 0, 0, table.Size() }, std::move(supis) });
+        sections.push_back({ SectionEntry{ static_cast<uint32_t>(Section::SubscriberKeys), t, static_cast<uint32_t>(keyWidth), 0, 0, table.Size() }, std::move(keys) });
+    }
+
+    uint64_t offset = sizeof(Header) + sections.size() * sizeof(SectionEntry);
+    for (Pending& section : sections) {
+        offset = AlignUp(offset);
+        section.entry.offset = offset;
+        offset += section.entry.count * section.entry.width;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.majorVersion = MajorVersion;
+    header.minorVersion = MinorVersion;
+    header.sectionCount = static_cast<uint32_t>(sections.size());
+    header.fileBytes = offset;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Snapshot: Cannot create " << path << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const Pending& section : sections) {
+        out.write(reinterpret_cast<const char*>(&section.entry), sizeof(SectionEntry));
+    }
+    uint64_t written = sizeof(Header) + sections.size() * sizeof(SectionEntry);
+    const char padding[SectionAlignment] = {};
+    for (const Pending& section : sections) {
+        const std::vector<char>& data = section.column.empty() ? m_Entities : section.column;
+        out.write(padding, static_cast<std::streamsize>(section.entry.offset - written));
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        written = section.entry.offset + data.size();
+    }
+    if (!out.flush()) {
+        std::cerr << "Snapshot: Write to " << path << " failed." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- SnapshotReader ---
+
+std::span<const char> SnapshotReader::Take(size_t size)
+{
+    if (m_Failed || size > m_Bytes.size() - m_Offset) {
+        m_Failed = true;
+        return {};
+    }
+    std::span<const char> bytes = m_Bytes.subspan(m_Offset, size);
+    m_Offset += size;
+    return bytes;
+}
+
+bool SnapshotReader::GetBytes(std::vector<uint8_t>& out)
+{
+    uint32_t size = 0;
+    if (!Get(size)) return false;
+    std::span<const char> bytes = Take(size);
+    if (!Ok()) return false;
+    out.assign(reinterpret_cast<const uint8_t*>(bytes.data()), reinterpret_cast<const uint8_t*>(bytes.data()) + bytes.size());
+    return true;
+}
+
+bool SnapshotReader::GetString(std::string& out)
+{
+    uint32_t size = 0;
+    if (!Get(size)) return false;
+    std::span<const char> bytes = Take(size);
+    if (!Ok()) return false;
+    out.assign(bytes.data(), bytes.size());
+    return true;
+}
+
+bool SnapshotReader::GetInts(std::vector<int>& out)
+{
+    uint32_t count = 0;
+    if (!Get(count) || count > (m_Bytes.size() - m_Offset) / sizeof(int32_t)) return Fail();
+    out.resize(count);
+    for (int& value : out) {
+        int32_t stored = 0;
+        Get(stored);
+        value = stored;
+    }
+    return Ok();
+}
+
+bool SnapshotReader::GetTimestamp(Kyber::Timestamp& out)
+{
+    int64_t micros = 0;
+    if (!Get(micros)) return false;
+    out = Kyber::Timestamp(std::chrono::duration_cast<Kyber::Timestamp::duration>(std::chrono::microseconds(micros)));
+    return true;
+}
+
+bool SnapshotReader::GetNetworkParams(std::shared_ptr<const Kyber::NetworkParams>& out, const SnapshotLinks& links)
+{
+    uint32_t gnbId = 0;
+    if (!Get(gnbId)) return false;
+    out = nullptr;
+    if (gnbId == NoID) return true;
+    gNB* owner = links.gnb(gnbId).Get();
+    if (!owner) return Fail();
+    out = owner->GetNetworkParams();
+    return true;
+}
+
+bool SnapshotReader::GetSubscriberTable(std::shared_ptr<const SubscriberTable>& out)
+{
+    uint32_t index = 0;
+    if (!Get(index)) return false;
+    out = nullptr;
+    if (index == NoID) return true;
+    if (!m_Tables || index >= m_Tables->size() || !(*m_Tables)[index]) return Fail();
+    out = (*m_Tables)[index];
+    return true;
+}
+
+// --- SnapshotImage ---
+
+std::shared_ptr<const SnapshotImage> SnapshotImage::Open(const std::string& path)
+{
+    auto fail = [&](const char* reason) {
+        std::cerr << "Snapshot: " << path << ": " << reason << std::endl;
+        return nullptr;
+    };
+
+    std::shared_ptr<SnapshotImage> image(new SnapshotImage());
+    image->m_File = MappedFile::Open(path);
+    if (!image->m_File) return nullptr;
+    const char* data = image->m_File->Data();
+    const size_t size = image->m_File->Size();
+
+    Header header;
+    if (size < sizeof(Header)) return fail("file too short");
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) return fail("not a snapshot file");
+    if (header.majorVersion != MajorVersion) return fail("unsupported snapshot version");
+    if (header.fileBytes != size) return fail("truncated or padded file");
+    uint64_t tableEnd = sizeof(Header) + uint64_t(header.sectionCount) * sizeof(SectionEntry);
+    if (tableEnd > size) return fail("section table out of range");
+
+    // SUPI and key columns per table, paired up after the scan
+    struct Column {
+        const char* data = nullptr;
+        uint32_t width = 0;
+        uint64_t count = 0;
+    };
+    std::map<uint32_t, std::pair<Column, Column>> columns;
+    bool haveEntities = false;
+    for (uint32_t i = 0; i < header.sectionCount; ++i) {
+        SectionEntry entry;
+        std::memcpy(&entry, data + sizeof(Header) + i * sizeof(SectionEntry), sizeof(entry));
+        if (entry.width == 0 || entry.offset < tableEnd || entry.offset > size
+            || entry.count > (size - entry.offset) / entry.width) {
+            return fail("section out of range");
+        }
+        const char* begin = data + entry.offset;
+        switch (static_cast<Section>(entry.section)) {
+        case Section::Entities:
+            image->m_Entities = std::span<const char>(begin, entry.count);
+            haveEntities = true;
+            break;
+        case Section::SubscriberSUPIs:
+            columns[entry.index].first = Column{ begin, entry.width, entry.count };
+            break;
+        case Section::SubscriberKeys:
+            columns[entry.index].second = Column{ begin, entry.width, entry.count };
+            break;
+        default:
+            break; // Newer minor version
+        }
+    }
+    if (!haveEntities) return fail("missing entity section");
+
+    for (const auto& [index, pair] : columns) {
+        const auto& [supis, keys] = pair;
+        if (!supis.data || !keys.data || supis.count != keys.count) return fail("incomplete subscriber table");
+        if (index >= image->m_Tables.size()) image->m_Tables.resize(index + 1);
+        image->m_Tables[index] = std::make_shared<const SubscriberTable>(image->m_File, supis.data, supis.width,
+            keys.data, keys.width, static_cast<size_t>(supis.count));
+    }
+    return image;
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "Entity.h"
+#include "EntityPool.h"
+#include "KyberUtils.h"
+#include "MappedFile.h"
+#include "StateMachine.h"
+#include "SubscriberTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+class UE;
+class UAV;
+class gNB;
+
+// World snapshot file (.ksnap).
+//
+// Layout, all little-endian:
+//   [Header][SectionEntry x sectionCount][section data ...]
+// The Entities section holds three counts (gNBs, UAVs, UEs) followed by one
+// record per entity: an EntityHeader (ID, position, velocity, payload size)
+// and the entity's own payload. Subscriber tables are stored once each as
+// fixed-width SUPI/key columns in SUPI order and are attached to gNBs in
+// place after a restore, exactly like a scenario file's.
+namespace SnapshotFormat {
+    constexpr char Magic[8] = { 'K', 'S', 'I', 'M', 'S', 'N', 'A', 'P' };
+    constexpr uint16_t MajorVersion = 3;
+    constexpr uint16_t MinorVersion = 0;
+    constexpr size_t SectionAlignment = 64;
+    constexpr uint32_t NoID = UINT32_MAX;
+
+    enum class Section : uint32_t { Entities, SubscriberSUPIs, SubscriberKeys };
+
+    struct Header {
+        char magic[8];
+        uint16_t majorVersion;
+        uint16_t minorVersion;
+        uint32_t sectionCount;
+        uint64_t fileBytes;
+    };
+    static_assert(sizeof(Header) == 24, "Snapshot header layout changed");
+
+    struct SectionEntry {
+        uint32_t section; // Section enum value
+        uint32_t index;   // Subscriber table number
+        uint32_t width;   // Bytes per record (1 for the entity stream)
+        uint32_t reserved;
+        uint64_t offset;
+        uint64_t count;   // Records
+    };
+    static_assert(sizeof(SectionEntry) == 32, "Snapshot section entry layout changed");
+
+    struct EntityHeader {
+        uint32_t id;
+        uint32_t x, y;
+        uint32_t vx, vy;
+        uint32_t payloadBytes;
+    };
+}
+
+// Serialises entity state. Entities append their payload with the Put*
+// helpers; shared subscriber tables and network parameters are written by
+// reference and resolved again by the reader.
+class SnapshotWriter {
+public:
+    template<typename T>
+    void Put(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Put needs a trivially copyable type");
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        m_Entities.insert(m_Entities.end(), bytes, bytes + sizeof(T));
+    }
+
+    void PutBytes(Kyber::ByteView bytes);
+    void PutString(std::string_view str);
+    void PutInts(const std::vector<int>& values);
+    void PutTimestamp(const Kyber::Timestamp& time);
+
+    template<typename Traits>
+    void PutState(const StateMachine<Traits>& machine) { Put(static_cast<uint8_t>(machine.Current())); }
+
+    // ID of the referenced entity, or NoID if it is gone
+    template<typename T>
+    void PutRef(const EntityRef<T>& ref)
+    {
+        const T* entity = ref.Get();
+        Put<uint32_t>(entity ? entity->GetID() : SnapshotFormat::NoID);
+    }
+
+    // Network parameters are recorded as the ID of the gNB that owns them
+    void AddNetworkOwner(const Kyber::NetworkParams* params, uint32_t gnbId) { m_NetworkOwners[params] = gnbId; }
+    void PutNetworkParams(const std::shared_ptr<const Kyber::NetworkParams>& params);
+
+    // Tables shared by several gNBs are stored once
+    void PutSubscriberTable(const std::shared_ptr<const SubscriberTable>& table);
+
+    // Frame one entity record; EndEntity patches the payload size
+    size_t BeginEntity(const Entity& entity);
+    void EndEntity(size_t mark);
+
+    bool WriteFile(const std::string& path) const;
+
+private:
+    std::vector<char> m_Entities;
+    std::unordered_map<const Kyber::NetworkParams*, uint32_t> m_NetworkOwners;
+    std::vector<const SubscriberTable*> m_Tables;
+    std::unordered_map<const SubscriberTable*, uint32_t> m_TableIndex;
+};
+
+// Resolves IDs recorded in a snapshot to restored entities
+struct SnapshotLinks {
+    std::function<EntityRef<UE>(uint32_t)> ue;
+    std::function<EntityRef<UAV>(uint32_t)> uav;
+    std::function<EntityRef<gNB>(uint32_t)> gnb;
+};
+
+// Bounds-checked cursor over snapshot bytes. A failed read leaves the
+// reader failed and every later read returns false, so callers can read a
+// whole payload and check Ok() once.
+class SnapshotReader {
+public:
+    SnapshotReader(std::span<const char> bytes, const std::vector<std::shared_ptr<const SubscriberTable>>* tables = nullptr)
+        : m_Bytes(bytes), m_Tables(tables) {}
+
+    template<typename T>
+    bool Get(T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Get needs a trivially copyable type");
+        std::span<const char> bytes = Take(sizeof(T));
+        if (bytes.empty()) return false;
+        std::memcpy(&value, bytes.data(), sizeof(T));
+        return true;
+    }
+
+    bool GetBytes(std::vector<uint8_t>& out);
+    bool GetString(std::string& out);
+    bool GetInts(std::vector<int>& out);
+    bool GetTimestamp(Kyber::Timestamp& out);
+
+    // Straight from the mapped bytes into inline storage
+    template<size_t N>
+    bool GetBytes(Kyber::FixedBytes<N>& out)
+    {
+        uint32_t size = 0;
+        if (!Get(size)) return false;
+        std::span<const char> bytes = Take(size);
+        if (size && bytes.empty()) return false;
+        if (!out.Assign(Kyber::ByteView(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size()))) return Fail();
+        return true;
+    }
+
+    template<typename Traits>
+    bool GetState(StateMachine<Traits>& machine)
+    {
+        uint8_t state = 0;
+        if (!Get(state)) return false;
+        return machine.Restore(static_cast<typename Traits::State>(state)) || Fail();
+    }
+
+    template<typename T>
+    bool GetRef(EntityRef<T>& out, const std::function<EntityRef<T>(uint32_t)>& resolve)
+    {
+        uint32_t id = 0;
+        if (!Get(id)) return false;
+        out = id == SnapshotFormat::NoID ? EntityRef<T>() : resolve(id);
+        return true;
+    }
+
+    bool GetNetworkParams(std::shared_ptr<const Kyber::NetworkParams>& out, const SnapshotLinks& links);
+    bool GetSubscriberTable(std::shared_ptr<const SubscriberTable>& out);
+
+    // Next `size` bytes, or an empty span (and failure) if fewer remain
+    std::span<const char> Take(size_t size);
+
+    // Reader over the next `size` bytes (an entity payload)
+    SnapshotReader Sub(size_t size) { return SnapshotReader(Take(size), m_Tables); }
+
+    inline bool Ok() const { return !m_Failed; }
+    inline bool AtEnd() const { return m_Offset == m_Bytes.size(); }
+
+private:
+    bool Fail()
+    {
+        m_Failed = true;
+        return false;
+    }
+
+    std::span<const char> m_Bytes;
+    size_t m_Offset = 0;
+    bool m_Failed = false;
+    const std::vector<std::shared_ptr<const SubscriberTable>>* m_Tables;
+};
+
+// A mapped snapshot file: the entity stream plus subscriber tables that
+// point into the mapping.
+class SnapshotImage {
+public:
+    // Reports to std::cerr and returns null on error
+    static std::shared_ptr<const SnapshotImage> Open(const std::string& path);
+
+    SnapshotReader Reader() const { return SnapshotReader(m_Entities, &m_Tables); }
+
+private:
+    std::shared_ptr<const MappedFile> m_File;
+    std::span<const char> m_Entities;
+    std::vector<std::shared_ptr<const SubscriberTable>> m_Tables;
+};
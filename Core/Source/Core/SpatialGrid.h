@@ -0,0 +1,159 @@
+#pragma once
+
+#include "Entity.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid of points for nearest-neighbour queries.
+//
+// Points are bucketed by cell; a query scans rings of cells outward from
+// the query's cell and stops as soon as no unscanned ring can hold anything
+// closer than the best match, so lookups cost a few cells instead of a scan
+// of every point. Rebuild it (Clear + Insert) when the points move.
+class SpatialGrid {
+public:
+    SpatialGrid() = default;
+    explicit SpatialGrid(uint32_t cellSize) : m_CellSize(std::max<uint32_t>(cellSize, 1)) {}
+
+    void Clear()
+    {
+        m_Cells.clear();
+        m_Count = 0;
+    }
+
+    void Insert(uint32_t item, const Position& pos)
+    {
+        uint32_t cx = pos.first / m_CellSize, cy = pos.second / m_CellSize;
+        if (m_Count == 0) {
+            m_MinCX = m_MaxCX = cx;
+            m_MinCY = m_MaxCY = cy;
+        }
+        m_MinCX = std::min(m_MinCX, cx);
+        m_MaxCX = std::max(m_MaxCX, cx);
+        m_MinCY = std::min(m_MinCY, cy);
+        m_MaxCY = std::max(m_MaxCY, cy);
+        m_Cells[Key(cx, cy)].push_back({ item, pos });
+        m_Count++;
+    }
+
+    inline size_t Size() const { return m_Count; }
+
+    static uint64_t DistanceSq(const Position& a, const Position& b)
+    {
+        int64_t dx = static_cast<int64_t>(a.first) - b.first;
+        int64_t dy = static_cast<int64_t>(a.second) - b.second;
+        return static_cast<uint64_t>(dx * dx + dy * dy);
+    }
+
+    // Nearest item to `pos` for which accept(item) is true
+    template<typename Accept>
+    std::optional<uint32_t> Nearest(const Position& pos, Accept&& accept) const
+    {
+        if (m_Count == 0) return std::nullopt;
+        const int64_t cx = pos.first / m_CellSize, cy = pos.second / m_CellSize;
+        // Rings beyond this cover no occupied cell
+        const int64_t maxRing = std::max({ cx - m_MinCX, int64_t(m_MaxCX) - cx, cy - m_MinCY, int64_t(m_MaxCY) - cy, int64_t(0) });
+
+        std::optional<uint32_t> best;
+        uint64_t bestDistSq = std::numeric_limits<uint64_t>::max();
+        auto scan = [&](int64_t x, int64_t y) {
+            if (x < m_MinCX || x > m_MaxCX || y < m_MinCY || y > m_MaxCY) return;
+            auto it = m_Cells.find(Key(static_cast<uint32_t>(x), static_cast<uint32_t>(y)));
+            if (it == m_Cells.end()) return;
+            for (const Point& point : it->second) {
+                uint64_t distSq = DistanceSq(point.pos, pos);
+                if (distSq < bestDistSq && accept(point.item)) {
+                    bestDistSq = distSq;
+                    best = point.item;
+                }
+            }
+        };
+
+        for (int64_t ring = 0; ring <= maxRing; ++ring) {
+            if (ring == 0) {
+                scan(cx, cy);
+            } else {
+                for (int64_t d = -ring; d <= ring; ++d) {
+                    scan(cx + d, cy - ring);
+                    scan(cx + d, cy + ring);
+                }
+                for (int64_t d = -ring + 1; d < ring; ++d) {
+                    scan(cx - ring, cy + d);
+                    scan(cx + ring, cy + d);
+                }
+            }
+            // Anything in ring + 1 or further is at least ring cells away
+            uint64_t reach = static_cast<uint64_t>(ring) * m_CellSize;
+            if (best && bestDistSq <= reach * reach) break;
+        }
+        return best;
+    }
+
+    std::optional<uint32_t> Nearest(const Position& pos) const
+    {
+        return Nearest(pos, [](uint32_t) { return true; });
+    }
+
+    // Item with the lowest cost(item, distance), skipping infinite costs.
+    // The cost must be at least distanceWeight * distance, so rings that far
+    // away can stop the search once they cannot beat the best match.
+    template<typename Cost>
+    std::optional<uint32_t> Cheapest(const Position& pos, double distanceWeight, Cost&& cost) const
+    {
+        if (m_Count == 0) return std::nullopt;
+        const int64_t cx = pos.first / m_CellSize, cy = pos.second / m_CellSize;
+        const int64_t maxRing = std::max({ cx - m_MinCX, int64_t(m_MaxCX) - cx, cy - m_MinCY, int64_t(m_MaxCY) - cy, int64_t(0) });
+
+        std::optional<uint32_t> best;
+        double bestCost = std::numeric_limits<double>::infinity();
+        auto scan = [&](int64_t x, int64_t y) {
+            if (x < m_MinCX || x > m_MaxCX || y < m_MinCY || y > m_MaxCY) return;
+            auto it = m_Cells.find(Key(static_cast<uint32_t>(x), static_cast<uint32_t>(y)));
+            if (it == m_Cells.end()) return;
+            for (const Point& point : it->second) {
+                double value = cost(point.item, std::sqrt(static_cast<double>(DistanceSq(point.pos, pos))));
+                if (value < bestCost) {
+                    bestCost = value;
+                    best = point.item;
+                }
+            }
+        };
+
+        for (int64_t ring = 0; ring <= maxRing; ++ring) {
+            if (ring == 0) {
+                scan(cx, cy);
+            } else {
+                for (int64_t d = -ring; d <= ring; ++d) {
+                    scan(cx + d, cy - ring);
+                    scan(cx + d, cy + ring);
+                }
+                for (int64_t d = -ring + 1; d < ring; ++d) {
+                    scan(cx - ring, cy + d);
+                    scan(cx + ring, cy + d);
+                }
+            }
+            if (best && bestCost <= distanceWeight * static_cast<double>(ring) * m_CellSize) break;
+        }
+        return best;
+    }
+
+private:
+    struct Point {
+        uint32_t item;
+        Position pos;
+    };
+
+    static uint64_t Key(uint32_t cx, uint32_t cy) { return (static_cast<uint64_t>(cx) << 32) | cy; }
+
+    uint32_t m_CellSize = 250;
+    std::unordered_map<uint64_t, std::vector<Point>> m_Cells;
+    size_t m_Count = 0;
+    uint32_t m_MinCX = 0, m_MaxCX = 0, m_MinCY = 0, m_MaxCY = 0;
+};
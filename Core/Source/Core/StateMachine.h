@@ -0,0 +1,200 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+// One row of a compile-time transition table. `handler` (may be null) runs
+// after the machine has moved to `to`.
+template<typename State, typename Event, typename Handler>
+struct StateTransition {
+    State from;
+    Event event;
+    State to;
+    Handler handler = nullptr;
+};
+
+// Table-driven protocol state machine.
+//
+// Traits supplies:
+//   State, Event      enum classes ending in a `Count` enumerator
+//   Initial           initial State
+//   Handler           function pointer type invoked with Fire()'s extra args
+//   Table             static constexpr std::array of StateTransition rows
+//   Name              static constexpr const char*
+//   StateName/EventName  const char* lookups for reports
+//
+// The table is folded into a constexpr [state][event] index at compile time
+// (duplicate rows fail to compile), so Fire() is one array load plus the
+// bookkeeping below. Occupancy (live machines per state) and per-transition
+// dwell time in the source state are aggregated per Traits across all
+// instances with relaxed atomics. The stats are process-wide, not per owner:
+// ResetStats() starts a new run's transition counts.
+template<typename Traits>
+class StateMachine {
+public:
+    using State = typename Traits::State;
+    using Event = typename Traits::Event;
+
+    static constexpr size_t StateCount = static_cast<size_t>(State::Count);
+    static constexpr size_t EventCount = static_cast<size_t>(Event::Count);
+    static constexpr size_t TransitionCount = Traits::Table.size();
+
+    struct TransitionStats {
+        std::atomic<uint64_t> count{ 0 };
+        std::atomic<uint64_t> totalNs{ 0 };
+        std::atomic<uint64_t> maxNs{ 0 };
+    };
+
+    struct Stats {
+        std::array<std::atomic<int64_t>, StateCount> occupancy{};
+        std::array<TransitionStats, TransitionCount> transitions{};
+        std::atomic<uint64_t> rejected{ 0 }; // Events with no row for the current state
+    };
+
+    StateMachine() : StateMachine(Traits::Initial) {}
+    explicit StateMachine(State initial) : m_State(initial), m_Entered(Clock::now()) { Enter(m_State); }
+
+    // Copies count as additional occupants of the same state
+    StateMachine(const StateMachine& other) : m_State(other.m_State), m_Entered(other.m_Entered) { Enter(m_State); }
+    StateMachine& operator=(const StateMachine& other)
+    {
+        if (this != &other) {
+            Leave(m_State);
+            m_State = other.m_State;
+            m_Entered = other.m_Entered;
+            Enter(m_State);
+        }
+        return *this;
+    }
+    ~StateMachine() { Leave(m_State); }
+
+    State Current() const { return m_State; }
+    bool Is(State state) const { return m_State == state; }
+    bool CanFire(Event event) const { return s_Lookup[Index(m_State)][Index(event)] >= 0; }
+
+    // Jump straight to `state` without a transition (snapshot restore).
+    // Invalid values leave the state unchanged and return false.
+    bool Restore(State state)
+    {
+        if (Index(state) >= StateCount) return false;
+        Leave(m_State);
+        m_State = state;
+        m_Entered = Clock::now();
+        Enter(m_State);
+        return true;
+    }
+
+    // Apply `event`. Returns false (state unchanged) if the table has no row
+    // for the current state; otherwise transitions and calls the row's
+    // handler with `args`.
+    template<typename... Args>
+    bool Fire(Event event, Args&&... args)
+    {
+        int16_t row = s_Lookup[Index(m_State)][Index(event)];
+        Stats& stats = GetStats();
+        if (row < 0) {
+            stats.rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        const auto& transition = Traits::Table[row];
+        auto now = Clock::now();
+        uint64_t dwellNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_Entered).count());
+        auto& counters = stats.transitions[row];
+        counters.count.fetch_add(1, std::memory_order_relaxed);
+        counters.totalNs.fetch_add(dwellNs, std::memory_order_relaxed);
+        uint64_t prevMax = counters.maxNs.load(std::memory_order_relaxed);
+        while (dwellNs > prevMax && !counters.maxNs.compare_exchange_weak(prevMax, dwellNs, std::memory_order_relaxed)) {}
+
+        Leave(m_State);
+        m_State = transition.to;
+        m_Entered = now;
+        Enter(m_State);
+
+        if (transition.handler) transition.handler(std::forward<Args>(args)...);
+        return true;
+    }
+
+    static Stats& GetStats()
+    {
+        static Stats stats;
+        return stats;
+    }
+
+    // Zero transition and rejection counts. Occupancy tracks live machines
+    // and is left alone.
+    static void ResetStats()
+    {
+        Stats& stats = GetStats();
+        for (TransitionStats& counters : stats.transitions) {
+            counters.count.store(0, std::memory_order_relaxed);
+            counters.totalNs.store(0, std::memory_order_relaxed);
+            counters.maxNs.store(0, std::memory_order_relaxed);
+        }
+        stats.rejected.store(0, std::memory_order_relaxed);
+    }
+
+    static void PrintReport(std::ostream& os = std::cout)
+    {
+        const Stats& stats = GetStats();
+        std::ios::fmtflags flags = os.flags();
+        std::streamsize precision = os.precision();
+        os << "\n--- State Machine: " << Traits::Name << " ---" << std::endl;
+        os << "Occupancy:";
+        for (size_t s = 0; s < StateCount; ++s) {
+            os << " " << Traits::StateName(static_cast<State>(s)) << "=" << stats.occupancy[s].load(std::memory_order_relaxed);
+        }
+        os << std::endl;
+
+        for (size_t i = 0; i < TransitionCount; ++i) {
+            const auto& t = Traits::Table[i];
+            uint64_t count = stats.transitions[i].count.load(std::memory_order_relaxed);
+            if (count == 0) continue;
+            double avgUs = static_cast<double>(stats.transitions[i].totalNs.load(std::memory_order_relaxed)) / count / 1000.0;
+            double maxUs = static_cast<double>(stats.transitions[i].maxNs.load(std::memory_order_relaxed)) / 1000.0;
+            os << "  " << std::left << std::setw(18) << Traits::StateName(t.from)
+               << " --" << std::setw(20) << Traits::EventName(t.event) << "-> "
+               << std::setw(18) << Traits::StateName(t.to) << std::right
+               << " n=" << count
+               << std::fixed << std::setprecision(1)
+               << " avg=" << avgUs << "us max=" << maxUs << "us" << std::endl;
+            os.flags(flags);
+            os.precision(precision);
+        }
+        os << "Rejected events: " << stats.rejected.load(std::memory_order_relaxed) << std::endl;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    using LookupTable = std::array<std::array<int16_t, EventCount>, StateCount>;
+
+    template<typename E>
+    static constexpr size_t Index(E value) { return static_cast<size_t>(value); }
+
+    static constexpr LookupTable BuildLookup()
+    {
+        static_assert(TransitionCount < 0x7fff, "Transition table too large");
+        LookupTable lookup{};
+        for (auto& row : lookup) row.fill(-1);
+        for (size_t i = 0; i < TransitionCount; ++i) {
+            int16_t& cell = lookup[Index(Traits::Table[i].from)][Index(Traits::Table[i].event)];
+            if (cell >= 0) throw "StateMachine: duplicate (state, event) row"; // Not a constant expression -> compile error
+            cell = static_cast<int16_t>(i);
+        }
+        return lookup;
+    }
+
+    static constexpr LookupTable s_Lookup = BuildLookup();
+
+    static void Enter(State state) { GetStats().occupancy[Index(state)].fetch_add(1, std::memory_order_relaxed); }
+    static void Leave(State state) { GetStats().occupancy[Index(state)].fetch_sub(1, std::memory_order_relaxed); }
+
+    State m_State;
+    Clock::time_point m_Entered;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+// Read-only SUPI -> long-term key table over fixed-width, NUL-padded
+// records sorted by SUPI, usually pointing straight into a mapped scenario
+// file. `owner` keeps that storage alive; lookups are a binary search.
+class SubscriberTable {
+public:
+    SubscriberTable(std::shared_ptr<const void> owner, const char* supis, size_t supiWidth,
+        const char* keys, size_t keyWidth, size_t count)
+        : m_Owner(std::move(owner)), m_SUPIs(supis), m_Keys(keys),
+          m_SUPIWidth(supiWidth), m_KeyWidth(keyWidth), m_Count(count) {}
+
+    inline size_t Size() const { return m_Count; }
+    inline size_t SUPIWidth() const { return m_SUPIWidth; }
+    inline size_t KeyWidth() const { return m_KeyWidth; }
+
+    std::string_view SUPIAt(size_t index) const { return Field(m_SUPIs + index * m_SUPIWidth, m_SUPIWidth); }
+    std::string_view KeyAt(size_t index) const { return Field(m_Keys + index * m_KeyWidth, m_KeyWidth); }
+
+    // Record number of `supi`
+    std::optional<size_t> FindIndex(std::string_view supi) const
+    {
+        size_t low = 0, high = m_Count;
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            if (SUPIAt(mid) < supi) low = mid + 1;
+            else high = mid;
+        }
+        if (low == m_Count || SUPIAt(low) != supi) return std::nullopt;
+        return low;
+    }
+
+    std::optional<std::string_view> FindKey(std::string_view supi) const
+    {
+        std::optional<size_t> index = FindIndex(supi);
+        if (!index) return std::nullopt;
+        return KeyAt(*index);
+    }
+
+private:
+    static std::string_view Field(const char* record, size_t width)
+    {
+        const void* end = std::memchr(record, '\0', width);
+        return std::string_view(record, end ? static_cast<const char*>(end) - record : width);
+    }
+
+    std::shared_ptr<const void> m_Owner;
+    const char* m_SUPIs;
+    const char* m_Keys;
+    size_t m_SUPIWidth;
+    size_t m_KeyWidth;
+    size_t m_Count;
+};
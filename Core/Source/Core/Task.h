@@ -0,0 +1,121 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+// Lazily started, move-only coroutine returning T.
+//
+// The body does not run until the task is co_awaited; when it finishes it
+// resumes the awaiting coroutine directly (symmetric transfer), so chains
+// of nested tasks do not grow the stack. Exceptions escaping the body are
+// rethrown at the co_await site.
+template<typename T>
+class Task;
+
+namespace Detail {
+
+    template<typename Promise>
+    struct TaskFinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            if (auto continuation = handle.promise().continuation) return continuation;
+            return std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    struct TaskPromiseBase {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr exception;
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        void unhandled_exception() noexcept { exception = std::current_exception(); }
+    };
+
+} // namespace Detail
+
+template<typename T>
+class Task {
+public:
+    struct promise_type : Detail::TaskPromiseBase {
+        std::optional<T> value;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        Detail::TaskFinalAwaiter<promise_type> final_suspend() const noexcept { return {}; }
+        template<typename U>
+        void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+    };
+
+    Task(Task&& other) noexcept : m_Handle(std::exchange(other.m_Handle, nullptr)) {}
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other) {
+            if (m_Handle) m_Handle.destroy();
+            m_Handle = std::exchange(other.m_Handle, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { if (m_Handle) m_Handle.destroy(); }
+
+    bool await_ready() const noexcept { return !m_Handle || m_Handle.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        m_Handle.promise().continuation = awaiting;
+        return m_Handle;
+    }
+    T await_resume()
+    {
+        promise_type& promise = m_Handle.promise();
+        if (promise.exception) std::rethrow_exception(promise.exception);
+        return std::move(*promise.value);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_Handle(handle) {}
+
+    std::coroutine_handle<promise_type> m_Handle;
+};
+
+template<>
+class Task<void> {
+public:
+    struct promise_type : Detail::TaskPromiseBase {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        Detail::TaskFinalAwaiter<promise_type> final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+    };
+
+    Task(Task&& other) noexcept : m_Handle(std::exchange(other.m_Handle, nullptr)) {}
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other) {
+            if (m_Handle) m_Handle.destroy();
+            m_Handle = std::exchange(other.m_Handle, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { if (m_Handle) m_Handle.destroy(); }
+
+    bool await_ready() const noexcept { return !m_Handle || m_Handle.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        m_Handle.promise().continuation = awaiting;
+        return m_Handle;
+    }
+    void await_resume()
+    {
+        if (m_Handle.promise().exception) std::rethrow_exception(m_Handle.promise().exception);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_Handle(handle) {}
+
+    std::coroutine_handle<promise_type> m_Handle;
+};
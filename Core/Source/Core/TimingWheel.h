@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timing wheel (Varghese & Lauck) used to expire protocol state.
+//
+// Four levels of 64 slots; level L slot spans 64^L ticks, so the wheel covers
+// 64^4 (~16.7M) ticks before clamping. An entry cascades down at most once per
+// level, giving O(1) amortized work per entry per expiry. Cancellation is lazy:
+// the owner keeps the authoritative deadline in its own table and ignores
+// fired entries whose deadline no longer matches.
+template<typename Key>
+class TimingWheel {
+public:
+    static constexpr uint32_t SlotBits = 6;
+    static constexpr uint32_t SlotsPerLevel = 1u << SlotBits;
+    static constexpr uint32_t Levels = 4;
+    static constexpr uint64_t Span = uint64_t(1) << (SlotBits * Levels);
+
+    explicit TimingWheel(uint64_t startTick = 0) : m_CurrentTick(startTick) {}
+
+    uint64_t CurrentTick() const { return m_CurrentTick; }
+    size_t Size() const { return m_Size; }
+
+    // Schedule `key` to fire once the wheel reaches `expiryTick`. Deadlines
+    // in the past fire on the next advance.
+    void Schedule(const Key& key, uint64_t expiryTick)
+    {
+        if (expiryTick <= m_CurrentTick) expiryTick = m_CurrentTick + 1;
+        Place({ key, expiryTick });
+        ++m_Size;
+    }
+
+    // Advance to `nowTick`, invoking onExpire(key, expiryTick) for every entry
+    // whose deadline has passed. Returns the number of entries fired.
+    template<typename Fn>
+    size_t Advance(uint64_t nowTick, Fn&& onExpire)
+    {
+        size_t fired = 0;
+        while (m_CurrentTick < nowTick) {
+            if (m_Size == 0) { m_CurrentTick = nowTick; break; }
+            ++m_CurrentTick;
+
+            // Cascade higher levels whose boundary we just crossed, highest first
+            for (uint32_t level = Levels - 1; level > 0; --level) {
+                uint64_t mask = (uint64_t(1) << (SlotBits * level)) - 1;
+                if ((m_CurrentTick & mask) != 0) continue;
+                auto& slot = m_Slots[level][SlotIndex(m_CurrentTick, level)];
+                std::vector<Entry> moved;
+                moved.swap(slot);
+                for (auto& entry : moved) Place(entry);
+            }
+
+            auto& due = m_Slots[0][SlotIndex(m_CurrentTick, 0)];
+            if (due.empty()) continue;
+            std::vector<Entry> firing;
+            firing.swap(due);
+            for (auto& entry : firing) {
+                if (entry.expiry > m_CurrentTick) { Place(entry); continue; } // clamped entry, not yet due
+                --m_Size;
+                ++fired;
+                onExpire(entry.key, entry.expiry);
+            }
+        }
+        return fired;
+    }
+
+private:
+    struct Entry {
+        Key key;
+        uint64_t expiry;
+    };
+
+    static size_t SlotIndex(uint64_t tick, uint32_t level)
+    {
+        return static_cast<size_t>((tick >> (SlotBits * level)) & (SlotsPerLevel - 1));
+    }
+
+    void Place(const Entry& entry)
+    {
+        // Deadlines beyond the wheel span are parked at the furthest reachable
+        // slot and re-placed when they cascade.
+        uint64_t placeAt = entry.expiry;
+        if (placeAt - m_CurrentTick >= Span) placeAt = m_CurrentTick + Span - 1;
+
+        uint64_t diff = placeAt ^ m_CurrentTick;
+        uint32_t level = 0;
+        while (level + 1 < Levels && diff >= (uint64_t(1) << (SlotBits * (level + 1)))) ++level;
+        m_Slots[level][SlotIndex(placeAt, level)].push_back(entry);
+    }
+
+    std::array<std::array<std::vector<Entry>, SlotsPerLevel>, Levels> m_Slots;
+    uint64_t m_CurrentTick = 0;
+    size_t m_Size = 0;
+};
+
+// --- Auth-state expiry policy shared by gNB and UAV tables ---
+
+constexpr uint32_t AuthStateTickMs = 100; // Wheel resolution
+
+struct AuthStateLimits {
+    uint32_t pendingAuthTimeoutMs = 10000;  // Abandoned Phase A/B/C exchanges
+    uint32_t sessionLifetimeMs = 3600000;   // Sessions with no known TST (matches token validity)
+    size_t maxPendingAuths = 65536;         // Cap per pending-auth table
+    size_t maxSessions = 1 << 20;           // Cap on established per-UE sessions
+};
+
+struct AuthStateStats {
+    uint64_t expiredPending = 0;   // Pending auths evicted after timeout
+    uint64_t expiredSessions = 0;  // Sessions evicted at TST / lifetime
+    uint64_t released = 0;         // Sessions removed by explicit release
+    uint64_t capacityRejects = 0;  // Inserts refused because a table was full
+};
+
+// Wall-clock tick source; TST deadlines are system_clock based.
+inline uint64_t AuthStateTick(const std::chrono::system_clock::time_point& t)
+{
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+    return static_cast<uint64_t>(ms) / AuthStateTickMs;
+}
+
+inline uint64_t AuthStateNowTick() { return AuthStateTick(std::chrono::system_clock::now()); }
+
+inline uint64_t AuthStateTicksFromMs(uint32_t ms) { return (ms + AuthStateTickMs - 1) / AuthStateTickMs; }
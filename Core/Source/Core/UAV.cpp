@@ -2,22 +2,253 @@
 #include "gNB.h" // Include gNB to call its methods
 #include "UE.h"  // Include UE to call its methods
 #include "KyberUtils.h"
+#include "PerfCounters.h"
+#include "AuthArena.h"
+#include "Snapshot.h"
 #include <iostream>
+#include <cmath>
 #include <stdexcept> // For exceptions
 #include <string>    // Ensure string is included
 #include <vector>    // Ensure vector is included
 
-// Helper to get associated gNB shared_ptr
-std::shared_ptr<gNB> UAV::GetAssociatedGNBShared() const
+// Helper to resolve the associated gNB
+gNB* UAV::ResolveAssociatedGNB() const
 {
-    if (auto gnb_sp = m_ConnectedgNB.lock())
+    if (gNB* gnb = m_ConnectedgNB.Get())
     {
-        return gnb_sp;
+        return gnb;
     }
     std::cerr << "UAV " << m_Id << ": Error - No associated gNB found!" << std::endl;
     return nullptr;
 }
 
+// --- Auth-State Expiry ---
+
+void UAV::Update(float deltaTime)
+{
+    Entity::Update(deltaTime);
+    ExpireAuthState();
+
+    // Exponentially weighted relay rate with a one-second time constant
+    if (deltaTime > 0.0f)
+    {
+        double alpha = 1.0 - std::exp(-static_cast<double>(deltaTime));
+        m_RelayRate += alpha * (m_RelayedSinceUpdate / static_cast<double>(deltaTime) - m_RelayRate);
+        m_RelayedSinceUpdate = 0;
+    }
+}
+
+void UAV::ExpireAuthState()
+{
+    m_ExpiryWheel.Advance(AuthStateNowTick(), [this](int ueId, uint64_t expiryTick) {
+        auto it = m_ConnectedUEInfo.find(ueId);
+        if (it == m_ConnectedUEInfo.end() || it->second.expiryTick != expiryTick) return;
+        if (it->second.state.Is(UAVSessionState::HandoverChallenged)) m_AuthStats.expiredPending++;
+        else m_AuthStats.expiredSessions++;
+        it->second.state.Fire(UAVSessionEvent::Expire);
+        m_ConnectedUEInfo.erase(it);
+        m_ConnectedUEs.erase(ueId);
+        std::cout << "UAV " << m_Id << ": State for UE " << ueId << " expired." << std::endl;
+    });
+    // Phase B exchanges that never came back (flow timed out or failed)
+    const uint64_t now = m_ExpiryWheel.CurrentTick();
+    std::erase_if(m_AdmittedUEs, [now](const auto& entry) { return entry.second <= now; });
+    TrimTokenCache();
+    TrimPreparedHandovers();
+}
+
+// --- Verified-Token Cache ---
+
+void UAV::SetTokenCacheLimits(const TokenCacheLimits& limits)
+{
+    m_TokenCacheLimits = limits;
+    TrimTokenCache();
+}
+
+const std::vector<uint8_t>* UAV::FindCachedTGK(const TokenKey& key)
+{
+    auto it = m_TokenCache.find(key);
+    if (it == m_TokenCache.end() || it->second.expiryTick <= m_ExpiryWheel.CurrentTick())
+    {
+        m_TokenCacheStats.misses++; // An expired record is reclaimed by TrimTokenCache
+        return nullptr;
+    }
+    m_TokenCacheStats.hits++;
+    return &it->second.tgk_i;
+}
+
+void UAV::CacheTGK(const TokenKey& key, std::vector<uint8_t> tgk_i)
+{
+    if (m_TokenCacheLimits.maxEntries == 0) return;
+    uint64_t expiryTick = m_ExpiryWheel.CurrentTick() + AuthStateTicksFromMs(m_TokenCacheLimits.lifetimeMs);
+    m_TokenCache[key] = { std::move(tgk_i), expiryTick };
+    m_TokenOrder.emplace_back(key, expiryTick);
+    TrimTokenCache();
+}
+
+void UAV::TrimTokenCache()
+{
+    const uint64_t now = m_ExpiryWheel.CurrentTick();
+    while (!m_TokenOrder.empty())
+    {
+        const auto& [key, expiryTick] = m_TokenOrder.front();
+        auto it = m_TokenCache.find(key);
+        bool live = it != m_TokenCache.end() && it->second.expiryTick == expiryTick;
+        if (live && expiryTick > now && m_TokenCache.size() <= m_TokenCacheLimits.maxEntries) break;
+        if (live)
+        {
+            m_TokenCache.erase(it);
+            if (expiryTick <= now) m_TokenCacheStats.expired++;
+            else m_TokenCacheStats.evicted++;
+        }
+        m_TokenOrder.pop_front();
+    }
+}
+
+void UAV::InvalidateTokenCache()
+{
+    m_TokenCacheStats.invalidated += m_TokenCache.size();
+    m_TokenCache.clear();
+    m_TokenOrder.clear();
+    DropPreparedHandovers();
+}
+
+// --- Handover Preparation ---
+
+void UAV::SetHandoverPrepLimits(const HandoverPrepLimits& limits)
+{
+    m_PrepLimits = limits;
+    TrimPreparedHandovers();
+}
+
+void UAV::PrepareHandover(const HandoverHint& hint)
+{
+    PERF_SCOPE("UAV::PrepareHandover");
+    if (m_PrepLimits.maxEntries == 0 || !IsAuthenticatedWithGNB() || !Kyber::ValidateTST(hint.tst)) return;
+    ExpireAuthState();
+    const TokenKey key{ hint.tid_i, hint.tst.time_since_epoch().count() };
+    if (m_PreparedHandovers.count(key))
+    {
+        m_PrepStats.duplicates++;
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    Kyber::AuthTransaction txn;
+    std::pmr::memory_resource* arena = Kyber::AuthTransaction::Resource();
+    PreparedHandover prepared;
+    Kyber::ArenaBytes tgk_input = Kyber::ConcatBytes({hint.tid_i, Kyber::TimestampToBytes(hint.tst, arena)}, arena);
+    prepared.tgk_i = Kyber::KDF(m_GKUAV, tgk_input);
+    Kyber::ArenaBytes k_star_input = Kyber::ConcatBytes({m_TIDj, hint.tid_i}, arena);
+    prepared.k_star_uav_i = Kyber::KDF(prepared.tgk_i, k_star_input);
+    prepared.cost = std::chrono::steady_clock::now() - start;
+    prepared.expiryTick = m_ExpiryWheel.CurrentTick() + AuthStateTicksFromMs(m_PrepLimits.lifetimeMs);
+
+    m_PrepStats.hints++;
+    m_PrepStats.prepTime += prepared.cost;
+    m_PreparedOrder.emplace_back(key, prepared.expiryTick);
+    m_PreparedHandovers.emplace(key, std::move(prepared));
+    TrimPreparedHandovers();
+    std::cout << "UAV " << m_Id << ": Prepared handover for TIDi=" << hint.tid_i << std::endl;
+}
+
+std::optional<UAV::PreparedHandover> UAV::TakePreparedHandover(const TokenKey& key)
+{
+    auto it = m_PreparedHandovers.find(key);
+    if (it == m_PreparedHandovers.end() || it->second.expiryTick <= m_ExpiryWheel.CurrentTick())
+    {
+        return std::nullopt; // An expired one is counted as wasted by TrimPreparedHandovers
+    }
+    PreparedHandover prepared = std::move(it->second);
+    m_PreparedHandovers.erase(it);
+    m_PrepStats.used++;
+    return prepared;
+}
+
+void UAV::TrimPreparedHandovers()
+{
+    const uint64_t now = m_ExpiryWheel.CurrentTick();
+    while (!m_PreparedOrder.empty())
+    {
+        const auto& [key, expiryTick] = m_PreparedOrder.front();
+        auto it = m_PreparedHandovers.find(key);
+        bool live = it != m_PreparedHandovers.end() && it->second.expiryTick == expiryTick;
+        if (live && expiryTick > now && m_PreparedHandovers.size() <= m_PrepLimits.maxEntries) break;
+        if (live)
+        {
+            m_PrepStats.wasted++;
+            m_PrepStats.wastedTime += it->second.cost;
+            m_PreparedHandovers.erase(it);
+        }
+        m_PreparedOrder.pop_front();
+    }
+}
+
+void UAV::DropPreparedHandovers()
+{
+    for (const auto& [key, prepared] : m_PreparedHandovers)
+    {
+        m_PrepStats.wasted++;
+        m_PrepStats.wastedTime += prepared.cost;
+    }
+    m_PreparedHandovers.clear();
+    m_PreparedOrder.clear();
+}
+
+bool UAV::HasSessionCapacity(int ueId)
+{
+    ExpireAuthState();
+    if (m_ConnectedUEInfo.count(ueId) || m_ConnectedUEInfo.size() < m_AuthLimits.maxSessions) return true;
+    m_AuthStats.capacityRejects++;
+    std::cerr << "UAV " << m_Id << ": Session table full. Rejecting UE " << ueId << "." << std::endl;
+    return false;
+}
+
+// --- Relay Load ---
+
+RelayLoad UAV::GetRelayLoad() const
+{
+    RelayLoad load;
+    load.connectedUEs = m_ConnectedUEs.size();
+    // Sessions without a served UE are handovers still awaiting confirmation
+    size_t challenged = m_ConnectedUEInfo.size() > m_ConnectedUEs.size() ? m_ConnectedUEInfo.size() - m_ConnectedUEs.size() : 0;
+    load.pendingAuths = m_AdmittedUEs.size() + challenged;
+    load.relayRate = m_RelayRate;
+    return load;
+}
+
+bool UAV::CanAdmit(size_t reserved) const
+{
+    RelayLoad load = GetRelayLoad();
+    return load.connectedUEs + load.pendingAuths + reserved < m_RelayCapacity.maxConnectedUEs
+        && load.pendingAuths < m_RelayCapacity.maxPendingAuths
+        && load.relayRate < m_RelayCapacity.maxRelayRate;
+}
+
+bool UAV::AdmitUE(int ueId)
+{
+    if (m_ConnectedUEs.count(ueId) || m_AdmittedUEs.count(ueId) || CanAdmit()) return true;
+    m_RelayStats.admissionRejects++;
+    std::cerr << "UAV " << m_Id << ": At relay capacity. Rejecting UE " << ueId << "." << std::endl;
+    return false;
+}
+
+void UAV::ScheduleUEExpiry(int ueId, uint64_t expiryTick)
+{
+    m_ConnectedUEInfo[ueId].expiryTick = expiryTick;
+    m_ExpiryWheel.Schedule(ueId, expiryTick);
+}
+
+// --- State machine handlers ---
+
+void UAVAccessTraits::ClearDerivedKeys(UAV& uav)
+{
+    uav.m_Derived_CKj.clear();
+    uav.m_Derived_IKj.clear();
+    uav.m_Derived_RESj.clear();
+    uav.m_Current_RAND_j.clear();
+}
+
 // --- UAV Service Access Authentication (Phase A) ---
 
 // void UAV::ReceiveServiceAccessAuthParams(const std::vector<uint8_t>& hres_star_j, const std::vector<uint8_t>& cj) {
@@ -64,13 +295,29 @@ void UAV::ReceiveServiceAccessAuthParams(const std::vector<uint8_t> &hres_star_j
                                          const std::vector<uint8_t> &cj,
                                          const std::vector<uint8_t> &rand_prime)
 { // Add rand_prime
+    if (VerifyServiceAccessAuth(hres_star_j, cj, rand_prime))
+    {
+        ConfirmServiceAccessAuth(); // Send confirmation back to gNB
+    }
+}
+
+bool UAV::VerifyServiceAccessAuth(const std::vector<uint8_t> &hres_star_j,
+                                  const std::vector<uint8_t> &cj,
+                                  const std::vector<uint8_t> &rand_prime)
+{
+    PERF_SCOPE("UAV::ReceiveServiceAccessAuthParams");
     std::cout << "UAV " << m_Id << ": Received Service Access Auth Params (HRES*j, Cj, RAND') from gNB." << std::endl;
     m_Current_RAND_j = rand_prime; // Store RAND'
 
     if (m_LongTermKey_Kj.empty())
     {
         std::cerr << "UAV " << m_Id << ": Error - Long term key Kj not set. Cannot proceed." << std::endl;
-        return;
+        return false;
+    }
+    if (!m_AccessState.Fire(UAVAccessEvent::ParamsReceived, *this))
+    {
+        std::cerr << "UAV " << m_Id << ": Error - Service access params received while already verifying." << std::endl;
+        return false;
     }
 
     // --- Start AKA Steps (UAV side) ---
@@ -113,40 +360,40 @@ void UAV::ReceiveServiceAccessAuthParams(const std::vector<uint8_t> &hres_star_j
 
         // Parse TIDj and GKUAV from decrypted_cj
         // Assuming format: [TIDj_bytes][GKUAV_bytes]
-        size_t tid_len = 20; // Example fixed length, must match gNB's generation
-        if (decrypted_cj.size() > tid_len)
+        constexpr size_t tid_len = Kyber::TID::Bytes;
+        std::optional<Kyber::TID> tid_j = decrypted_cj.size() > tid_len
+            ? Kyber::TID::FromBytes(Kyber::ByteView(decrypted_cj).first(tid_len)) : std::nullopt;
+        if (tid_j)
         {
-            m_TIDj = Kyber::BytesToString(std::vector<uint8_t>(decrypted_cj.begin(), decrypted_cj.begin() + tid_len));
-            m_GKUAV = std::vector<uint8_t>(decrypted_cj.begin() + tid_len, decrypted_cj.end());
+            m_TIDj = *tid_j;
+            std::vector<uint8_t> gk_uav(decrypted_cj.begin() + tid_len, decrypted_cj.end());
+            if (gk_uav != m_GKUAV)
+            {
+                InvalidateTokenCache();
+            }
+            m_GKUAV = std::move(gk_uav);
             m_KRANj = derived_kran_j; // Store the derived KRANj
-            m_IsAuthenticatedWithGNB = true;
+            m_AccessState.Fire(UAVAccessEvent::GnbVerified, *this);
             std::cout << "UAV " << m_Id << ": Decrypted Cj. Got TIDj=" << m_TIDj << ", GKUAV (size=" << m_GKUAV.size() << "). Storing keys." << std::endl;
-
-            
-
-            ConfirmServiceAccessAuth(); // Send confirmation back to gNB
+            return true;
         }
         else
         {
-            std::cerr << "UAV " << m_Id << ": Error - Decrypted Cj is too short." << std::endl;
-            m_IsAuthenticatedWithGNB = false;
+            std::cerr << "UAV " << m_Id << ": Error - Decrypted Cj is too short or holds no valid TIDj." << std::endl;
+            m_AccessState.Fire(UAVAccessEvent::VerificationFailed, *this);
         }
     }
     else
     {
         std::cerr << "UAV " << m_Id << ": Error - HRES*j mismatch! Authentication failed." << std::endl;
-        m_IsAuthenticatedWithGNB = false;
-        // Clear derived keys?
-        m_Derived_CKj.clear();
-        m_Derived_IKj.clear();
-        m_Derived_RESj.clear();
-        m_Current_RAND_j.clear();
+        m_AccessState.Fire(UAVAccessEvent::VerificationFailed, *this); // Clears derived keys
     }
+    return false;
 }
 
 void UAV::ConfirmServiceAccessAuth()
 {
-    if (auto gnb = GetAssociatedGNBShared())
+    if (auto gnb = ResolveAssociatedGNB())
     {
         std::cout << "UAV " << m_Id << ": Sending Service Access Confirmation to gNB " << gnb->GetID() << std::endl;
         gnb->ReceiveServiceAccessConfirmation(m_Id);
@@ -156,36 +403,58 @@ void UAV::ConfirmServiceAccessAuth()
 // --- UAV-Assisted UE Access Authentication (Phase B) ---
 
 void UAV::ReceiveConnectionRequest(int ueId, const std::vector<uint8_t> &suci_bytes)
+{
+    if (gNB* gnb = AcceptConnectionRequest(ueId))
+    {
+        gnb->ProcessUAVAssistedAuthRequest(suci_bytes, m_TIDj, *this, ueId);
+    }
+}
+
+void UAV::ReceiveResumeRequest(int ueId, const ResumeRequest &request)
+{
+    if (gNB* gnb = AcceptConnectionRequest(ueId))
+    {
+        gnb->ProcessResumeRequest(request, m_TIDj, *this, ueId);
+    }
+}
+
+gNB* UAV::AcceptConnectionRequest(int ueId)
 {
     std::cout << "UAV " << m_Id << ": Received connection request (SUCI) from UE " << ueId << std::endl;
-    if (!m_IsAuthenticatedWithGNB)
+    if (!IsAuthenticatedWithGNB())
     {
         std::cerr << "UAV " << m_Id << ": Not authenticated with gNB. Cannot process UE request." << std::endl;
         // Optionally inform UE of failure
-        return;
+        return nullptr;
     }
-    if (auto gnb = GetAssociatedGNBShared())
+    ExpireAuthState();
+    if (!AdmitUE(ueId))
     {
+        return nullptr;
+    }
+    gNB* gnb = ResolveAssociatedGNB();
+    if (gnb)
+    {
+        m_AdmittedUEs[ueId] = m_ExpiryWheel.CurrentTick() + AuthStateTicksFromMs(m_AuthLimits.pendingAuthTimeoutMs);
+        CountRelayed();
         std::cout << "UAV " << m_Id << ": Forwarding SUCI and TIDj=" << m_TIDj << " to gNB " << gnb->GetID() << std::endl;
-        gnb->ProcessUAVAssistedAuthRequest(suci_bytes, m_TIDj, *this, ueId);
     }
+    return gnb;
 }
 
 void UAV::ReceiveUEAuthParams(int ueId,
                               const std::vector<uint8_t> &hres_star_i,
                               const std::vector<uint8_t> &ci,
-                              const std::string &tid_i,
+                              const Kyber::TID &tid_i,
                               const std::vector<uint8_t> &kuav_i)
 {
-    std::cout << "UAV " << m_Id << ": Received UE Auth Params (HRES*i, Ci, TIDi, KUAVi) from gNB for UE " << ueId << "." << std::endl;
-    std::cout << "   TIDi=" << tid_i << ", KUAVi size=" << kuav_i.size() << std::endl;
-
-    // Store UE-specific info
-    m_ConnectedUEInfo[ueId] = {tid_i, kuav_i};
-    std::cout << "UAV " << m_Id << ": Stored TIDi and KUAVi for UE " << ueId << "." << std::endl;
+    Kyber::AuthTransaction txn; // Joins the UE's Phase B transaction when relayed synchronously
+    if (!StoreUEAuthParams(ueId, tid_i, kuav_i))
+    {
+        return;
+    }
 
     // Forward (HRES*i, Ci) to UE
-    
     auto ue_sp = FindUEById(ueId); // Use virtual function or World lookup
     if (ue_sp)
     {
@@ -199,20 +468,80 @@ void UAV::ReceiveUEAuthParams(int ueId,
     }
 }
 
+bool UAV::StoreUEAuthParams(int ueId, const Kyber::TID &tid_i, const std::vector<uint8_t> &kuav_i)
+{
+    std::cout << "UAV " << m_Id << ": Received UE Auth Params (HRES*i, Ci, TIDi, KUAVi) from gNB for UE " << ueId << "." << std::endl;
+    std::cout << "   TIDi=" << tid_i << ", KUAVi size=" << kuav_i.size() << std::endl;
+
+    m_AdmittedUEs.erase(ueId);
+    if (!HasSessionCapacity(ueId))
+    {
+        return false;
+    }
+
+    // Store UE-specific info; the UAV never sees the token, so bound the
+    // session by the configured lifetime instead of TST
+    m_ConnectedUEInfo[ueId] = {tid_i, kuav_i};
+    m_ConnectedUEInfo[ueId].state.Fire(UAVSessionEvent::KeysStored);
+    ScheduleUEExpiry(ueId, m_ExpiryWheel.CurrentTick() + AuthStateTicksFromMs(m_AuthLimits.sessionLifetimeMs));
+    // This UAV now serves the UE; the gNB re-homes these on a UAV failure
+    if (auto ue = FindUEById(ueId))
+    {
+        m_ConnectedUEs[ueId] = ue->SelfRef();
+    }
+    CountRelayed();
+    std::cout << "UAV " << m_Id << ": Stored TIDi and KUAVi for UE " << ueId << "." << std::endl;
+    return true;
+}
+
 // --- UE Handover Authentication (Phase C) ---
 
 void UAV::ReceiveHandoverAuthRequest(int ueId,
-                                     const std::string &tid_i,
+                                     const Kyber::TID &tid_i,
                                      const std::vector<uint8_t> &mac_i,
                                      const std::vector<uint8_t> &r1,
                                      const Kyber::Timestamp &tst)
 {
+    std::optional<HandoverAuthChallenge> challenge = ProcessHandoverRequest(ueId, HandoverAuthRequest{ tid_i, mac_i, r1, tst });
+    if (!challenge)
+    {
+        return;
+    }
+
+    // Send (HRESi, R2) to UE
+    auto ue_sp = FindUEById(ueId);
+    if (ue_sp)
+    {
+        std::cout << "UAV " << m_Id << ": Sending (HRESi, R2) to UE " << ueId << std::endl;
+        ue_sp->HandleHandoverAuthChallenge(challenge->hres_i, challenge->r2);
+    }
+    else
+    {
+        std::cerr << "UAV " << m_Id << ": Could not find UE " << ueId << " to send Handover Challenge." << std::endl;
+        m_ConnectedUEInfo[ueId].state.Fire(UAVSessionEvent::Abort);
+        m_ConnectedUEInfo.erase(ueId); // Clean up state
+    }
+}
+
+std::optional<HandoverAuthChallenge> UAV::ProcessHandoverRequest(int ueId, const HandoverAuthRequest &request)
+{
+    const Kyber::TID &tid_i = request.tid_i;
+    const std::vector<uint8_t> &mac_i = request.mac_i;
+    const std::vector<uint8_t> &r1 = request.r1;
+    const Kyber::Timestamp &tst = request.tst;
+    PERF_SCOPE("UAV::ReceiveHandoverAuthRequest");
+    const auto start = std::chrono::steady_clock::now();
     std::cout << "UAV " << m_Id << " (Target): Received Handover Auth Request from UE " << ueId << " (TIDi=" << tid_i << ")" << std::endl;
 
-    if (!m_IsAuthenticatedWithGNB)
+    if (!IsAuthenticatedWithGNB())
     {
         std::cerr << "UAV " << m_Id << ": Not authenticated with gNB. Cannot process handover." << std::endl;
-        return;
+        return std::nullopt;
+    }
+    ExpireAuthState();
+    if (!m_ConnectedUEInfo.count(ueId) && !AdmitUE(ueId))
+    {
+        return std::nullopt;
     }
 
     // Step 2: Check TST
@@ -220,23 +549,36 @@ void UAV::ReceiveHandoverAuthRequest(int ueId,
     {
         std::cerr << "UAV " << m_Id << ": Handover failed for UE " << ueId << ". TST is invalid." << std::endl;
         // Inform UE?
-        return;
+        return std::nullopt;
     }
     std::cout << "UAV " << m_Id << ": TST is valid." << std::endl;
 
-    // Compute TGK'i = KDF(GKUAV, TIDi || TST)
-    std::vector<uint8_t> tidi_bytes = Kyber::StringToBytes(tid_i);
-    std::vector<uint8_t> tst_bytes = Kyber::TimestampToBytes(tst);
-    std::vector<uint8_t> tgk_input = tidi_bytes;
-    tgk_input.insert(tgk_input.end(), tst_bytes.begin(), tst_bytes.end());
-    std::vector<uint8_t> tgk_prime_i = Kyber::KDF(m_GKUAV, tgk_input);
-    std::cout << "UAV " << m_Id << ": Computed TGK'i." << std::endl;
-
-    // Compute XMACi = KDF(TGK'i, TID*j || TIDi || R1)
-    std::vector<uint8_t> tid_star_j_bytes = Kyber::StringToBytes(m_TIDj); // Target UAV's TID
-    std::vector<uint8_t> xmac_input = tid_star_j_bytes;
-    xmac_input.insert(xmac_input.end(), tidi_bytes.begin(), tidi_bytes.end());
-    xmac_input.insert(xmac_input.end(), r1.begin(), r1.end());
+    // Compute TGK'i = KDF(GKUAV, TIDi || TST), unless it was prepared from
+    // a hint or this token already passed a MAC check here
+    Kyber::AuthTransaction txn;
+    std::pmr::memory_resource* arena = Kyber::AuthTransaction::Resource();
+    const TokenKey token_key{ tid_i, tst.time_since_epoch().count() };
+    std::optional<PreparedHandover> prepared = TakePreparedHandover(token_key);
+    const std::vector<uint8_t>* cached_tgk = prepared ? &prepared->tgk_i : FindCachedTGK(token_key);
+    std::vector<uint8_t> derived_tgk;
+    if (prepared)
+    {
+        std::cout << "UAV " << m_Id << ": Using prepared TGK'i and K*UAVi." << std::endl;
+    }
+    else if (cached_tgk)
+    {
+        std::cout << "UAV " << m_Id << ": Reusing verified TGK'i." << std::endl;
+    }
+    else
+    {
+        Kyber::ArenaBytes tgk_input = Kyber::ConcatBytes({tid_i, Kyber::TimestampToBytes(tst, arena)}, arena);
+        derived_tgk = Kyber::KDF(m_GKUAV, tgk_input);
+        std::cout << "UAV " << m_Id << ": Computed TGK'i." << std::endl;
+    }
+    Kyber::ByteView tgk_prime_i = cached_tgk ? Kyber::ByteView(*cached_tgk) : Kyber::ByteView(derived_tgk);
+
+    // Compute XMACi = KDF(TGK'i, TID*j || TIDi || R1), TID*j being this UAV's TID
+    Kyber::ArenaBytes xmac_input = Kyber::ConcatBytes({m_TIDj, tid_i, r1}, arena);
     std::vector<uint8_t> xmac_i = Kyber::KDF(tgk_prime_i, xmac_input);
     std::cout << "UAV " << m_Id << ": Computed XMACi." << std::endl;
 
@@ -245,25 +587,35 @@ void UAV::ReceiveHandoverAuthRequest(int ueId,
     {
         std::cerr << "UAV " << m_Id << ": Handover MAC check failed for UE " << ueId << "." << std::endl;
         // Inform UE?
-        return;
+        return std::nullopt;
     }
     std::cout << "UAV " << m_Id << ": MAC check successful." << std::endl;
+    if (!cached_tgk || prepared)
+    {
+        CacheTGK(token_key, Kyber::ToVector(tgk_prime_i));
+    }
 
     // Generate R2
     std::vector<uint8_t> r2 = GenerateRandomBytesUtil(16); // Example size for R2
     std::cout << "UAV " << m_Id << ": Generated R2." << std::endl;
 
     // Compute RESi = KDF(TGK'i, TID*j || TIDi || R1 || R2)
-    std::vector<uint8_t> res_input = xmac_input; // Reuses TID*j || TIDi || R1
-    res_input.insert(res_input.end(), r2.begin(), r2.end());
+    Kyber::ArenaBytes res_input = Kyber::ConcatBytes({xmac_input, r2}, arena); // Reuses TID*j || TIDi || R1
     std::vector<uint8_t> res_i = Kyber::KDF(tgk_prime_i, res_input);
     std::cout << "UAV " << m_Id << ": Computed RESi." << std::endl;
 
     // Compute K*UAVi = KDF(TGK'i, TID*j || TIDi)
-    std::vector<uint8_t> k_star_input = tid_star_j_bytes;
-    k_star_input.insert(k_star_input.end(), tidi_bytes.begin(), tidi_bytes.end());
-    std::vector<uint8_t> k_star_uav_i = Kyber::KDF(tgk_prime_i, k_star_input);
-    std::cout << "UAV " << m_Id << ": Computed K*UAVi." << std::endl;
+    std::vector<uint8_t> k_star_uav_i;
+    if (prepared)
+    {
+        k_star_uav_i = std::move(prepared->k_star_uav_i);
+    }
+    else
+    {
+        Kyber::ArenaBytes k_star_input = Kyber::ConcatBytes({m_TIDj, tid_i}, arena);
+        k_star_uav_i = Kyber::KDF(tgk_prime_i, k_star_input);
+        std::cout << "UAV " << m_Id << ": Computed K*UAVi." << std::endl;
+    }
 
     // Compute HRESi = KDF(RESi || R2)
     std::vector<uint8_t> hres_input = res_i;
@@ -271,54 +623,81 @@ void UAV::ReceiveHandoverAuthRequest(int ueId,
     std::vector<uint8_t> hres_i = Kyber::KDF(hres_input); // Using KDF as a hash here
     std::cout << "UAV " << m_Id << ": Computed HRESi." << std::endl;
 
+    if (!HasSessionCapacity(ueId))
+    {
+        return std::nullopt;
+    }
+
     // Store state for verification later
-    m_ConnectedUEInfo[ueId] = {tid_i, k_star_uav_i, r1, res_i}; // Store K*, R1, RESi
+    m_ConnectedUEInfo[ueId] = {tid_i, k_star_uav_i, r1, res_i, tst}; // Store K*, R1, RESi
+    m_ConnectedUEInfo[ueId].state.Fire(UAVSessionEvent::HandoverChallenge);
+    ScheduleUEExpiry(ueId, m_ExpiryWheel.CurrentTick() + AuthStateTicksFromMs(m_AuthLimits.pendingAuthTimeoutMs));
+    CountRelayed();
     std::cout << "UAV " << m_Id << ": Stored K*UAVi, R1, RESi for UE " << ueId << "." << std::endl;
-
-    // Send (HRESi, R2) to UE
-    auto ue_sp = FindUEById(ueId);
-    if (ue_sp)
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (prepared)
     {
-        std::cout << "UAV " << m_Id << ": Sending (HRESi, R2) to UE " << ueId << std::endl;
-        ue_sp->HandleHandoverAuthChallenge(hres_i, r2);
+        // Timed by whoever predicted the handover
+    }
+    else if (cached_tgk)
+    {
+        m_TokenCacheStats.timedHits++;
+        m_TokenCacheStats.hitTime += elapsed;
     }
     else
     {
-        std::cerr << "UAV " << m_Id << ": Could not find UE " << ueId << " to send Handover Challenge." << std::endl;
-        m_ConnectedUEInfo.erase(ueId); // Clean up state
+        m_TokenCacheStats.timedMisses++;
+        m_TokenCacheStats.missTime += elapsed;
     }
+    return HandoverAuthChallenge{ std::move(hres_i), std::move(r2) };
 }
 
 void UAV::ReceiveHandoverAuthConfirmation(int ueId, const std::vector<uint8_t> &xres_i)
+{
+    if (!VerifyHandoverConfirmation(ueId, xres_i))
+    {
+        return;
+    }
+    // Inform gNB
+    if (auto gnb = ResolveAssociatedGNB())
+    {
+        const Kyber::TID &tid_i = m_ConnectedUEInfo[ueId].tid_i;
+        std::cout << "UAV " << m_Id << ": Sending Handover Inform message to gNB " << gnb->GetID() << " for UE " << ueId << " (TIDi=" << tid_i << ")" << std::endl;
+        gnb->ReceiveHandoverInform(m_TIDj, tid_i);
+    }
+}
+
+bool UAV::VerifyHandoverConfirmation(int ueId, const std::vector<uint8_t> &xres_i)
 {
     std::cout << "UAV " << m_Id << ": Received Handover Auth Confirmation (XRESi) from UE " << ueId << std::endl;
 
     // Step 4: Check if XRESi matches stored RESi
-    if (m_ConnectedUEInfo.count(ueId))
+    auto info_it = m_ConnectedUEInfo.find(ueId);
+    if (info_it != m_ConnectedUEInfo.end() && info_it->second.state.Is(UAVSessionState::HandoverChallenged))
     {
-        const auto &ue_info = m_ConnectedUEInfo[ueId];
+        auto &ue_info = info_it->second;
         if (xres_i == ue_info.expected_res_i)
         {
             std::cout << "UAV " << m_Id << ": XRESi matches RESi. Handover successful for UE " << ueId << "." << std::endl;
+            // Session now lives until the UE's token expires
+            ue_info.state.Fire(UAVSessionEvent::HandoverConfirmed);
+            ScheduleUEExpiry(ueId, AuthStateTick(ue_info.tst));
             // Store final state (TIDi, K*UAVi) - already stored when RESi was computed
             std::cout << "UAV " << m_Id << ": Stored final state (TIDi, K*UAVi) for UE " << ueId << "." << std::endl;
 
-            // Inform gNB
-            if (auto gnb = GetAssociatedGNBShared())
-            {
-                std::cout << "UAV " << m_Id << ": Sending Handover Inform message to gNB " << gnb->GetID() << " for UE " << ueId << " (TIDi=" << ue_info.tid_i << ")" << std::endl;
-                gnb->ReceiveHandoverInform(m_TIDj, ue_info.tid_i);
-            }
             // Add UE to connected list (if not already)
             if (auto ue_sp = FindUEById(ueId))
             {
-                m_ConnectedUEs[ueId] = ue_sp; // Store weak_ptr
+                m_ConnectedUEs[ueId] = ue_sp->SelfRef(); // Store generation-checked ref
             }
+            CountRelayed();
+            return true;
         }
         else
         {
             std::cerr << "UAV " << m_Id << ": Handover confirmation failed for UE " << ueId << ". XRESi mismatch." << std::endl;
-            m_ConnectedUEInfo.erase(ueId); // Clean up state
+            ue_info.state.Fire(UAVSessionEvent::Abort);
+            m_ConnectedUEInfo.erase(info_it); // Clean up state
             m_ConnectedUEs.erase(ueId);    // Remove from connected list
         }
     }
@@ -326,19 +705,64 @@ void UAV::ReceiveHandoverAuthConfirmation(int ueId, const std::vector<uint8_t> &
     {
         std::cerr << "UAV " << m_Id << ": Received unexpected Handover Confirmation from UE " << ueId << "." << std::endl;
     }
+    return false;
 }
 
 // --- General ---
 
 void UAV::BroadcastNotification()
 {
-    if (m_IsAuthenticatedWithGNB && m_Operational)
+    if (IsAuthenticatedWithGNB() && m_Operational)
     {
         std::cout << "UAV " << m_Id << ": Broadcasting readiness notification (TIDj=" << m_TIDj << ")" << std::endl;
         // In a real simulation, this would trigger nearby UEs
     }
 }
 
+bool UAV::ApplyGroupRekey(const GroupRekey &rekey)
+{
+    if (!IsAuthenticatedWithGNB())
+    {
+        return false;
+    }
+    for (const auto &[uavId, leaf] : rekey.joined)
+    {
+        if (uavId == m_Id)
+        {
+            m_GroupPathKeys.clear(); // Placed anew, under the current KRANj
+            m_GroupPathKeys[leaf] = m_KRANj;
+            break;
+        }
+    }
+    if (m_GroupPathKeys.empty())
+    {
+        return false; // Not in the tree
+    }
+
+    // Leaves to root: each key unwrapped here can unwrap the next level
+    for (const GroupRekeyMessage &message : rekey.messages)
+    {
+        auto wrapping = m_GroupPathKeys.find(message.wrappingNode);
+        if (wrapping == m_GroupPathKeys.end())
+        {
+            continue;
+        }
+        std::vector<uint8_t> key = Kyber::DecryptSymmetric(wrapping->second, message.wrapped_key);
+        m_GroupPathKeys[message.node] = std::move(key);
+    }
+
+    auto root = m_GroupPathKeys.find(rekey.root);
+    if (root == m_GroupPathKeys.end() || root->second == m_GKUAV)
+    {
+        std::cerr << "UAV " << m_Id << ": Error - Could not follow group rekey " << rekey.epoch << "." << std::endl;
+        return false;
+    }
+    m_GKUAV = root->second;
+    InvalidateTokenCache();
+    std::cout << "UAV " << m_Id << ": Group rekey " << rekey.epoch << " applied. New GKUAV." << std::endl;
+    return true;
+}
+
 // --- Existing Methods Modified/Used ---
 
 // void UAV::SendAuthResponseToUE(int ueId, const std::vector<uint8_t>& res_star) {
@@ -354,6 +778,7 @@ void UAV::BroadcastNotification()
 
 void UAV::SendSyncFailureToUE(int ueId, const std::vector<uint8_t> &auts)
 {
+    m_AdmittedUEs.erase(ueId);
     std::cout << "UAV " << m_Id << ": Forwarding Sync Failure (AUTS) to UE " << ueId << std::endl;
     auto ue_sp = FindUEById(ueId);
     if (ue_sp)
@@ -368,6 +793,7 @@ void UAV::SendSyncFailureToUE(int ueId, const std::vector<uint8_t> &auts)
 
 void UAV::SendMacFailureToUE(int ueId)
 {
+    m_AdmittedUEs.erase(ueId);
     std::cout << "UAV " << m_Id << ": Forwarding MAC Failure to UE " << ueId << std::endl;
     auto ue_sp = FindUEById(ueId);
     if (ue_sp)
@@ -392,11 +818,24 @@ void UAV::NotifyHandoverInitiated(UE &ue, UAV &targetUAV)
 
 void UAV::ReleaseUE(int ueId)
 {
+    // Pending wheel entry is ignored once the session is gone
+    m_AdmittedUEs.erase(ueId);
+    auto info_it = m_ConnectedUEInfo.find(ueId);
+    bool had_session = info_it != m_ConnectedUEInfo.end();
+    if (had_session)
+    {
+        info_it->second.state.Fire(UAVSessionEvent::Release);
+        m_ConnectedUEInfo.erase(info_it);
+    }
     if (m_ConnectedUEs.count(ueId))
     {
         m_ConnectedUEs.erase(ueId);
         std::cout << "UAV " << m_Id << ": Released connection for UE " << ueId << std::endl;
     }
+    if (had_session)
+    {
+        m_AuthStats.released++;
+    }
 }
 
 void UAV::ReceiveHandoverConnection(UE &ue)
@@ -409,7 +848,7 @@ std::vector<int> UAV::GetConnectedUEIds() const
     std::vector<int> ueIds;
     for (const auto &pair : m_ConnectedUEs)
     {
-        if (auto ue_sp = pair.second.lock())
+        if (pair.second.Get())
         {
             ueIds.push_back(pair.first);
         }
@@ -422,3 +861,82 @@ void UAV::SetLongTermKey(const std::string &key)
     m_LongTermKey_Kj = key;
     std::cout << "UAV " << m_Id << ": Long term key set." << std::endl;
 }
+
+void UAV::SaveSnapshot(SnapshotWriter& out) const
+{
+    out.PutRef(m_ConnectedgNB);
+    out.Put<uint8_t>(m_Operational);
+    out.PutString(m_LongTermKey_Kj);
+    out.PutBytes(m_Current_RAND_j);
+    out.PutBytes(m_Derived_CKj);
+    out.PutBytes(m_Derived_IKj);
+    out.PutBytes(m_Derived_RESj);
+    out.PutState(m_AccessState);
+    out.Put(m_TIDj);
+    out.PutBytes(m_KRANj);
+    out.PutBytes(m_GKUAV);
+
+    out.Put(static_cast<uint32_t>(m_ConnectedUEs.size()));
+    for (const auto& [ueId, ref] : m_ConnectedUEs) out.PutRef(ref);
+
+    out.Put(static_cast<uint32_t>(m_ConnectedUEInfo.size()));
+    for (const auto& [ueId, info] : m_ConnectedUEInfo) {
+        out.Put<int32_t>(ueId);
+        out.Put(info.tid_i);
+        out.PutBytes(info.kuav_i);
+        out.PutBytes(info.r1);
+        out.PutBytes(info.expected_res_i);
+        out.PutTimestamp(info.tst);
+        out.Put(info.expiryTick);
+        out.PutState(info.state);
+    }
+}
+
+bool UAV::LoadSnapshot(SnapshotReader& in, const SnapshotLinks& links)
+{
+    uint8_t operational = 1;
+    in.GetRef(m_ConnectedgNB, links.gnb);
+    in.Get(operational);
+    m_Operational = operational != 0;
+    in.GetString(m_LongTermKey_Kj);
+    in.GetBytes(m_Current_RAND_j);
+    in.GetBytes(m_Derived_CKj);
+    in.GetBytes(m_Derived_IKj);
+    in.GetBytes(m_Derived_RESj);
+    in.GetState(m_AccessState);
+    in.Get(m_TIDj);
+    in.GetBytes(m_KRANj);
+    in.GetBytes(m_GKUAV);
+    m_TokenCache.clear(); // Rebuilt by the next handovers
+    m_TokenOrder.clear();
+    m_GroupPathKeys.clear(); // The gNB rejoins this UAV to its key tree
+    m_PreparedHandovers.clear();
+    m_PreparedOrder.clear();
+
+    uint32_t count = 0;
+    m_ConnectedUEs.clear();
+    for (in.Get(count); in.Ok() && count > 0; --count) {
+        EntityRef<UE> ref;
+        if (in.GetRef(ref, links.ue) && ref.Get()) m_ConnectedUEs[ref.Get()->GetID()] = ref;
+    }
+
+    m_ConnectedUEInfo.clear();
+    for (in.Get(count); in.Ok() && count > 0; --count) {
+        int32_t ueId = 0;
+        in.Get(ueId);
+        UEConnectionInfo& info = m_ConnectedUEInfo[ueId];
+        uint64_t expiryTick = 0;
+        in.Get(info.tid_i);
+        in.GetBytes(info.kuav_i);
+        in.GetBytes(info.r1);
+        in.GetBytes(info.expected_res_i);
+        in.GetTimestamp(info.tst);
+        in.Get(expiryTick);
+        in.GetState(info.state);
+        if (in.Ok() && expiryTick) ScheduleUEExpiry(ueId, expiryTick); // Wall-clock ticks stay valid across runs
+    }
+
+    m_PendingUEAuth_C1.clear();
+    m_PendingUEAuth_RES_star_i.clear();
+    return in.Ok();
+}
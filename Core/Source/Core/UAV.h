@@ -2,32 +2,164 @@
 
 #include "Entity.h"
 #include "KyberUtils.h" // Include Kyber utilities
+#include "TimingWheel.h"
+#include "EntityPool.h"
+#include "StateMachine.h"
+#include "AuthMessages.h"
+#include "UAVLoad.h"
 
 class gNB;
 class UAV;
 class UE;
+class SnapshotWriter;
+class SnapshotReader;
+struct SnapshotLinks;
 
 #include "UE.h"
 #include "gNB.h"
 
+#include <chrono>
 #include <vector>
+#include <deque>
 #include <memory>
 #include <map>
-#include <string> // For TID
+#include <unordered_map>
+#include <string>
 #include <optional> // For optional values
 #include <functional>
 #include <string>
 
+// Bounds of the verified-token cache a target UAV keeps for repeat
+// handovers. Entries past their lifetime are dropped, and the oldest go
+// first when the cache is full; capacity 0 turns the cache off.
+struct TokenCacheLimits {
+    size_t maxEntries = 1024;
+    uint32_t lifetimeMs = 300000; // The token's own TST is still checked on every hit
+};
+
+// Verified-token cache use at one UAV (UAV::GetTokenCacheStats)
+struct TokenCacheStats {
+    uint64_t hits = 0;        // TGK'i reused; no group-key derivation
+    uint64_t misses = 0;      // TGK'i derived from GKUAV
+    uint64_t expired = 0;     // Dropped at end of lifetime
+    uint64_t evicted = 0;     // Dropped to make room
+    uint64_t invalidated = 0; // Dropped because GKUAV changed
+    // Target-side processing of handovers that reached the challenge, by
+    // whether TGK'i came from the cache
+    uint64_t timedHits = 0;
+    uint64_t timedMisses = 0;
+    std::chrono::nanoseconds hitTime{ 0 };
+    std::chrono::nanoseconds missTime{ 0 };
+
+    double HitRate() const { return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+    double MicrosPerHandover() const
+    {
+        uint64_t handovers = timedHits + timedMisses;
+        return handovers ? std::chrono::duration<double, std::micro>(hitTime + missTime).count() / handovers : 0.0;
+    }
+};
+
+// Bounds of the handovers a UAV prepares ahead of time from hints
+// (UAV::PrepareHandover). Unused preparations are dropped after their
+// lifetime, the oldest first when full; capacity 0 ignores hints.
+struct HandoverPrepLimits {
+    size_t maxEntries = 1024;
+    uint32_t lifetimeMs = 5000;
+};
+
+struct HandoverPrepStats {
+    uint64_t hints = 0;      // Preparations made
+    uint64_t duplicates = 0; // Hints for a handover already prepared
+    uint64_t used = 0;       // Requests that found their preparation
+    uint64_t wasted = 0;     // Dropped unused (expired, evicted, group key changed)
+    std::chrono::nanoseconds prepTime{ 0 };
+    std::chrono::nanoseconds wastedTime{ 0 }; // Share of prepTime thrown away
+};
+
+// Phase A standing of a UAV with its gNB
+enum class UAVAccessState : uint8_t { Unauthenticated, Verifying, Authorized, Failed, Count };
+enum class UAVAccessEvent : uint8_t { ParamsReceived, GnbVerified, VerificationFailed, Count };
+
+struct UAVAccessTraits {
+    using State = UAVAccessState;
+    using Event = UAVAccessEvent;
+    using Handler = void (*)(UAV&);
+    using Row = StateTransition<State, Event, Handler>;
+
+    static constexpr const char* Name = "UAV access (Phase A)";
+    static constexpr State Initial = State::Unauthenticated;
+
+    static const char* StateName(State state)
+    {
+        static constexpr const char* names[] = { "Unauthenticated", "Verifying", "Authorized", "Failed" };
+        return names[static_cast<size_t>(state)];
+    }
+    static const char* EventName(Event event)
+    {
+        static constexpr const char* names[] = { "ParamsReceived", "GnbVerified", "VerificationFailed" };
+        return names[static_cast<size_t>(event)];
+    }
+
+    // Drops CKj/IKj/RESj/RAND' from the failed attempt (UAV.cpp)
+    static void ClearDerivedKeys(UAV& uav);
+
+    static constexpr std::array Table{
+        Row{ State::Unauthenticated, Event::ParamsReceived,     State::Verifying },
+        Row{ State::Authorized,      Event::ParamsReceived,     State::Verifying }, // Re-authentication
+        Row{ State::Failed,          Event::ParamsReceived,     State::Verifying },
+        Row{ State::Verifying,       Event::GnbVerified,        State::Authorized },
+        Row{ State::Verifying,       Event::VerificationFailed, State::Failed, &ClearDerivedKeys },
+    };
+};
+
+// Per-UE session held by a serving or handover-target UAV. Closed is
+// transient: the entry is erased right after entering it.
+enum class UAVSessionState : uint8_t { Inactive, Active, HandoverChallenged, Closed, Count };
+enum class UAVSessionEvent : uint8_t { KeysStored, HandoverChallenge, HandoverConfirmed, Expire, Release, Abort, Count };
+
+struct UAVSessionTraits {
+    using State = UAVSessionState;
+    using Event = UAVSessionEvent;
+    using Handler = void (*)();
+    using Row = StateTransition<State, Event, Handler>;
+
+    static constexpr const char* Name = "UAV UE session";
+    static constexpr State Initial = State::Inactive;
+
+    static const char* StateName(State state)
+    {
+        static constexpr const char* names[] = { "Inactive", "Active", "HandoverChallenged", "Closed" };
+        return names[static_cast<size_t>(state)];
+    }
+    static const char* EventName(Event event)
+    {
+        static constexpr const char* names[] = { "KeysStored", "HandoverChallenge", "HandoverConfirmed", "Expire", "Release", "Abort" };
+        return names[static_cast<size_t>(event)];
+    }
+
+    static constexpr std::array Table{
+        Row{ State::Inactive,           Event::KeysStored,        State::Active },
+        Row{ State::Inactive,           Event::HandoverChallenge, State::HandoverChallenged },
+        Row{ State::HandoverChallenged, Event::HandoverConfirmed, State::Active },
+        Row{ State::Active,             Event::Expire,            State::Closed },
+        Row{ State::HandoverChallenged, Event::Expire,            State::Closed },
+        Row{ State::Active,             Event::Release,           State::Closed },
+        Row{ State::HandoverChallenged, Event::Release,           State::Closed },
+        Row{ State::Active,             Event::Abort,             State::Closed },
+        Row{ State::HandoverChallenged, Event::Abort,             State::Closed },
+    };
+};
+
 // Unmanned Aerial Vehicle class (acts as a relay)
-class UAV : public Entity {
+class UAV : public Entity, public EnableSelfRef<UAV> {
 public:
     UAV(uint32_t xPos, uint32_t yPos, uint32_t xVel = 0, uint32_t yVel = 0, uint32_t id = 0) 
         : Entity(xPos, yPos, xVel, yVel, id) {}
 
     std::string GetType() const override { return "UAV"; }
 
-    inline void SetAssociatedGNB(std::shared_ptr<gNB> gnb) { m_ConnectedgNB = gnb; }
-    inline std::weak_ptr<gNB> GetAssociatedGNB() const { return m_ConnectedgNB; }
+    inline void SetAssociatedGNB(const EntityRef<gNB>& gnb) { m_ConnectedgNB = gnb; }
+    inline gNB* GetAssociatedGNB() const { return m_ConnectedgNB.Get(); }
 
     inline bool IsOperational() const { return m_Operational; }
 
@@ -36,6 +168,12 @@ public:
     }
 
     void SetLongTermKey(const std::string& key);
+    inline const std::string& GetLongTermKey() const { return m_LongTermKey_Kj; }
+
+    // --- Snapshot (see Snapshot.h) ---
+    // In-flight exchanges are not saved; snapshot a settled world.
+    void SaveSnapshot(SnapshotWriter& out) const;
+    bool LoadSnapshot(SnapshotReader& in, const SnapshotLinks& links);
 
     // --- UAV Service Access Authentication (Phase A) ---
     // Called by gNB after successful AKA steps
@@ -52,17 +190,20 @@ public:
     void ReceiveConnectionRequest(int ueId,
                                   const std::vector<uint8_t>& suci_bytes); // SUCI includes C1, C2, MAC
 
+    // Fast re-authentication: relayed like a SUCI (same admission control)
+    void ReceiveResumeRequest(int ueId, const ResumeRequest& request);
+
     // Called by gNB to forward UE auth params
     void ReceiveUEAuthParams(int ueId,
                              const std::vector<uint8_t>& hres_star_i,
                              const std::vector<uint8_t>& ci,
-                             const std::string& tid_i,
+                             const Kyber::TID& tid_i,
                              const std::vector<uint8_t>& kuav_i);
 
     // --- UE Handover Authentication (Phase C) ---
     // Receive handover request from UE
     void ReceiveHandoverAuthRequest(int ueId,
-                                    const std::string& tid_i,
+                                    const Kyber::TID& tid_i,
                                     const std::vector<uint8_t>& mac_i,
                                     const std::vector<uint8_t>& r1,
                                     const Kyber::Timestamp& tst);
@@ -70,27 +211,36 @@ public:
     // Receive handover confirmation from UE
     void ReceiveHandoverAuthConfirmation(int ueId, const std::vector<uint8_t>& xres_i);
 
+    // --- Protocol steps ---
+    // Handle one incoming message without forwarding the result; the
+    // Receive* entry points above chain them synchronously.
+    bool VerifyServiceAccessAuth(const std::vector<uint8_t>& hres_star_j,
+                                 const std::vector<uint8_t>& cj,
+                                 const std::vector<uint8_t>& rand_prime); // True once TIDj/GKUAV are stored
+    gNB* AcceptConnectionRequest(int ueId); // gNB to forward the SUCI to, or null
+    bool StoreUEAuthParams(int ueId, const Kyber::TID& tid_i, const std::vector<uint8_t>& kuav_i);
+    std::optional<HandoverAuthChallenge> ProcessHandoverRequest(int ueId, const HandoverAuthRequest& request);
+    bool VerifyHandoverConfirmation(int ueId, const std::vector<uint8_t>& xres_i);
+
     // --- General ---
-    inline const std::string& GetTID() const { return m_TIDj; }
-    inline bool IsAuthenticatedWithGNB() const { return m_IsAuthenticatedWithGNB; }
+    inline const Kyber::TID& GetTID() const { return m_TIDj; }
+    inline bool IsAuthenticatedWithGNB() const { return m_AccessState.Is(UAVAccessState::Authorized); }
+    inline UAVAccessState GetAccessState() const { return m_AccessState.Current(); }
     void BroadcastNotification(); // Broadcast TIDj
+    // Follow a group rekey from the gNB (GroupKeyTree.h): unwrap the keys
+    // on this UAV's path and take the new root key as GKUAV. True if GKUAV
+    // changed.
+    bool ApplyGroupRekey(const GroupRekey& rekey);
+    inline const std::vector<uint8_t>& GetGroupKey() const { return m_GKUAV; }
 
     // Placeholder for finding UE (replace with World lookup)
-    virtual std::shared_ptr<UE> FindUEById(int ueId) 
+    virtual UE* FindUEById(int ueId) 
     {
         if (findUEHandler)
             return findUEHandler(ueId);
         else
             return nullptr; 
     }
-    // Placeholder for getting self shared_ptr (replace with World mechanism or pass shared_ptr)
-    virtual std::shared_ptr<UAV> GetSelfPtr() 
-    {
-        if (getSelfPtrHandler)
-            return getSelfPtrHandler();
-        else
-            return nullptr;
-    }
 
     // --- Methods called by gNB to forward results to UE ---
     //void SendAuthResponseToUE(int ueId, const std::vector<uint8_t>& res_star);
@@ -112,12 +262,43 @@ public:
     // Get list of connected UE IDs (for gNB during failure handover)
     std::vector<int> GetConnectedUEIds() const;
 
-    std::function<std::shared_ptr<UE>(int)> findUEHandler;
-    std::function<std::shared_ptr<UAV>()> getSelfPtrHandler;
+    std::function<UE*(int)> findUEHandler;
+
+    // --- Auth-State Expiry ---
+    void Update(float deltaTime) override;
+    void SetAuthStateLimits(const AuthStateLimits& limits) { m_AuthLimits = limits; }
+    const AuthStateStats& GetAuthStateStats() const { return m_AuthStats; }
+    // Evict pending handovers and sessions whose deadline has passed
+    void ExpireAuthState();
+
+    // --- Relay load and admission control ---
+    void SetRelayCapacity(const RelayCapacity& capacity) { m_RelayCapacity = capacity; }
+    const RelayCapacity& GetRelayCapacity() const { return m_RelayCapacity; }
+    RelayLoad GetRelayLoad() const;
+    const RelayStats& GetRelayStats() const { return m_RelayStats; }
+    // True if `reserved` more UEs would still fit; UEs already served always do
+    bool CanAdmit(size_t reserved = 0) const;
+
+    // --- Handover preparation (Phase C) ---
+    // Derive TGK'i and K*UAVi for a UE predicted to hand over here, so its
+    // request only needs the R1/R2-dependent values
+    void PrepareHandover(const HandoverHint& hint);
+    void SetHandoverPrepLimits(const HandoverPrepLimits& limits);
+    const HandoverPrepStats& GetHandoverPrepStats() const { return m_PrepStats; }
+    size_t GetPreparedHandoverCount() const { return m_PreparedHandovers.size(); }
+
+    // --- Verified-token cache (Phase C) ---
+    // TGK'i of tokens that already passed a handover MAC check here, so a
+    // UE coming back with the same (TIDi, TST) skips the KDF under GKUAV
+    void SetTokenCacheLimits(const TokenCacheLimits& limits);
+    const TokenCacheStats& GetTokenCacheStats() const { return m_TokenCacheStats; }
+    size_t GetTokenCacheSize() const { return m_TokenCache.size(); }
 
 private:
-    std::weak_ptr<gNB> m_ConnectedgNB; // The gNB this UAV is associated with
-    std::map<int, std::weak_ptr<UE>> m_ConnectedUEs; // UEs connected via this UAV
+    friend struct UAVAccessTraits;
+
+    EntityRef<gNB> m_ConnectedgNB; // The gNB this UAV is associated with
+    std::map<int, EntityRef<UE>> m_ConnectedUEs; // UEs connected via this UAV
     bool m_Operational = true; // Status flag
 
     std::string m_LongTermKey_Kj; // UAV's long-term key
@@ -127,10 +308,11 @@ private:
     std::vector<uint8_t> m_Derived_RESj; // Derived RESj
 
 
-    bool m_IsAuthenticatedWithGNB = false;
-    std::string m_TIDj = ""; // Temporary Identity assigned by gNB
+    StateMachine<UAVAccessTraits> m_AccessState;
+    Kyber::TID m_TIDj; // Temporary Identity assigned by gNB
     std::vector<uint8_t> m_KRANj; // Key derived during UAV auth with gNB
     std::vector<uint8_t> m_GKUAV; // Group Key for UAVs
+    std::unordered_map<uint64_t, std::vector<uint8_t>> m_GroupPathKeys; // Key-tree node -> key, from the leaf (KRANj) up
 
     // State for ongoing authentications
     std::map<int, std::vector<uint8_t>> m_PendingUEAuth_C1; // Store C1 from SUCI temporarily if needed
@@ -138,14 +320,83 @@ private:
 
     // State for UE connections established via this UAV
     struct UEConnectionInfo {
-        std::string tid_i;
+        Kyber::TID tid_i;
         std::vector<uint8_t> kuav_i; // Key between UE and this UAV
-        std::vector<uint8_t> r1; // Store R1 during handover
-        std::vector<uint8_t> expected_res_i; // Store RESi during handover
+        std::vector<uint8_t> r1{}; // Store R1 during handover
+        std::vector<uint8_t> expected_res_i{}; // Store RESi during handover
+        Kyber::Timestamp tst{}; // Token expiry presented during handover
+        uint64_t expiryTick = 0; // Deadline tracked by m_ExpiryWheel
+        StateMachine<UAVSessionTraits> state{};
     };
     std::map<int, UEConnectionInfo> m_ConnectedUEInfo; // Map UE ID -> Info
 
-    // Helper to get associated gNB shared_ptr
-    std::shared_ptr<gNB> GetAssociatedGNBShared() const;
+    // Session/pending-handover expiry keyed by UE ID (lazy cancellation)
+    TimingWheel<int> m_ExpiryWheel{ AuthStateNowTick() };
+    AuthStateLimits m_AuthLimits;
+    AuthStateStats m_AuthStats;
+
+    RelayCapacity m_RelayCapacity;
+    RelayStats m_RelayStats;
+    std::map<int, uint64_t> m_AdmittedUEs; // Phase B relayed, keys not back yet -> deadline tick
+    uint64_t m_RelayedSinceUpdate = 0;
+    double m_RelayRate = 0.0;
+
+    // Verified TGK'i by (TIDi, TST). m_TokenOrder holds keys in insertion
+    // order, which is also expiry order; an entry whose expiry no longer
+    // matches the record is stale.
+    struct TokenKey {
+        Kyber::TID tid_i;
+        int64_t tst = 0; // Kyber::Timestamp ticks
+        bool operator==(const TokenKey&) const = default;
+    };
+    struct TokenKeyHash {
+        size_t operator()(const TokenKey& key) const noexcept {
+            return Kyber::TIDHash{}(key.tid_i) ^ std::hash<int64_t>{}(key.tst);
+        }
+    };
+    struct CachedToken {
+        std::vector<uint8_t> tgk_i;
+        uint64_t expiryTick = 0;
+    };
+    std::unordered_map<TokenKey, CachedToken, TokenKeyHash> m_TokenCache;
+    std::deque<std::pair<TokenKey, uint64_t>> m_TokenOrder;
+    TokenCacheLimits m_TokenCacheLimits;
+    TokenCacheStats m_TokenCacheStats;
+
+    // Handovers prepared from hints, by the same key and with the same
+    // FIFO expiry as the token cache. Unverified until a request's MAC
+    // checks out, so kept apart from it.
+    struct PreparedHandover {
+        std::vector<uint8_t> tgk_i;
+        std::vector<uint8_t> k_star_uav_i;
+        std::chrono::nanoseconds cost{ 0 };
+        uint64_t expiryTick = 0;
+    };
+    std::unordered_map<TokenKey, PreparedHandover, TokenKeyHash> m_PreparedHandovers;
+    std::deque<std::pair<TokenKey, uint64_t>> m_PreparedOrder;
+    HandoverPrepLimits m_PrepLimits;
+    HandoverPrepStats m_PrepStats;
+
+    // Removes and returns the preparation for `key`, if still live
+    std::optional<PreparedHandover> TakePreparedHandover(const TokenKey& key);
+    void TrimPreparedHandovers();
+    void DropPreparedHandovers();
+
+    // Cached TGK'i for `key`, or null; counts the hit or miss
+    const std::vector<uint8_t>* FindCachedTGK(const TokenKey& key);
+    void CacheTGK(const TokenKey& key, std::vector<uint8_t> tgk_i);
+    void TrimTokenCache();
+    // GKUAV changed: every cached TGK'i is stale
+    void InvalidateTokenCache();
+
+    // Cap check before inserting a new UE entry; counts rejects
+    bool HasSessionCapacity(int ueId);
+    // RelayCapacity check for a new Phase B or handover request; counts rejects
+    bool AdmitUE(int ueId);
+    inline void CountRelayed() { m_RelayStats.relayed++; m_RelayedSinceUpdate++; }
+    void ScheduleUEExpiry(int ueId, uint64_t expiryTick);
+
+    // Helper to resolve the associated gNB, logging if it is gone
+    gNB* ResolveAssociatedGNB() const;
 
 };
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Relay limits of one UAV. A request that would push the UAV past any of
+// them is rejected (UAV::AdmitUE) and the UE is redirected to another UAV.
+// The defaults never reject.
+struct RelayCapacity {
+    size_t maxConnectedUEs = std::numeric_limits<size_t>::max();
+    size_t maxPendingAuths = std::numeric_limits<size_t>::max();
+    double maxRelayRate = std::numeric_limits<double>::infinity(); // Messages per simulated second
+};
+
+// Current relay load of one UAV (UAV::GetRelayLoad)
+struct RelayLoad {
+    size_t connectedUEs = 0;   // UEs this UAV serves
+    size_t pendingAuths = 0;   // Phase B requests relayed and handovers challenged, not yet settled
+    double relayRate = 0.0;    // Relayed messages per simulated second, smoothed over ~1 s
+};
+
+struct RelayStats {
+    uint64_t relayed = 0;          // Protocol messages handled on behalf of a UE
+    uint64_t admissionRejects = 0; // Requests refused by RelayCapacity
+};
+
+// Cost of serving a UE from a UAV; the lowest-cost admitting UAV wins. All
+// weights are in distance units, so the defaults let a UAV with five more
+// connected UEs lose to one 10 units further away.
+struct UAVSelectionPolicy {
+    double distanceWeight = 1.0;
+    double connectedWeight = 2.0;       // Per connected UE
+    double pendingWeight = 5.0;         // Per in-flight authentication
+    double relayRateWeight = 1.0;       // Per relayed message per second
+    double otherGNBPenalty = 100.0;     // UAV is anchored at a different gNB than preferred
+    uint32_t maxRedirects = 3;          // Further UAVs tried when the chosen one rejects
+
+    // `reserved` counts UEs already assigned to the UAV but not attached yet
+    double Cost(double distance, const RelayLoad& load, bool sameGNB, size_t reserved = 0) const
+    {
+        return distanceWeight * distance
+            + connectedWeight * static_cast<double>(load.connectedUEs + reserved)
+            + pendingWeight * static_cast<double>(load.pendingAuths)
+            + relayRateWeight * load.relayRate
+            + (sameGNB ? 0.0 : otherGNBPenalty);
+    }
+};
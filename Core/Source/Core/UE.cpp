@@ -1,5 +1,8 @@
 ﻿#include "UE.h"
 #include "KyberUtils.h"
+#include "PerfCounters.h"
+#include "AuthArena.h"
+#include "Snapshot.h"
 #include <random>
 #include <vector>
 #include <array>
@@ -7,120 +10,221 @@
 #include <iomanip>
 #include <stdexcept>
 
-void UE::SetAuthenticationParameters(const std::string& supi, const std::string& key, const std::vector<uint8_t>& amf, const std::vector<uint8_t>& rho, const Kyber::Polynomial& pk)
+void UE::SetAuthenticationParameters(const std::string& supi, std::string_view key, std::shared_ptr<const Kyber::NetworkParams> network)
 {
-    m_SUPI = supi;
-    m_LongTermKey = key;
-    m_AMF = amf;
-    m_Rho = rho;
-    m_NetworkPK = pk;
-
-    // Assuming Kyber::Matrix A is generated from rho  
-    m_A = Kyber::GenerateA(rho);
+    if (!m_SUPI.Assign(std::string_view(supi)) || !m_LongTermKey.Assign(key)) {
+        std::cerr << "UE " << m_Id << ": Error - SUPI or long-term key exceeds inline capacity." << std::endl;
+        return;
+    }
+    // AMF, rho, pk and A are shared with the provisioning gNB instead of copied
+    m_Network = std::move(network);
 
     std::cout << "Authentication parameters set for UE " << m_Id << std::endl;
 }
 
-// Helper to get connected UAV shared_ptr
-std::shared_ptr<UAV> UE::GetConnectedUAVShared() const {
-    if (auto uav_sp = m_ConnectedUAV.lock()) {
-        return uav_sp;
-    }
-    return nullptr;
+// Helper to resolve the connected UAV
+UAV* UE::GetConnectedUAV() const {
+    return m_ConnectedUAV.Get();
+}
+
+UE::SessionKeys& UE::Session() {
+    if (!m_Session) m_Session = std::make_unique<SessionKeys>();
+    return *m_Session;
+}
+
+void UE::ClearHandoverState() {
+    if (!m_Session) return;
+    m_Session->handover_r1.clear();
+    m_Session->handover_target_tid_j.clear();
+    m_Session->handover_target_uav.Reset();
+    m_Session->handover_tgk_i.clear();
+    m_Session->handover_gnb_id = 0;
+}
+
+// --- State machine handlers ---
+
+void UEStateTraits::ClearHandover(UE& ue)
+{
+    ue.ClearHandoverState();
+}
+
+void UEStateTraits::ReleaseSession(UE& ue)
+{
+    ue.m_Session.reset();
 }
 
 void UE::InitiateConnection(UAV& targetUAV) {
-    std::cout << "UE " << m_Id << ": Initiating connection via UAV " << targetUAV.GetID() << std::endl;
-    m_UEState = "Connecting";
+    // Phase B runs UE -> UAV -> gNB -> UAV -> UE on this thread; all
+    // temporaries share one arena released when this returns
+    Kyber::AuthTransaction txn;
+    if (std::optional<ResumeRequest> resume = BuildResumeRequest(targetUAV)) {
+        std::cout << "UE " << m_Id << " -> UAV " << targetUAV.GetID() << ": Sending resumption request" << std::endl;
+        targetUAV.ReceiveResumeRequest(m_Id, *resume);
+        if (m_State.Is(UEState::Connected)) {
+            return;
+        }
+        std::cout << "UE " << m_Id << ": Resumption not accepted; falling back to full authentication." << std::endl;
+        AbandonResumption();
+    }
+    std::optional<std::vector<uint8_t>> suci_bytes = BuildConnectionRequest(targetUAV);
+    if (!suci_bytes) {
+        return;
+    }
+
+    // Send SUCI to UAV
+    std::cout << "UE " << m_Id << " -> UAV " << targetUAV.GetID() << ": Sending SUCI" << std::endl;
+    targetUAV.ReceiveConnectionRequest(m_Id, *suci_bytes);
+}
+
+std::optional<std::vector<uint8_t>> UE::BuildConnectionRequest(UAV& uav) {
+    std::cout << "UE " << m_Id << ": Initiating connection via UAV " << uav.GetID() << std::endl;
+    if (!m_State.Fire(UEEvent::Connect, *this)) {
+        std::cerr << "UE " << m_Id << ": Cannot initiate connection in state " << UEStateName(m_State.Current()) << "." << std::endl;
+        return std::nullopt;
+    }
+    // Becomes the serving UAV once the auth response checks out
+    m_ConnectedUAV = uav.SelfRef();
+    Session().resume_counter = 0;
 
     // Step 1 & 2: Generate SUCI = C1 || C2 || MAC
-    
-    
+
+
     // It stores RAND and increments SQN internally.
     auto [suci_bytes, suci_string_for_display] = GenerateAuthParams(); // Assuming this returns the byte vector now
 
     std::cout << "UE " << m_Id << ": Generated SUCI: " << suci_string_for_display << std::endl;
+    return std::move(suci_bytes);
+}
 
-    // Send SUCI to UAV
-    std::cout << "UE " << m_Id << " -> UAV " << targetUAV.GetID() << ": Sending SUCI" << std::endl;
-    targetUAV.ReceiveConnectionRequest(m_Id, suci_bytes);
+std::optional<ResumeRequest> UE::BuildResumeRequest(UAV& uav) {
+    if (!m_Resumption) {
+        return std::nullopt;
+    }
+    std::cout << "UE " << m_Id << ": Resuming session via UAV " << uav.GetID() << std::endl;
+    if (!m_State.Fire(UEEvent::Connect, *this)) {
+        std::cerr << "UE " << m_Id << ": Cannot resume in state " << UEStateName(m_State.Current()) << "." << std::endl;
+        return std::nullopt;
+    }
+    m_ConnectedUAV = uav.SelfRef();
+
+    ResumeRequest request;
+    request.tid_i = m_Resumption->tid_i;
+    request.counter = ++m_Resumption->counter;
+    request.mac = Kyber::ResumeRequestMAC(m_Resumption->kran_i, request.tid_i, request.counter);
+    Session().resume_counter = request.counter;
+    return request;
+}
+
+void UE::AbandonResumption() {
+    m_Resumption.reset();
+    if (m_Session) m_Session->resume_counter = 0;
 }
 
 void UE::HandleUAVAssistedAuthResponse(const std::vector<uint8_t>& hres_star_i,
                                        const std::vector<uint8_t>& ci,
-                                       const std::string& tid_j) { // UAV's TID needed
+                                       const Kyber::TID& tid_j) { // UAV's TID needed
+    PERF_SCOPE("UE::HandleUAVAssistedAuthResponse");
+    Kyber::AuthTransaction txn;
+    std::pmr::memory_resource* arena = Kyber::AuthTransaction::Resource();
     std::cout << "UE " << m_Id << ": Received UAV-Assisted Auth Response (HRES*i, Ci) via UAV (TIDj=" << tid_j << ")" << std::endl;
 
+    if (!m_State.Is(UEState::Connecting)) {
+        std::cerr << "UE " << m_Id << ": Ignoring unexpected Auth Response in state " << UEStateName(m_State.Current()) << "." << std::endl;
+        return;
+    }
+
+    SessionKeys& session = Session();
+    const std::string_view longTermKey = m_LongTermKey.AsString();
+    // A resumption answer is keyed by the next KRANi and carries no RES*i
+    const bool resuming = session.resume_counter != 0 && m_Resumption;
+
     // Step 6: Calculate HXRES*i and KRANi
     // Need RAND from the initial GenerateAuthParams call.
     // Need K (long term key).
 
-    m_KRANi = Kyber::KDF(Kyber::StringToBytes(m_LongTermKey), m_RAND); 
-    std::cout << "UE " << m_Id << ": Derived KRANi (size=" << m_KRANi.size() << ")" << std::endl;
-
-
+    bool kran_fits = resuming
+        ? session.kran_i.Assign(Kyber::ResumeKRAN(m_Resumption->kran_i, m_Resumption->tid_i, session.resume_counter))
+        : session.kran_i.Assign(Kyber::KDF(m_LongTermKey, session.rand, arena));
+    if (!kran_fits) {
+        std::cerr << "UE " << m_Id << ": Error - KRANi exceeds inline key capacity." << std::endl;
+        m_State.Fire(UEEvent::AuthFailed, *this);
+        return;
+    }
+    std::cout << "UE " << m_Id << ": Derived KRANi (size=" << session.kran_i.size() << ")" << std::endl;
 
-    std::vector<uint8_t> res_i = Kyber::f2K(m_LongTermKey, m_RAND);
-    std::vector<uint8_t> ck = Kyber::f3K(m_LongTermKey, m_RAND);
-    std::vector<uint8_t> ik = Kyber::f4K(m_LongTermKey, m_RAND);
-    std::vector<uint8_t> ck_ik = Kyber::ConcatBytes({ck, ik});
-    std::vector<uint8_t> net_name_bytes = Kyber::StringToBytes("TestNet"); // Assume known or configured
-    std::vector<uint8_t> res_star_input = Kyber::ConcatBytes({net_name_bytes, m_RAND, res_i});
-    for(size_t i=0; i<res_star_input.size() && i<ck_ik.size(); ++i) res_star_input[i] ^= ck_ik[i];
-    std::vector<uint8_t> res_star_i = Kyber::KDF(res_star_input); // This is RES*i
-    std::cout << "UE " << m_Id << ": Calculated RES*i." << std::endl;
 
 
-    // Calculate HXRES*i = KDF(KRANi, Ci || RES*i)
-    std::vector<uint8_t> hxres_input = ci;
-    hxres_input.insert(hxres_input.end(), res_star_i.begin(), res_star_i.end());
-    std::vector<uint8_t> hxres_star_i = Kyber::KDF(m_KRANi, hxres_input);
-    std::cout << "UE " << m_Id << ": Calculated HXRES*i." << std::endl;
+    Kyber::ArenaBytes hxres_star_i(arena);
+    if (resuming) {
+        // HXRES*i = KDF(KRANi, Ci)
+        hxres_star_i = Kyber::KDF(session.kran_i, ci, arena);
+        std::cout << "UE " << m_Id << ": Calculated HXRES*i under the resumed KRANi." << std::endl;
+    } else {
+        Kyber::ArenaBytes res_i = Kyber::f2K(longTermKey, session.rand, arena);
+        Kyber::ArenaBytes ck = Kyber::f3K(longTermKey, session.rand, arena);
+        Kyber::ArenaBytes ik = Kyber::f4K(longTermKey, session.rand, arena);
+        Kyber::ArenaBytes ck_ik = Kyber::ConcatBytes({ck, ik}, arena);
+        Kyber::ArenaBytes net_name_bytes = Kyber::StringToBytes("TestNet", arena); // Assume known or configured
+        Kyber::ArenaBytes res_star_input = Kyber::ConcatBytes({net_name_bytes, session.rand, res_i}, arena);
+        for(size_t i=0; i<res_star_input.size() && i<ck_ik.size(); ++i) res_star_input[i] ^= ck_ik[i];
+        Kyber::ArenaBytes res_star_i = Kyber::KDF(res_star_input, arena); // This is RES*i
+        std::cout << "UE " << m_Id << ": Calculated RES*i." << std::endl;
+
+        // Calculate HXRES*i = KDF(KRANi, Ci || RES*i)
+        Kyber::ArenaBytes hxres_input = Kyber::ConcatBytes({ci, res_star_i}, arena);
+        hxres_star_i = Kyber::KDF(session.kran_i, hxres_input, arena);
+        std::cout << "UE " << m_Id << ": Calculated HXRES*i." << std::endl;
+    }
 
 
     // Authenticate network: Check HXRES*i == HRES*i
-    if (hxres_star_i != hres_star_i) {
+    if (!Kyber::BytesEqual(hxres_star_i, hres_star_i)) {
         std::cerr << "UE " << m_Id << ": Network authentication failed! HRES*i mismatch." << std::endl;
-        m_UEState = "Failed";
+        m_State.Fire(UEEvent::AuthFailed, *this);
         Disconnect(); // Or specific failure state
         return;
     }
     std::cout << "UE " << m_Id << ": Network authentication successful (HRES*i matches)." << std::endl;
 
     // Compute TID'i || Token'i = DKRANi(Ci)
-    std::vector<uint8_t> decrypted_ci = Kyber::DecryptSymmetric(m_KRANi, ci);
+    Kyber::ArenaBytes decrypted_ci = Kyber::DecryptSymmetric(session.kran_i, ci, arena);
     std::cout << "UE " << m_Id << ": Decrypted Ci (size=" << decrypted_ci.size() << ")" << std::endl;
 
 
     // Parse TID'i and Token'i
     // Assuming format: [TIDi_bytes][Tokeni_bytes = TGKi || TST]
-    size_t tid_len = 19; // Example fixed length, must match gNB's generation
+    constexpr size_t tid_len = Kyber::TID::Bytes;
     size_t tst_len = sizeof(long long); // Timestamp bytes length
-    if (decrypted_ci.size() <= tid_len) {
+    Kyber::ByteView decrypted_view(decrypted_ci);
+    std::optional<Kyber::TID> tid_i = decrypted_ci.size() > tid_len ? Kyber::TID::FromBytes(decrypted_view.first(tid_len)) : std::nullopt;
+    if (!tid_i) {
          std::cerr << "UE " << m_Id << ": Error - Decrypted Ci too short to contain TIDi." << std::endl;
-         m_UEState = "Failed";
+         m_State.Fire(UEEvent::AuthFailed, *this);
          return;
     }
-    m_TIDi = Kyber::BytesToString(std::vector<uint8_t>(decrypted_ci.begin(), decrypted_ci.begin() + tid_len));
-    m_Tokeni = std::vector<uint8_t>(decrypted_ci.begin() + tid_len, decrypted_ci.end());
-    std::cout << "UE " << m_Id << ": Parsed TID'i=" << m_TIDi << ", Token'i size=" << m_Tokeni.size() << std::endl;
+    Kyber::ByteView token_i = decrypted_view.subspan(tid_len);
+    session.tid_i = *tid_i;
+    std::cout << "UE " << m_Id << ": Parsed TID'i=" << session.tid_i << ", Token'i size=" << token_i.size() << std::endl;
 
 
-    // Parse TGKi and TST from Token'i
-    if (m_Tokeni.size() <= tst_len) {
+    // Parse TGKi and TST from Token'i; the token itself is not retained
+    if (token_i.size() <= tst_len) {
          std::cerr << "UE " << m_Id << ": Error - Token'i too short to contain TST." << std::endl;
-         m_UEState = "Failed";
+         m_State.Fire(UEEvent::AuthFailed, *this);
          return;
     }
-    m_TGKi = std::vector<uint8_t>(m_Tokeni.begin(), m_Tokeni.end() - tst_len);
-    std::vector<uint8_t> tst_bytes(m_Tokeni.end() - tst_len, m_Tokeni.end());
-    m_TST = Kyber::BytesToTimestamp(tst_bytes);
-    std::cout << "UE " << m_Id << ": Parsed TGKi (size=" << m_TGKi.size() << ") and TST." << std::endl;
+    if (!session.tgk_i.Assign(token_i.first(token_i.size() - tst_len))) {
+         std::cerr << "UE " << m_Id << ": Error - TGKi exceeds inline key capacity." << std::endl;
+         m_State.Fire(UEEvent::AuthFailed, *this);
+         return;
+    }
+    session.tst = Kyber::BytesToTimestamp(token_i.last(tst_len));
+    std::cout << "UE " << m_Id << ": Parsed TGKi (size=" << session.tgk_i.size() << ") and TST." << std::endl;
 
     // Validate TST
-    if (!Kyber::ValidateTST(m_TST)) {
+    if (!Kyber::ValidateTST(session.tst)) {
          std::cerr << "UE " << m_Id << ": Error - Received TST is invalid/expired." << std::endl;
-         m_UEState = "Failed";
+         m_State.Fire(UEEvent::AuthFailed, *this);
          return;
     }
      std::cout << "UE " << m_Id << ": TST is valid." << std::endl;
@@ -129,12 +233,13 @@ void UE::HandleUAVAssistedAuthResponse(const std::vector<uint8_t>& hres_star_i,
     // Update SQNi = SQNi + 1 (already done in GenerateAuthParams)
 
     // Compute KUAVi = KDF(KRANi, TID'i || TIDj)
-    std::vector<uint8_t> tidi_bytes = Kyber::StringToBytes(m_TIDi);
-    std::vector<uint8_t> tidj_bytes = Kyber::StringToBytes(tid_j);
-    std::vector<uint8_t> kuavi_input = tidi_bytes;
-    kuavi_input.insert(kuavi_input.end(), tidj_bytes.begin(), tidj_bytes.end());
-    m_KUAVi = Kyber::KDF(m_KRANi, kuavi_input);
-    std::cout << "UE " << m_Id << ": Computed KUAVi (size=" << m_KUAVi.size() << ")" << std::endl;
+    Kyber::ArenaBytes kuavi_input = Kyber::ConcatBytes({session.tid_i, tid_j}, arena);
+    if (!session.kuav_i.Assign(Kyber::KDF(session.kran_i, kuavi_input, arena))) {
+         std::cerr << "UE " << m_Id << ": Error - KUAVi exceeds inline key capacity." << std::endl;
+         m_State.Fire(UEEvent::AuthFailed, *this);
+         return;
+    }
+    std::cout << "UE " << m_Id << ": Computed KUAVi (size=" << session.kuav_i.size() << ")" << std::endl;
 
 
     // Store (TID'i, KUAVi, Token'i)
@@ -147,145 +252,233 @@ void UE::HandleUAVAssistedAuthResponse(const std::vector<uint8_t>& hres_star_i,
     // Update state to Connected
     // Need to get shared_ptr to the UAV somehow (passed in or looked up)
     // ConfirmConnection(find_uav_somehow(tid_j), find_gnb_somehow()); // Update connection state
-     m_UEState = "Connected"; // Simplified state update
+     if (UAV* uav = m_ConnectedUAV.Get()) {
+         m_ServingUAVId = uav->GetID();
+         if (gNB* gnb = uav->GetAssociatedGNB()) m_ServingGNBId = gnb->GetID();
+     }
+     // Keep KRANi for a later fast re-authentication
+     if (!m_Resumption) m_Resumption = std::make_unique<ResumptionTicket>();
+     m_Resumption->tid_i = session.tid_i;
+     m_Resumption->kran_i = session.kran_i;
+     m_Resumption->counter = 0;
+     session.resume_counter = 0;
+     m_State.Fire(UEEvent::AuthSucceeded, *this); // Simplified state update
      std::cout << "UE " << m_Id << ": Authentication successful. State set to Connected." << std::endl;
 
 
 }
 
 void UE::InitiateHandoverAuthentication(UAV& targetUAV) {
+    // Crossing to another gNB: UE -> serving gNB -> target gNB -> UE first
+    gNB* source = GetServingGNB();
+    gNB* target = targetUAV.GetAssociatedGNB();
+    if (source && target && source != target) {
+        std::optional<XnHandoverRequest> xn = BuildXnHandoverRequest(target->GetID());
+        if (!xn) {
+            return;
+        }
+        std::optional<XnHandoverContext> context = source->PrepareXnHandover(m_Id, *xn);
+        std::optional<XnHandoverCommand> command = context ? target->AcceptXnHandover(m_Id, *context) : std::nullopt;
+        if (!command || !ApplyXnHandoverCommand(*command)) {
+            std::cerr << "UE " << m_Id << ": Xn preparation towards gNB " << target->GetID() << " failed." << std::endl;
+            return;
+        }
+    }
+
+    std::optional<HandoverAuthRequest> request = BuildHandoverRequest(targetUAV);
+    if (!request) {
+        return;
+    }
+
+    // Transmit (TIDi, MACi, R1, TST) to target UAV
+    std::cout << "UE " << m_Id << " -> Target UAV " << targetUAV.GetID() << ": Sending Handover Auth Request (TIDi, MACi, R1, TST)" << std::endl;
+    targetUAV.ReceiveHandoverAuthRequest(m_Id, request->tid_i, request->mac_i, request->r1, request->tst);
+}
+
+std::optional<HandoverAuthRequest> UE::BuildHandoverRequest(UAV& targetUAV) {
     std::cout << "UE " << m_Id << ": Initiating Handover Authentication with Target UAV " << targetUAV.GetID() << " (TID*j=" << targetUAV.GetTID() << ")" << std::endl;
 
-    if (m_UEState != "Connected" || m_TIDi.empty() || m_TGKi.empty() || !Kyber::ValidateTST(m_TST)) {
+    if (!m_State.CanFire(UEEvent::StartHandover) || !m_Session || m_Session->tid_i.empty() || m_Session->tgk_i.empty() || !Kyber::ValidateTST(m_Session->tst)) {
         std::cerr << "UE " << m_Id << ": Cannot initiate handover. Not connected or missing required state (TIDi, TGKi, valid TST)." << std::endl;
-        return;
+        return std::nullopt;
+    }
+    SessionKeys& session = *m_Session;
+    Kyber::AuthTransaction txn;
+    std::pmr::memory_resource* arena = Kyber::AuthTransaction::Resource();
+
+    // A TGKi prepared over Xn is only good at that gNB's UAVs
+    gNB* targetGNB = targetUAV.GetAssociatedGNB();
+    if (session.handover_gnb_id != 0 && (!targetGNB || targetGNB->GetID() != session.handover_gnb_id)) {
+        session.handover_tgk_i.clear();
+        session.handover_gnb_id = 0;
     }
 
-    m_UEState = "Handover";
-    m_Handover_TargetTIDj = targetUAV.GetTID();
-    m_Handover_TargetUAV = targetUAV.GetSelfPtr(); // Need a way for UAV to provide its shared_ptr
+    m_State.Fire(UEEvent::StartHandover, *this);
+    session.handover_target_tid_j = targetUAV.GetTID();
+    session.handover_target_uav = targetUAV.SelfRef();
 
     // Step 1: Generate R1, compute MACi
-    m_Handover_R1 = GenerateRandomBytes(16); // Example size for R1
+    std::vector<uint8_t> r1 = GenerateRandomBytes(16); // Example size for R1
+    session.handover_r1.Assign(r1);
     std::cout << "UE " << m_Id << ": Generated R1 for handover." << std::endl;
 
 
     // MACi = KDF(TGKi, TID*j || TIDi || R1)
-    std::vector<uint8_t> tid_star_j_bytes = Kyber::StringToBytes(m_Handover_TargetTIDj);
-    std::vector<uint8_t> tidi_bytes = Kyber::StringToBytes(m_TIDi);
-    std::vector<uint8_t> mac_input = tid_star_j_bytes;
-    mac_input.insert(mac_input.end(), tidi_bytes.begin(), tidi_bytes.end());
-    mac_input.insert(mac_input.end(), m_Handover_R1.begin(), m_Handover_R1.end());
-    std::vector<uint8_t> mac_i = Kyber::KDF(m_TGKi, mac_input);
+    Kyber::ArenaBytes mac_input = Kyber::ConcatBytes({session.handover_target_tid_j, session.tid_i, r1}, arena);
+    std::vector<uint8_t> mac_i = Kyber::KDF(session.HandoverTGK(), mac_input);
     std::cout << "UE " << m_Id << ": Computed MACi for handover." << std::endl;
-
-
-    // Transmit (TIDi, MACi, R1, TST) to target UAV
-    std::cout << "UE " << m_Id << " -> Target UAV " << targetUAV.GetID() << ": Sending Handover Auth Request (TIDi, MACi, R1, TST)" << std::endl;
-    targetUAV.ReceiveHandoverAuthRequest(m_Id, m_TIDi, mac_i, m_Handover_R1, m_TST);
+    return HandoverAuthRequest{ session.tid_i, std::move(mac_i), std::move(r1), session.tst };
 }
 
 void UE::HandleHandoverAuthChallenge(const std::vector<uint8_t>& hres_i,
                                      const std::vector<uint8_t>& r2) {
-    std::cout << "UE " << m_Id << ": Received Handover Auth Challenge (HRESi, R2) from Target UAV " << m_Handover_TargetTIDj << std::endl;
+    std::optional<std::vector<uint8_t>> xres_i = AnswerHandoverChallenge(hres_i, r2);
+    if (!xres_i) {
+        return;
+    }
+
+    // Transmit XRESi to target UAV
+    if (UAV* targetUAV = m_Session->handover_target_uav.Get()) {
+        std::cout << "UE " << m_Id << " -> Target UAV " << targetUAV->GetID() << ": Sending Handover Auth Confirmation (XRESi)" << std::endl;
+        targetUAV->ReceiveHandoverAuthConfirmation(m_Id, *xres_i);
+        FinishHandover(true);
+    } else {
+         std::cerr << "UE " << m_Id << ": Target UAV pointer invalid. Cannot complete handover." << std::endl;
+         FinishHandover(false);
+    }
+}
 
-    if (m_UEState != "Handover" || m_Handover_R1.empty() || m_Handover_TargetTIDj.empty()) {
+std::optional<std::vector<uint8_t>> UE::AnswerHandoverChallenge(const std::vector<uint8_t>& hres_i,
+                                                                const std::vector<uint8_t>& r2) {
+    PERF_SCOPE("UE::HandleHandoverAuthChallenge");
+    if (!m_State.Is(UEState::Handover) || !m_Session || m_Session->handover_r1.empty() || m_Session->handover_target_tid_j.empty()) {
          std::cerr << "UE " << m_Id << ": Received unexpected Handover Challenge or missing state." << std::endl;
-         return;
+         return std::nullopt;
     }
+    SessionKeys& session = *m_Session;
+    Kyber::AuthTransaction txn;
+    std::pmr::memory_resource* arena = Kyber::AuthTransaction::Resource();
+    std::cout << "UE " << m_Id << ": Received Handover Auth Challenge (HRESi, R2) from Target UAV " << session.handover_target_tid_j << std::endl;
 
     // Step 3: Compute XRESi, HXRESi
     // XRESi = KDF(TGKi, TID*j || TIDi || R1 || R2)
-    std::vector<uint8_t> tid_star_j_bytes = Kyber::StringToBytes(m_Handover_TargetTIDj);
-    std::vector<uint8_t> tidi_bytes = Kyber::StringToBytes(m_TIDi);
-    std::vector<uint8_t> xres_input = tid_star_j_bytes;
-    xres_input.insert(xres_input.end(), tidi_bytes.begin(), tidi_bytes.end());
-    xres_input.insert(xres_input.end(), m_Handover_R1.begin(), m_Handover_R1.end());
-    xres_input.insert(xres_input.end(), r2.begin(), r2.end());
-    std::vector<uint8_t> xres_i = Kyber::KDF(m_TGKi, xres_input);
+    Kyber::ArenaBytes xres_input = Kyber::ConcatBytes({session.handover_target_tid_j, session.tid_i, session.handover_r1, r2}, arena);
+    std::vector<uint8_t> xres_i = Kyber::KDF(session.HandoverTGK(), xres_input);
     std::cout << "UE " << m_Id << ": Computed XRESi." << std::endl;
 
 
     // HXRESi = KDF(XRESi || R2)
-    std::vector<uint8_t> hxres_input = xres_i;
-    hxres_input.insert(hxres_input.end(), r2.begin(), r2.end());
-    std::vector<uint8_t> hxres_i = Kyber::KDF(hxres_input); // Using KDF as hash
+    Kyber::ArenaBytes hxres_input = Kyber::ConcatBytes({xres_i, r2}, arena);
+    Kyber::ArenaBytes hxres_i = Kyber::KDF(hxres_input, arena); // Using KDF as hash
     std::cout << "UE " << m_Id << ": Computed HXRESi." << std::endl;
 
 
     // Check HXRESi == HRESi
-    if (hxres_i != hres_i) {
+    if (!Kyber::BytesEqual(hxres_i, hres_i)) {
         std::cerr << "UE " << m_Id << ": Handover authentication failed! HRESi mismatch." << std::endl;
-        m_UEState = "Connected"; // Revert state? Or FailedHandover?
-        m_Handover_R1.clear();
-        m_Handover_TargetTIDj = "";
-        m_Handover_TargetUAV.reset();
-        return;
+        m_State.Fire(UEEvent::HandoverFailed, *this); // Back to the source UAV
+        return std::nullopt;
     }
     std::cout << "UE " << m_Id << ": Handover authentication successful (HRESi matches)." << std::endl;
 
     // Compute K*UAVi = KDF(TGKi, TID*j || TIDi)
-    std::vector<uint8_t> k_star_input = tid_star_j_bytes;
-    k_star_input.insert(k_star_input.end(), tidi_bytes.begin(), tidi_bytes.end());
-    std::vector<uint8_t> k_star_uav_i = Kyber::KDF(m_TGKi, k_star_input);
+    Kyber::ArenaBytes k_star_input = Kyber::ConcatBytes({session.handover_target_tid_j, session.tid_i}, arena);
+    Kyber::ArenaBytes k_star_uav_i = Kyber::KDF(session.HandoverTGK(), k_star_input, arena);
     std::cout << "UE " << m_Id << ": Computed K*UAVi (new KUAVi)." << std::endl;
 
 
     // Store K*UAVi (replace old KUAVi)
-    m_KUAVi = k_star_uav_i;
+    session.kuav_i.Assign(k_star_uav_i);
     std::cout << "UE " << m_Id << ": Stored new KUAVi." << std::endl;
+    return xres_i;
+}
 
+void UE::FinishHandover(bool confirmed) {
+    UAV* targetUAV = m_Session ? m_Session->handover_target_uav.Get() : nullptr;
+    if (!confirmed || !targetUAV) {
+        m_State.Fire(UEEvent::HandoverFailed, *this);
+        return;
+    }
+    // Update connection state
+    m_ConnectedUAV = m_Session->handover_target_uav; // Point to new UAV
+    m_ServingUAVId = targetUAV->GetID();
+    // After an Xn preparation the target gNB's TGKi is the one from now on
+    if (!m_Session->handover_tgk_i.empty()) {
+        m_Session->tgk_i.Assign(m_Session->handover_tgk_i.View());
+        m_ServingGNBId = static_cast<int>(m_Session->handover_gnb_id);
+    }
+    m_State.Fire(UEEvent::HandoverSucceeded, *this); // Clears handover state
+    std::cout << "UE " << m_Id << ": Handover to UAV " << m_ServingUAVId << " completed." << std::endl;
+}
 
-    // Transmit XRESi to target UAV
-    if (auto targetUAV = m_Handover_TargetUAV.lock()) {
-        std::cout << "UE " << m_Id << " -> Target UAV " << targetUAV->GetID() << ": Sending Handover Auth Confirmation (XRESi)" << std::endl;
-        targetUAV->ReceiveHandoverAuthConfirmation(m_Id, xres_i);
+// --- Inter-gNB Handover (Xn) ---
 
-        // Update connection state
-        m_ConnectedUAV = targetUAV; // Point to new UAV
-        m_ServingUAVId = targetUAV->GetID();
-        // gNB connection likely remains the same
-        m_UEState = "Connected";
-        std::cout << "UE " << m_Id << ": Handover to UAV " << m_ServingUAVId << " completed." << std::endl;
+gNB* UE::GetServingGNB() const {
+    UAV* uav = GetConnectedUAV();
+    return uav ? uav->GetAssociatedGNB() : nullptr;
+}
 
-    } else {
-         std::cerr << "UE " << m_Id << ": Target UAV pointer invalid. Cannot complete handover." << std::endl;
-         m_UEState = "Connected"; // Revert state?
+std::optional<HandoverHint> UE::BuildHandoverHint() const {
+    if (!m_State.Is(UEState::Connected) || !m_Session || m_Session->tid_i.empty() || !Kyber::ValidateTST(m_Session->tst)) {
+        return std::nullopt;
     }
+    return HandoverHint{ m_Session->tid_i, m_Session->tst };
+}
 
-    // Clear handover state
-    m_Handover_R1.clear();
-    m_Handover_TargetTIDj = "";
-    m_Handover_TargetUAV.reset();
+std::optional<XnHandoverRequest> UE::BuildXnHandoverRequest(uint32_t targetGnbId) {
+    if (!m_State.Is(UEState::Connected) || !m_Session || m_Session->tid_i.empty() || m_Session->tgk_i.empty() || !Kyber::ValidateTST(m_Session->tst)) {
+        std::cerr << "UE " << m_Id << ": Cannot request Xn handover. Not connected or missing required state (TIDi, TGKi, valid TST)." << std::endl;
+        return std::nullopt;
+    }
+    const SessionKeys& session = *m_Session;
+    std::cout << "UE " << m_Id << ": Requesting Xn handover to gNB " << targetGnbId << " from gNB " << m_ServingGNBId << std::endl;
+    return XnHandoverRequest{ session.tid_i, session.tst, targetGnbId, Kyber::XnRequestMAC(session.tgk_i, session.tid_i, targetGnbId) };
 }
 
-void UE::ConfirmConnection(std::shared_ptr<UAV> uav, std::shared_ptr<gNB> gnb)
+bool UE::ApplyXnHandoverCommand(const XnHandoverCommand& command) {
+    if (!m_State.Is(UEState::Connected) || !m_Session) {
+        std::cerr << "UE " << m_Id << ": Received unexpected Xn handover command." << std::endl;
+        return false;
+    }
+    SessionKeys& session = *m_Session;
+    Kyber::AuthTransaction txn;
+    std::pmr::memory_resource* arena = Kyber::AuthTransaction::Resource();
+    std::vector<uint8_t> nh = Kyber::XnNextHopKey(session.tgk_i, session.tid_i, command.targetGnbId);
+    Kyber::ArenaBytes tgk_i = Kyber::DecryptSymmetric(nh, command.c_tgk, arena);
+    if (!session.handover_tgk_i.Assign(tgk_i)) {
+        std::cerr << "UE " << m_Id << ": Xn handover command carries a malformed TGKi." << std::endl;
+        return false;
+    }
+    session.handover_gnb_id = command.targetGnbId;
+    std::cout << "UE " << m_Id << ": Adopted TGKi from gNB " << command.targetGnbId << " for the handover." << std::endl;
+    return true;
+}
+
+void UE::ConfirmConnection(UAV& uav, gNB& gnb)
 {
-    m_ConnectedUAV = uav;
-    m_ConnectedgNB = gnb;
-    m_ServingUAVId = uav->GetID();
-    m_ServingGNBId = gnb->GetID();
-    m_UEState = "Connected";
+    m_ConnectedUAV = uav.SelfRef();
+    m_ServingUAVId = uav.GetID();
+    m_ServingGNBId = gnb.GetID();
+    m_State.Fire(UEEvent::Attach, *this);
     std::cout << "UE " << m_Id << ": Connection established via UAV " << m_ServingUAVId << " to gNB " << m_ServingGNBId << std::endl;
 }
 
-void UE::ConfirmHandover(std::shared_ptr<UAV> newUAV)
+void UE::ConfirmHandover(UAV& newUAV)
 {
-    m_ConnectedUAV = newUAV;
-    m_ServingUAVId = newUAV->GetID();
+    m_ConnectedUAV = newUAV.SelfRef();
+    m_ServingUAVId = newUAV.GetID();
     // gNB connection usually remains the same unless gNB also changes
-    m_UEState = "Connected";
+    m_State.Fire(UEEvent::Attach, *this);
     std::cout << "UE " << m_Id << ": Handover to UAV " << m_ServingUAVId << " completed." << std::endl;
 }
 
 
 void UE::Disconnect()
 {
-    m_ConnectedUAV.reset();
-    m_ConnectedgNB.reset();
+    m_ConnectedUAV.Reset();
     m_ServingUAVId = -1;
     m_ServingGNBId = -1;
-    m_UEState = "Idle";
+    m_State.Fire(UEEvent::Disconnect, *this); // Drops per-session key material
     std::cout << "UE " << m_Id << ": Disconnected." << std::endl;
 }
 
@@ -349,8 +542,10 @@ Kyber::Polynomial UE::SampleB2(size_t size)
 // Generate authentication parameters using Kyber algorithm
 std::pair<std::vector<uint8_t>, std::string> UE::GenerateAuthParams()
 {
+    PERF_SCOPE("UE::GenerateAuthParams");
     // Step 1: Generate a random value RAND ∈ {0, 1}^256
-    m_RAND = GenerateRandomBytes(32); // 32 bytes = 256 bits
+    std::vector<uint8_t> rand = GenerateRandomBytes(Kyber::RandBytes); // 32 bytes = 256 bits
+    Session().rand.Assign(rand);
 
     // Step 2: Generate a fresh sequence number SQN
     m_SQN++;
@@ -377,7 +572,7 @@ std::pair<std::vector<uint8_t>, std::string> UE::GenerateAuthParams()
     std::vector<int> decompressed;
     try {
         // Assuming Kyber::Decompressq is implemented elsewhere
-        decompressed = Kyber::Decompressq(m_RAND, 1);
+        decompressed = Kyber::Decompressq(rand, 1);
     }
     catch (...) {
         // Fallback for compilation if the actual function is not available
@@ -386,6 +581,10 @@ std::pair<std::vector<uint8_t>, std::string> UE::GenerateAuthParams()
     }
 
     std::vector<uint8_t> v(polynomialSize / 2); 
+    // Placeholder: v = Decompressq(RAND) without the pk^T * r + e2 mask
+    for (size_t i = 0; i < decompressed.size() && i < v.size(); ++i) {
+        v[i] = static_cast<uint8_t>(decompressed[i]);
+    }
 
     // Step 8: Compute C1 = (u, v)
     std::vector<uint8_t> C1;
@@ -396,26 +595,21 @@ std::pair<std::vector<uint8_t>, std::string> UE::GenerateAuthParams()
     std::vector<uint8_t> MSK;
     try {
         // Assuming Kyber::KDF is implemented elsewhere
-        MSK = Kyber::KDF(m_RAND);
+        MSK = Kyber::KDF(rand);
     }
     catch (...) {
         // Fallback for compilation if the actual function is not available
-        MSK = m_RAND;
+        MSK = rand;
         
     }
 
-    // Step 10: Convert SQN to bytes for further operations
-    std::vector<uint8_t> sqnBytes(8);
-    for (int i = 0; i < 8; ++i) {
-        sqnBytes[i] = static_cast<uint8_t>((m_SQN >> (i * 8)) & 0xFF);
-    }
+    // Step 10: Convert SQN to bytes for further operations (big-endian, as
+    // the gNB reads it; IND is the low bits)
+    std::vector<uint8_t> sqnBytes = Kyber::U64ToBytes(m_SQN);
 
     // Step 11: Compute C2 = EMSK(SUPI || SQNUE)
-    const std::string& SUPI = m_SUPI;
-
-    std::vector<uint8_t> supiBytes(SUPI.begin(), SUPI.end());
-    std::vector<uint8_t> supiAndSqn;
-    supiAndSqn.insert(supiAndSqn.end(), supiBytes.begin(), supiBytes.end());
+    Kyber::ByteView supiBytes = m_SUPI.View();
+    std::vector<uint8_t> supiAndSqn(supiBytes.begin(), supiBytes.end());
     supiAndSqn.insert(supiAndSqn.end(), sqnBytes.begin(), sqnBytes.end());
 
     std::vector<uint8_t> C2;
@@ -435,13 +629,13 @@ std::pair<std::vector<uint8_t>, std::string> UE::GenerateAuthParams()
 
     std::vector<uint8_t> macInput;
     macInput.insert(macInput.end(), sqnBytes.begin(), sqnBytes.end());
-    macInput.insert(macInput.end(), m_RAND.begin(), m_RAND.end());
+    macInput.insert(macInput.end(), rand.begin(), rand.end());
     macInput.insert(macInput.end(), AMF.begin(), AMF.end());
 
     std::vector<uint8_t> MAC;
     try {
         // Assuming Kyber::f1K is implemented elsewhere
-        MAC = Kyber::f1K(m_LongTermKey ,macInput);
+        MAC = Kyber::f1K(m_LongTermKey.AsString(), macInput);
     }
     catch (...) {
         // Fallback for compilation if the actual function is not available
@@ -465,3 +659,59 @@ std::pair<std::vector<uint8_t>, std::string> UE::GenerateAuthParams()
     // Return the SUCI bytes and the display string
     return { SUCI_bytes, ss.str() };
 }
+
+void UE::SaveSnapshot(SnapshotWriter& out) const
+{
+    out.PutState(m_State);
+    out.Put<int32_t>(m_ServingUAVId);
+    out.Put<int32_t>(m_ServingGNBId);
+    out.PutRef(m_ConnectedUAV);
+    out.Put(m_SQN);
+    out.PutBytes(m_SUPI.View());
+    out.PutBytes(m_LongTermKey.View());
+    out.PutNetworkParams(m_Network);
+
+    out.Put<uint8_t>(m_Session != nullptr);
+    if (!m_Session) return;
+    const SessionKeys& session = *m_Session;
+    out.PutBytes(session.rand.View());
+    out.PutBytes(session.kran_i.View());
+    out.PutBytes(session.kuav_i.View());
+    out.PutBytes(session.tgk_i.View());
+    out.PutTimestamp(session.tst);
+    out.Put(session.tid_i);
+    out.PutBytes(session.handover_r1.View());
+    out.Put(session.handover_target_tid_j);
+    out.PutRef(session.handover_target_uav);
+}
+
+bool UE::LoadSnapshot(SnapshotReader& in, const SnapshotLinks& links)
+{
+    int32_t servingUAV = -1, servingGNB = -1;
+    uint8_t hasSession = 0;
+    in.GetState(m_State);
+    in.Get(servingUAV);
+    in.Get(servingGNB);
+    m_ServingUAVId = servingUAV;
+    m_ServingGNBId = servingGNB;
+    in.GetRef(m_ConnectedUAV, links.uav);
+    in.Get(m_SQN);
+    in.GetBytes(m_SUPI);
+    in.GetBytes(m_LongTermKey);
+    in.GetNetworkParams(m_Network, links);
+
+    m_Session.reset();
+    m_Resumption.reset(); // gNBs restore with empty resumption caches
+    if (!in.Get(hasSession) || !hasSession) return in.Ok();
+    SessionKeys& session = Session();
+    in.GetBytes(session.rand);
+    in.GetBytes(session.kran_i);
+    in.GetBytes(session.kuav_i);
+    in.GetBytes(session.tgk_i);
+    in.GetTimestamp(session.tst);
+    in.Get(session.tid_i);
+    in.GetBytes(session.handover_r1);
+    in.Get(session.handover_target_tid_j);
+    in.GetRef(session.handover_target_uav, links.uav);
+    return in.Ok();
+}
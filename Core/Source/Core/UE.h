@@ -2,10 +2,16 @@
 
 #include "Entity.h"
 #include "KyberUtils.h" // Include Kyber utilities
+#include "EntityPool.h"
+#include "StateMachine.h"
+#include "AuthMessages.h"
 
 class gNB;
 class UAV;
 class UE;
+class SnapshotWriter;
+class SnapshotReader;
+struct SnapshotLinks;
 
 #include "UAV.h"
 #include "gNB.h"
@@ -17,33 +23,133 @@ class UE;
 #include <random>
 #include <optional> // For optional values
 
-class UE : public Entity {
+// Connection state of a UE (replaces the former string state)
+enum class UEState : uint8_t { Idle, Connecting, Connected, Handover, Failed, Count };
+
+enum class UEEvent : uint8_t {
+    Connect,            // SUCI sent (Phase B start or retry)
+    AuthSucceeded,      // HRES*i verified, token accepted
+    AuthFailed,         // HRES*i mismatch or malformed Ci/token
+    Attach,             // Serving UAV/gNB confirmed externally
+    StartHandover,      // Phase C request sent to target UAV
+    HandoverSucceeded,  // HRESi verified, K*UAVi adopted
+    HandoverFailed,     // HRESi mismatch or target UAV gone
+    Disconnect,
+    Count
+};
+
+inline const char* UEStateName(UEState state)
+{
+    switch (state) {
+    case UEState::Idle: return "Idle";
+    case UEState::Connecting: return "Connecting";
+    case UEState::Connected: return "Connected";
+    case UEState::Handover: return "Handover";
+    case UEState::Failed: return "Failed";
+    case UEState::Count: break;
+    }
+    return "Unknown";
+}
+
+struct UEStateTraits {
+    using State = UEState;
+    using Event = UEEvent;
+    using Handler = void (*)(UE&);
+    using Row = StateTransition<State, Event, Handler>;
+
+    static constexpr const char* Name = "UE";
+    static constexpr State Initial = State::Idle;
+
+    static const char* StateName(State state) { return UEStateName(state); }
+    static const char* EventName(Event event)
+    {
+        static constexpr const char* names[] = { "Connect", "AuthSucceeded", "AuthFailed", "Attach",
+                                                  "StartHandover", "HandoverSucceeded", "HandoverFailed", "Disconnect" };
+        return names[static_cast<size_t>(event)];
+    }
+
+    // Transition handlers (UE.cpp)
+    static void ClearHandover(UE& ue);
+    static void ReleaseSession(UE& ue);
+
+    static constexpr std::array Table{
+        Row{ State::Idle,       Event::Connect,           State::Connecting },
+        Row{ State::Failed,     Event::Connect,           State::Connecting },
+        Row{ State::Connected,  Event::Connect,           State::Connecting },
+        Row{ State::Connecting, Event::Connect,           State::Connecting }, // Retry after a lost response
+        Row{ State::Connecting, Event::AuthSucceeded,     State::Connected },
+        Row{ State::Connecting, Event::AuthFailed,        State::Failed },
+        Row{ State::Connecting, Event::Attach,            State::Connected },
+        Row{ State::Connected,  Event::Attach,            State::Connected },
+        Row{ State::Handover,   Event::Attach,            State::Connected, &ClearHandover },
+        Row{ State::Connected,  Event::StartHandover,     State::Handover },
+        Row{ State::Handover,   Event::HandoverSucceeded, State::Connected, &ClearHandover },
+        Row{ State::Handover,   Event::HandoverFailed,    State::Connected, &ClearHandover },
+        Row{ State::Idle,       Event::Disconnect,        State::Idle,      &ReleaseSession },
+        Row{ State::Connecting, Event::Disconnect,        State::Idle,      &ReleaseSession },
+        Row{ State::Connected,  Event::Disconnect,        State::Idle,      &ReleaseSession },
+        Row{ State::Handover,   Event::Disconnect,        State::Idle,      &ReleaseSession },
+        Row{ State::Failed,     Event::Disconnect,        State::Idle,      &ReleaseSession },
+    };
+};
+
+// Compact UE for million-UE scenarios.
+//
+// Hot fields touched by mobility and handover checks (position, state,
+// serving UAV) sit at the front of the object. Subscriber data is stored in
+// fixed-size inline arrays, network parameters are shared read-only with
+// the provisioning gNB, and per-session key material lives in a cold block
+// that is only allocated once the UE starts authenticating.
+class UE : public Entity, public EnableSelfRef<UE> {
 public:
+    // Inline capacities; stub KDF outputs are as long as their input, so key
+    // buffers are sized for TID-length inputs.
+    static constexpr size_t KeyBytes = 64;
+    static constexpr size_t SUPIBytes = 24;
+    static constexpr size_t LongTermKeyBytes = 32;
+
     UE(uint32_t xPos, uint32_t yPos, uint32_t xVel = 0, uint32_t yVel = 0, uint32_t id = 0,
-        const std::string& theLongTermKey = "DEFAULT_KEY") // Use default key
-        : Entity(xPos, yPos, xVel, yVel, id), m_LongTermKey(theLongTermKey)
+        std::string_view theLongTermKey = "DEFAULT_KEY") // Use default key
+        : Entity(xPos, yPos, xVel, yVel, id)
     {
-        m_SUPI = "SUPI_UE" + std::to_string(id); // Default SUPI based on ID
+        if (!m_LongTermKey.Assign(theLongTermKey)) {
+            std::cerr << "UE " << id << ": Error - Long-term key exceeds " << LongTermKeyBytes << " bytes." << std::endl;
+        }
+        m_SUPI.Assign(std::string_view("SUPI_UE" + std::to_string(id))); // Default SUPI based on ID
     }
 
     std::string GetType() const override { return "UE"; }
-    const std::string& GetLongTermKey() const { return m_LongTermKey; }
+    std::string_view GetLongTermKey() const { return m_LongTermKey.AsString(); }
+    std::string_view GetSUPI() const { return m_SUPI.AsString(); }
 
     // --- Provisioning --- 
     void SetAuthenticationParameters(const std::string& supi,
-                                     const std::string& key,
-                                     const std::vector<uint8_t>& amf,
-                                     const std::vector<uint8_t>& rho,
-                                     const Kyber::Polynomial& pk);
+                                     std::string_view key,
+                                     std::shared_ptr<const Kyber::NetworkParams> network);
+
+    // Bulk provisioning: the key was set at construction; no logging
+    inline void AttachSubscription(std::string_view supi, std::shared_ptr<const Kyber::NetworkParams> network) {
+        m_SUPI.Assign(supi);
+        m_Network = std::move(network);
+    }
+    inline bool IsProvisioned() const { return m_Network != nullptr; }
+    // Issued by the home gNB; shared with it
+    inline const std::shared_ptr<const Kyber::NetworkParams>& GetNetworkParams() const { return m_Network; }
+
+    // --- Snapshot (see Snapshot.h) ---
+    // In-flight exchanges are not saved; snapshot a settled world.
+    void SaveSnapshot(SnapshotWriter& out) const;
+    bool LoadSnapshot(SnapshotReader& in, const SnapshotLinks& links);
 
     // --- UAV-Assisted UE Access Authentication (Phase B) ---
-    // Modified InitiateConnection to send SUCI
+    // Modified InitiateConnection to send SUCI; tries fast re-authentication
+    // first while KRANi from an earlier session is kept
     void InitiateConnection(UAV& targetUAV); // Sends SUCI
 
     // Handle response from UAV (HRES*i, Ci)
     void HandleUAVAssistedAuthResponse(const std::vector<uint8_t>& hres_star_i,
                                        const std::vector<uint8_t>& ci,
-                                       const std::string& tid_j); // UAV's TID needed for KUAVi calc
+                                       const Kyber::TID& tid_j); // UAV's TID needed for KUAVi calc
 
     // --- UE Handover Authentication (Phase C) ---
     // Initiate handover authentication with a target UAV
@@ -53,15 +159,42 @@ public:
     void HandleHandoverAuthChallenge(const std::vector<uint8_t>& hres_i,
                                      const std::vector<uint8_t>& r2);
 
+    // --- Protocol steps ---
+    // Produce the next outgoing message without sending it; the methods
+    // above chain them synchronously.
+    std::optional<std::vector<uint8_t>> BuildConnectionRequest(UAV& uav); // SUCI
+    // Null without a resumption ticket; the answer arrives through
+    // HandleUAVAssistedAuthResponse like a Phase B one
+    std::optional<ResumeRequest> BuildResumeRequest(UAV& uav);
+    // The gNB no longer knows the ticket (miss or rejection); use a SUCI next
+    void AbandonResumption();
+    inline bool HasResumptionTicket() const { return m_Resumption != nullptr; }
+    std::optional<HandoverAuthRequest> BuildHandoverRequest(UAV& targetUAV);
+    // Null unless connected with a valid token
+    std::optional<HandoverHint> BuildHandoverHint() const;
+    std::optional<std::vector<uint8_t>> AnswerHandoverChallenge(const std::vector<uint8_t>& hres_i,
+                                                                const std::vector<uint8_t>& r2); // XRESi
+    // Switch to the handover target if it accepted XRESi, else stay on the source
+    void FinishHandover(bool confirmed);
+
+    // --- Inter-gNB Handover (Xn) ---
+    // Needed before Phase C when the target UAV is anchored at another gNB
+    // than the serving one: that gNB re-issues TGKi under its own group key.
+    std::optional<XnHandoverRequest> BuildXnHandoverRequest(uint32_t targetGnbId);
+    // Unwrap the re-issued TGKi; the next Phase C uses it and adopts it on success
+    bool ApplyXnHandoverCommand(const XnHandoverCommand& command);
+    gNB* GetServingGNB() const; // Via the serving UAV; null if gone
+
     // --- Connection Management ---
-    void ConfirmConnection(std::shared_ptr<UAV> uav, std::shared_ptr<gNB> gnb);
+    void ConfirmConnection(UAV& uav, gNB& gnb);
 
-    void ConfirmHandover(std::shared_ptr<UAV> newUAV);
+    void ConfirmHandover(UAV& newUAV);
 
     void Disconnect();
 
     inline int GetServingUAVId() const { return m_ServingUAVId; }
-    inline const std::string& GetState() const { return m_UEState; }
+    inline int GetServingGNBId() const { return m_ServingGNBId; }
+    inline UEState GetState() const { return m_State.Current(); }
 
     // --- Handlers for Standard AKA Failures (called by UAV) ---
     void HandleSyncFailure(const std::vector<uint8_t>& auts);
@@ -69,6 +202,41 @@ public:
     void HandleGnbConnectionFailure(); // Called by UAV if gNB unreachable
 
 private:
+    // Per-session key material; allocated on first authentication
+    struct SessionKeys {
+        Kyber::FixedBytes<32> rand;             // RAND used in the current SUCI
+        Kyber::FixedBytes<KeyBytes> kran_i;     // KRANi derived during AKA with gNB
+        Kyber::FixedBytes<KeyBytes> kuav_i;     // Key shared with current serving UAV
+        Kyber::FixedBytes<KeyBytes> tgk_i;      // Temporary group key from Tokeni
+        Kyber::Timestamp tst{};                 // Token expiry
+        Kyber::TID tid_i;                       // Temporary identity assigned by gNB
+
+        // State during handover
+        Kyber::FixedBytes<16> handover_r1;
+        Kyber::TID handover_target_tid_j;
+        EntityRef<UAV> handover_target_uav;
+        Kyber::FixedBytes<KeyBytes> handover_tgk_i; // From an Xn preparation, until the handover completes
+        uint32_t handover_gnb_id = 0;
+
+        uint64_t resume_counter = 0; // Outstanding resumption request; 0 after a SUCI
+
+        // TGKi to use towards the handover target
+        Kyber::ByteView HandoverTGK() const { return handover_tgk_i.empty() ? tgk_i.View() : handover_tgk_i.View(); }
+    };
+
+    // KRANi of the last session, kept across Disconnect for fast
+    // re-authentication; replaced after every successful authentication
+    struct ResumptionTicket {
+        Kyber::TID tid_i;
+        Kyber::FixedBytes<KeyBytes> kran_i;
+        uint64_t counter = 0; // Last counter sent under kran_i
+    };
+
+    friend struct UEStateTraits;
+
+    SessionKeys& Session();
+    void ClearHandoverState();
+
     // Generates a random 256-bit value
     std::vector<uint8_t> GenerateRandomBytes(size_t numBytes);
 
@@ -78,44 +246,22 @@ private:
 
     std::pair<std::vector<uint8_t>, std::string> GenerateAuthParams();
 
-    std::weak_ptr<UAV> m_ConnectedUAV; // Weak pointer to avoid cyclic dependencies
-    std::weak_ptr<gNB> m_ConnectedgNB; // Connection via UAV
+    // --- Hot: mobility and handover checks ---
+    StateMachine<UEStateTraits> m_State;
     int m_ServingUAVId = -1;
     int m_ServingGNBId = -1;
-    std::string m_UEState = "Idle"; // e.g., Idle, Connecting, Connected, Handover, Failed
-
-    // --- Provisioned Parameters ---
-    std::string m_SUPI;                 // Subscriber Permanent Identifier
-    std::string m_LongTermKey;          // Long-term secret key K
-    std::vector<uint8_t> m_AMF;         // Authentication Management Field
-    std::vector<uint8_t> m_Rho;         // Public parameter rho (for generating A)
-    Kyber::Polynomial m_NetworkPK;      // Network public key pk
-    Kyber::Matrix m_A;                  // Matrix A (generated from rho)
-
-    // --- Authentication State ---
-    std::vector<uint8_t> m_RAND;        // Current random value used in SUCI
-    uint64_t m_SQN = 0;                 // Sequence number counter
-
-    // --- Derived Keys (after successful auth) ---
-    std::vector<uint8_t> m_CK;          // Ciphering Key
-    std::vector<uint8_t> m_IK;          // Integrity Key
-    std::vector<uint8_t> m_K_network;   // e.g., K_AMF
-    std::vector<uint8_t> m_K_RAN;       // Key for RAN communication
-
-    // --- New State for UAV Protocol ---
-    std::string m_TIDi = ""; // Temporary Identity assigned by gNB
-    std::vector<uint8_t> m_KUAVi; // Key shared with current serving UAV
-    std::vector<uint8_t> m_Tokeni; // Token received from gNB (TGKi || TST)
-    std::vector<uint8_t> m_TGKi; // Temporary Group Key derived from Token
-    Kyber::Timestamp m_TST; // Expiration time from Token
-
-    std::vector<uint8_t> m_KRANi; // Key derived during AKA with gNB
-
-    // State during handover
-    std::vector<uint8_t> m_Handover_R1; // Store R1 during handover
-    std::string m_Handover_TargetTIDj = ""; // Store Target UAV TIDj during handover
-    std::weak_ptr<UAV> m_Handover_TargetUAV; // Store target UAV during handover
-
-    // Helper to get connected UAV shared_ptr
-    std::shared_ptr<UAV> GetConnectedUAVShared() const;
+    EntityRef<UAV> m_ConnectedUAV; // Generation-checked, non-owning
+
+    // --- Warm: provisioned subscriber data ---
+    uint64_t m_SQN = 0;                                     // Sequence number counter
+    Kyber::FixedBytes<SUPIBytes> m_SUPI;                    // Subscriber Permanent Identifier
+    Kyber::FixedBytes<LongTermKeyBytes> m_LongTermKey;      // Long-term secret key K
+    std::shared_ptr<const Kyber::NetworkParams> m_Network;  // AMF, rho, pk, A (shared, read-only)
+
+    // --- Cold: authentication/session state ---
+    std::unique_ptr<SessionKeys> m_Session;
+    std::unique_ptr<ResumptionTicket> m_Resumption;
+
+    // Helper to resolve the connected UAV (nullptr if gone)
+    UAV* GetConnectedUAV() const;
 };
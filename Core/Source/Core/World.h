@@ -3,103 +3,504 @@
 #include "UE.h"
 #include "gNB.h"
 #include "UAV.h"
+#include "EntityPool.h"
+#include "AuthFlows.h"
+#include "ParallelEngine.h"
+#include "ScenarioFile.h"
+#include "Snapshot.h"
+#include "ChurnGenerator.h"
+#include "MobilityTrace.h"
+#include "SpatialGrid.h"
 #include <limits> // Include limits for numeric_limits
 #include <stdexcept> // For exceptions
 #include <string> // Ensure string is included
+#include <span>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <deque>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <vector>
+
+// Bulk-creation record for large scenarios
+struct UESpawn {
+    uint32_t id;
+    uint32_t x;
+    uint32_t y;
+    std::string longTermKey = "DEFAULT_KEY";
+};
+
+// Options and outcome of World::runChurnWorkload
+struct ChurnOptions {
+    double duration = 10.0;  // Simulated seconds
+    double timeScale = 0.0;  // Wall seconds per simulated second; 0 runs as fast as possible
+    std::string ueKey = "5G_LONG_TERM_KEY";
+};
+
+struct ChurnStats {
+    uint64_t arrivals = 0;
+    uint64_t departures = 0;
+    uint64_t attached = 0;      // Phase B completed
+    uint64_t attachFailed = 0;
+    uint64_t blocked = 0;       // Arrivals refused because the ID pool was full
+    size_t peakActive = 0;
+    double wallSeconds = 0.0;
+    double busySeconds = 0.0;   // Spent handling events
+    double meanLagMs = 0.0;     // Paced runs: event start behind its due time
+    double maxLagMs = 0.0;
+
+    // Attaches per busy second: the gNB's saturation throughput when the
+    // offered load exceeds it
+    double AttachRate() const { return busySeconds > 0.0 ? attached / busySeconds : 0.0; }
+};
+
+// Automatic Phase C handover driven by World::update
+struct HandoverPolicy {
+    double checkInterval = 0.5;  // Simulated seconds between scans
+    uint32_t moveThreshold = 5;  // UEs that moved less since their last scan are skipped
+    uint32_t hysteresis = 50;    // A target must be this much closer than the serving UAV
+    double maxPerSecond = 100.0; // Handover starts per simulated second
+    size_t burst = 20;           // Starts allowed back to back after an idle spell
+    size_t batchSize = 16;       // Starts towards one target UAV per dispatch
+    uint32_t gridCell = 250;     // Cell size of the UAV spatial index
+    double predictLookahead = 0.0; // Seconds ahead to predict the next target and send it a hint; 0 = off
+};
+
+struct HandoverStats {
+    uint64_t scans = 0;
+    uint64_t evaluated = 0;      // UEs that had moved and were re-checked
+    uint64_t queued = 0;
+    uint64_t started = 0;
+    uint64_t succeeded = 0;
+    uint64_t failed = 0;
+    uint64_t dropped = 0;        // Queued but no longer valid at dispatch
+    double simSeconds = 0.0;
+    std::vector<double> protocolUs;  // Phase C wall time per started handover
+    std::vector<double> queueDelayS; // Simulated seconds from decision to start
+    uint64_t hintsSent = 0;      // Predicted targets told to prepare
+    uint64_t predictedHits = 0;  // Started towards the predicted target
+    uint64_t mispredicted = 0;   // Started towards another target than predicted
+    uint64_t overwritten = 0;    // Replaced by a hint to another target before any handover
+    std::vector<double> preparedUs;   // protocolUs of handovers that found a preparation
+    std::vector<double> unpreparedUs; // protocolUs of the rest
+
+    double Rate() const { return simSeconds > 0.0 ? succeeded / simSeconds : 0.0; }
+    // Share of all hints sent that the UE then followed; hints still
+    // outstanding count against it
+    double PredictionAccuracy() const
+    {
+        return hintsSent ? static_cast<double>(predictedHits) / hintsSent : 0.0;
+    }
+    uint64_t WastedHints() const { return mispredicted + overwritten; }
+
+    // p in [0, 1] of a latency sample
+    static double Percentile(std::vector<double> samples, double p)
+    {
+        if (samples.empty()) return 0.0;
+        size_t rank = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+        std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+        return samples[rank];
+    }
+};
+
+// Outcome of World::authenticateUAVFleet
+struct FleetAuthStats {
+    size_t requested = 0;
+    size_t challenged = 0;  // Challenges the gNBs issued
+    size_t verified = 0;    // UAVs that accepted their gNB
+    size_t authorized = 0;
+    size_t threads = 0;     // Workers that ran the UAV side
+    std::chrono::nanoseconds gnbTime{}; // Challenges and confirmations, all gNBs
+    std::chrono::nanoseconds uavTime{}; // Wall time of the parallel verification
+
+    double GNBMicrosPerUAV() const
+    {
+        return requested ? std::chrono::duration<double, std::micro>(gnbTime).count() / requested : 0.0;
+    }
+};
+
+// Outcome of World::runCellSimulation
+struct CellSimulationStats {
+    ParallelEngine::Stats engine;
+    uint64_t reassociations = 0; // UEs handed to another cell
+    uint64_t digest = 0;         // Final UE positions and cell membership
+};
+
+// How subscribers and UAVs are split between gNBs. Each entity is
+// provisioned at its home gNB only and authenticates through it.
+enum class HomePartitioning {
+    Region,         // Nearest gNB when provisioned
+    ConsistentHash, // Hash ring over gNBs; adding a gNB re-homes ~1/N of the entities
+};
 
 class World {
 public:
-    std::vector<std::shared_ptr<UE>> ues;
-    std::vector<std::shared_ptr<UAV>> uavs;
-    std::vector<std::shared_ptr<gNB>> gnbs;
+    // Entities live in pooled, contiguous storage; ID lookups go through
+    // the index maps and cross-entity links are EntityRef handles.
+    EntityPool<UE> ues;
+    EntityPool<UAV> uavs;
+    EntityPool<gNB> gnbs;
+
+    // State machine stats are process-wide; each World reports from zero
+    World() { resetStateMachineStats(); }
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
 
-    void addUE(uint32_t id, uint32_t x, uint32_t y, const std::string& longTermKey = "DEFAULT_KEY") {
-        ues.push_back(std::make_shared<UE>(x, y, 0, 0, id, longTermKey));
+    UE* addUE(uint32_t id, uint32_t x, uint32_t y, const std::string& longTermKey = "DEFAULT_KEY") {
+        UE* ue = createUE(id, x, y, longTermKey);
         std::cout << "World: Added UE " << id << " at (" << x << ", " << y << ")" << std::endl;
+        return ue;
     }
 
-    void addUAV(uint32_t id, uint32_t x, uint32_t y) {
-        uavs.push_back(std::make_shared<UAV>(x, y, 0, 0, id));
+    UAV* addUAV(uint32_t id, uint32_t x, uint32_t y) {
+        UAV* uav = createUAV(id, x, y);
         std::cout << "World: Added UAV " << id << " at (" << x << ", " << y << ")" << std::endl;
+        return uav;
     }
 
-    void addGNB(uint32_t id, uint32_t x, uint32_t y) {
-        gnbs.push_back(std::make_shared<gNB>(x, y, 0, 0, id));
+    gNB* addGNB(uint32_t id, uint32_t x, uint32_t y) {
+        gNB* gnb = createGNB(id, x, y);
         std::cout << "World: Added gNB " << id << " at (" << x << ", " << y << ")" << std::endl;
+        return gnb;
     }
 
-    // Associate UAVs with the nearest gNB
+    // Bulk UE creation: one reservation, no per-entity logging
+    void addUEs(std::span<const UESpawn> spawns) {
+        ues.Reserve(ues.Size() + spawns.size());
+        m_UEIndex.reserve(m_UEIndex.size() + spawns.size());
+        for (const auto& spawn : spawns) {
+            createUE(spawn.id, spawn.x, spawn.y, spawn.longTermKey);
+        }
+        std::cout << "World: Added " << spawns.size() << " UEs in bulk" << std::endl;
+    }
+
+    // Bulk load from a scenario file (see ScenarioFile.h). Entities are
+    // created straight from the mapped columns and every gNB shares the
+    // file's subscriber table, so UE keys are neither parsed nor copied into
+    // per-gNB maps. UEs come out provisioned against their home gNB.
+    bool loadScenario(const std::string& path) {
+        using Column = ScenarioFile::Column;
+        auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<const ScenarioFile> file = ScenarioFile::Open(path);
+        if (!file) {
+            std::cerr << "World Error: Could not load scenario " << path << std::endl;
+            return false;
+        }
+
+        auto gnbIds = file->U32Column(Column::GNBId);
+        auto gnbX = file->U32Column(Column::GNBX);
+        auto gnbY = file->U32Column(Column::GNBY);
+        gnbs.Reserve(gnbs.Size() + gnbIds.size());
+        for (size_t i = 0; i < gnbIds.size(); ++i) {
+            createGNB(gnbIds[i], gnbX[i], gnbY[i]);
+        }
+        std::shared_ptr<const SubscriberTable> subscribers = file->GetSubscribers();
+        gnbs.ForEach([&](gNB& gnb) { gnb.AttachSubscriberTable(subscribers); });
+
+        auto uavIds = file->U32Column(Column::UAVId);
+        auto uavX = file->U32Column(Column::UAVX);
+        auto uavY = file->U32Column(Column::UAVY);
+        auto uavVelX = file->U32Column(Column::UAVVelX);
+        auto uavVelY = file->U32Column(Column::UAVVelY);
+        uavs.Reserve(uavs.Size() + uavIds.size());
+        for (size_t i = 0; i < uavIds.size(); ++i) {
+            UAV* uav = createUAV(uavIds[i], uavX[i], uavY[i]);
+            if (!uavVelX.empty()) uav->SetVelocity(uavVelX[i], uavVelY[i]);
+            std::string key(file->StringAt(Column::UAVKey, i));
+            if (!key.empty()) {
+                uav->SetLongTermKey(key);
+                if (gNB* home = partitionGNB(uavPartitionKey(uav->GetID()), uav->GetPosition())) {
+                    home->ProvisionUAVKey(uav->GetID(), key);
+                }
+            }
+        }
+
+        auto ueIds = file->U32Column(Column::UEId);
+        auto ueX = file->U32Column(Column::UEX);
+        auto ueY = file->U32Column(Column::UEY);
+        auto ueVelX = file->U32Column(Column::UEVelX);
+        auto ueVelY = file->U32Column(Column::UEVelY);
+        ues.Reserve(ues.Size() + ueIds.size());
+        m_UEIndex.reserve(m_UEIndex.size() + ueIds.size());
+        for (size_t i = 0; i < ueIds.size(); ++i) {
+            // UE rows are in subscriber-table order
+            bool hasRecord = i < subscribers->Size();
+            UE* ue = createUE(ueIds[i], ueX[i], ueY[i], hasRecord ? subscribers->KeyAt(i) : std::string_view("DEFAULT_KEY"));
+            if (!ueVelX.empty()) ue->SetVelocity(ueVelX[i], ueVelY[i]);
+            if (!hasRecord) continue;
+            if (gNB* home = partitionGNB(subscribers->SUPIAt(i), ue->GetPosition())) {
+                ue->AttachSubscription(subscribers->SUPIAt(i), home->GetNetworkParams());
+            }
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << "World: Loaded scenario " << path << " (" << gnbIds.size() << " gNBs, " << uavIds.size()
+                  << " UAVs, " << ueIds.size() << " UEs) in " << elapsed.count() << " ms" << std::endl;
+        return true;
+    }
+
+    // Checkpoint every entity with its associations, derived keys and
+    // sessions, plus the gNB subscriber and SQN tables, to one mappable
+    // file. Exchanges still in flight are not saved, so call it between
+    // phases.
+    bool saveSnapshot(const std::string& path) const {
+        auto start = std::chrono::steady_clock::now();
+        SnapshotWriter out;
+        gnbs.ForEach([&](const gNB& gnb) { out.AddNetworkOwner(gnb.GetNetworkParams().get(), gnb.GetID()); });
+        out.Put<uint64_t>(gnbs.Size());
+        out.Put<uint64_t>(uavs.Size());
+        out.Put<uint64_t>(ues.Size());
+        auto save = [&](const auto& entity) {
+            size_t mark = out.BeginEntity(entity);
+            entity.SaveSnapshot(out);
+            out.EndEntity(mark);
+        };
+        gnbs.ForEach(save);
+        uavs.ForEach(save);
+        ues.ForEach(save);
+        if (!out.WriteFile(path)) {
+            std::cerr << "World Error: Could not save snapshot " << path << std::endl;
+            return false;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << "World: Saved snapshot " << path << " in " << elapsed.count() << " ms" << std::endl;
+        return true;
+    }
+
+    // Restore a snapshot into an empty World. The file is mapped, every
+    // entity is created from its record header, and a second pass lets each
+    // entity read its payload with IDs fixed up to the new handles.
+    // Subscriber tables are attached in place. On error the World is left
+    // empty.
+    bool loadSnapshot(const std::string& path) {
+        if (ues.Size() || uavs.Size() || gnbs.Size()) {
+            std::cerr << "World Error: loadSnapshot needs an empty world." << std::endl;
+            return false;
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<const SnapshotImage> image = SnapshotImage::Open(path);
+        if (!image) {
+            std::cerr << "World Error: Could not load snapshot " << path << std::endl;
+            return false;
+        }
+        auto fail = [&](const std::string& reason) {
+            std::cerr << "World Error: Snapshot " << path << ": " << reason << std::endl;
+            ues.Clear();
+            uavs.Clear();
+            gnbs.Clear();
+            m_UEIndex.clear();
+            m_UAVIndex.clear();
+            m_UAVGridDirty = true;
+            m_HashRingDirty = true;
+            m_GNBIndex.clear();
+            return false;
+        };
+
+        SnapshotReader in = image->Reader();
+        uint64_t gnbCount = 0, uavCount = 0, ueCount = 0;
+        in.Get(gnbCount);
+        in.Get(uavCount);
+        in.Get(ueCount);
+        if (!in.Ok() || gnbCount + uavCount + ueCount > EntityHandle::MaxIndex) return fail("bad entity counts");
+
+        // Pass 1: create entities so references can be resolved
+        std::vector<gNB*> restoredGNBs;
+        std::vector<UAV*> restoredUAVs;
+        std::vector<UE*> restoredUEs;
+        restoredGNBs.reserve(gnbCount);
+        restoredUAVs.reserve(uavCount);
+        restoredUEs.reserve(ueCount);
+        gnbs.Reserve(gnbCount);
+        uavs.Reserve(uavCount);
+        ues.Reserve(ueCount);
+        m_UEIndex.reserve(ueCount);
+        SnapshotReader scan = in;
+        for (uint64_t i = 0; i < gnbCount + uavCount + ueCount; ++i) {
+            SnapshotFormat::EntityHeader header{};
+            scan.Get(header);
+            scan.Take(header.payloadBytes);
+            if (!scan.Ok()) return fail("truncated entity record");
+            if (i < gnbCount) {
+                restoredGNBs.push_back(createGNB(header.id, header.x, header.y));
+                restoredGNBs.back()->SetVelocity(header.vx, header.vy);
+            } else if (i < gnbCount + uavCount) {
+                restoredUAVs.push_back(createUAV(header.id, header.x, header.y));
+                restoredUAVs.back()->SetVelocity(header.vx, header.vy);
+            } else {
+                restoredUEs.push_back(createUE(header.id, header.x, header.y, std::string_view()));
+                restoredUEs.back()->SetVelocity(header.vx, header.vy);
+            }
+        }
+
+        // Pass 2: payloads, gNBs first so UEs can share their network parameters
+        SnapshotLinks links;
+        links.ue = [this](uint32_t id) {
+            auto it = m_UEIndex.find(id);
+            return it != m_UEIndex.end() ? EntityRef<UE>(&ues, it->second) : EntityRef<UE>();
+        };
+        links.uav = [this](uint32_t id) {
+            auto it = m_UAVIndex.find(id);
+            return it != m_UAVIndex.end() ? EntityRef<UAV>(&uavs, it->second) : EntityRef<UAV>();
+        };
+        links.gnb = [this](uint32_t id) {
+            auto it = m_GNBIndex.find(id);
+            return it != m_GNBIndex.end() ? EntityRef<gNB>(&gnbs, it->second) : EntityRef<gNB>();
+        };
+        auto restore = [&](auto& entities) {
+            for (auto* entity : entities) {
+                SnapshotFormat::EntityHeader header{};
+                in.Get(header);
+                SnapshotReader payload = in.Sub(header.payloadBytes);
+                if (!entity->LoadSnapshot(payload, links) || !payload.AtEnd()) {
+                    return fail("corrupt record for " + entity->GetType() + " " + std::to_string(entity->GetID()));
+                }
+            }
+            return true;
+        };
+        if (!restore(restoredGNBs) || !restore(restoredUAVs) || !restore(restoredUEs)) return false;
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << "World: Restored snapshot " << path << " (" << gnbCount << " gNBs, " << uavCount
+                  << " UAVs, " << ueCount << " UEs) in " << elapsed.count() << " ms" << std::endl;
+        return true;
+    }
+
+    // A UE leaves the system: its UAV session and the pending state and
+    // SQN row at its home gNB are released and its pool slot is recycled
+    bool departUE(uint32_t id) {
+        UE* ue = findUE(id);
+        if (!ue) return false;
+        if (ue->GetServingUAVId() >= 0) {
+            if (UAV* uav = findUAV(ue->GetServingUAVId())) uav->ReleaseUE(static_cast<int>(id));
+        }
+        if (gNB* home = homeGNB(*ue)) home->ReleaseUE(static_cast<int>(id), std::string(ue->GetSUPI()));
+        ue->Disconnect();
+        return removeUE(id);
+    }
+
+    // O(1) removal; the freed slot is reused and outstanding refs expire
+    bool removeUE(uint32_t id) {
+        auto it = m_UEIndex.find(id);
+        if (it == m_UEIndex.end()) return false;
+        ues.Destroy(it->second);
+        m_UEIndex.erase(it);
+        return true;
+    }
+
+    bool removeUAV(uint32_t id) {
+        auto it = m_UAVIndex.find(id);
+        if (it == m_UAVIndex.end()) return false;
+        uavs.Destroy(it->second);
+        m_UAVIndex.erase(it);
+        m_UAVGridDirty = true;
+        return true;
+    }
+
+    // Associate UAVs with their home gNB (the nearest one unless hashing)
     void setupAssociations() {
-        if (gnbs.empty()) {
+        if (gnbs.Size() == 0) {
             std::cerr << "Warning: No gNBs in the world to associate UAVs with." << std::endl;
             return;
         }
-        for (auto& uav : uavs) {
-            std::shared_ptr<gNB> nearestGNB = gnbs[0];
-            uint32_t minDistance = std::numeric_limits<uint32_t>::max();
+        uavs.ForEach([&](UAV& uav) {
+            gNB* home = partitionGNB(uavPartitionKey(uav.GetID()), uav.GetPosition());
+            std::cout << "World: Associating UAV " << uav.GetID() << " with gNB " << home->GetID() << std::endl;
+            home->RegisterUAV(uav);
+        });
+    }
 
-            for (auto& gnb : gnbs) {
-                uint32_t dx = uav->GetPosition().first - gnb->GetPosition().first;
-                uint32_t dy = uav->GetPosition().second - gnb->GetPosition().second;
-                uint32_t distSq = dx * dx + dy * dy;
-                if (distSq < minDistance) {
-                    minDistance = distSq;
-                    nearestGNB = gnb;
-                }
-            }
-            std::cout << "World: Associating UAV " << uav->GetID() << " with gNB " << nearestGNB->GetID() << std::endl;
-            nearestGNB->RegisterUAV(uav);
+    void setHomePartitioning(HomePartitioning partitioning) { m_Partitioning = partitioning; }
+
+    // gNB that issued the UE's network parameters, i.e. the one it can
+    // authenticate with; null before provisioning
+    gNB* homeGNB(const UE& ue) {
+        gNB* home = nullptr;
+        if (const Kyber::NetworkParams* network = ue.GetNetworkParams().get()) {
+            gnbs.ForEach([&](gNB& gnb) { if (gnb.GetNetworkParams().get() == network) home = &gnb; });
         }
+        return home;
     }
 
-    // Provision UEs with necessary parameters from their associated gNB
+    // Provision each UE at its home gNB. The gNBs' subscriber tables are
+    // independent, so every gNB takes its share on its own thread.
     void provisionUEs() {
         std::cout << "World: Provisioning UEs..." << std::endl;
-        if (gnbs.empty()) {
+        if (gnbs.Size() == 0) {
             std::cerr << "Warning: No gNBs to provision from." << std::endl;
             return;
         }
-        auto provisioningGNB = gnbs[0];
-        const auto& pk = provisioningGNB->GetKyberPublicKey();
-        const auto& rho = provisioningGNB->GetKyberRho();
-        const auto& amf = provisioningGNB->GetAMF();
 
-        for (auto& ue : ues) {
-            std::string supi = "SUPI_UE" + std::to_string(ue->GetID());
-            std::string key = ue->GetLongTermKey();
+        struct Batch {
+            gNB* gnb;
+            std::vector<UE*> ues;
+        };
+        std::vector<Batch> batches;
+        std::unordered_map<const gNB*, size_t> batchOf;
+        gnbs.ForEach([&](gNB& gnb) {
+            batchOf[&gnb] = batches.size();
+            batches.push_back({ &gnb, {} });
+        });
+        size_t preprovisioned = 0;
+        ues.ForEach([&](UE& ue) {
+            if (ue.IsProvisioned()) { // Loaded with its subscriber record
+                preprovisioned++;
+                return;
+            }
+            gNB* home = partitionGNB(defaultSUPI(ue.GetID()), ue.GetPosition());
+            batches[batchOf[home]].ues.push_back(&ue);
+        });
+        std::erase_if(batches, [](const Batch& batch) { return batch.ues.empty(); });
 
-            provisioningGNB->ProvisionUEKey(supi, key);
-            ue->SetAuthenticationParameters(supi, key, amf, rho, pk);
-            std::cout << "World: Provisioned UE " << ue->GetID() << " with SUPI " << supi << std::endl;
+        auto provisionBatch = [this](Batch& batch) {
+            const auto& network = batch.gnb->GetNetworkParams();
+            for (UE* ue : batch.ues) provisionUE(*ue, *batch.gnb, network);
+        };
+        if (batches.size() == 1) {
+            provisionBatch(batches.front());
+        } else if (batches.size() > 1) {
+            std::vector<std::thread> workers;
+            workers.reserve(batches.size());
+            for (Batch& batch : batches) workers.emplace_back(provisionBatch, std::ref(batch));
+            for (std::thread& worker : workers) worker.join();
+            std::cout << "World: Provisioned UEs at " << batches.size() << " gNBs in parallel:";
+            for (const Batch& batch : batches) std::cout << " gNB " << batch.gnb->GetID() << "=" << batch.ues.size();
+            std::cout << std::endl;
+        }
+        if (preprovisioned) {
+            std::cout << "World: " << preprovisioned << " UEs were already provisioned in bulk." << std::endl;
         }
         std::cout << "World: UE provisioning complete." << std::endl;
     }
 
+    // Each UAV's key goes to its home gNB only
     void provisionUAVs() {
         std::cout << "\n--- Provisioning UAV Keys ---" << std::endl;
-        if (gnbs.empty()) {
+        if (gnbs.Size() == 0) {
             std::cerr << "World Error: No gNBs to provision UAVs." << std::endl;
             return;
         }
-        auto gnb = gnbs[0]; // Assume one gNB
 
-        for (auto& uav : uavs) {
-            // Simple key generation for simulation: "UAV_KEY_" + ID
-            std::string uav_key = "UAV_KEY_" + std::to_string(uav->GetID());
-            uav->SetLongTermKey(uav_key);
-            gnb->ProvisionUAVKey(uav->GetID(), uav_key);
-        }
+        uavs.ForEach([&](UAV& uav) {
+            // Keep a key loaded from a scenario file; otherwise simple
+            // key generation for simulation: "UAV_KEY_" + ID
+            std::string uav_key = uav.GetLongTermKey().empty() ? "UAV_KEY_" + std::to_string(uav.GetID()) : uav.GetLongTermKey();
+            uav.SetLongTermKey(uav_key);
+            partitionGNB(uavPartitionKey(uav.GetID()), uav.GetPosition())->ProvisionUAVKey(uav.GetID(), uav_key);
+        });
         std::cout << "--- UAV Key Provisioning Complete ---" << std::endl;
     }
 
     void setupInfrastructure() {
         std::cout << "\n--- Setting up Infrastructure ---" << std::endl;
-        if (gnbs.empty()) {
+        if (gnbs.Size() == 0) {
              std::cerr << "World Error: No gNBs defined." << std::endl;
              return;
         }
-        auto gnb = gnbs[0];
-        gnb->GenerateGroupKey(); // Generate GKUAV
+        gnbs.ForEach([](gNB& gnb) { gnb.GenerateGroupKey(); }); // Generate GKUAV per cell
         provisionUAVs(); // Provision UAV keys
         setupAssociations(); // Associate UAVs
         provisionUEs(); // Provision UEs with gNB params
@@ -116,7 +517,7 @@ public:
              std::cerr << "World Error: UAV " << uavId << " not found." << std::endl;
              return;
          }
-         if (auto gnb = uav->GetAssociatedGNB().lock()) {
+         if (gNB* gnb = uav->GetAssociatedGNB()) {
              gnb->InitiateUAVServiceAccessAuth(uavId);
              // Note: The rest of Phase A happens via callbacks between gNB and UAV
          } else {
@@ -124,6 +525,121 @@ public:
          }
     }
 
+    // Phase A for a whole fleet. Each gNB builds the challenges of its UAVs
+    // in one batch, the UAVs verify theirs on `threads` workers (0 = one per
+    // core), and each gNB then takes the confirmations in one pass. Ends in
+    // the same state as simulateUAVServiceAuthentication for every UAV.
+    FleetAuthStats authenticateUAVFleet(std::span<const int> uavIds, size_t threads = 0) {
+        std::cout << "\n--- Authenticating a fleet of " << uavIds.size() << " UAVs ---" << std::endl;
+        FleetAuthStats stats;
+        stats.requested = uavIds.size();
+
+        struct Batch {
+            gNB* gnb;
+            std::vector<int> ids;
+            std::vector<UAV*> uavs;
+            std::vector<std::optional<UAVAuthChallenge>> challenges;
+            std::vector<uint8_t> verified; // Written by the workers, one slot each
+        };
+        std::vector<Batch> batches;
+        std::unordered_map<const gNB*, size_t> batchOf;
+        for (int uavId : uavIds) {
+            UAV* uav = findUAV(uavId);
+            gNB* gnb = uav ? uav->GetAssociatedGNB() : nullptr;
+            if (!gnb) {
+                std::cerr << "World Error: UAV " << uavId << " not found or has no associated gNB." << std::endl;
+                continue;
+            }
+            auto [it, added] = batchOf.try_emplace(gnb, batches.size());
+            if (added) batches.push_back({ .gnb = gnb, .ids = {}, .uavs = {}, .challenges = {}, .verified = {} });
+            batches[it->second].ids.push_back(uavId);
+            batches[it->second].uavs.push_back(uav);
+        }
+
+        auto gnbStart = std::chrono::steady_clock::now();
+        for (Batch& batch : batches) {
+            batch.challenges = batch.gnb->BuildUAVServiceAccessChallenges(batch.ids);
+            batch.verified.assign(batch.ids.size(), 0);
+        }
+        stats.gnbTime += std::chrono::steady_clock::now() - gnbStart;
+
+        // UAVs share no state, so their checks need no locking
+        struct Job {
+            UAV* uav;
+            const UAVAuthChallenge* challenge;
+            uint8_t* verified;
+        };
+        std::vector<Job> jobs;
+        for (Batch& batch : batches) {
+            for (size_t i = 0; i < batch.ids.size(); ++i) {
+                if (batch.challenges[i]) jobs.push_back({ batch.uavs[i], &*batch.challenges[i], &batch.verified[i] });
+            }
+        }
+        stats.challenged = jobs.size();
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        stats.threads = std::clamp<size_t>(jobs.size(), 1, threads);
+        auto verify = [&jobs](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                *jobs[i].verified = jobs[i].uav->VerifyServiceAccessAuth(jobs[i].challenge->hres_star_j, jobs[i].challenge->cj, jobs[i].challenge->rand_prime);
+            }
+        };
+        auto uavStart = std::chrono::steady_clock::now();
+        if (stats.threads == 1) {
+            verify(0, jobs.size());
+        } else {
+            const size_t chunk = (jobs.size() + stats.threads - 1) / stats.threads;
+            std::vector<std::thread> workers;
+            workers.reserve(stats.threads);
+            for (size_t begin = 0; begin < jobs.size(); begin += chunk) {
+                workers.emplace_back(verify, begin, std::min(begin + chunk, jobs.size()));
+            }
+            for (std::thread& worker : workers) worker.join();
+        }
+        stats.uavTime = std::chrono::steady_clock::now() - uavStart;
+
+        gnbStart = std::chrono::steady_clock::now();
+        for (Batch& batch : batches) {
+            std::vector<int> confirmed;
+            for (size_t i = 0; i < batch.ids.size(); ++i) {
+                if (batch.verified[i]) confirmed.push_back(batch.ids[i]);
+            }
+            stats.verified += confirmed.size();
+            stats.authorized += batch.gnb->AcceptServiceAccessConfirmations(confirmed);
+        }
+        stats.gnbTime += std::chrono::steady_clock::now() - gnbStart;
+
+        for (const Batch& batch : batches) {
+            for (size_t i = 0; i < batch.ids.size(); ++i) {
+                if (batch.gnb->IsUAVAuthorized(batch.ids[i])) batch.uavs[i]->BroadcastNotification();
+            }
+        }
+        std::cout << "World: Fleet authentication authorized " << stats.authorized << "/" << stats.requested << " UAVs ("
+                  << stats.GNBMicrosPerUAV() << " us gNB time per UAV, UAV side on " << stats.threads << " threads)" << std::endl;
+        return stats;
+    }
+
+    // End a UAV's authorization and drop it from its gNB's group key tree.
+    // Without rekeyNow the change waits for the next rekeyUAVGroups(), so
+    // many revocations can share one rekey.
+    void revokeUAV(int uavId, bool rekeyNow = true) {
+        UAV* uav = findUAV(uavId);
+        gNB* gnb = uav ? uav->GetAssociatedGNB() : nullptr;
+        if (!gnb) {
+            std::cerr << "World Error: UAV " << uavId << " not found or has no associated gNB." << std::endl;
+            return;
+        }
+        gnb->RevokeUAV(uavId);
+        if (rekeyNow) gnb->RekeyUAVGroup();
+    }
+
+    // Broadcast one group rekey per gNB with pending key-tree changes;
+    // returns the wrapped keys sent
+    size_t rekeyUAVGroups() {
+        size_t messages = 0;
+        gnbs.ForEach([&](gNB& gnb) { messages += gnb.RekeyUAVGroup().messages.size(); });
+        return messages;
+    }
+
     // Phase B: UE connects via an authenticated UAV
     void simulateUAVAssistedConnection(int ueId) {
         std::cout << "\n--- Simulating UAV-Assisted Connection for UE " << ueId << " ---" << std::endl;
@@ -133,15 +649,27 @@ public:
             return;
         }
 
-        // Find nearest *authenticated* and operational UAV
-        auto targetUAV = findNearestAuthenticatedUAV(ue->GetPosition());
-        if (targetUAV) {
-            std::cout << "World: UE " << ueId << " found nearest authenticated UAV " << targetUAV->GetID() << " (TIDj=" << targetUAV->GetTID() << ")" << std::endl;
+        // Lowest-cost authenticated, operational UAV of the UE's home gNB
+        // with room (the UAV relays to its own gNB, and only the home gNB
+        // holds the subscriber); a UAV that rejects the request redirects
+        // the UE to the next best one
+        gNB* home = homeGNB(*ue);
+        std::vector<int> tried;
+        for (uint32_t attempt = 0; attempt <= m_SelectionPolicy.maxRedirects; ++attempt) {
+            UAV* targetUAV = selectServingUAV(ue->GetPosition(), home, {}, tried, home != nullptr);
+            if (!targetUAV) break;
+            if (attempt == 0) {
+                std::cout << "World: UE " << ueId << " found nearest authenticated UAV " << targetUAV->GetID() << " (TIDj=" << targetUAV->GetTID() << ")" << std::endl;
+            } else {
+                std::cout << "World: UE " << ueId << " redirected to UAV " << targetUAV->GetID() << " (TIDj=" << targetUAV->GetTID() << ")" << std::endl;
+            }
+            uint64_t rejects = targetUAV->GetRelayStats().admissionRejects;
             ue->InitiateConnection(*targetUAV);
             // Note: The rest of Phase B happens via callbacks: UE -> UAV -> gNB -> UAV -> UE
-        } else {
-            std::cerr << "World Error: No available authenticated UAV found for UE " << ueId << std::endl;
+            if (targetUAV->GetRelayStats().admissionRejects == rejects) return;
+            tried.push_back(targetUAV->GetID());
         }
+        std::cerr << "World Error: No available authenticated UAV found for UE " << ueId << std::endl;
     }
 
     // Phase C: UE Handover between authenticated UAVs
@@ -169,7 +697,7 @@ public:
 
          // Check if UE has necessary state from Phase B
          // (Simplified check - just see if state is Connected)
-         if (ue->GetState() != "Connected") {
+         if (ue->GetState() != UEState::Connected) {
               std::cerr << "World Error: UE " << ueId << " is not in Connected state. Cannot initiate handover auth." << std::endl;
               return;
          }
@@ -179,111 +707,886 @@ public:
          // Note: The rest of Phase C happens via callbacks: UE -> TargetUAV -> UE -> TargetUAV -> gNB
     }
 
-    // --- Helper Methods ---
-    std::shared_ptr<UE> findUE(int id) {
-        for (auto& ue : ues) {
-            if (ue->GetID() == id) return ue;
+    // A UAV drops out: its gNB re-homes the UEs it was serving (see
+    // gNB::HandleUAVFailure)
+    UAVFailureReport simulateUAVFailure(int uavId, size_t threads = 4) {
+        std::cout << "\n--- Simulating failure of UAV " << uavId << " ---" << std::endl;
+        UAV* uav = findUAV(uavId);
+        if (!uav) {
+            std::cerr << "World Error: UAV " << uavId << " not found." << std::endl;
+            return {};
+        }
+        gNB* gnb = uav->GetAssociatedGNB();
+        if (!gnb) {
+            std::cerr << "World Error: UAV " << uavId << " has no associated gNB." << std::endl;
+            return {};
         }
-        return nullptr;
+        return gnb->HandleUAVFailure(*uav, threads);
     }
 
-    std::shared_ptr<UAV> findUAV(int id) {
-        for (auto& uav : uavs) {
-            if (uav->GetID() == id) return uav;
+    // Phase B for many UEs at once: each UE runs as a coroutine flow on a
+    // pool of `threads` workers (AuthFlows.h), with `linkLatency` per message
+    // hop and `timeout` per UE. Blocks until every flow has finished and
+    // returns one result per entry of `ueIds`.
+    std::vector<AuthResult> simulateConcurrentUEAccess(const std::vector<int>& ueIds,
+                                                       size_t threads = 4,
+                                                       std::chrono::milliseconds timeout = std::chrono::milliseconds(1000),
+                                                       std::chrono::microseconds linkLatency = std::chrono::microseconds(0)) {
+        std::cout << "\n--- Simulating Concurrent UAV-Assisted Connection for " << ueIds.size() << " UEs on " << threads << " threads ---" << std::endl;
+        std::vector<AuthResult> results(ueIds.size());
+        AuthScheduler scheduler(threads);
+        scheduler.SetLinkLatency(linkLatency);
+        // Every UAV is picked before any flow runs: selection reads UAV load
+        // that the flows write on their strands. Nothing has attached yet, so
+        // earlier picks count as load.
+        std::map<int, size_t> reserved;
+        std::vector<std::tuple<size_t, UE*, UAV*>> picks;
+        picks.reserve(ueIds.size());
+
+        for (size_t i = 0; i < ueIds.size(); ++i) {
+            results[i].entityId = ueIds[i];
+            UE* ue = findUE(ueIds[i]);
+            if (!ue) {
+                results[i].message = "UE not found";
+                continue;
+            }
+            gNB* home = homeGNB(*ue);
+            UAV* uav = selectServingUAV(ue->GetPosition(), home, reserved, {}, home != nullptr);
+            if (!uav) {
+                results[i].message = "No authenticated UAV";
+                continue;
+            }
+            reserved[uav->GetID()]++;
+            picks.emplace_back(i, ue, uav);
+        }
+        for (auto [i, ue, uav] : picks) {
+            scheduler.Spawn(RunAuthFlow([&scheduler, ue, uav](FlowContext& ctx) { return UEAccessFlow(scheduler, ctx, *ue, *uav); },
+                                        timeout, results[i]));
+        }
+        scheduler.WaitIdle();
+
+        size_t succeeded = 0, timedOut = 0;
+        for (const AuthResult& result : results) {
+            if (result.status == AuthResult::Status::Success) succeeded++;
+            else if (result.status == AuthResult::Status::TimedOut) timedOut++;
         }
-        return nullptr;
+        std::cout << "World: Concurrent access finished. Success=" << succeeded << " TimedOut=" << timedOut
+                  << " Failed=" << (results.size() - succeeded - timedOut) << std::endl;
+        return results;
     }
 
-    std::shared_ptr<gNB> findGNB(int id) {
-        for (auto& gnb : gnbs) {
-            if (gnb->GetID() == id) return gnb;
+    // Open-system run: UEs from `generator` arrive, are provisioned and
+    // attach through simulateUAVAssistedConnection, move with the world and
+    // depart. With timeScale > 0 events are paced in wall-clock time at the
+    // offered load and the lag shows whether the gNB keeps up; otherwise
+    // events run back to back and AttachRate() is the service capacity.
+    // UAVs must have completed Phase A.
+    ChurnStats runChurnWorkload(ChurnGenerator& generator, const ChurnOptions& options = {}) {
+        std::cout << "\n--- Running churn workload for " << options.duration << " s ---" << std::endl;
+        ChurnStats stats;
+        if (gnbs.Size() == 0) {
+            std::cerr << "World Error: No gNBs to provision arriving UEs." << std::endl;
+            return stats;
         }
-        return nullptr;
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point wallStart = Clock::now();
+        double simNow = 0.0, totalLagMs = 0.0;
+        uint64_t events = 0;
+
+        while (auto event = generator.Next()) {
+            if (event->time >= options.duration) break;
+            if (event->time > simNow) {
+                update(static_cast<float>(event->time - simNow));
+                simNow = event->time;
+            }
+            if (options.timeScale > 0.0) {
+                auto due = wallStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(event->time * options.timeScale));
+                std::this_thread::sleep_until(due);
+                double lagMs = std::chrono::duration<double, std::milli>(Clock::now() - due).count();
+                totalLagMs += lagMs;
+                stats.maxLagMs = std::max(stats.maxLagMs, lagMs);
+            }
+            events++;
+
+            const Clock::time_point begin = Clock::now();
+            if (event->kind == ChurnEvent::Kind::Arrival) {
+                stats.arrivals++;
+                const UEArrival& arrival = event->arrival;
+                UE* ue = createUE(event->ueId, arrival.x, arrival.y, options.ueKey);
+                ue->SetVelocity(arrival.vx, arrival.vy);
+                gNB* ueHome = partitionGNB(defaultSUPI(event->ueId), ue->GetPosition());
+                provisionUE(*ue, *ueHome, ueHome->GetNetworkParams());
+                simulateUAVAssistedConnection(static_cast<int>(event->ueId));
+                if (ue->GetState() == UEState::Connected) stats.attached++;
+                else stats.attachFailed++;
+                stats.peakActive = std::max(stats.peakActive, generator.GetActive());
+            } else {
+                stats.departures++;
+                departUE(event->ueId);
+            }
+            stats.busySeconds += std::chrono::duration<double>(Clock::now() - begin).count();
+        }
+
+        stats.blocked = generator.GetBlocked();
+        stats.wallSeconds = std::chrono::duration<double>(Clock::now() - wallStart).count();
+        stats.meanLagMs = events ? totalLagMs / events : 0.0;
+        std::cout << "World: Churn finished. Arrivals=" << stats.arrivals << " Departures=" << stats.departures
+                  << " Attached=" << stats.attached << " Failed=" << stats.attachFailed << " Blocked=" << stats.blocked
+                  << " PeakActive=" << stats.peakActive << " AttachRate=" << stats.AttachRate() << "/s"
+                  << " MaxLag=" << stats.maxLagMs << "ms" << std::endl;
+        return stats;
+    }
+
+    // Per-state occupancy and per-transition latency for every protocol
+    // state machine (aggregated across all entities). Transition counts
+    // cover everything since the last reset, including any other World
+    // alive at the same time.
+    static void resetStateMachineStats() {
+        StateMachine<UEStateTraits>::ResetStats();
+        StateMachine<UAVAccessTraits>::ResetStats();
+        StateMachine<UAVSessionTraits>::ResetStats();
+        StateMachine<GNBUAVAuthTraits>::ResetStats();
+        StateMachine<GNBUEAuthTraits>::ResetStats();
+    }
+
+    void printStateMachineReport(std::ostream& os = std::cout) const {
+        os << "\n===== Protocol State Machine Report =====" << std::endl;
+        StateMachine<UEStateTraits>::PrintReport(os);
+        StateMachine<UAVAccessTraits>::PrintReport(os);
+        StateMachine<UAVSessionTraits>::PrintReport(os);
+        StateMachine<GNBUAVAuthTraits>::PrintReport(os);
+        StateMachine<GNBUEAuthTraits>::PrintReport(os);
     }
 
-    std::shared_ptr<UAV> findNearestAvailableUAV(const Position& pos) {
-        std::shared_ptr<UAV> bestUAV = nullptr;
+    // --- Helper Methods ---
+    UE* findUE(int id) {
+        auto it = m_UEIndex.find(static_cast<uint32_t>(id));
+        return it != m_UEIndex.end() ? ues.Get(it->second) : nullptr;
+    }
+
+    UAV* findUAV(int id) {
+        auto it = m_UAVIndex.find(static_cast<uint32_t>(id));
+        return it != m_UAVIndex.end() ? uavs.Get(it->second) : nullptr;
+    }
+
+    gNB* findGNB(int id) {
+        auto it = m_GNBIndex.find(static_cast<uint32_t>(id));
+        return it != m_GNBIndex.end() ? gnbs.Get(it->second) : nullptr;
+    }
+
+    UAV* findNearestAvailableUAV(const Position& pos) {
+        UAV* bestUAV = nullptr;
         uint32_t minDistSq = std::numeric_limits<uint32_t>::max();
 
-        for (auto& uav : uavs) {
-            if (uav->IsOperational()) {
-                uint32_t dx = uav->GetPosition().first - pos.first;
-                uint32_t dy = uav->GetPosition().second - pos.second;
+        uavs.ForEach([&](UAV& uav) {
+            if (uav.IsOperational()) {
+                uint32_t dx = uav.GetPosition().first - pos.first;
+                uint32_t dy = uav.GetPosition().second - pos.second;
                 uint32_t distSq = dx * dx + dy * dy;
                 if (distSq < minDistSq) {
                     minDistSq = distSq;
-                    bestUAV = uav;
+                    bestUAV = &uav;
                 }
             }
-        }
+        });
         return bestUAV;
     }
 
-    std::shared_ptr<UAV> findNearestAuthenticatedUAV(const Position& pos) {
-        std::shared_ptr<UAV> bestUAV = nullptr;
+    UAV* findNearestAuthenticatedUAV(const Position& pos) {
+        UAV* bestUAV = nullptr;
         uint32_t minDistSq = std::numeric_limits<uint32_t>::max();
 
-        for (auto& uav : uavs) {
+        uavs.ForEach([&](UAV& uav) {
             // Check operational status AND if authenticated with gNB
-            if (uav->IsOperational() && uav->IsAuthenticatedWithGNB()) {
-                uint32_t dx = uav->GetPosition().first - pos.first;
-                uint32_t dy = uav->GetPosition().second - pos.second;
+            if (uav.IsOperational() && uav.IsAuthenticatedWithGNB()) {
+                uint32_t dx = uav.GetPosition().first - pos.first;
+                uint32_t dy = uav.GetPosition().second - pos.second;
                 uint32_t distSq = dx * dx + dy * dy;
                 if (distSq < minDistSq) {
                     minDistSq = distSq;
-                    bestUAV = uav;
+                    bestUAV = &uav;
                 }
             }
-        }
+        });
         return bestUAV;
     }
 
-    std::shared_ptr<UAV> findBestAlternativeUAVForGNB(const Position& uePos, int failedUavId, std::shared_ptr<gNB> gnb) {
-        std::shared_ptr<UAV> bestUAV = nullptr;
-        uint32_t minDistSq = std::numeric_limits<uint32_t>::max();
-
-        for (auto& uav : uavs) {
-            if (uav->GetID() != failedUavId && uav->IsOperational()) {
-                bool associated = false;
-                if (auto assoc_gnb = uav->GetAssociatedGNB().lock()) {
-                    if (assoc_gnb->GetID() == gnb->GetID()) associated = true;
-                }
+    // Replacement for a failed UAV, preferring UAVs anchored at `gnb`
+    UAV* findBestAlternativeUAVForGNB(const Position& uePos, int failedUavId, gNB* gnb) {
+        return selectServingUAV(uePos, gnb, {}, { failedUavId });
+    }
 
-                uint32_t dx = uav->GetPosition().first - uePos.first;
-                uint32_t dy = uav->GetPosition().second - uePos.second;
-                uint32_t distSq = dx * dx + dy * dy;
-                if (distSq < minDistSq) {
-                    minDistSq = distSq;
-                    bestUAV = uav;
-                }
+    // Lowest-cost authenticated, operational UAV that can admit another UE
+    // (UAVSelectionPolicy). `preferred` is the gNB the UE is anchored at, if
+    // any, and with preferredOnly UAVs of other gNBs are skipped; `reserved`
+    // counts UEs already assigned per UAV ID but not yet attached. Served
+    // from a spatial index of UAV positions that is rebuilt only after UAVs
+    // were added, removed or moved.
+    UAV* selectServingUAV(const Position& pos, const gNB* preferred = nullptr,
+                          const std::map<int, size_t>& reserved = {}, const std::vector<int>& exclude = {},
+                          bool preferredOnly = false) {
+        if (m_UAVGridDirty) rebuildUAVGrid();
+        const UAVSelectionPolicy& policy = m_SelectionPolicy;
+        auto best = m_UAVGrid.Cheapest(pos, policy.distanceWeight, [&](uint32_t item, double distance) {
+            UAV* uav = m_UAVGridItems[item].Get();
+            if (!uav || !uav->IsOperational() || !uav->IsAuthenticatedWithGNB()
+                || std::find(exclude.begin(), exclude.end(), uav->GetID()) != exclude.end()) {
+                return std::numeric_limits<double>::infinity();
             }
-        }
-        return bestUAV;
+            auto it = reserved.find(uav->GetID());
+            size_t pending = it != reserved.end() ? it->second : 0;
+            if (!uav->CanAdmit(pending)) return std::numeric_limits<double>::infinity();
+            bool sameGNB = !preferred || uav->GetAssociatedGNB() == preferred;
+            if (!sameGNB && preferredOnly) return std::numeric_limits<double>::infinity();
+            return policy.Cost(distance, uav->GetRelayLoad(), sameGNB, pending);
+        });
+        return best ? m_UAVGridItems[*best].Get() : nullptr;
+    }
+
+    // Cost weights for selectServingUAV; also applied by every gNB when it
+    // re-homes UEs after a UAV failure
+    void setUAVSelectionPolicy(const UAVSelectionPolicy& policy) {
+        m_SelectionPolicy = policy;
+        gnbs.ForEach([&](gNB& gnb) { gnb.SetUAVSelectionPolicy(policy); });
+    }
+
+    void setRelayCapacity(const RelayCapacity& capacity) {
+        uavs.ForEach([&](UAV& uav) { uav.SetRelayCapacity(capacity); });
+    }
+
+    // Per-UAV relay load, one line per UAV
+    void printRelayLoadReport(std::ostream& os = std::cout) const {
+        os << "\n===== UAV Relay Load Report =====" << std::endl;
+        uavs.ForEach([&](const UAV& uav) {
+            RelayLoad load = uav.GetRelayLoad();
+            os << "UAV " << uav.GetID() << ": connected=" << load.connectedUEs << " pending=" << load.pendingAuths
+               << " rate=" << load.relayRate << "/s relayed=" << uav.GetRelayStats().relayed
+               << " rejected=" << uav.GetRelayStats().admissionRejects << std::endl;
+        });
+    }
+
+    // 2^indBits SQN slots per subscriber; 0 keeps only the last SQN
+    void setSQNWindow(uint32_t indBits) {
+        gnbs.ForEach([&](gNB& gnb) { gnb.SetSQNWindow(indBits); });
+    }
+
+    void setResumptionLimits(const ResumptionLimits& limits) {
+        gnbs.ForEach([&](gNB& gnb) { gnb.SetResumptionLimits(limits); });
+    }
+
+    // Fast re-authentication cache use, one line per gNB
+    void printResumptionReport(std::ostream& os = std::cout) const {
+        os << "\n===== Fast Re-authentication Report =====" << std::endl;
+        gnbs.ForEach([&](const gNB& gnb) {
+            const ResumptionStats& stats = gnb.GetResumptionStats();
+            os << "gNB " << gnb.GetID() << ": cached=" << gnb.GetResumptionCacheSize() << " hits=" << stats.hits
+               << " misses=" << stats.misses << " rejected=" << stats.rejected << " expired=" << stats.expired
+               << " evicted=" << stats.evicted << " hit rate=" << 100.0 * stats.HitRate() << "%"
+               << " saved/hit=" << stats.SavedMicrosPerHit() << " us" << std::endl;
+        });
+    }
+
+    void setTokenCacheLimits(const TokenCacheLimits& limits) {
+        uavs.ForEach([&](UAV& uav) { uav.SetTokenCacheLimits(limits); });
+    }
+
+    void setHandoverPrepLimits(const HandoverPrepLimits& limits) {
+        uavs.ForEach([&](UAV& uav) { uav.SetHandoverPrepLimits(limits); });
+    }
+
+    // Verified-token cache use at handover targets, one line per UAV
+    void printTokenCacheReport(std::ostream& os = std::cout) const {
+        os << "\n===== Verified-Token Cache Report =====" << std::endl;
+        uavs.ForEach([&](const UAV& uav) {
+            const TokenCacheStats& stats = uav.GetTokenCacheStats();
+            os << "UAV " << uav.GetID() << ": cached=" << uav.GetTokenCacheSize() << " hits=" << stats.hits
+               << " misses=" << stats.misses << " expired=" << stats.expired << " evicted=" << stats.evicted
+               << " invalidated=" << stats.invalidated << " hit rate=" << 100.0 * stats.HitRate() << "%"
+               << " target=" << stats.MicrosPerHandover() << " us/handover" << std::endl;
+        });
     }
 
     void update(float deltaTime) {
-        for (auto& ue : ues) { ue->Update(deltaTime); }
-        for (auto& uav : uavs) { uav->Update(deltaTime); }
-        for (auto& gnb : gnbs) { gnb->Update(deltaTime); }
+        ues.ForEach([&](UE& ue) { ue.Update(deltaTime); });
+        uavs.ForEach([&](UAV& uav) {
+            if (uav.GetVelocity() != Velocity{}) m_UAVGridDirty = true;
+            uav.Update(deltaTime);
+        });
+        gnbs.ForEach([&](gNB& gnb) { gnb.Update(deltaTime); });
+        advanceMobilityTraces(deltaTime);
+        if (m_Handover.enabled) runHandovers(deltaTime);
+    }
+
+    // Let update() hand UEs over to a closer authenticated UAV on its own.
+    // Every checkInterval the UEs that moved are matched against a spatial
+    // index of authenticated UAVs; a UE whose nearest UAV beats its serving
+    // UAV by more than the hysteresis is queued for Phase C with that
+    // target. The queue is drained per target UAV in batches, paced by a
+    // token bucket of maxPerSecond. With a predictLookahead, the UAV nearest
+    // to where a UE will be is sent a HandoverHint ahead of time, so it has
+    // TGK'i and K*UAVi derived when the handover arrives.
+    void enableAutomaticHandover(const HandoverPolicy& policy = {}) {
+        m_Handover = HandoverState{};
+        m_Handover.enabled = true;
+        m_Handover.policy = policy;
+        m_Handover.grid = SpatialGrid(policy.gridCell);
+        m_Handover.tokens = static_cast<double>(policy.burst);
+        std::cout << "World: Automatic handover enabled (hysteresis " << policy.hysteresis << ", max "
+                  << policy.maxPerSecond << "/s)" << std::endl;
+    }
+
+    void disableAutomaticHandover() { m_Handover.enabled = false; }
+
+    const HandoverStats& getHandoverStats() const { return m_Handover.stats; }
+
+    void printHandoverReport(std::ostream& os = std::cout) const {
+        const HandoverStats& stats = m_Handover.stats;
+        os << "\n===== Automatic Handover Report =====" << std::endl;
+        os << "Scans=" << stats.scans << " Evaluated=" << stats.evaluated << " Queued=" << stats.queued
+           << " Started=" << stats.started << " Succeeded=" << stats.succeeded << " Failed=" << stats.failed
+           << " Dropped=" << stats.dropped << std::endl;
+        os << "Rate=" << stats.Rate() << " handovers/s over " << stats.simSeconds << " simulated s" << std::endl;
+        os << "Phase C latency (us): p50=" << HandoverStats::Percentile(stats.protocolUs, 0.5)
+           << " p90=" << HandoverStats::Percentile(stats.protocolUs, 0.9)
+           << " p99=" << HandoverStats::Percentile(stats.protocolUs, 0.99)
+           << " max=" << HandoverStats::Percentile(stats.protocolUs, 1.0) << std::endl;
+        os << "Queue delay (s): p50=" << HandoverStats::Percentile(stats.queueDelayS, 0.5)
+           << " p90=" << HandoverStats::Percentile(stats.queueDelayS, 0.9)
+           << " p99=" << HandoverStats::Percentile(stats.queueDelayS, 0.99)
+           << " max=" << HandoverStats::Percentile(stats.queueDelayS, 1.0) << std::endl;
+        if (m_Handover.policy.predictLookahead <= 0.0) return;
+
+        HandoverPrepStats prep;
+        size_t pendingPreps = 0;
+        uavs.ForEach([&](const UAV& uav) {
+            const HandoverPrepStats& uavPrep = uav.GetHandoverPrepStats();
+            prep.used += uavPrep.used;
+            prep.duplicates += uavPrep.duplicates;
+            prep.wasted += uavPrep.wasted;
+            prep.wastedTime += uavPrep.wastedTime;
+            pendingPreps += uav.GetPreparedHandoverCount();
+        });
+        os << "Prediction: hints=" << stats.hintsSent << " hits=" << stats.predictedHits
+           << " accuracy=" << 100.0 * stats.PredictionAccuracy() << "% wasted=" << stats.WastedHints()
+           << " (mispredicted=" << stats.mispredicted << " overwritten=" << stats.overwritten
+           << ") outstanding=" << m_Handover.predicted.size() << std::endl;
+        // Percentiles of an empty side would read as 0 us
+        auto latency = [&](const char* label, const std::vector<double>& samples) {
+            os << label << " latency (us): n=" << samples.size() << " p50=" << HandoverStats::Percentile(samples, 0.5)
+               << " p90=" << HandoverStats::Percentile(samples, 0.9) << std::endl;
+        };
+        if (!stats.preparedUs.empty()) latency("Prepared", stats.preparedUs);
+        if (!stats.unpreparedUs.empty()) latency("Unprepared", stats.unpreparedUs);
+        os << "Preparations used=" << prep.used << " wasted=" << prep.wasted << " ("
+           << std::chrono::duration<double, std::micro>(prep.wastedTime).count() << " us)"
+           << " duplicates=" << prep.duplicates << " pending=" << pendingPreps << std::endl;
+    }
+
+    // Drive the trace's UEs or UAVs from a mobility trace (see
+    // MobilityTrace.h) instead of their velocities. Frame 0 is applied now;
+    // update() then moves to the next frame every tick of simulated time.
+    // Frames are decoded straight from the mapping, so traces far larger
+    // than RAM replay at the speed the disk can stream them. Trace IDs with
+    // no entity are skipped until an entity with that ID is created.
+    bool attachMobilityTrace(const std::string& path) {
+        std::unique_ptr<MobilityTrace> trace = MobilityTrace::Open(path);
+        if (!trace || !trace->Advance()) {
+            std::cerr << "World Error: Could not attach mobility trace " << path << std::endl;
+            return false;
+        }
+        TracePlayback playback;
+        playback.path = path;
+        playback.handles.resize(trace->GetEntityCount());
+        playback.trace = std::move(trace);
+        applyMobilityTrace(playback);
+
+        size_t matched = 0;
+        for (size_t i = 0; i < playback.handles.size(); ++i) {
+            if (tracedEntity(playback, i)) matched++;
+        }
+        bool isUE = playback.trace->GetKind() == MobilityTrace::EntityKind::UE;
+        std::cout << "World: Attached mobility trace " << path << " (" << matched << "/" << playback.handles.size()
+                  << (isUE ? " UEs, " : " UAVs, ") << playback.trace->GetTickCount() << " ticks of "
+                  << playback.trace->GetTickSeconds() << " s)" << std::endl;
+        m_Traces.push_back(std::move(playback));
+        return true;
+    }
+
+    // Run mobility and auth-state expiry for `duration` seconds on a
+    // ParallelEngine. Each gNB with its UAVs and UEs is one logical process
+    // that updates its entities every `tick` seconds; a UE that has become
+    // closer to another gNB is handed to that cell as a message taking
+    // `linkDelay` seconds, which is also the engine's lookahead. The result
+    // (including `digest`) is identical for every thread count. No protocol
+    // exchanges run inside or between cells; the per-cell work is mobility
+    // and nearest-gNB re-association only.
+    CellSimulationStats runCellSimulation(float duration, float tick = 0.1f, float linkDelay = 0.01f,
+                                          size_t threads = std::thread::hardware_concurrency()) {
+        CellRun run;
+        run.tick = tick;
+        run.linkDelay = linkDelay;
+        std::unordered_map<const gNB*, uint32_t> cellOfGNB;
+        gnbs.ForEach([&](gNB& gnb) {
+            cellOfGNB[&gnb] = static_cast<uint32_t>(run.cells.size());
+            CellPartition& cell = run.cells.emplace_back();
+            cell.gnb = &gnb;
+            cell.position = gnb.GetPosition();
+        });
+        if (run.cells.empty()) {
+            std::cerr << "World Error: No gNBs to partition the simulation by." << std::endl;
+            return {};
+        }
+        std::cout << "\n--- Cell-Partitioned Simulation: " << run.cells.size() << " cells, " << duration << "s, "
+                  << threads << " threads ---" << std::endl;
+
+        uavs.ForEach([&](UAV& uav) {
+            auto assoc = cellOfGNB.find(uav.GetAssociatedGNB());
+            uint32_t cell = assoc != cellOfGNB.end() ? assoc->second : nearestCell(run.cells, uav.GetPosition());
+            run.cells[cell].uavs.push_back(&uav);
+        });
+        ues.ForEach([&](UE& ue) {
+            run.cells[nearestCell(run.cells, ue.GetPosition())].ues.push_back(&ue);
+        });
+        for (CellPartition& cell : run.cells) {
+            std::sort(cell.ues.begin(), cell.ues.end(), [](const UE* a, const UE* b) { return a->GetID() < b->GetID(); });
+        }
+
+        ParallelEngine engine(linkDelay, threads);
+        for (size_t i = 0; i < run.cells.size(); ++i) {
+            engine.AddProcess().Schedule(0.0, [this, &run](LogicalProcess& lp) { tickCell(lp, run); });
+        }
+        CellSimulationStats stats;
+        stats.engine = engine.Run(duration);
+
+        // FNV-1a over cell membership and UE positions
+        stats.digest = 1469598103934665603ull;
+        auto mix = [&stats](uint64_t value) { stats.digest = (stats.digest ^ value) * 1099511628211ull; };
+        for (const CellPartition& cell : run.cells) {
+            stats.reassociations += cell.reassociations;
+            mix(cell.gnb->GetID());
+            for (const UE* ue : cell.ues) {
+                mix(ue->GetID());
+                mix((static_cast<uint64_t>(ue->GetPosition().first) << 32) | ue->GetPosition().second);
+            }
+        }
+        std::cout << "World: Cell simulation finished. Events=" << stats.engine.events << " Windows=" << stats.engine.windows
+                  << " CrossMessages=" << stats.engine.crossMessages << " Steals=" << stats.engine.steals
+                  << " Reassociations=" << stats.reassociations << std::endl;
+        return stats;
     }
 
     std::vector<std::pair<std::string, Position>> getAllEntityPositions() const {
         std::vector<std::pair<std::string, Position>> positions;
-        for (const auto& ue : ues) { positions.push_back({ ue->GetType() + std::to_string(ue->GetID()), ue->GetPosition() }); }
-        for (const auto& uav : uavs) { positions.push_back({ uav->GetType() + std::to_string(uav->GetID()), uav->GetPosition() }); }
-        for (const auto& gnb : gnbs) { positions.push_back({ gnb->GetType() + std::to_string(gnb->GetID()), gnb->GetPosition() }); }
+        positions.reserve(ues.Size() + uavs.Size() + gnbs.Size());
+        ues.ForEach([&](const UE& ue) { positions.push_back({ ue.GetType() + std::to_string(ue.GetID()), ue.GetPosition() }); });
+        uavs.ForEach([&](const UAV& uav) { positions.push_back({ uav.GetType() + std::to_string(uav.GetID()), uav.GetPosition() }); });
+        gnbs.ForEach([&](const gNB& gnb) { positions.push_back({ gnb.GetType() + std::to_string(gnb.GetID()), gnb.GetPosition() }); });
         return positions;
     }
 
     void linkEntities() {
         std::cout << "World: Linking entities..." << std::endl;
-        for(auto& uav : uavs) {
-            // Hacky way to allow UAV to find UEs - inject find function
-            uav->findUEHandler = [this](int ueId) { return this->findUE(ueId); };
-            // Hacky way to allow UAV to get shared_ptr to itself
-            uav->getSelfPtrHandler = [uav]() { return uav; };
-        }
-         // Similar linking could be done for UE finding UAVs if needed
+        // UAVs get their UE lookup and self reference when added; re-inject
+        // the lookup in case handlers were replaced
+        uavs.ForEach([this](UAV& uav) {
+            uav.findUEHandler = [this](int ueId) { return this->findUE(ueId); };
+        });
          std::cout << "World: Entity linking complete." << std::endl;
     }
+
+private:
+    // One logical process of runCellSimulation
+    struct CellPartition {
+        gNB* gnb = nullptr;
+        Position position{}; // Cached; gNBs do not move during a run
+        std::vector<UAV*> uavs;
+        std::vector<UE*> ues; // Sorted by ID
+        uint64_t reassociations = 0; // UEs adopted from other cells
+    };
+
+    struct CellRun {
+        std::vector<CellPartition> cells;
+        float tick = 0.1f;
+        float linkDelay = 0.01f;
+    };
+
+    static uint32_t nearestCell(const std::vector<CellPartition>& cells, const Position& pos) {
+        uint32_t best = 0;
+        uint64_t minDistSq = std::numeric_limits<uint64_t>::max();
+        for (uint32_t i = 0; i < cells.size(); ++i) {
+            int64_t dx = static_cast<int64_t>(cells[i].position.first) - pos.first;
+            int64_t dy = static_cast<int64_t>(cells[i].position.second) - pos.second;
+            uint64_t distSq = static_cast<uint64_t>(dx * dx + dy * dy);
+            if (distSq < minDistSq) {
+                minDistSq = distSq;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    // Periodic event of one cell; touches only entities owned by the cell
+    void tickCell(LogicalProcess& lp, CellRun& run) {
+        CellPartition& cell = run.cells[lp.GetID()];
+        for (UE* ue : cell.ues) ue->Update(run.tick);
+        for (UAV* uav : cell.uavs) uav->Update(run.tick);
+        cell.gnb->Update(run.tick);
+
+        size_t kept = 0;
+        for (UE* ue : cell.ues) {
+            uint32_t target = nearestCell(run.cells, ue->GetPosition());
+            if (target == lp.GetID()) {
+                cell.ues[kept++] = ue;
+                continue;
+            }
+            // Ownership moves with the message; nobody updates the UE in flight
+            lp.Send(target, run.linkDelay, [&run, ue](LogicalProcess& dst) {
+                CellPartition& adopter = run.cells[dst.GetID()];
+                auto pos = std::lower_bound(adopter.ues.begin(), adopter.ues.end(), ue,
+                    [](const UE* a, const UE* b) { return a->GetID() < b->GetID(); });
+                adopter.ues.insert(pos, ue);
+                adopter.reassociations++;
+            });
+        }
+        cell.ues.resize(kept);
+        lp.Schedule(run.tick, [this, &run](LogicalProcess& next) { tickCell(next, run); });
+    }
+
+    // An attached mobility trace and the entities it drives
+    struct TracePlayback {
+        std::string path;
+        std::unique_ptr<MobilityTrace> trace;
+        std::vector<EntityHandle> handles; // Per trace entity; re-resolved by ID when stale
+        double elapsed = 0.0;              // Since the current frame
+        bool finished = false;
+    };
+
+    // Entity `i` of the trace, or null if no entity has its ID. A newly
+    // resolved entity stops moving on its own.
+    Entity* tracedEntity(TracePlayback& playback, size_t i) {
+        bool isUE = playback.trace->GetKind() == MobilityTrace::EntityKind::UE;
+        EntityHandle& handle = playback.handles[i];
+        Entity* entity = isUE ? static_cast<Entity*>(ues.Get(handle)) : uavs.Get(handle);
+        if (entity) return entity;
+
+        auto& index = isUE ? m_UEIndex : m_UAVIndex;
+        auto it = index.find(playback.trace->GetIDs()[i]);
+        if (it == index.end()) return nullptr;
+        handle = it->second;
+        entity = isUE ? static_cast<Entity*>(ues.Get(handle)) : uavs.Get(handle);
+        if (entity) entity->SetVelocity(0, 0);
+        return entity;
+    }
+
+    void applyMobilityTrace(TracePlayback& playback) {
+        std::span<const Position> positions = playback.trace->Positions();
+        for (size_t i = 0; i < positions.size(); ++i) {
+            if (Entity* entity = tracedEntity(playback, i)) {
+                entity->SetPosition(positions[i].first, positions[i].second);
+            }
+        }
+        if (playback.trace->GetKind() == MobilityTrace::EntityKind::UAV) m_UAVGridDirty = true;
+    }
+
+    // Only the newest frame is written to the entities; frames skipped by a
+    // long deltaTime are still decoded, since each is a delta on the last
+    void advanceMobilityTraces(float deltaTime) {
+        for (TracePlayback& playback : m_Traces) {
+            if (playback.finished) continue;
+            const double tick = playback.trace->GetTickSeconds();
+            playback.elapsed += deltaTime;
+            bool moved = false;
+            while (playback.elapsed >= tick) {
+                playback.elapsed -= tick;
+                if (!playback.trace->Advance()) {
+                    playback.finished = true;
+                    std::cout << "World: Mobility trace " << playback.path << " ended at tick "
+                              << playback.trace->GetTick() << std::endl;
+                    break;
+                }
+                moved = true;
+            }
+            if (moved) applyMobilityTrace(playback);
+        }
+    }
+
+    struct PendingHandover {
+        uint32_t ueId;
+        double queuedAt; // Simulated time
+    };
+
+    struct ScannedUE {
+        EntityHandle handle;
+        Position pos;
+        double at = 0.0; // Simulated time
+    };
+
+    struct HandoverState {
+        bool enabled = false;
+        HandoverPolicy policy;
+        HandoverStats stats;
+        SpatialGrid grid;
+        std::vector<UAV*> candidates;   // Grid item -> authenticated UAV
+        // Position at the last scan, per UE pool slot; the handle tells a
+        // reused slot from the UE that was scanned
+        std::vector<ScannedUE> scanned;
+        std::unordered_map<uint32_t, uint32_t> predicted; // UE ID -> UAV ID sent a hint
+        std::map<uint32_t, std::deque<PendingHandover>> pending; // By target UAV ID
+        std::unordered_set<uint32_t> queuedUEs;
+        uint32_t lastTarget = 0;        // Dispatch resumes after this target
+        double now = 0.0;
+        double sinceScan = 0.0;
+        double tokens = 0.0;
+    };
+
+    void runHandovers(float deltaTime) {
+        HandoverState& state = m_Handover;
+        state.now += deltaTime;
+        state.stats.simSeconds += deltaTime;
+        state.sinceScan += deltaTime;
+        state.tokens = std::min(state.tokens + state.policy.maxPerSecond * deltaTime, static_cast<double>(state.policy.burst));
+        if (state.sinceScan >= state.policy.checkInterval) {
+            state.sinceScan = 0.0;
+            scanForHandovers();
+        }
+        dispatchHandovers();
+    }
+
+    void scanForHandovers() {
+        HandoverState& state = m_Handover;
+        state.stats.scans++;
+        state.grid.Clear();
+        state.candidates.clear();
+        uavs.ForEach([&](UAV& uav) {
+            if (!uav.IsOperational() || !uav.IsAuthenticatedWithGNB()) return;
+            state.grid.Insert(static_cast<uint32_t>(state.candidates.size()), uav.GetPosition());
+            state.candidates.push_back(&uav);
+        });
+        if (state.candidates.empty()) return;
+
+        const uint64_t moveSq = uint64_t(state.policy.moveThreshold) * state.policy.moveThreshold;
+        ues.ForEach([&](UE& ue) {
+            EntityHandle handle = ue.SelfRef().Handle();
+            if (state.scanned.size() <= handle.Index()) state.scanned.resize(handle.Index() + 1);
+            ScannedUE& scanned = state.scanned[handle.Index()];
+            Position pos = ue.GetPosition();
+            bool known = scanned.handle.value == handle.value;
+            if (known && SpatialGrid::DistanceSq(pos, scanned.pos) < moveSq) return;
+            // Velocity from the displacement since the last scan, which also
+            // covers UEs moved by a mobility trace
+            double elapsed = state.now - scanned.at;
+            double vx = known && elapsed > 0.0 ? (double(pos.first) - scanned.pos.first) / elapsed : 0.0;
+            double vy = known && elapsed > 0.0 ? (double(pos.second) - scanned.pos.second) / elapsed : 0.0;
+            // UEs not evaluated now keep their reference position, so the
+            // move is still seen once they can be handed over
+            if (ue.GetState() != UEState::Connected || ue.GetServingUAVId() < 0) return;
+            if (state.queuedUEs.count(ue.GetID())) return;
+            scanned = { handle, pos, state.now };
+            state.stats.evaluated++;
+
+            std::optional<uint32_t> nearest = state.grid.Nearest(pos);
+            UAV* target = state.candidates[*nearest];
+            bool handover = static_cast<int>(target->GetID()) != ue.GetServingUAVId();
+            UAV* serving = findUAV(ue.GetServingUAVId());
+            if (handover && serving) {
+                double servingDist = std::sqrt(static_cast<double>(SpatialGrid::DistanceSq(pos, serving->GetPosition())));
+                double targetDist = std::sqrt(static_cast<double>(SpatialGrid::DistanceSq(pos, target->GetPosition())));
+                handover = servingDist - targetDist > state.policy.hysteresis;
+            }
+            if (!handover) {
+                if (state.policy.predictLookahead > 0.0 && (vx != 0.0 || vy != 0.0)) predictHandover(ue, pos, vx, vy);
+                return;
+            }
+            state.pending[target->GetID()].push_back({ ue.GetID(), state.now });
+            state.queuedUEs.insert(ue.GetID());
+            state.stats.queued++;
+        });
+    }
+
+    // Hint the UAV nearest to where `ue` will be after the lookahead, once
+    // per predicted target
+    void predictHandover(UE& ue, const Position& pos, double vx, double vy) {
+        HandoverState& state = m_Handover;
+        constexpr double maxCoord = std::numeric_limits<uint32_t>::max();
+        Position ahead{
+            static_cast<uint32_t>(std::clamp(pos.first + vx * state.policy.predictLookahead, 0.0, maxCoord)),
+            static_cast<uint32_t>(std::clamp(pos.second + vy * state.policy.predictLookahead, 0.0, maxCoord)) };
+        std::optional<uint32_t> nearest = state.grid.Nearest(ahead);
+        UAV* target = state.candidates[*nearest];
+        if (static_cast<int>(target->GetID()) == ue.GetServingUAVId()) return;
+        auto it = state.predicted.find(ue.GetID());
+        if (it != state.predicted.end() && it->second == target->GetID()) return;
+        std::optional<HandoverHint> hint = ue.BuildHandoverHint();
+        if (!hint) return;
+        if (it != state.predicted.end()) {
+            it->second = target->GetID();
+            state.stats.overwritten++;
+        } else {
+            state.predicted.emplace(ue.GetID(), target->GetID());
+        }
+        target->PrepareHandover(*hint);
+        state.stats.hintsSent++;
+    }
+
+    // Round-robin over target UAVs, at most batchSize each, while tokens last
+    void dispatchHandovers() {
+        HandoverState& state = m_Handover;
+        while (state.tokens >= 1.0 && !state.pending.empty()) {
+            auto it = state.pending.upper_bound(state.lastTarget);
+            if (it == state.pending.end()) it = state.pending.begin();
+            state.lastTarget = it->first;
+            UAV* target = findUAV(static_cast<int>(it->first));
+            std::deque<PendingHandover>& queue = it->second;
+
+            const size_t batch = std::max<size_t>(state.policy.batchSize, 1);
+            for (size_t sent = 0; sent < batch && state.tokens >= 1.0 && !queue.empty(); ) {
+                PendingHandover next = queue.front();
+                queue.pop_front();
+                state.queuedUEs.erase(next.ueId);
+                UE* ue = findUE(static_cast<int>(next.ueId));
+                bool valid = ue && target && target->IsOperational() && target->IsAuthenticatedWithGNB()
+                    && ue->GetState() == UEState::Connected && ue->GetServingUAVId() != static_cast<int>(target->GetID());
+                if (!valid) {
+                    state.stats.dropped++;
+                    continue;
+                }
+                state.tokens -= 1.0;
+                sent++;
+                state.stats.started++;
+                state.stats.queueDelayS.push_back(state.now - next.queuedAt);
+
+                if (auto predicted = state.predicted.find(next.ueId); predicted != state.predicted.end()) {
+                    if (predicted->second == target->GetID()) state.stats.predictedHits++;
+                    else state.stats.mispredicted++;
+                    state.predicted.erase(predicted);
+                }
+
+                // An earlier, overwritten hint may still have prepared the target
+                const uint64_t usedBefore = target->GetHandoverPrepStats().used;
+                auto begin = std::chrono::steady_clock::now();
+                ue->InitiateHandoverAuthentication(*target);
+                double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+                state.stats.protocolUs.push_back(us);
+                if (state.policy.predictLookahead > 0.0) {
+                    bool prepared = target->GetHandoverPrepStats().used != usedBefore;
+                    (prepared ? state.stats.preparedUs : state.stats.unpreparedUs).push_back(us);
+                }
+                if (ue->GetServingUAVId() == static_cast<int>(target->GetID())) state.stats.succeeded++;
+                else state.stats.failed++;
+            }
+            if (queue.empty()) state.pending.erase(it);
+        }
+    }
+
+    UE* createUE(uint32_t id, uint32_t x, uint32_t y, std::string_view longTermKey) {
+        EntityHandle handle = ues.Create(x, y, 0, 0, id, longTermKey);
+        UE* ue = ues.Get(handle);
+        ue->SetSelfRef({ &ues, handle });
+        m_UEIndex[id] = handle;
+        return ue;
+    }
+
+    static std::string defaultSUPI(uint32_t ueId) { return "SUPI_UE" + std::to_string(ueId); }
+    static std::string uavPartitionKey(uint32_t uavId) { return "UAV" + std::to_string(uavId); }
+
+    void provisionUE(UE& ue, gNB& gnb, const std::shared_ptr<const Kyber::NetworkParams>& network) {
+        std::string supi = defaultSUPI(ue.GetID());
+        std::string key(ue.GetLongTermKey());
+
+        gnb.ProvisionUEKey(supi, key);
+        ue.SetAuthenticationParameters(supi, key, network);
+        std::cout << "World: Provisioned UE " << ue.GetID() << " with SUPI " << supi << std::endl;
+    }
+
+    UAV* createUAV(uint32_t id, uint32_t x, uint32_t y) {
+        EntityHandle handle = uavs.Create(x, y, 0, 0, id);
+        UAV* uav = uavs.Get(handle);
+        uav->SetSelfRef({ &uavs, handle });
+        uav->findUEHandler = [this](int ueId) { return this->findUE(ueId); };
+        m_UAVIndex[id] = handle;
+        m_UAVGridDirty = true;
+        return uav;
+    }
+
+    gNB* createGNB(uint32_t id, uint32_t x, uint32_t y) {
+        EntityHandle handle = gnbs.Create(x, y, 0, 0, id);
+        gNB* gnb = gnbs.Get(handle);
+        gnb->SetSelfRef({ &gnbs, handle });
+        gnb->SetUAVSelectionPolicy(m_SelectionPolicy);
+        m_GNBIndex[id] = handle;
+        m_HashRingDirty = true;
+        return gnb;
+    }
+
+    // Home gNB of the entity with partition key `key` (its SUPI, or
+    // uavPartitionKey) at `pos`; null without gNBs
+    gNB* partitionGNB(std::string_view key, const Position& pos) {
+        if (m_Partitioning == HomePartitioning::Region) {
+            gNB* nearest = nullptr;
+            uint64_t bestDistSq = std::numeric_limits<uint64_t>::max();
+            gnbs.ForEach([&](gNB& gnb) {
+                uint64_t distSq = SpatialGrid::DistanceSq(gnb.GetPosition(), pos);
+                if (distSq < bestDistSq) {
+                    bestDistSq = distSq;
+                    nearest = &gnb;
+                }
+            });
+            return nearest;
+        }
+        if (m_HashRingDirty) rebuildHashRing();
+        if (m_HashRing.empty()) return nullptr;
+        // First ring point clockwise of the key
+        auto it = std::lower_bound(m_HashRing.begin(), m_HashRing.end(), std::make_pair(hashKey(key), uint32_t(0)));
+        if (it == m_HashRing.end()) it = m_HashRing.begin();
+        return findGNB(static_cast<int>(it->second));
+    }
+
+    static uint64_t hashKey(std::string_view key) {
+        uint64_t hash = 14695981039346656037ull; // FNV-1a
+        for (unsigned char c : key) hash = (hash ^ c) * 1099511628211ull;
+        // FNV leaves similar keys close together; finish with a mixer so
+        // they scatter around the ring
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    // Virtual nodes per gNB even out each gNB's share of the ring
+    void rebuildHashRing() {
+        constexpr uint32_t VirtualNodes = 64;
+        m_HashRing.clear();
+        gnbs.ForEach([&](gNB& gnb) {
+            for (uint32_t v = 0; v < VirtualNodes; ++v) {
+                m_HashRing.push_back({ hashKey("gNB" + std::to_string(gnb.GetID()) + "#" + std::to_string(v)), gnb.GetID() });
+            }
+        });
+        std::sort(m_HashRing.begin(), m_HashRing.end());
+        m_HashRingDirty = false;
+    }
+
+    std::unordered_map<uint32_t, EntityHandle> m_UEIndex;
+    std::unordered_map<uint32_t, EntityHandle> m_UAVIndex;
+    std::unordered_map<uint32_t, EntityHandle> m_GNBIndex;
+    std::vector<TracePlayback> m_Traces;
+    HandoverState m_Handover;
+    HomePartitioning m_Partitioning = HomePartitioning::Region;
+    std::vector<std::pair<uint64_t, uint32_t>> m_HashRing; // (point, gNB ID), sorted
+    bool m_HashRingDirty = true;
+
+    // selectServingUAV index over every UAV; eligibility is checked per query
+    void rebuildUAVGrid() {
+        m_UAVGrid.Clear();
+        m_UAVGridItems.clear();
+        uavs.ForEach([&](UAV& uav) {
+            m_UAVGrid.Insert(static_cast<uint32_t>(m_UAVGridItems.size()), uav.GetPosition());
+            m_UAVGridItems.push_back(uav.SelfRef());
+        });
+        m_UAVGridDirty = false;
+    }
+
+    UAVSelectionPolicy m_SelectionPolicy;
+    SpatialGrid m_UAVGrid;
+    std::vector<EntityRef<UAV>> m_UAVGridItems;
+    bool m_UAVGridDirty = true;
 };
@@ -2,15 +2,20 @@
 #include "UAV.h" // Include UAV to call its methods
 #include "UE.h"   // Include UE for context (though maybe just ID is needed)
 #include "KyberUtils.h"
+#include "PerfCounters.h"
+#include "AuthArena.h"
+#include "Snapshot.h"
+#include "AuthFlows.h"
 #include <iostream>
 #include <algorithm> // for std::equal
+#include <limits>
 #include <stdexcept>
 
-void gNB::RegisterUAV(std::shared_ptr<UAV> uav)
+void gNB::RegisterUAV(UAV& uav)
 {
-    m_RegisteredUAVs[uav->GetID()] = uav;
-    uav->SetAssociatedGNB(std::static_pointer_cast<gNB>(shared_from_this())); // Requires enabling shared_from_this
-    std::cout << "gNB " << m_Id << ": Registered UAV " << uav->GetID() << std::endl;
+    m_RegisteredUAVs[uav.GetID()] = uav.SelfRef();
+    uav.SetAssociatedGNB(SelfRef());
+    std::cout << "gNB " << m_Id << ": Registered UAV " << uav.GetID() << std::endl;
 }
 
 void gNB::SetupKyberParams() {
@@ -25,12 +30,19 @@ void gNB::SetupKyberParams() {
     m_Kyber_A = Kyber::GenerateA(m_Kyber_rho);
     auto As = Kyber::MatrixVecMul(m_Kyber_A, m_Kyber_sk);
     m_Kyber_pk = Kyber::PolyAdd(As, e);
+    m_NetworkParams = std::make_shared<const Kyber::NetworkParams>(
+        Kyber::NetworkParams{ m_AMF, m_Kyber_rho, m_Kyber_pk, m_Kyber_A, m_ServingNetworkName });
     std::cout << "gNB " << m_Id << ": Kyber parameters generated." << std::endl;
 }
 
 void gNB::ProvisionUEKey(const std::string& supi, const std::string& key) {
-    m_UEKeys[supi] = key;
-    m_UESequenceNumbers[supi] = 0;
+    auto it = m_UEKeys.find(supi);
+    if (it == m_UEKeys.end()) {
+        m_UEKeys.emplace(supi, ProvisionedUE{ key, m_SQNs.AddRows(1) });
+    } else {
+        it->second.key = key;
+        m_SQNs.ResetRow(it->second.sqnRow);
+    }
     std::cout << "gNB " << m_Id << ": Provisioned key for SUPI " << supi << std::endl;
 }
 
@@ -39,11 +51,77 @@ void gNB::ProvisionUAVKey(int uavId, const std::string& key) {
     m_UAVKeys[uavId] = key;
 }
 
+void gNB::AttachSubscriberTable(std::shared_ptr<const SubscriberTable> table) {
+    m_Subscribers = std::move(table);
+    m_SubscriberSQNBase = m_SQNs.AddRows(m_Subscribers ? m_Subscribers->Size() : 0);
+    std::cout << "gNB " << m_Id << ": Attached subscriber table with "
+              << (m_Subscribers ? m_Subscribers->Size() : 0) << " entries" << std::endl;
+}
+
+void gNB::ReleaseUE(int ueId, const std::string& supi) {
+    m_OngoingUEAuths.erase(ueId);
+    m_ResumptionCache.erase(ueId);
+    DropUESession(ueId);
+    if (std::optional<SubscriberRecord> subscriber = FindSubscriber(supi)) m_SQNs.ResetRow(subscriber->sqnRow);
+}
+
+std::optional<gNB::SubscriberRecord> gNB::FindSubscriber(const std::string& supi) const {
+    auto it = m_UEKeys.find(supi);
+    if (it != m_UEKeys.end()) return SubscriberRecord{ it->second.key, it->second.sqnRow };
+    if (!m_Subscribers) return std::nullopt;
+    std::optional<size_t> index = m_Subscribers->FindIndex(supi);
+    if (!index) return std::nullopt;
+    return SubscriberRecord{ m_Subscribers->KeyAt(*index), m_SubscriberSQNBase + *index };
+}
+
+std::optional<std::string_view> gNB::FindUEKey(const std::string& supi) const {
+    std::optional<SubscriberRecord> subscriber = FindSubscriber(supi);
+    if (!subscriber) return std::nullopt;
+    return subscriber->key;
+}
+
 void gNB::GenerateGroupKey() {
     m_GKUAV = GenerateRandomBytesUtil(32); // Example 32-byte group key
+    m_GroupKeys.SetGroupKey(m_GKUAV);
     std::cout << "gNB " << m_Id << ": Generated new Group Key GKUAV (size=" << m_GKUAV.size() << ")" << std::endl;
 }
 
+void gNB::Update(float deltaTime)
+{
+    Entity::Update(deltaTime);
+    ExpireAuthState();
+}
+
+void gNB::ExpireAuthState()
+{
+    m_ExpiryWheel.Advance(AuthStateNowTick(), [this](int uavId, uint64_t expiryTick) {
+        auto it = m_OngoingUAVAuths.find(uavId);
+        if (it == m_OngoingUAVAuths.end() || it->second.expiryTick != expiryTick) return;
+        m_OngoingUAVAuths.erase(it);
+        auto state_it = m_UAVAuthStates.find(uavId);
+        if (state_it != m_UAVAuthStates.end()) state_it->second.Fire(GNBUAVAuthEvent::Timeout, *this, uavId);
+        m_AuthStats.expiredPending++;
+        std::cout << "gNB " << m_Id << ": Pending Phase A auth for UAV " << uavId << " expired." << std::endl;
+    });
+    TrimResumptionCache();
+}
+
+void GNBUAVAuthTraits::DropUAVKeys(gNB& gnb, int uavId)
+{
+    gnb.m_GroupKeys.Leave(uavId);
+    gnb.m_UAV_KRANj.erase(uavId);
+    auto it = gnb.m_UAV_TIDj.find(uavId);
+    if (it == gnb.m_UAV_TIDj.end()) return;
+    gnb.m_UAVByTID.erase(it->second);
+    gnb.m_UAV_TIDj.erase(it);
+}
+
+bool gNB::IsUAVAuthorized(int uavId) const
+{
+    auto it = m_UAVAuthStates.find(uavId);
+    return it != m_UAVAuthStates.end() && it->second.Is(GNBUAVAuthState::Authorized);
+}
+
 void gNB::HandleSyncFailure(const std::string& supi, const std::vector<uint8_t>& rand_prime, uint64_t sqn_hn, UAV& uav, int ueId)
 {
 }
@@ -53,107 +131,256 @@ void gNB::HandleMacFailure(UAV& uav, int ueId)
 }
 
 void gNB::InitiateUAVServiceAccessAuth(int uavId) {
-    std::cout << "gNB " << m_Id << ": Initiating Service Access Auth for UAV " << uavId << std::endl;
-    auto uav_it = m_RegisteredUAVs.find(uavId);
-    if (uav_it == m_RegisteredUAVs.end() || uav_it->second.expired()) {
-        std::cerr << "gNB " << m_Id << ": Cannot initiate auth. UAV " << uavId << " not registered or expired." << std::endl;
+    Kyber::AuthTransaction txn; // Phase A chain: gNB -> UAV -> gNB
+    std::optional<UAVAuthChallenge> challenge = BuildUAVServiceAccessChallenge(uavId);
+    if (!challenge) {
         return;
     }
-    auto uav = uav_it->second.lock();
-     if (!uav) {
-          std::cerr << "gNB " << m_Id << ": Cannot initiate auth. UAV " << uavId << " pointer invalid." << std::endl;
-          return;
-     }
+    auto uav_it = m_RegisteredUAVs.find(uavId);
+    if (UAV* uav = uav_it != m_RegisteredUAVs.end() ? uav_it->second.Get() : nullptr) {
+        // Pass RAND' so UAV can perform its calculations
+        uav->ReceiveServiceAccessAuthParams(challenge->hres_star_j, challenge->cj, challenge->rand_prime);
+    }
+}
 
-    // Retrieve UAV's long-term key Kj
-    if (m_UAVKeys.find(uavId) == m_UAVKeys.end()) {
-        std::cerr << "gNB " << m_Id << ": Error - Long term key Kj not found for UAV " << uavId << "." << std::endl;
-        return;
+std::optional<UAVAuthChallenge> gNB::BuildUAVServiceAccessChallenge(int uavId) {
+    PERF_SCOPE("gNB::InitiateUAVServiceAccessAuth");
+    Kyber::AuthTransaction txn;
+    std::cout << "gNB " << m_Id << ": Initiating Service Access Auth for UAV " << uavId << std::endl;
+    ExpireAuthState();
+    const std::string* uav_key_Kj = AdmitUAVChallenge(uavId);
+    if (!uav_key_Kj) {
+        return std::nullopt;
     }
-    const std::string& uav_key_Kj = m_UAVKeys[uavId];
     std::cout << "gNB " << m_Id << ": Retrieved key Kj for UAV " << uavId << "." << std::endl;
 
     // --- Start AKA Steps ---
     // Step 1 & 2 (Simplified gNB side): Generate RAND', derive keys
-    std::vector<uint8_t> rand_prime = GenerateRandomBytesUtil(32); // Generate fresh RAND'
+    std::vector<uint8_t> rand_prime = GenerateRandomBytesUtil(RandPrimeBytes); // Generate fresh RAND'
     std::cout << "gNB " << m_Id << ": Generated RAND' for UAV " << uavId << " (size=" << rand_prime.size() << ")" << std::endl;
+    if (m_GKUAV.empty()) {
+        GenerateGroupKey();
+    }
 
-    // Derive CKj, IKj, RESj from Kj and RAND'
-    std::vector<uint8_t> ckj = Kyber::f3K(uav_key_Kj, rand_prime);
-    std::vector<uint8_t> ikj = Kyber::f4K(uav_key_Kj, rand_prime);
-    std::vector<uint8_t> resj = Kyber::f2K(uav_key_Kj, rand_prime); // RESj
+    UAVAuthChallenge challenge = DeriveUAVServiceAccessChallenge(uavId, *uav_key_Kj, std::move(rand_prime));
+    const OngoingUAVAuthInfo& pending = m_OngoingUAVAuths[uavId];
     std::cout << "gNB " << m_Id << ": Derived CKj, IKj, RESj for UAV " << uavId << "." << std::endl;
+    std::cout << "gNB " << m_Id << ": Derived KRANj for UAV " << uavId << " (size=" << pending.kran_j.size() << ")" << std::endl;
+    std::cout << "gNB " << m_Id << ": Calculated RES*j for UAV " << uavId << " (size=" << pending.res_star_j.size() << ")" << std::endl;
+    std::cout << "gNB " << m_Id << ": Computed Cj for UAV " << uavId << " (size=" << challenge.cj.size() << ")" << std::endl;
+    std::cout << "gNB " << m_Id << ": Computed HRES*j for UAV " << uavId << " (size=" << challenge.hres_star_j.size() << ")" << std::endl;
 
-    // Derive KRANj = KDF(CKj || IKj, "KRAN") - "KRAN" is an example label
-    std::vector<uint8_t> kran_key = ckj;
-    kran_key.insert(kran_key.end(), ikj.begin(), ikj.end());
-    std::vector<uint8_t> kran_j = Kyber::KDF(kran_key, Kyber::StringToBytes("KRAN"));
-    m_UAV_KRANj[uavId] = kran_j; // Store KRANj
-    std::cout << "gNB " << m_Id << ": Derived KRANj for UAV " << uavId << " (size=" << kran_j.size() << ")" << std::endl;
-
-    // Step 3 (gNB side): Calculate RES*j = KDF(CKj || IKj, SNN || RAND' || RESj)
-    std::vector<uint8_t> res_star_input = Kyber::StringToBytes(m_ServingNetworkName);
-    res_star_input.insert(res_star_input.end(), rand_prime.begin(), rand_prime.end());
-    res_star_input.insert(res_star_input.end(), resj.begin(), resj.end());
-    std::vector<uint8_t> res_star_j = Kyber::KDF(kran_key, res_star_input); // Using CK||IK as key
-    std::cout << "gNB " << m_Id << ": Calculated RES*j for UAV " << uavId << " (size=" << res_star_j.size() << ")" << std::endl;
-
-    // --- End AKA Steps ---
+    // Send (HRES*j, Cj, RAND') to UAV
+    std::cout << "gNB " << m_Id << ": Sending (HRES*j, Cj, RAND') to UAV " << uavId << std::endl;
+    return challenge;
+}
 
-    // Step 4: Generate TIDj, compute Cj, HRES*j
+std::vector<std::optional<UAVAuthChallenge>> gNB::BuildUAVServiceAccessChallenges(std::span<const int> uavIds) {
+    PERF_SCOPE("gNB::BuildUAVServiceAccessChallenges");
+    std::vector<std::optional<UAVAuthChallenge>> challenges(uavIds.size());
+    ExpireAuthState();
     if (m_GKUAV.empty()) {
         GenerateGroupKey();
     }
 
-    std::string tid_j = Kyber::GenerateTID("TID_UAV_" + std::to_string(uavId));
-    m_UAV_TIDj[uavId] = tid_j; // Store TIDj
+    // Every RAND' is a slice of one draw
+    std::vector<uint8_t> rands = GenerateRandomBytesUtil(uavIds.size() * RandPrimeBytes);
+    size_t issued = 0;
+    for (size_t i = 0; i < uavIds.size(); ++i) {
+        const std::string* uav_key_Kj = AdmitUAVChallenge(uavIds[i]);
+        if (!uav_key_Kj) continue;
+        Kyber::AuthTransaction txn; // Scratch of one UAV, so the arena stays small
+        auto rand_prime = rands.begin() + i * RandPrimeBytes;
+        challenges[i] = DeriveUAVServiceAccessChallenge(uavIds[i], *uav_key_Kj, std::vector<uint8_t>(rand_prime, rand_prime + RandPrimeBytes));
+        issued++;
+    }
+    std::cout << "gNB " << m_Id << ": Sent Phase A challenges to " << issued << "/" << uavIds.size() << " UAVs." << std::endl;
+    return challenges;
+}
 
-    // Compute Cj = E_KRANj(TIDj || GKUAV)
-    std::vector<uint8_t> tidj_bytes = Kyber::StringToBytes(tid_j);
-    std::vector<uint8_t> cj_plaintext = tidj_bytes;
-    cj_plaintext.insert(cj_plaintext.end(), m_GKUAV.begin(), m_GKUAV.end());
-    std::vector<uint8_t> cj = Kyber::EncryptSymmetric(kran_j, cj_plaintext);
-    std::cout << "gNB " << m_Id << ": Computed Cj for UAV " << uavId << " (size=" << cj.size() << ")" << std::endl;
+const std::string* gNB::AdmitUAVChallenge(int uavId) {
+    auto uav_it = m_RegisteredUAVs.find(uavId);
+    if (uav_it == m_RegisteredUAVs.end() || uav_it->second.Expired()) {
+        std::cerr << "gNB " << m_Id << ": Cannot initiate auth. UAV " << uavId << " not registered or expired." << std::endl;
+        return nullptr;
+    }
+    if (!uav_it->second.Get()) {
+        std::cerr << "gNB " << m_Id << ": Cannot initiate auth. UAV " << uavId << " pointer invalid." << std::endl;
+        return nullptr;
+    }
 
-    // Compute HRES*j = KDF(KRANj, Cj || RES*j)
-    std::vector<uint8_t> hres_input = cj;
-    hres_input.insert(hres_input.end(), res_star_j.begin(), res_star_j.end());
-    std::vector<uint8_t> hres_star_j = Kyber::KDF(kran_j, hres_input);
-    std::cout << "gNB " << m_Id << ": Computed HRES*j for UAV " << uavId << " (size=" << hres_star_j.size() << ")" << std::endl;
+    // Retrieve UAV's long-term key Kj
+    auto key_it = m_UAVKeys.find(uavId);
+    if (key_it == m_UAVKeys.end()) {
+        std::cerr << "gNB " << m_Id << ": Error - Long term key Kj not found for UAV " << uavId << "." << std::endl;
+        return nullptr;
+    }
 
-    // Send (HRES*j, Cj, RAND') to UAV
-    std::cout << "gNB " << m_Id << ": Sending (HRES*j, Cj, RAND') to UAV " << uavId << std::endl;
-    // Pass RAND' so UAV can perform its calculations
-    uav->ReceiveServiceAccessAuthParams(hres_star_j, cj, rand_prime);
+    if (!m_OngoingUAVAuths.count(uavId) && m_OngoingUAVAuths.size() >= m_AuthLimits.maxPendingAuths) {
+        m_AuthStats.capacityRejects++;
+        std::cerr << "gNB " << m_Id << ": Pending UAV auth table full. Rejecting auth for UAV " << uavId << "." << std::endl;
+        return nullptr;
+    }
+    return &key_it->second;
+}
+
+UAVAuthChallenge gNB::DeriveUAVServiceAccessChallenge(int uavId, const std::string& uav_key_Kj, std::vector<uint8_t> rand_prime) {
+    std::pmr::memory_resource* arena = Kyber::AuthTransaction::Resource();
+
+    // Derive CKj, IKj, RESj from Kj and RAND'
+    Kyber::ArenaBytes ckj = Kyber::f3K(uav_key_Kj, rand_prime, arena);
+    Kyber::ArenaBytes ikj = Kyber::f4K(uav_key_Kj, rand_prime, arena);
+    Kyber::ArenaBytes resj = Kyber::f2K(uav_key_Kj, rand_prime, arena); // RESj
+
+    // Derive KRANj = KDF(CKj || IKj, "KRAN") - "KRAN" is an example label
+    Kyber::ArenaBytes kran_key = Kyber::ConcatBytes({ckj, ikj}, arena);
+    std::vector<uint8_t> kran_j = Kyber::KDF(kran_key, Kyber::StringToBytes("KRAN", arena));
+    m_UAV_KRANj[uavId] = kran_j; // Store KRANj
+
+    // Step 3 (gNB side): Calculate RES*j = KDF(CKj || IKj, SNN || RAND' || RESj)
+    Kyber::ArenaBytes snn = Kyber::StringToBytes(m_ServingNetworkName, arena);
+    std::vector<uint8_t> res_star_j = Kyber::KDF(kran_key, Kyber::ConcatBytes({snn, rand_prime, resj}, arena)); // Using CK||IK as key
+
+    // Step 4: Generate TIDj, compute Cj = E_KRANj(TIDj || GKUAV) and HRES*j = KDF(KRANj, Cj || RES*j)
+    Kyber::TID tid_j = Kyber::GenerateTID(Kyber::TIDKind::UAV, static_cast<uint32_t>(uavId));
+    AssignUAVTID(uavId, tid_j); // Store TIDj
+    std::vector<uint8_t> cj = Kyber::EncryptSymmetric(kran_j, Kyber::ConcatBytes({tid_j, m_GKUAV}, arena));
+    std::vector<uint8_t> hres_star_j = Kyber::KDF(kran_j, Kyber::ConcatBytes({cj, res_star_j}, arena));
+
+    // Track until the UAV confirms; reclaimed by the expiry wheel otherwise
+    uint64_t expiryTick = m_ExpiryWheel.CurrentTick() + AuthStateTicksFromMs(m_AuthLimits.pendingAuthTimeoutMs);
+    m_OngoingUAVAuths[uavId] = { std::move(res_star_j), std::move(kran_j), expiryTick };
+    m_ExpiryWheel.Schedule(uavId, expiryTick);
+    m_UAVAuthStates[uavId].Fire(GNBUAVAuthEvent::Challenge, *this, uavId);
+    return UAVAuthChallenge{ std::move(hres_star_j), std::move(cj), std::move(rand_prime) };
 }
 
 void gNB::ReceiveServiceAccessConfirmation(int uavId) {
+    if (!AcceptServiceAccessConfirmation(uavId)) {
+        return;
+    }
+    auto uav_it = m_RegisteredUAVs.find(uavId);
+    if (uav_it != m_RegisteredUAVs.end()) {
+        if(UAV* uav_sp = uav_it->second.Get()) {
+            uav_sp->BroadcastNotification();
+        }
+    }
+}
+
+bool gNB::AcceptServiceAccessConfirmation(int uavId) {
     std::cout << "gNB " << m_Id << ": Received Service Access Confirmation from UAV " << uavId << std::endl;
-    if (m_UAV_KRANj.count(uavId) && m_UAV_TIDj.count(uavId)) {
-        m_AuthorizedUAVs.insert(uavId);
+    if (AuthorizeUAV(uavId)) {
         std::cout << "gNB " << m_Id << ": UAV " << uavId << " successfully authenticated and authorized." << std::endl;
-        auto uav_it = m_RegisteredUAVs.find(uavId);
-        if (uav_it != m_RegisteredUAVs.end()) {
-            if(auto uav_sp = uav_it->second.lock()) {
-                uav_sp->BroadcastNotification();
-            }
+        return true;
+    }
+    std::cerr << "gNB " << m_Id << ": Received unexpected confirmation from UAV " << uavId << " (missing state)." << std::endl;
+    return false;
+}
+
+size_t gNB::AcceptServiceAccessConfirmations(std::span<const int> uavIds) {
+    PERF_SCOPE("gNB::AcceptServiceAccessConfirmations");
+    size_t authorized = 0;
+    for (int uavId : uavIds) {
+        if (AuthorizeUAV(uavId)) {
+            authorized++;
+        } else {
+            std::cerr << "gNB " << m_Id << ": Received unexpected confirmation from UAV " << uavId << " (missing state)." << std::endl;
         }
-    } else {
-        std::cerr << "gNB " << m_Id << ": Received unexpected confirmation from UAV " << uavId << " (missing state)." << std::endl;
     }
+    std::cout << "gNB " << m_Id << ": Authorized " << authorized << "/" << uavIds.size() << " UAVs of the batch." << std::endl;
+    return authorized;
+}
+
+bool gNB::AuthorizeUAV(int uavId) {
+    auto state_it = m_UAVAuthStates.find(uavId);
+    if (m_UAV_KRANj.count(uavId) && m_UAV_TIDj.count(uavId) && state_it != m_UAVAuthStates.end()
+        && state_it->second.Fire(GNBUAVAuthEvent::Confirm, *this, uavId)) {
+        m_OngoingUAVAuths.erase(uavId);
+        m_GroupKeys.Join(static_cast<uint32_t>(uavId), m_UAV_KRANj[uavId]); // Path keys come with the next rekey
+        return true;
+    }
+    return false;
+}
+
+// --- UAV Group Key ---
+
+void gNB::RevokeUAV(int uavId) {
+    auto state_it = m_UAVAuthStates.find(uavId);
+    if (state_it == m_UAVAuthStates.end() || !state_it->second.Fire(GNBUAVAuthEvent::Revoke, *this, uavId)) {
+        std::cerr << "gNB " << m_Id << ": Cannot revoke UAV " << uavId << ". It is not authenticated." << std::endl;
+        return;
+    }
+    m_OngoingUAVAuths.erase(uavId);
+    std::cout << "gNB " << m_Id << ": Revoked UAV " << uavId << "; it leaves the group key tree at the next rekey." << std::endl;
+}
+
+void gNB::RotateGroupKey() {
+    m_GroupKeys.Rotate();
+}
+
+GroupRekey gNB::RekeyUAVGroup() {
+    PERF_SCOPE("gNB::RekeyUAVGroup");
+    if (!m_GroupKeys.HasPendingChanges()) {
+        return {};
+    }
+    GroupRekey rekey = m_GroupKeys.Rekey();
+    m_GKUAV = m_GroupKeys.GroupKey();
+    std::cout << "gNB " << m_Id << ": Group rekey " << rekey.epoch << ": " << rekey.messages.size() << " wrapped keys for "
+              << m_GroupKeys.Size() << " UAVs (" << rekey.joined.size() << " joined)." << std::endl;
+    // Broadcast: every registered UAV hears it, members or not
+    for (auto& [uavId, uavRef] : m_RegisteredUAVs) {
+        if (UAV* uav = uavRef.Get()) {
+            uav->ApplyGroupRekey(rekey);
+        }
+    }
+    return rekey;
 }
 
 void gNB::ProcessUAVAssistedAuthRequest(const std::vector<uint8_t>& suci_bytes,
-                                        const std::string& tid_j,
+                                        const Kyber::TID& tid_j,
                                         UAV& originatingUAV,
                                         int ueId) {
-    std::cout << "gNB " << m_Id << ": Processing UAV-Assisted Auth Request for UE " << ueId << " via UAV " << originatingUAV.GetID() << " (TIDj=" << tid_j << ")" << std::endl;
+    UEAuthResponse response = AuthenticateUE(suci_bytes, tid_j, originatingUAV.GetID(), ueId);
+    switch (response.outcome) {
+    case UEAuthResponse::Outcome::Accepted:
+        originatingUAV.ReceiveUEAuthParams(ueId, response.hres_star_i, response.ci, response.tid_i, response.kuav_i);
+        break;
+    case UEAuthResponse::Outcome::MacFailure:
+        originatingUAV.SendMacFailureToUE(ueId);
+        break;
+    case UEAuthResponse::Outcome::SyncFailure:
+        originatingUAV.SendSyncFailureToUE(ueId, response.auts);
+        break;
+    case UEAuthResponse::Outcome::Rejected:
+        break;
+    }
+}
 
-    if (m_AuthorizedUAVs.find(originatingUAV.GetID()) == m_AuthorizedUAVs.end() || m_UAV_TIDj[originatingUAV.GetID()] != tid_j) {
-        std::cerr << "gNB " << m_Id << ": Auth request rejected. UAV " << originatingUAV.GetID() << " not authorized or TIDj mismatch." << std::endl;
-        return;
+UEAuthResponse gNB::AuthenticateUE(const std::vector<uint8_t>& suci_bytes,
+                                   const Kyber::TID& tid_j,
+                                   int uavId,
+                                   int ueId) {
+    PERF_SCOPE("gNB::ProcessUAVAssistedAuthRequest");
+    const auto start = std::chrono::steady_clock::now();
+    Kyber::AuthTransaction txn;
+    std::pmr::memory_resource* arena = Kyber::AuthTransaction::Resource();
+    UEAuthResponse response;
+    std::cout << "gNB " << m_Id << ": Processing UAV-Assisted Auth Request for UE " << ueId << " via UAV " << uavId << " (TIDj=" << tid_j << ")" << std::endl;
+
+    if (!IsUAVAuthorized(uavId) || FindUAVByTID(tid_j) != uavId) {
+        std::cerr << "gNB " << m_Id << ": Auth request rejected. UAV " << uavId << " not authorized or TIDj mismatch." << std::endl;
+        return response;
+    }
+    std::cout << "gNB " << m_Id << ": Originating UAV " << uavId << " is authorized." << std::endl;
+
+    ExpireAuthState();
+    if (!m_OngoingUEAuths.count(ueId) && m_OngoingUEAuths.size() >= m_AuthLimits.maxPendingAuths) {
+        m_AuthStats.capacityRejects++;
+        std::cerr << "gNB " << m_Id << ": Pending UE auth table full. Rejecting auth for UE " << ueId << "." << std::endl;
+        return response;
     }
-    std::cout << "gNB " << m_Id << ": Originating UAV " << originatingUAV.GetID() << " is authorized." << std::endl;
+    OngoingUEAuthInfo& pending = m_OngoingUEAuths[ueId];
+    pending.state.Fire(GNBUEAuthEvent::SuciReceived);
 
     std::string supi_prime;
     uint64_t sqn_ue_prime;
@@ -166,70 +393,252 @@ void gNB::ProcessUAVAssistedAuthRequest(const std::vector<uint8_t>& suci_bytes,
     bool ue_authorized = true; // Assume authorized if AKA passes basic checks
     if (!aka_step1_2_ok || !ue_authorized) {
         std::cerr << "gNB " << m_Id << ": UE " << ueId << " authentication failed or not authorized." << std::endl;
+        pending.state.Fire(GNBUEAuthEvent::AkaFailed);
+        m_OngoingUEAuths.erase(ueId);
         if (!mac_ok) {
-            std::cout << "gNB " << m_Id << ": Sending MAC Failure to UAV " << originatingUAV.GetID() << " for UE " << ueId << std::endl;
-            originatingUAV.SendMacFailureToUE(ueId);
+            std::cout << "gNB " << m_Id << ": Sending MAC Failure to UAV " << uavId << " for UE " << ueId << std::endl;
+            response.outcome = UEAuthResponse::Outcome::MacFailure;
         } else if (!sqn_ok) {
-            std::cout << "gNB " << m_Id << ": Sending Sync Failure (AUTS) to UAV " << originatingUAV.GetID() << " for UE " << ueId << std::endl;
-            originatingUAV.SendSyncFailureToUE(ueId, autn_or_auts);
+            std::cout << "gNB " << m_Id << ": Sending Sync Failure (AUTS) to UAV " << uavId << " for UE " << ueId << std::endl;
+            response.outcome = UEAuthResponse::Outcome::SyncFailure;
+            response.auts = std::move(autn_or_auts);
         }
-        return;
+        return response;
     }
     std::cout << "gNB " << m_Id << ": UE " << ueId << " (SUPI=" << supi_prime << ") passed initial AKA checks and is authorized." << std::endl;
-    m_UESequenceNumbers[supi_prime] = sqn_ue_prime;
-
-    std::string tid_i = Kyber::GenerateTID("TID_UE_" + std::to_string(ueId));
 
     std::vector<uint8_t> kran_i = DeriveKRAN(supi_prime, rand_prime);
     std::cout << "gNB " << m_Id << ": Derived KRANi for UE " << ueId << " (size=" << kran_i.size() << ")" << std::endl;
 
-    std::vector<uint8_t> tidi_bytes = Kyber::StringToBytes(tid_i);
-    std::vector<uint8_t> tidj_bytes = Kyber::StringToBytes(tid_j);
-    std::vector<uint8_t> kuavi_input = tidi_bytes;
-    kuavi_input.insert(kuavi_input.end(), tidj_bytes.begin(), tidj_bytes.end());
-    std::vector<uint8_t> kuav_i = Kyber::KDF(kran_i, kuavi_input);
-    std::cout << "gNB " << m_Id << ": Computed KUAVi for UE " << ueId << " (size=" << kuav_i.size() << ")" << std::endl;
+    IssueUESession(ueId, tid_j, kran_i, response);
+
+    std::string_view K = FindUEKey(supi_prime).value_or(std::string_view());
+    Kyber::ArenaBytes res_i = Kyber::f2K(K, rand_prime, arena);
+    Kyber::ArenaBytes ck = Kyber::f3K(K, rand_prime, arena);
+    Kyber::ArenaBytes ik = Kyber::f4K(K, rand_prime, arena);
+    Kyber::ArenaBytes ck_ik = Kyber::ConcatBytes({ck, ik}, arena);
+    Kyber::ArenaBytes net_name_bytes = Kyber::StringToBytes(m_ServingNetworkName, arena);
+    Kyber::ArenaBytes res_star_input = Kyber::ConcatBytes({net_name_bytes, rand_prime, res_i}, arena);
+    for(size_t i=0; i<res_star_input.size() && i<ck_ik.size(); ++i) res_star_input[i] ^= ck_ik[i];
+    Kyber::ArenaBytes res_star_i = Kyber::KDF(res_star_input, arena);
+
+    Kyber::ArenaBytes hres_input = Kyber::ConcatBytes({response.ci, res_star_i}, arena);
+    response.hres_star_i = Kyber::KDF(kran_i, hres_input);
+    std::cout << "gNB " << m_Id << ": Computed HRES*i for UE " << ueId << " (size=" << response.hres_star_i.size() << ")" << std::endl;
+
+    // Nothing comes back from the UE in Phase B, so the entry is done
+    pending.state.Fire(GNBUEAuthEvent::AkaPassed);
+    m_OngoingUEAuths.erase(ueId);
+    RegisterUESession(ueId, response.tid_i, uavId);
+    CacheResumptionContext(ueId, response.tid_i, std::move(kran_i));
+
+    std::cout << "gNB " << m_Id << ": Sending UE Auth Params (HRES*i, Ci, TIDi, KUAVi) to UAV " << uavId << " for UE " << ueId << std::endl;
+    response.outcome = UEAuthResponse::Outcome::Accepted;
+    m_ResumptionStats.fullAuths++;
+    m_ResumptionStats.fullAuthTime += std::chrono::steady_clock::now() - start;
+    return response;
+}
+
+void gNB::IssueUESession(int ueId, const Kyber::TID& tid_j, const std::vector<uint8_t>& kran_i, UEAuthResponse& response) {
+    std::pmr::memory_resource* arena = Kyber::AuthTransaction::Resource();
+    response.tid_i = Kyber::GenerateTID(Kyber::TIDKind::UE, static_cast<uint32_t>(ueId));
+
+    Kyber::ByteView tidi_bytes = response.tid_i;
+    Kyber::ArenaBytes kuavi_input = Kyber::ConcatBytes({tidi_bytes, tid_j}, arena);
+    response.kuav_i = Kyber::KDF(kran_i, kuavi_input);
+    std::cout << "gNB " << m_Id << ": Computed KUAVi for UE " << ueId << " (size=" << response.kuav_i.size() << ")" << std::endl;
 
     Kyber::Timestamp tst = Kyber::GenerateTST(3600);
-    std::vector<uint8_t> tst_bytes = Kyber::TimestampToBytes(tst);
-    std::vector<uint8_t> tgki_input = tidi_bytes;
-    tgki_input.insert(tgki_input.end(), tst_bytes.begin(), tst_bytes.end());
-    std::vector<uint8_t> tgk_i = Kyber::KDF(m_GKUAV, tgki_input);
+    Kyber::ArenaBytes tst_bytes = Kyber::TimestampToBytes(tst, arena);
+    Kyber::ArenaBytes tgki_input = Kyber::ConcatBytes({tidi_bytes, tst_bytes}, arena);
+    Kyber::ArenaBytes tgk_i = Kyber::KDF(m_GKUAV, tgki_input, arena);
     std::cout << "gNB " << m_Id << ": Computed TGKi for UE " << ueId << " (size=" << tgk_i.size() << ")" << std::endl;
 
-    std::vector<uint8_t> token_i = tgk_i;
-    token_i.insert(token_i.end(), tst_bytes.begin(), tst_bytes.end());
+    Kyber::ArenaBytes token_i = Kyber::ConcatBytes({tgk_i, tst_bytes}, arena);
     std::cout << "gNB " << m_Id << ": Computed Tokeni for UE " << ueId << " (size=" << token_i.size() << ")" << std::endl;
 
-    std::vector<uint8_t> ci_plaintext = tidi_bytes;
-    ci_plaintext.insert(ci_plaintext.end(), token_i.begin(), token_i.end());
-    std::vector<uint8_t> ci = Kyber::EncryptSymmetric(kran_i, ci_plaintext);
-    std::cout << "gNB " << m_Id << ": Computed Ci for UE " << ueId << " (size=" << ci.size() << ")" << std::endl;
-
-    const std::string& K = m_UEKeys[supi_prime];
-    std::vector<uint8_t> res_i = Kyber::f2K(K, rand_prime);
-    std::vector<uint8_t> ck = Kyber::f3K(K, rand_prime);
-    std::vector<uint8_t> ik = Kyber::f4K(K, rand_prime);
-    std::vector<uint8_t> ck_ik = Kyber::ConcatBytes({ck, ik});
-    std::vector<uint8_t> net_name_bytes(m_ServingNetworkName.begin(), m_ServingNetworkName.end());
-    std::vector<uint8_t> res_star_input = Kyber::ConcatBytes({net_name_bytes, rand_prime, res_i});
-    for(size_t i=0; i<res_star_input.size() && i<ck_ik.size(); ++i) res_star_input[i] ^= ck_ik[i];
-    std::vector<uint8_t> res_star_i = Kyber::KDF(res_star_input);
+    Kyber::ArenaBytes ci_plaintext = Kyber::ConcatBytes({tidi_bytes, token_i}, arena);
+    response.ci = Kyber::EncryptSymmetric(kran_i, ci_plaintext);
+    std::cout << "gNB " << m_Id << ": Computed Ci for UE " << ueId << " (size=" << response.ci.size() << ")" << std::endl;
+}
+
+// --- Fast Re-authentication ---
+
+void gNB::ProcessResumeRequest(const ResumeRequest& request, const Kyber::TID& tid_j, UAV& originatingUAV, int ueId) {
+    UEAuthResponse response = ResumeUE(request, tid_j, originatingUAV.GetID(), ueId);
+    if (response.outcome == UEAuthResponse::Outcome::Accepted) {
+        originatingUAV.ReceiveUEAuthParams(ueId, response.hres_star_i, response.ci, response.tid_i, response.kuav_i);
+    }
+}
+
+UEAuthResponse gNB::ResumeUE(const ResumeRequest& request, const Kyber::TID& tid_j, int uavId, int ueId) {
+    PERF_SCOPE("gNB::ResumeUE");
+    const auto start = std::chrono::steady_clock::now();
+    Kyber::AuthTransaction txn;
+    UEAuthResponse response;
+    std::cout << "gNB " << m_Id << ": Processing resumption request for UE " << ueId << " via UAV " << uavId << " (TIDi=" << request.tid_i << ")" << std::endl;
+
+    if (!IsUAVAuthorized(uavId) || FindUAVByTID(tid_j) != uavId) {
+        std::cerr << "gNB " << m_Id << ": Resumption rejected. UAV " << uavId << " not authorized or TIDj mismatch." << std::endl;
+        return response;
+    }
+
+    ExpireAuthState();
+    auto it = m_ResumptionCache.find(ueId);
+    if (it == m_ResumptionCache.end() || it->second.tid_i != request.tid_i) {
+        m_ResumptionStats.misses++;
+        std::cout << "gNB " << m_Id << ": No cached context for UE " << ueId << "; full authentication required." << std::endl;
+        return response;
+    }
+    // A forged or replayed request leaves the cached context usable
+    ResumptionContext& cached = it->second;
+    if (request.counter <= cached.counter
+        || !Kyber::BytesEqual(Kyber::ResumeRequestMAC(cached.kran_i, request.tid_i, request.counter), request.mac)) {
+        m_ResumptionStats.rejected++;
+        std::cerr << "gNB " << m_Id << ": Resumption rejected for UE " << ueId << ". MAC or counter check failed." << std::endl;
+        return response;
+    }
 
-    std::vector<uint8_t> hres_input = ci;
-    hres_input.insert(hres_input.end(), res_star_i.begin(), res_star_i.end());
-    std::vector<uint8_t> hres_star_i = Kyber::KDF(kran_i, hres_input);
-    std::cout << "gNB " << m_Id << ": Computed HRES*i for UE " << ueId << " (size=" << hres_star_i.size() << ")" << std::endl;
+    // Next KRANi, bound to this counter; the old TIDi and KRANi are retired
+    std::vector<uint8_t> kran_i = Kyber::ResumeKRAN(cached.kran_i, request.tid_i, request.counter);
+    m_ResumptionCache.erase(it);
+    IssueUESession(ueId, tid_j, kran_i, response);
+    response.hres_star_i = Kyber::KDF(kran_i, response.ci);
+    RegisterUESession(ueId, response.tid_i, uavId);
+    CacheResumptionContext(ueId, response.tid_i, std::move(kran_i));
 
-    std::cout << "gNB " << m_Id << ": Sending UE Auth Params (HRES*i, Ci, TIDi, KUAVi) to UAV " << originatingUAV.GetID() << " for UE " << ueId << std::endl;
-    originatingUAV.ReceiveUEAuthParams(ueId, hres_star_i, ci, tid_i, kuav_i);
+    std::cout << "gNB " << m_Id << ": Resumed UE " << ueId << "; sending (HRES*i, Ci, TIDi, KUAVi) to UAV " << uavId << std::endl;
+    response.outcome = UEAuthResponse::Outcome::Accepted;
+    m_ResumptionStats.hits++;
+    m_ResumptionStats.resumeTime += std::chrono::steady_clock::now() - start;
+    return response;
 }
 
-void gNB::ReceiveHandoverInform(const std::string& tid_star_j, const std::string& tid_i) {
+void gNB::SetResumptionLimits(const ResumptionLimits& limits) {
+    m_ResumptionLimits = limits;
+    TrimResumptionCache();
+}
+
+void gNB::CacheResumptionContext(int ueId, const Kyber::TID& tid_i, std::vector<uint8_t> kran_i) {
+    if (m_ResumptionLimits.maxEntries == 0) return;
+    uint64_t expiryTick = m_ExpiryWheel.CurrentTick() + AuthStateTicksFromMs(m_ResumptionLimits.lifetimeMs);
+    m_ResumptionCache[ueId] = { tid_i, std::move(kran_i), 0, expiryTick };
+    m_ResumptionOrder.emplace_back(ueId, expiryTick);
+    TrimResumptionCache();
+}
+
+void gNB::TrimResumptionCache() {
+    const uint64_t now = m_ExpiryWheel.CurrentTick();
+    while (!m_ResumptionOrder.empty()) {
+        auto [ueId, expiryTick] = m_ResumptionOrder.front();
+        auto it = m_ResumptionCache.find(ueId);
+        bool live = it != m_ResumptionCache.end() && it->second.expiryTick == expiryTick;
+        if (live && expiryTick > now && m_ResumptionCache.size() <= m_ResumptionLimits.maxEntries) break;
+        m_ResumptionOrder.pop_front();
+        if (!live) continue;
+        m_ResumptionCache.erase(it);
+        if (expiryTick <= now) m_ResumptionStats.expired++;
+        else m_ResumptionStats.evicted++;
+    }
+}
+
+void gNB::ReceiveHandoverInform(const Kyber::TID& tid_star_j, const Kyber::TID& tid_i) {
     std::cout << "gNB " << m_Id << ": Received Handover Inform message." << std::endl;
     std::cout << "   Target UAV TID*: " << tid_star_j << std::endl;
     std::cout << "   UE TID: " << tid_i << std::endl;
-    std::cout << "gNB " << m_Id << ": Noted successful handover." << std::endl;
+    auto uav_it = m_UAVByTID.find(tid_star_j);
+    auto session_it = m_UESessions.find(tid_i);
+    if (uav_it == m_UAVByTID.end() || session_it == m_UESessions.end()) {
+        std::cerr << "gNB " << m_Id << ": Handover inform names an unknown TID; ignored." << std::endl;
+        return;
+    }
+    session_it->second.servingUavId = uav_it->second;
+    std::cout << "gNB " << m_Id << ": Noted successful handover of UE " << session_it->second.ueId << " to UAV " << uav_it->second << "." << std::endl;
+}
+
+// --- Temporary Identities ---
+
+std::optional<gNB::UESession> gNB::FindUESession(const Kyber::TID& tid_i) const {
+    auto it = m_UESessions.find(tid_i);
+    if (it == m_UESessions.end()) return std::nullopt;
+    return it->second;
+}
+
+std::optional<int> gNB::FindUAVByTID(const Kyber::TID& tid_j) const {
+    auto it = m_UAVByTID.find(tid_j);
+    if (it == m_UAVByTID.end()) return std::nullopt;
+    return it->second;
+}
+
+void gNB::AssignUAVTID(int uavId, const Kyber::TID& tid_j) {
+    auto [it, inserted] = m_UAV_TIDj.try_emplace(uavId, tid_j);
+    if (!inserted) {
+        m_UAVByTID.erase(it->second);
+        it->second = tid_j;
+    }
+    m_UAVByTID[tid_j] = uavId;
+}
+
+void gNB::RegisterUESession(int ueId, const Kyber::TID& tid_i, int servingUavId) {
+    DropUESession(ueId);
+    m_UESessions[tid_i] = { ueId, servingUavId };
+    m_UESessionTIDs[ueId] = tid_i;
+}
+
+void gNB::DropUESession(int ueId) {
+    auto it = m_UESessionTIDs.find(ueId);
+    if (it == m_UESessionTIDs.end()) return;
+    m_UESessions.erase(it->second);
+    m_UESessionTIDs.erase(it);
+}
+
+// --- Inter-gNB Handover (Xn) ---
+
+std::optional<XnHandoverContext> gNB::PrepareXnHandover(int ueId, const XnHandoverRequest& request) {
+    PERF_SCOPE("gNB::PrepareXnHandover");
+    Kyber::AuthTransaction txn;
+    std::pmr::memory_resource* arena = Kyber::AuthTransaction::Resource();
+    std::cout << "gNB " << m_Id << " (Source): Received Xn handover request from UE " << ueId << " towards gNB " << request.targetGnbId << std::endl;
+
+    if (!Kyber::ValidateTST(request.tst)) {
+        m_XnStats.rejected++;
+        std::cerr << "gNB " << m_Id << ": Xn handover rejected for UE " << ueId << ". TST is invalid." << std::endl;
+        return std::nullopt;
+    }
+
+    // Recompute the TGKi this gNB issued: TGKi = KDF(GKUAV, TIDi || TST)
+    Kyber::ArenaBytes tgki_input = Kyber::ConcatBytes({request.tid_i, Kyber::TimestampToBytes(request.tst, arena)}, arena);
+    Kyber::ArenaBytes tgk_i = Kyber::KDF(m_GKUAV, tgki_input, arena);
+    if (!Kyber::BytesEqual(Kyber::XnRequestMAC(tgk_i, request.tid_i, request.targetGnbId), request.mac)) {
+        m_XnStats.rejected++;
+        std::cerr << "gNB " << m_Id << ": Xn handover rejected for UE " << ueId << ". MAC check failed." << std::endl;
+        return std::nullopt;
+    }
+
+    m_XnStats.prepared++;
+    std::cout << "gNB " << m_Id << ": Forwarding context (TIDi, TST, NH) for UE " << ueId << " to gNB " << request.targetGnbId << std::endl;
+    return XnHandoverContext{ request.tid_i, request.tst, Kyber::XnNextHopKey(tgk_i, request.tid_i, request.targetGnbId), m_Id };
+}
+
+std::optional<XnHandoverCommand> gNB::AcceptXnHandover(int ueId, const XnHandoverContext& context) {
+    PERF_SCOPE("gNB::AcceptXnHandover");
+    Kyber::AuthTransaction txn;
+    std::pmr::memory_resource* arena = Kyber::AuthTransaction::Resource();
+    std::cout << "gNB " << m_Id << " (Target): Received Xn context for UE " << ueId << " from gNB " << context.sourceGnbId << std::endl;
+
+    if (!Kyber::ValidateTST(context.tst) || context.nh.empty()) {
+        m_XnStats.rejected++;
+        std::cerr << "gNB " << m_Id << ": Xn context for UE " << ueId << " rejected." << std::endl;
+        return std::nullopt;
+    }
+
+    // Same token, this gNB's group key: its UAVs derive TGK'i from TIDi || TST as usual
+    Kyber::ArenaBytes tgki_input = Kyber::ConcatBytes({context.tid_i, Kyber::TimestampToBytes(context.tst, arena)}, arena);
+    Kyber::ArenaBytes tgk_i = Kyber::KDF(m_GKUAV, tgki_input, arena);
+    RegisterUESession(ueId, context.tid_i, -1); // Serving UAV known once Phase C informs
+    m_XnStats.accepted++;
+    std::cout << "gNB " << m_Id << ": Re-issued TGKi for UE " << ueId << std::endl;
+    return XnHandoverCommand{ m_Id, Kyber::EncryptSymmetric(context.nh, tgk_i) };
 }
 
 bool gNB::PerformStandardAKA_Step1_2(const std::vector<uint8_t>& suci_bytes,
@@ -238,6 +647,9 @@ bool gNB::PerformStandardAKA_Step1_2(const std::vector<uint8_t>& suci_bytes,
                                      std::vector<uint8_t>& out_autn_or_auts,
                                      bool& out_mac_ok, bool& out_sqn_ok)
 {
+    PERF_SCOPE("gNB::PerformStandardAKA_Step1_2");
+    Kyber::AuthTransaction txn;
+    std::pmr::memory_resource* arena = Kyber::AuthTransaction::Resource();
     std::cout << "gNB " << m_Id << ": Performing Standard AKA Steps 1 & 2..." << std::endl;
     out_mac_ok = false;
     out_sqn_ok = false;
@@ -249,55 +661,64 @@ bool gNB::PerformStandardAKA_Step1_2(const std::vector<uint8_t>& suci_bytes,
     size_t mac_size = 42;
     size_t c2_size = 18;
     size_t c1_size = suci_bytes.size() - c2_size - mac_size;
-    std::vector<uint8_t> c1_bytes(suci_bytes.begin(), suci_bytes.begin() + c1_size);
-    std::vector<uint8_t> c2_bytes(suci_bytes.begin() + c1_size, suci_bytes.begin() + c1_size + c2_size);
-    std::vector<uint8_t> mac_bytes(suci_bytes.begin() + c1_size + c2_size, suci_bytes.end());
+    Kyber::ByteView suci(suci_bytes);
+    Kyber::ByteView c1_bytes = suci.subspan(0, c1_size);
+    Kyber::ByteView c2_bytes = suci.subspan(c1_size, c2_size);
+    Kyber::ByteView mac_bytes = suci.subspan(c1_size + c2_size);
 
     std::cout << "gNB " << m_Id << ": Parsed SUCI (C1 size=" << c1_bytes.size() << ", C2 size=" << c2_bytes.size() << ", MAC size=" << mac_bytes.size() << ")" << std::endl;
 
     std::cout << "gNB " << m_Id << ": (Placeholder) Decrypting C1..." << std::endl;
-    out_rand_prime = Kyber::Compressq(Kyber::Polynomial(), 1);
+    // Placeholder: RAND' = Compress(v), v being the last third of C1
+    Kyber::ByteView v_bytes = c1_bytes.subspan(c1_bytes.size() * 2 / 3);
+    size_t rand_size = std::min(v_bytes.size(), Kyber::RandBytes);
+    out_rand_prime = Kyber::Compressq(Kyber::Polynomial(v_bytes.begin(), v_bytes.begin() + rand_size), 1);
     std::cout << "gNB " << m_Id << ": (Placeholder) Got RAND' (size=" << out_rand_prime.size() << ")" << std::endl;
 
-    std::vector<uint8_t> msk_prime = Kyber::KDF(out_rand_prime);
-    std::vector<uint8_t> decrypted_c2 = Kyber::DMSK(c2_bytes);
+    Kyber::ArenaBytes msk_prime = Kyber::KDF(out_rand_prime, arena);
+    Kyber::ArenaBytes decrypted_c2 = Kyber::DMSK(c2_bytes, arena);
     if (decrypted_c2.size() < 9) {
         std::cerr << "gNB " << m_Id << ": Error - Decrypted C2 too short!" << std::endl;
         return false;
     }
-    out_supi = Kyber::BytesToString(std::vector<uint8_t>(decrypted_c2.begin(), decrypted_c2.end() - 8));
-    std::vector<uint8_t> sqn_ue_prime_bytes(decrypted_c2.end() - 8, decrypted_c2.end());
+    Kyber::ByteView c2_plain(decrypted_c2);
+    out_supi = Kyber::BytesToString(c2_plain.first(c2_plain.size() - 8));
+    Kyber::ByteView sqn_ue_prime_bytes = c2_plain.last(8);
     out_sqn_ue = Kyber::BytesToU64(sqn_ue_prime_bytes);
     std::cout << "gNB " << m_Id << ": Decrypted C2. Got SUPI'=" << out_supi << ", SQN_UE'=" << out_sqn_ue << std::endl;
 
-    if (m_UEKeys.find(out_supi) == m_UEKeys.end()) {
+    std::optional<SubscriberRecord> subscriber = FindSubscriber(out_supi);
+    if (!subscriber) {
         std::cerr << "gNB " << m_Id << ": Error - SUPI' " << out_supi << " not found!" << std::endl;
         return false;
     }
-    const std::string& ue_key_K = m_UEKeys[out_supi];
+    std::string_view ue_key_K = subscriber->key;
     std::cout << "gNB " << m_Id << ": Found key K for SUPI' " << out_supi << "." << std::endl;
 
-    std::vector<uint8_t> xmac_input = Kyber::ConcatBytes({sqn_ue_prime_bytes, out_rand_prime, m_AMF});
-    std::vector<uint8_t> xmac = Kyber::f1K(ue_key_K, xmac_input);
+    Kyber::ArenaBytes xmac_input = Kyber::ConcatBytes({sqn_ue_prime_bytes, out_rand_prime, m_AMF}, arena);
+    Kyber::ArenaBytes xmac = Kyber::f1K(ue_key_K, xmac_input, arena);
     std::cout << "gNB " << m_Id << ": Calculated XMAC." << std::endl;
 
-    out_mac_ok = (xmac.size() == mac_bytes.size() && std::equal(xmac.begin(), xmac.end(), mac_bytes.begin()));
+    out_mac_ok = Kyber::BytesEqual(xmac, mac_bytes);
     if (!out_mac_ok) {
         std::cout << "gNB " << m_Id << ": MAC check failed." << std::endl;
         return false;
     }
     std::cout << "gNB " << m_Id << ": MAC check successful." << std::endl;
 
-    uint64_t last_sqn = m_UESequenceNumbers[out_supi];
-    out_sqn_ok = (out_sqn_ue > last_sqn);
+    // Fresh if it beats the last SQN accepted in its IND slot; records it
+    out_sqn_ok = m_SQNs.Accept(subscriber->sqnRow, out_sqn_ue);
     if (!out_sqn_ok) {
-        std::cout << "gNB " << m_Id << ": SQN check failed (SQN_UE'=" << out_sqn_ue << ", LastSQN=" << last_sqn << ")" << std::endl;
-        uint64_t sqn_hn = last_sqn;
+        m_SyncFailures.fetch_add(1, std::memory_order_relaxed);
+        uint64_t sqn_hn = m_SQNs.Highest(subscriber->sqnRow);
+        std::cout << "gNB " << m_Id << ": SQN check failed (SQN_UE'=" << out_sqn_ue << ", IND=" << (out_sqn_ue & (m_SQNs.Window() - 1))
+                  << ", HighestSQN=" << sqn_hn << ")" << std::endl;
         std::vector<uint8_t> sqn_hn_bytes = Kyber::U64ToBytes(sqn_hn);
-        std::vector<uint8_t> macs_input = Kyber::ConcatBytes({sqn_hn_bytes, out_rand_prime, m_AMF});
-        std::vector<uint8_t> macs = Kyber::f1_star_K(ue_key_K, macs_input);
-        std::vector<uint8_t> csqn = Kyber::EMSK(sqn_hn_bytes);
-        out_autn_or_auts = Kyber::ConcatBytes({csqn, macs});
+        Kyber::ArenaBytes macs_input = Kyber::ConcatBytes({sqn_hn_bytes, out_rand_prime, m_AMF}, arena);
+        Kyber::ArenaBytes macs = Kyber::f1_star_K(ue_key_K, macs_input, arena);
+        Kyber::ArenaBytes csqn = Kyber::EMSK(sqn_hn_bytes, arena);
+        Kyber::ArenaBytes auts = Kyber::ConcatBytes({csqn, macs}, arena);
+        out_autn_or_auts.assign(auts.begin(), auts.end());
         std::cout << "gNB " << m_Id << ": Generated AUTS for Sync Failure." << std::endl;
         return false;
     }
@@ -310,7 +731,8 @@ bool gNB::PerformStandardAKA_Step1_2(const std::vector<uint8_t>& suci_bytes,
 
 std::vector<uint8_t> gNB::DeriveKRAN(const std::string& id, const std::vector<uint8_t>& rand_prime) {
     std::cout << "gNB " << m_Id << ": (Placeholder) Deriving KRAN for " << id << std::endl;
-    return Kyber::KDF(Kyber::StringToBytes(m_UEKeys[id]), rand_prime);
+    std::string_view key = FindUEKey(id).value_or(std::string_view());
+    return Kyber::KDF(Kyber::ByteView(reinterpret_cast<const uint8_t*>(key.data()), key.size()), rand_prime);
 
     std::string key_material = "KRAN_for_" + id;
     std::vector<uint8_t> input = Kyber::StringToBytes(key_material);
@@ -318,24 +740,286 @@ std::vector<uint8_t> gNB::DeriveKRAN(const std::string& id, const std::vector<ui
     return Kyber::KDF(input);
 }
 
-void gNB::HandleUAVFailure(UAV& failedUAV)
+UAVFailureReport gNB::HandleUAVFailure(UAV& failedUAV, size_t threads)
 {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    UAVFailureReport report;
+    report.failedUavId = failedUAV.GetID();
     std::cout << "gNB " << m_Id << ": Handling failure of UAV " << failedUAV.GetID() << std::endl;
-    if (!m_RegisteredUAVs.count(failedUAV.GetID())) return;
+    if (!m_RegisteredUAVs.count(failedUAV.GetID())) return report;
 
     auto affectedUEIds = failedUAV.GetConnectedUEIds();
     failedUAV.SetOperationalStatus(false);
+    RebuildUAVIndex();
 
+    // Group by target so each target UAV's strand takes its UEs back to back;
+    // the group sizes count against each target's load for later picks
+    std::map<int, std::vector<UE*>> groups;
+    std::map<int, UAV*> targets;
+    std::map<int, size_t> reserved;
     for (int ueId : affectedUEIds) {
-        // Placeholder: Find the actual UE object (World class might help here)
-        // Placeholder: Find the best *alternative* operational UAV for this UE
-        // Placeholder: Command the UE to handover
-        // Placeholder: Optionally inform the target UAV to expect the UE
+        UE* ue = failedUAV.FindUEById(ueId);
+        failedUAV.ReleaseUE(ueId);
+        if (!ue || ue->GetServingUAVId() != static_cast<int>(failedUAV.GetID())) continue; // Already moved on
+        report.affected++;
+        UAV* target = FindBestAlternativeUAV(ue->GetPosition(), reserved);
+        if (!target) {
+            report.stranded++;
+            continue;
+        }
+        reserved[target->GetID()]++;
+        groups[target->GetID()].push_back(ue);
+        targets[target->GetID()] = target;
+    }
+    report.targets = groups.size();
+
+    struct Move {
+        UE* ue;
+        UAV* target;
+        AuthResult result;
+    };
+    std::vector<Move> moves;
+    for (auto& [targetId, ues] : groups) {
+        for (UE* ue : ues) moves.push_back({ ue, targets[targetId], {} });
+    }
+
+    const std::chrono::milliseconds timeout(1000);
+    {
+        AuthScheduler scheduler(threads);
+        for (Move& move : moves) {
+            UE* ue = move.ue;
+            UAV* target = move.target;
+            scheduler.Spawn(RunAuthFlow([&scheduler, ue, target](FlowContext& ctx) { return UEHandoverFlow(scheduler, ctx, *ue, *target); },
+                                        timeout, move.result));
+        }
+        scheduler.WaitIdle();
+
+        // Second wave: UEs the target could not verify re-authenticate from scratch
+        for (Move& move : moves) {
+            if (move.result.status == AuthResult::Status::Success) continue;
+            UE* ue = move.ue;
+            UAV* target = move.target;
+            scheduler.Spawn(RunAuthFlow([&scheduler, ue, target](FlowContext& ctx) { return UEAccessFlow(scheduler, ctx, *ue, *target); },
+                                        timeout, move.result));
+        }
+        scheduler.WaitIdle();
+    }
+    for (const Move& move : moves) {
+        if (move.ue->GetServingUAVId() != static_cast<int>(move.target->GetID())) report.stranded++;
+        else if (move.result.phase == AuthResult::Phase::UEHandover) report.handedOver++;
+        else report.reauthenticated++;
+    }
+
+    report.recovery = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+    std::cout << "gNB " << m_Id << ": UAV " << failedUAV.GetID() << " failure recovered in " << report.recovery.count()
+              << " us: " << report.affected << " UEs, " << report.handedOver << " handed over, " << report.reauthenticated
+              << " re-authenticated, " << report.stranded << " stranded, across " << report.targets << " UAVs" << std::endl;
+    return report;
+}
+
+void gNB::RebuildUAVIndex()
+{
+    m_UAVIndex.Clear();
+    m_UAVIndexItems.clear();
+    for (const auto& [uavId, ref] : m_RegisteredUAVs) {
+        UAV* uav = ref.Get();
+        if (!uav || !uav->IsOperational() || !IsUAVAuthorized(uavId)) continue;
+        m_UAVIndex.Insert(static_cast<uint32_t>(m_UAVIndexItems.size()), uav->GetPosition());
+        m_UAVIndexItems.push_back(ref);
+    }
+}
+
+UAV* gNB::FindBestAlternativeUAV(const Position& uePosition, const std::map<int, size_t>& reserved)
+{
+    auto best = m_UAVIndex.Cheapest(uePosition, m_SelectionPolicy.distanceWeight, [&](uint32_t item, double distance) {
+        // Entries may have failed or gone since the index was built
+        UAV* uav = m_UAVIndexItems[item].Get();
+        if (!uav || !uav->IsOperational() || !uav->IsAuthenticatedWithGNB()) return std::numeric_limits<double>::infinity();
+        auto it = reserved.find(uav->GetID());
+        size_t pending = it != reserved.end() ? it->second : 0;
+        if (!uav->CanAdmit(pending)) return std::numeric_limits<double>::infinity();
+        return m_SelectionPolicy.Cost(distance, uav->GetRelayLoad(), uav->GetAssociatedGNB() == this, pending);
+    });
+    return best ? m_UAVIndexItems[*best].Get() : nullptr;
+}
+
+void gNB::SaveSnapshot(SnapshotWriter& out) const
+{
+    out.PutBytes(m_Kyber_d);
+    out.PutBytes(m_Kyber_rho);
+    out.PutBytes(m_Kyber_sigma);
+    out.PutInts(m_Kyber_sk);
+    out.PutInts(m_Kyber_pk);
+    out.Put(static_cast<uint32_t>(m_Kyber_A.size()));
+    for (const auto& row : m_Kyber_A) out.PutInts(row);
+    out.PutBytes(m_AMF);
+    out.PutString(m_ServingNetworkName);
+
+    out.Put(static_cast<uint32_t>(m_RegisteredUAVs.size()));
+    for (const auto& [uavId, ref] : m_RegisteredUAVs) out.PutRef(ref);
+    out.Put(static_cast<uint32_t>(m_UAVKeys.size()));
+    for (const auto& [uavId, key] : m_UAVKeys) {
+        out.Put<int32_t>(uavId);
+        out.PutString(key);
+    }
+
+    // Subscriber data: individually provisioned keys, the shared table and SQNs
+    out.Put(static_cast<uint64_t>(m_UEKeys.size()));
+    for (const auto& [supi, provisioned] : m_UEKeys) {
+        out.PutString(supi);
+        out.PutString(provisioned.key);
+        out.Put(static_cast<uint64_t>(provisioned.sqnRow));
+    }
+    out.PutSubscriberTable(m_Subscribers);
+    out.Put(static_cast<uint64_t>(m_SubscriberSQNBase));
+    // SQN array: window and row count, then only the rows in use
+    out.Put(m_SQNs.IndBits());
+    out.Put(static_cast<uint64_t>(m_SQNs.Rows()));
+    uint64_t used = 0;
+    for (size_t row = 0; row < m_SQNs.Rows(); ++row) used += m_SQNs.Highest(row) != 0;
+    out.Put(used);
+    for (size_t row = 0; row < m_SQNs.Rows(); ++row) {
+        if (m_SQNs.Highest(row) == 0) continue;
+        out.Put(static_cast<uint64_t>(row));
+        for (size_t ind = 0; ind < m_SQNs.Window(); ++ind) out.Put(m_SQNs.Get(row, ind));
+    }
+
+    out.PutBytes(m_GKUAV);
+    out.Put(static_cast<uint32_t>(m_UAV_KRANj.size()));
+    for (const auto& [uavId, kran] : m_UAV_KRANj) {
+        out.Put<int32_t>(uavId);
+        out.PutBytes(kran);
+    }
+    out.Put(static_cast<uint32_t>(m_UAV_TIDj.size()));
+    for (const auto& [uavId, tid] : m_UAV_TIDj) {
+        out.Put<int32_t>(uavId);
+        out.Put(tid);
+    }
+    out.Put(static_cast<uint64_t>(m_UESessions.size()));
+    for (const auto& [tid, session] : m_UESessions) {
+        out.Put(tid);
+        out.Put<int32_t>(session.ueId);
+        out.Put<int32_t>(session.servingUavId);
+    }
+    out.Put(static_cast<uint32_t>(m_UAVAuthStates.size()));
+    for (const auto& [uavId, state] : m_UAVAuthStates) {
+        out.Put<int32_t>(uavId);
+        out.PutState(state);
     }
 }
 
-UAV* gNB::FindBestAlternativeUAV(const Position& uePosition)
+bool gNB::LoadSnapshot(SnapshotReader& in, const SnapshotLinks& links)
 {
-    std::cout << "gNB " << m_Id << ": Searching for alternative UAV near (" << uePosition.first << ", " << uePosition.second << ")" << std::endl;
-    return nullptr;
+    uint32_t count = 0;
+    uint64_t count64 = 0;
+    in.GetBytes(m_Kyber_d);
+    in.GetBytes(m_Kyber_rho);
+    in.GetBytes(m_Kyber_sigma);
+    in.GetInts(m_Kyber_sk);
+    in.GetInts(m_Kyber_pk);
+    if (!in.Get(count) || count > 16) return false; // Module rank is tiny
+    m_Kyber_A.assign(count, {});
+    for (auto& row : m_Kyber_A) in.GetInts(row);
+    in.GetBytes(m_AMF);
+    in.GetString(m_ServingNetworkName);
+    if (!in.Ok()) return false;
+    m_NetworkParams = std::make_shared<const Kyber::NetworkParams>(
+        Kyber::NetworkParams{ m_AMF, m_Kyber_rho, m_Kyber_pk, m_Kyber_A, m_ServingNetworkName });
+
+    m_RegisteredUAVs.clear();
+    for (in.Get(count); in.Ok() && count > 0; --count) {
+        EntityRef<UAV> ref;
+        if (in.GetRef(ref, links.uav) && ref.Get()) m_RegisteredUAVs[ref.Get()->GetID()] = ref;
+    }
+    m_UAVKeys.clear();
+    for (in.Get(count); in.Ok() && count > 0; --count) {
+        int32_t uavId = 0;
+        in.Get(uavId);
+        in.GetString(m_UAVKeys[uavId]);
+    }
+
+    m_UEKeys.clear();
+    for (in.Get(count64); in.Ok() && count64 > 0; --count64) {
+        std::string supi;
+        uint64_t row = 0;
+        in.GetString(supi);
+        ProvisionedUE& provisioned = m_UEKeys[supi];
+        in.GetString(provisioned.key);
+        in.Get(row);
+        provisioned.sqnRow = static_cast<size_t>(row);
+    }
+    in.GetSubscriberTable(m_Subscribers);
+    uint64_t base = 0, rows = 0;
+    uint32_t indBits = 0;
+    in.Get(base);
+    in.Get(indBits);
+    in.Get(rows);
+    if (!in.Ok() || indBits > SQNArray::MaxIndBits || base > rows) return false;
+    for (const auto& [supi, provisioned] : m_UEKeys) {
+        if (provisioned.sqnRow >= rows) return false;
+    }
+    if (m_Subscribers && base + m_Subscribers->Size() > rows) return false;
+    m_SubscriberSQNBase = static_cast<size_t>(base);
+    m_SQNs = SQNArray(indBits);
+    m_SQNs.AddRows(static_cast<size_t>(rows));
+    for (in.Get(count64); in.Ok() && count64 > 0; --count64) {
+        uint64_t row = 0;
+        if (!in.Get(row) || row >= rows) return false;
+        for (size_t ind = 0; ind < m_SQNs.Window(); ++ind) {
+            uint64_t sqn = 0;
+            in.Get(sqn);
+            m_SQNs.Set(static_cast<size_t>(row), ind, sqn);
+        }
+    }
+
+    in.GetBytes(m_GKUAV);
+    m_UAV_KRANj.clear();
+    for (in.Get(count); in.Ok() && count > 0; --count) {
+        int32_t uavId = 0;
+        in.Get(uavId);
+        in.GetBytes(m_UAV_KRANj[uavId]);
+    }
+    m_UAV_TIDj.clear();
+    m_UAVByTID.clear();
+    for (in.Get(count); in.Ok() && count > 0; --count) {
+        int32_t uavId = 0;
+        Kyber::TID tid;
+        in.Get(uavId);
+        in.Get(tid);
+        AssignUAVTID(uavId, tid);
+    }
+    m_UESessions.clear();
+    m_UESessionTIDs.clear();
+    for (in.Get(count64); in.Ok() && count64 > 0; --count64) {
+        Kyber::TID tid;
+        int32_t ueId = 0, servingUavId = -1;
+        in.Get(tid);
+        in.Get(ueId);
+        in.Get(servingUavId);
+        RegisterUESession(ueId, tid, servingUavId);
+    }
+    m_UAVAuthStates.clear();
+    for (in.Get(count); in.Ok() && count > 0; --count) {
+        int32_t uavId = 0;
+        in.Get(uavId);
+        in.GetState(m_UAVAuthStates[uavId]);
+    }
+
+    // The key tree is not saved: authorized UAVs rejoin under their KRANj
+    // and get fresh path keys with the next rekey
+    m_GroupKeys = GroupKeyTree();
+    m_GroupKeys.SetGroupKey(m_GKUAV);
+    for (const auto& [uavId, state] : m_UAVAuthStates) {
+        auto kran_it = m_UAV_KRANj.find(uavId);
+        if (state.Is(GNBUAVAuthState::Authorized) && kran_it != m_UAV_KRANj.end()) {
+            m_GroupKeys.Join(static_cast<uint32_t>(uavId), kran_it->second);
+        }
+    }
+
+    m_OngoingUAVAuths.clear();
+    m_OngoingUEAuths.clear();
+    m_ResumptionCache.clear();
+    m_ResumptionOrder.clear();
+    return in.Ok();
 }
@@ -2,39 +2,178 @@
 
 #include "Entity.h"
 #include "KyberUtils.h" // Include Kyber utilities
+#include "TimingWheel.h"
+#include "EntityPool.h"
+#include "StateMachine.h"
+#include "AuthMessages.h"
+#include "GroupKeyTree.h"
+#include "SubscriberTable.h"
+#include "SQNArray.h"
+#include "SpatialGrid.h"
+#include "UAVLoad.h"
 
 class gNB;
 class UAV;
 class UE;
+class SnapshotWriter;
+class SnapshotReader;
+struct SnapshotLinks;
 
 #include "UAV.h"
 #include "UE.h"
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
 #include <map>
 #include <memory>
 #include <string>
 #include <iostream>
 #include <vector>
-#include <set> // For authorized UAVs
+#include <optional>
 #include <random>
+#include <span>
 #include <string>
+#include <unordered_map>
 
 
-// Helper to generate random bytes (can be moved to a common utility)
+// Helper to generate random bytes (can be moved to a common utility).
+// Each thread seeds its generator once and takes 8 bytes per draw, so one
+// call can produce the RANDs of a whole batch.
 inline std::vector<uint8_t> GenerateRandomBytesUtil(size_t numBytes) {
+    thread_local std::mt19937_64 gen(std::random_device{}());
     std::vector<uint8_t> bytes(numBytes);
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distrib(0, 255);
-    for (size_t i = 0; i < numBytes; ++i) {
-        bytes[i] = static_cast<uint8_t>(distrib(gen));
+    for (size_t i = 0; i < numBytes; i += 8) {
+        uint64_t word = gen();
+        for (size_t b = i; b < std::min(i + 8, numBytes); ++b, word >>= 8) {
+            bytes[b] = static_cast<uint8_t>(word);
+        }
     }
     return bytes;
 }
 
 
+// gNB view of one UAV's Phase A service access authentication
+enum class GNBUAVAuthState : uint8_t { Unauthenticated, ChallengeSent, Authorized, Count };
+enum class GNBUAVAuthEvent : uint8_t { Challenge, Confirm, Timeout, Revoke, Count };
+
+struct GNBUAVAuthTraits {
+    using State = GNBUAVAuthState;
+    using Event = GNBUAVAuthEvent;
+    using Handler = void (*)(gNB&, int uavId);
+    using Row = StateTransition<State, Event, Handler>;
+
+    static constexpr const char* Name = "gNB UAV auth (Phase A)";
+    static constexpr State Initial = State::Unauthenticated;
+
+    static const char* StateName(State state)
+    {
+        static constexpr const char* names[] = { "Unauthenticated", "ChallengeSent", "Authorized" };
+        return names[static_cast<size_t>(state)];
+    }
+    static const char* EventName(Event event)
+    {
+        static constexpr const char* names[] = { "Challenge", "Confirm", "Timeout", "Revoke" };
+        return names[static_cast<size_t>(event)];
+    }
+
+    // A UAV that never confirmed keeps no keying material (gNB.cpp)
+    static void DropUAVKeys(gNB& gnb, int uavId);
+
+    static constexpr std::array Table{
+        Row{ State::Unauthenticated, Event::Challenge, State::ChallengeSent },
+        Row{ State::ChallengeSent,   Event::Challenge, State::ChallengeSent },
+        Row{ State::Authorized,      Event::Challenge, State::ChallengeSent }, // Re-authentication
+        Row{ State::ChallengeSent,   Event::Confirm,   State::Authorized },
+        Row{ State::ChallengeSent,   Event::Timeout,   State::Unauthenticated, &DropUAVKeys },
+        Row{ State::ChallengeSent,   Event::Revoke,    State::Unauthenticated, &DropUAVKeys },
+        Row{ State::Authorized,      Event::Revoke,    State::Unauthenticated, &DropUAVKeys },
+    };
+};
+
+// gNB view of one UE's UAV-assisted Phase B authentication. Phase B has no
+// confirmation back to the gNB, so Accepted and Rejected are transient: the
+// pending entry is erased as soon as the response is built.
+enum class GNBUEAuthState : uint8_t { Idle, Verifying, Accepted, Rejected, Count };
+enum class GNBUEAuthEvent : uint8_t { SuciReceived, AkaPassed, AkaFailed, Count };
+
+struct GNBUEAuthTraits {
+    using State = GNBUEAuthState;
+    using Event = GNBUEAuthEvent;
+    using Handler = void (*)();
+    using Row = StateTransition<State, Event, Handler>;
+
+    static constexpr const char* Name = "gNB UE auth (Phase B)";
+    static constexpr State Initial = State::Idle;
+
+    static const char* StateName(State state)
+    {
+        static constexpr const char* names[] = { "Idle", "Verifying", "Accepted", "Rejected" };
+        return names[static_cast<size_t>(state)];
+    }
+    static const char* EventName(Event event)
+    {
+        static constexpr const char* names[] = { "SuciReceived", "AkaPassed", "AkaFailed" };
+        return names[static_cast<size_t>(event)];
+    }
+
+    static constexpr std::array Table{
+        Row{ State::Idle,      Event::SuciReceived, State::Verifying },
+        Row{ State::Verifying, Event::AkaPassed,    State::Accepted },
+        Row{ State::Verifying, Event::AkaFailed,    State::Rejected },
+    };
+};
+
+// Outcome of gNB::HandleUAVFailure
+struct UAVFailureReport {
+    int failedUavId = -1;
+    size_t affected = 0;        // UEs the failed UAV was serving
+    size_t handedOver = 0;      // Phase C to an alternative UAV
+    size_t reauthenticated = 0; // Handover failed; full Phase B via the alternative
+    size_t stranded = 0;        // No alternative UAV, or both attempts failed
+    size_t targets = 0;         // Alternative UAVs taking UEs
+    std::chrono::microseconds recovery{ 0 }; // Failure handling start -> last UE settled
+};
+
+// Inter-gNB handovers seen by one gNB (gNB::GetXnStats)
+struct XnHandoverStats {
+    uint64_t prepared = 0; // As source: contexts handed to a target gNB
+    uint64_t accepted = 0; // As target: TGKi re-issued under this gNB's group key
+    uint64_t rejected = 0; // Bad MAC or expired token
+};
+
+// Bounds of the fast re-authentication cache. Entries past their lifetime
+// are dropped, and the oldest go first when the cache is full; capacity 0
+// turns resumption off.
+struct ResumptionLimits {
+    size_t maxEntries = 65536;
+    uint32_t lifetimeMs = 600000; // Re-attaches later than this run a full Phase B
+};
+
+// Fast re-authentication seen by one gNB (gNB::GetResumptionStats)
+struct ResumptionStats {
+    uint64_t hits = 0;      // Resumed without KEM or AKA work
+    uint64_t misses = 0;    // No cached context; the UE falls back to Phase B
+    uint64_t rejected = 0;  // Bad MAC or replayed counter
+    uint64_t expired = 0;   // Dropped at end of lifetime
+    uint64_t evicted = 0;   // Dropped to make room
+    uint64_t fullAuths = 0; // Accepted full Phase B runs, for comparison
+    std::chrono::nanoseconds fullAuthTime{ 0 };
+    std::chrono::nanoseconds resumeTime{ 0 };
+
+    double HitRate() const { return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+    // gNB processing time saved per hit, from the averages of both paths
+    double SavedMicrosPerHit() const
+    {
+        if (!hits || !fullAuths) return 0.0;
+        double full = std::chrono::duration<double, std::micro>(fullAuthTime).count() / fullAuths;
+        double resume = std::chrono::duration<double, std::micro>(resumeTime).count() / hits;
+        return full - resume;
+    }
+};
+
 // Base Station class (Ground RAN)
-class gNB : public Entity, public std::enable_shared_from_this<gNB> { // Ensure enable_shared_from_this is on gNB itself
+class gNB : public Entity, public EnableSelfRef<gNB> {
 public:
     gNB(uint32_t xPos, uint32_t yPos, uint32_t xVel = 0, uint32_t yVel = 0, uint32_t id = 0)
         : Entity(xPos, yPos, xVel, yVel, id), m_AMF({0x00, 0x00}), m_ServingNetworkName("TestNet") // Initialize AMF and Network Name
@@ -47,8 +186,9 @@ public:
     const Kyber::Polynomial& GetKyberPublicKey() const { return m_Kyber_pk; }
     const std::vector<uint8_t>& GetKyberRho() const { return m_Kyber_rho; }
     const std::vector<uint8_t>& GetAMF() const { return m_AMF; }
+    const std::shared_ptr<const Kyber::NetworkParams>& GetNetworkParams() const { return m_NetworkParams; }
 
-    void RegisterUAV(std::shared_ptr<UAV> uav);
+    void RegisterUAV(UAV& uav);
 
     // --- Authentication ---
     // Setup Kyber parameters for the gNB
@@ -59,6 +199,26 @@ public:
 
     void ProvisionUAVKey(int uavId, const std::string& key);
 
+    // Bulk provisioning: SUPIs not found in m_UEKeys are looked up in this
+    // shared read-only table (e.g. a memory-mapped scenario file)
+    void AttachSubscriberTable(std::shared_ptr<const SubscriberTable> table);
+
+    // A UE left the system: drop any pending access for it and its SQN
+    // record, so its recycled ID registers afresh. Keys stay provisioned.
+    void ReleaseUE(int ueId, const std::string& supi);
+
+    // SQN replay window: 2^indBits slots per subscriber (SQNArray). Set it
+    // before authentications start; already accepted SQNs stay stale.
+    void SetSQNWindow(uint32_t indBits) { m_SQNs.SetIndBits(indBits); }
+    uint32_t GetSQNWindowBits() const { return m_SQNs.IndBits(); }
+    // SQNs rejected as stale, each costing the UE a resync round trip
+    uint64_t GetSyncFailureCount() const { return m_SyncFailures.load(std::memory_order_relaxed); }
+
+    // --- Snapshot (see Snapshot.h) ---
+    // In-flight exchanges are not saved; snapshot a settled world.
+    void SaveSnapshot(SnapshotWriter& out) const;
+    bool LoadSnapshot(SnapshotReader& in, const SnapshotLinks& links);
+
 
     // Process authentication request (SUCI) forwarded by a UAV
     // SUCI = C1 || C2 || MAC || Other (Other is ignored for now)
@@ -68,32 +228,117 @@ public:
                                       UAV& originatingUAV, // Need UAV to send response back
                                       int ueId); // Need UE ID for context
 
-    // Handle UAV failure: Find new UAVs for affected UEs
-    void HandleUAVFailure(UAV& failedUAV);
+    // Handle UAV failure: take the UAV out of service and re-home every UE
+    // it was serving. UEs are grouped by their best alternative UAV and the
+    // groups run Phase C as one parallel batch on `threads` workers; UEs
+    // whose handover fails fall back to a full Phase B through the same
+    // UAV. Blocks until every UE has settled.
+    UAVFailureReport HandleUAVFailure(UAV& failedUAV, size_t threads = 4);
 
-    virtual UAV* FindBestAlternativeUAV(const Position& uePosition);
+    // Lowest-cost operational, authorized UAV of this gNB with room for the
+    // UE, from the index built by the last RebuildUAVIndex(). `reserved`
+    // holds UEs already assigned per UAV ID in the current batch.
+    virtual UAV* FindBestAlternativeUAV(const Position& uePosition, const std::map<int, size_t>& reserved = {});
+    void RebuildUAVIndex();
+    void SetUAVSelectionPolicy(const UAVSelectionPolicy& policy) { m_SelectionPolicy = policy; }
 
     // --- UAV Service Access Authentication (Phase A) ---
     // Called by gNB to initiate auth for a specific UAV
     void InitiateUAVServiceAccessAuth(int uavId);
+    // Challenges for many UAVs at once, in the order of `uavIds` (nullopt
+    // where refused): one expiry sweep, one RNG draw for every RAND' and a
+    // summary line instead of per-UAV logging
+    std::vector<std::optional<UAVAuthChallenge>> BuildUAVServiceAccessChallenges(std::span<const int> uavIds);
+    // Confirmations of UAVs that verified a batch; returns how many were authorized
+    size_t AcceptServiceAccessConfirmations(std::span<const int> uavIds);
     // Called by UAV to confirm successful authentication
     void ReceiveServiceAccessConfirmation(int uavId);
+    bool IsUAVAuthorized(int uavId) const;
 
     // --- UAV-Assisted UE Access Authentication (Phase B) ---
     // Process auth request coming via an authenticated UAV
     void ProcessUAVAssistedAuthRequest(const std::vector<uint8_t>& suci_bytes,
-                                       const std::string& tid_j, // UAV's Temp ID
+                                       const Kyber::TID& tid_j, // UAV's Temp ID
                                        UAV& originatingUAV,
                                        int ueId);
 
+    // --- Fast Re-authentication ---
+    // Resume a UE from the KRANi cached at its last Phase B (or resumption):
+    // a fresh TIDi, KUAVi and token under the next KRANi, with no SUCI
+    // decapsulation or AKA. Rejected on a miss; the UE then runs Phase B.
+    void ProcessResumeRequest(const ResumeRequest& request, const Kyber::TID& tid_j, UAV& originatingUAV, int ueId);
+    void SetResumptionLimits(const ResumptionLimits& limits);
+    const ResumptionStats& GetResumptionStats() const { return m_ResumptionStats; }
+    size_t GetResumptionCacheSize() const { return m_ResumptionCache.size(); }
+
     // --- UE Handover Authentication (Phase C) ---
-    // Receive handover inform message from target UAV
-    void ReceiveHandoverInform(const std::string& tid_star_j, const std::string& tid_i);
+    // Receive handover inform message from target UAV; both TIDs resolve
+    // through the TID indexes below
+    void ReceiveHandoverInform(const Kyber::TID& tid_star_j, const Kyber::TID& tid_i);
+
+    // --- Temporary Identities ---
+    // UE holding session `tid_i` and the UAV currently serving it (-1 until
+    // a handover inform names one, for sessions taken over via Xn)
+    struct UESession {
+        int ueId = 0;
+        int servingUavId = -1;
+    };
+    std::optional<UESession> FindUESession(const Kyber::TID& tid_i) const;
+    std::optional<int> FindUAVByTID(const Kyber::TID& tid_j) const;
+    size_t GetUESessionCount() const { return m_UESessions.size(); }
+
+    // --- Inter-gNB Handover (Xn) ---
+    // Replaces a full Phase B when a UE moves to a UAV of another gNB: a
+    // few KDFs on each side instead of a KEM decapsulation.
+    // Source side: check the UE's proof of TGKi and derive its context for
+    // the target gNB
+    std::optional<XnHandoverContext> PrepareXnHandover(int ueId, const XnHandoverRequest& request);
+    // Target side: re-issue TGKi under this gNB's GKUAV, wrapped with NH
+    std::optional<XnHandoverCommand> AcceptXnHandover(int ueId, const XnHandoverContext& context);
+    const XnHandoverStats& GetXnStats() const { return m_XnStats; }
+
+    // --- UAV Group Key ---
+    // UAVs join the key tree (GroupKeyTree.h) as their Phase A completes.
+    // Joins, revocations and rotations are batched until RekeyUAVGroup()
+    // broadcasts one rekey to every registered UAV; each rekey replaces
+    // GKUAV, so UE tokens issued under the old one stop verifying.
+    void RevokeUAV(int uavId); // Also ends its authorization
+    void RotateGroupKey();
+    GroupRekey RekeyUAVGroup();
+    const GroupKeyTree& GetGroupKeyTree() const { return m_GroupKeys; }
+    const std::vector<uint8_t>& GetGroupKey() const { return m_GKUAV; }
 
     // --- General ---
-    void GenerateGroupKey(); // Generate GKUAV
+    void GenerateGroupKey(); // Generate GKUAV, without telling the UAVs
+
+    // --- Protocol steps ---
+    // Each handles one incoming message and returns the reply without
+    // calling the next hop. The entry points above chain them synchronously;
+    // the coroutine flows (AuthFlows.h) deliver the replies themselves.
+    std::optional<UAVAuthChallenge> BuildUAVServiceAccessChallenge(int uavId);
+    bool AcceptServiceAccessConfirmation(int uavId);
+    UEAuthResponse AuthenticateUE(const std::vector<uint8_t>& suci_bytes, const Kyber::TID& tid_j, int uavId, int ueId);
+    UEAuthResponse ResumeUE(const ResumeRequest& request, const Kyber::TID& tid_j, int uavId, int ueId);
+
+    // --- Auth-State Expiry ---
+    void Update(float deltaTime) override;
+    void SetAuthStateLimits(const AuthStateLimits& limits) { m_AuthLimits = limits; }
+    const AuthStateStats& GetAuthStateStats() const { return m_AuthStats; }
+    // Evict pending auths whose deadline has passed
+    void ExpireAuthState();
 
 private:
+    friend struct GNBUAVAuthTraits;
+
+    // --- Phase A ---
+    static constexpr size_t RandPrimeBytes = 32;
+    // Kj of a UAV that may be challenged now, or null (logged)
+    const std::string* AdmitUAVChallenge(int uavId);
+    // Steps 1-4 for one admitted UAV: KRANj, RES*j, a fresh TIDj, Cj and
+    // HRES*j; registers TIDj and the pending auth
+    UAVAuthChallenge DeriveUAVServiceAccessChallenge(int uavId, const std::string& uav_key_Kj, std::vector<uint8_t> rand_prime);
+    bool AuthorizeUAV(int uavId);
+
     // --- Authentication Success (Step 3)
     void HandleAuthSuccess(const std::string& supi, const std::vector<uint8_t>& rand_prime, uint64_t sqn_ue_prime, UAV& uav, int ueId);
     // Sync Failure (Step 3*)
@@ -102,7 +347,10 @@ private:
     void HandleMacFailure(UAV& uav, int ueId);
 
     // --- Authentication State & Keys ---
-    std::map<int, std::weak_ptr<UAV>> m_RegisteredUAVs; // UAVs associated with this gNB
+    std::map<int, EntityRef<UAV>> m_RegisteredUAVs; // UAVs associated with this gNB
+    SpatialGrid m_UAVIndex;                     // Positions of serving-capable UAVs
+    std::vector<EntityRef<UAV>> m_UAVIndexItems; // Grid item -> UAV
+    UAVSelectionPolicy m_SelectionPolicy;
     std::string m_PublicKey = "NULL"; // Legacy?
     std::string m_PrivateKey = "NULL"; // Legacy?
 
@@ -118,31 +366,78 @@ private:
 
     std::vector<uint8_t> m_AMF;          // Authentication Management Field
     std::string m_ServingNetworkName;    // Serving Network Name
+    std::shared_ptr<const Kyber::NetworkParams> m_NetworkParams; // Shared with provisioned UEs
 
-    std::map<std::string, std::string> m_UEKeys; // Map SUPI -> Long-term key K
-    std::map<std::string, uint64_t> m_UESequenceNumbers; // Map SUPI -> Last accepted SQN_UE (for replay protection)
-
-    std::vector<uint8_t> m_GKUAV; // Group Key for UAVs
+    // Individually provisioned subscriber
+    struct ProvisionedUE {
+        std::string key; // Long-term key K
+        size_t sqnRow;   // Row in m_SQNs
+    };
+    std::map<std::string, ProvisionedUE> m_UEKeys; // Map SUPI -> K and SQN row
+    std::shared_ptr<const SubscriberTable> m_Subscribers; // Bulk-provisioned SUPI -> K
+    size_t m_SubscriberSQNBase = 0; // Row of table record 0; records map to consecutive rows
+    SQNArray m_SQNs;                // Accepted SQN_UE per subscriber (replay protection)
+    std::atomic<uint64_t> m_SyncFailures{ 0 };
+
+    std::vector<uint8_t> m_GKUAV; // Group Key for UAVs, the root key of m_GroupKeys
+    GroupKeyTree m_GroupKeys;     // Leaves keyed with each authorized UAV's KRANj
     std::map<int, std::vector<uint8_t>> m_UAV_KRANj; // Map UAV ID -> KRANj
-    std::map<int, std::string> m_UAV_TIDj; // Map UAV ID -> TIDj
-    std::set<int> m_AuthorizedUAVs; // Set of UAV IDs that completed Phase A
+    std::map<int, Kyber::TID> m_UAV_TIDj; // Map UAV ID -> TIDj
+    std::unordered_map<Kyber::TID, int, Kyber::TIDHash> m_UAVByTID; // TIDj -> UAV ID, kept in step with m_UAV_TIDj
+
+    // Issued TIDi -> session, and UE ID -> its current TIDi so a re-issued
+    // TIDi retires the old entry
+    std::unordered_map<Kyber::TID, UESession, Kyber::TIDHash> m_UESessions;
+    std::unordered_map<int, Kyber::TID> m_UESessionTIDs;
+    std::map<int, StateMachine<GNBUAVAuthTraits>> m_UAVAuthStates; // Map UAV ID -> Phase A state
 
     // Store state during ongoing authentications
     struct OngoingUAVAuthInfo {
         std::vector<uint8_t> res_star_j; // Expected RES*j from UAV (or HRES*j?)
         std::vector<uint8_t> kran_j;     // Derived KRANj for this session
+        uint64_t expiryTick = 0;         // Deadline for confirmation
         // Add other necessary state from AKA...
     };
     std::map<int, OngoingUAVAuthInfo> m_OngoingUAVAuths; // Map UAV ID -> Auth Info
 
     struct OngoingUEAuthInfo {
-         std::string tid_j;
+         Kyber::TID tid_j;
          std::vector<uint8_t> kran_i; // Derived KRANi for UE session
          std::vector<uint8_t> res_star_i; // RES*i calculated for UE
+         StateMachine<GNBUEAuthTraits> state;
          // Add other necessary state from AKA...
      };
     std::map<int, OngoingUEAuthInfo> m_OngoingUEAuths; // Map UE ID -> Auth Info
 
+    // Pending Phase A expiry by UAV ID (lazy cancellation: an entry fires
+    // only if the table still holds the same deadline)
+    TimingWheel<int> m_ExpiryWheel{ AuthStateNowTick() };
+    AuthStateLimits m_AuthLimits;
+    AuthStateStats m_AuthStats;
+    XnHandoverStats m_XnStats;
+
+    // Fast re-authentication contexts by UE ID. m_ResumptionOrder holds
+    // (UE ID, expiry) in insertion order, which is also expiry order; a
+    // record whose expiry no longer matches the entry is stale.
+    struct ResumptionContext {
+        Kyber::TID tid_i;
+        std::vector<uint8_t> kran_i;
+        uint64_t counter = 0; // Highest counter accepted under this KRANi
+        uint64_t expiryTick = 0;
+    };
+    std::unordered_map<int, ResumptionContext> m_ResumptionCache;
+    std::deque<std::pair<int, uint64_t>> m_ResumptionOrder;
+    ResumptionLimits m_ResumptionLimits;
+    ResumptionStats m_ResumptionStats;
+
+    void CacheResumptionContext(int ueId, const Kyber::TID& tid_i, std::vector<uint8_t> kran_i);
+    void TrimResumptionCache();
+
+    // Both TID indexes go through these
+    void AssignUAVTID(int uavId, const Kyber::TID& tid_j);
+    void RegisterUESession(int ueId, const Kyber::TID& tid_i, int servingUavId);
+    void DropUESession(int ueId);
+
     // --- Private Helper Methods ---
     // Placeholder for standard AKA steps (modified from ProcessAuthenticationRequest)
     bool PerformStandardAKA_Step1_2(const std::vector<uint8_t>& suci_bytes,
@@ -151,11 +446,23 @@ private:
                                      std::vector<uint8_t>& out_autn_or_auts, // AUTN on success, AUTS on sync fail
                                      bool& out_mac_ok, bool& out_sqn_ok);
 
+    // Long-term key K and SQN row for `supi`, from m_UEKeys or the
+    // subscriber table
+    struct SubscriberRecord {
+        std::string_view key;
+        size_t sqnRow;
+    };
+    std::optional<SubscriberRecord> FindSubscriber(const std::string& supi) const;
+    std::optional<std::string_view> FindUEKey(const std::string& supi) const;
+
+    // Fill in TIDi, KUAVi and Ci (TIDi || Tokeni under KRANi) of a response
+    void IssueUESession(int ueId, const Kyber::TID& tid_j, const std::vector<uint8_t>& kran_i, UEAuthResponse& response);
+
     // Placeholder for deriving keys based on standard AKA
     std::vector<uint8_t> DeriveKRAN(const std::string& supi_or_uav_id, const std::vector<uint8_t>& rand_prime);
 
     // Handle results of standard AKA for UAV
     void HandleUAV_AKA_Result(int uavId, bool mac_ok, bool sqn_ok, const std::vector<uint8_t>& autn_or_auts, const std::vector<uint8_t>& rand_prime);
     // Handle results of standard AKA for UE (via UAV)
-    void HandleUE_AKA_Result(int ueId, UAV& uav, const std::string& tid_j, const std::string& supi, bool mac_ok, bool sqn_ok, const std::vector<uint8_t>& autn_or_auts, const std::vector<uint8_t>& rand_prime);
+    void HandleUE_AKA_Result(int ueId, UAV& uav, const Kyber::TID& tid_j, const std::string& supi, bool mac_ok, bool sqn_ok, const std::vector<uint8_t>& autn_or_auts, const std::vector<uint8_t>& rand_prime);
 };